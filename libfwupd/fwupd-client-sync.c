@@ -21,10 +21,13 @@ typedef struct {
 	gchar		*str;
 	GError		*error;
 	GPtrArray	*array;
+	GPtrArray	*array2;
+	guint64		 generation;
 	GMainContext	*context;
 	GMainLoop	*loop;
 	GVariant	*val;
 	GHashTable	*hash;
+	GHashTable	*hash2;
 	GBytes		*bytes;
 	FwupdDevice	*device;
 } FwupdClientHelper;
@@ -38,8 +41,12 @@ fwupd_client_helper_free (FwupdClientHelper *helper)
 		g_error_free (helper->error);
 	if (helper->array != NULL)
 		g_ptr_array_unref (helper->array);
+	if (helper->array2 != NULL)
+		g_ptr_array_unref (helper->array2);
 	if (helper->hash != NULL)
 		g_hash_table_unref (helper->hash);
+	if (helper->hash2 != NULL)
+		g_hash_table_unref (helper->hash2);
 	if (helper->bytes != NULL)
 		g_bytes_unref (helper->bytes);
 	if (helper->device != NULL)
@@ -154,6 +161,72 @@ fwupd_client_get_devices (FwupdClient *self, GCancellable *cancellable, GError *
 	return g_steal_pointer (&helper->array);
 }
 
+static void
+fwupd_client_get_devices_since_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientHelper *helper = (FwupdClientHelper *) user_data;
+	helper->ret = fwupd_client_get_devices_since_finish (FWUPD_CLIENT (source), res,
+							     &helper->generation,
+							     &helper->array,
+							     &helper->array2,
+							     &helper->error);
+	g_main_loop_quit (helper->loop);
+}
+
+/**
+ * fwupd_client_get_devices_since:
+ * @self: A #FwupdClient
+ * @generation: the generation returned from a previous call, or 0
+ * @generation_current: (out) (optional): the current generation to use for the next call
+ * @devices: (out) (optional) (element-type FwupdDevice) (transfer container): added or changed devices
+ * @removed_ids: (out) (optional) (element-type utf8) (transfer container): removed device IDs
+ * @cancellable: the #GCancellable, or %NULL
+ * @error: the #GError, or %NULL
+ *
+ * Gets the devices that have been added or changed since @generation, and the
+ * IDs of any devices that have been removed.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fwupd_client_get_devices_since (FwupdClient *self,
+				guint64 generation,
+				guint64 *generation_current,
+				GPtrArray **devices,
+				GPtrArray **removed_ids,
+				GCancellable *cancellable,
+				GError **error)
+{
+	g_autoptr(FwupdClientHelper) helper = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* connect */
+	if (!fwupd_client_connect (self, cancellable, error))
+		return FALSE;
+
+	/* call async version and run loop until complete */
+	helper = fwupd_client_helper_new (self);
+	fwupd_client_get_devices_since_async (self, generation, cancellable,
+					      fwupd_client_get_devices_since_cb, helper);
+	g_main_loop_run (helper->loop);
+	if (!helper->ret) {
+		g_propagate_error (error, g_steal_pointer (&helper->error));
+		return FALSE;
+	}
+	if (generation_current != NULL)
+		*generation_current = helper->generation;
+	if (devices != NULL)
+		*devices = g_steal_pointer (&helper->array);
+	if (removed_ids != NULL)
+		*removed_ids = g_steal_pointer (&helper->array2);
+	return TRUE;
+}
+
 static void
 fwupd_client_get_plugins_cb (GObject *source, GAsyncResult *res, gpointer user_data)
 {
@@ -244,6 +317,67 @@ fwupd_client_get_history (FwupdClient *self, GCancellable *cancellable, GError *
 	return g_steal_pointer (&helper->array);
 }
 
+static void
+fwupd_client_get_history_full_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientHelper *helper = (FwupdClientHelper *) user_data;
+	helper->array = fwupd_client_get_history_full_finish (FWUPD_CLIENT (source), res, &helper->error);
+	g_main_loop_quit (helper->loop);
+}
+
+/**
+ * fwupd_client_get_history_full:
+ * @self: A #FwupdClient
+ * @device_id: (nullable): the device ID to match, or %NULL for any
+ * @update_state: the #FwupdUpdateState to match, or %FWUPD_UPDATE_STATE_UNKNOWN for any
+ * @modified_min: the earliest modification time to include, or 0
+ * @modified_max: the latest modification time to include, or 0
+ * @offset: the number of matching entries to skip
+ * @limit: the maximum number of entries to return, or 0 for no limit
+ * @cancellable: the #GCancellable, or %NULL
+ * @error: the #GError, or %NULL
+ *
+ * Gets a filtered page of the history.
+ *
+ * Returns: (element-type FwupdDevice) (transfer container): results
+ *
+ * Since: 1.5.8
+ **/
+GPtrArray *
+fwupd_client_get_history_full (FwupdClient *self,
+			       const gchar *device_id,
+			       FwupdUpdateState update_state,
+			       guint64 modified_min,
+			       guint64 modified_max,
+			       guint offset,
+			       guint limit,
+			       GCancellable *cancellable,
+			       GError **error)
+{
+	g_autoptr(FwupdClientHelper) helper = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* connect */
+	if (!fwupd_client_connect (self, cancellable, error))
+		return NULL;
+
+	/* call async version and run loop until complete */
+	helper = fwupd_client_helper_new (self);
+	fwupd_client_get_history_full_async (self, device_id, update_state,
+					     modified_min, modified_max,
+					     offset, limit, cancellable,
+					     fwupd_client_get_history_full_cb, helper);
+	g_main_loop_run (helper->loop);
+	if (helper->array == NULL) {
+		g_propagate_error (error, g_steal_pointer (&helper->error));
+		return NULL;
+	}
+	return g_steal_pointer (&helper->array);
+}
+
 static void
 fwupd_client_get_releases_cb (GObject *source, GAsyncResult *res, gpointer user_data)
 {
@@ -388,6 +522,61 @@ fwupd_client_get_upgrades (FwupdClient *self, const gchar *device_id,
 	return g_steal_pointer (&helper->array);
 }
 
+static void
+fwupd_client_get_all_upgrades_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientHelper *helper = (FwupdClientHelper *) user_data;
+	helper->hash = fwupd_client_get_all_upgrades_finish (FWUPD_CLIENT (source), res,
+							     &helper->hash2, &helper->error);
+	g_main_loop_quit (helper->loop);
+}
+
+/**
+ * fwupd_client_get_all_upgrades:
+ * @self: A #FwupdClient
+ * @errors: (out) (optional) (element-type utf8 GError) (transfer container): device ID:error
+ * @cancellable: the #GCancellable, or %NULL
+ * @error: the #GError, or %NULL
+ *
+ * Gets all the upgrades for all the devices in one call. Devices with no
+ * upgrades available are not included, and the reason for each is returned
+ * in @errors instead.
+ *
+ * Returns: (element-type utf8 GPtrArray) (transfer container): device ID:releases
+ *
+ * Since: 1.5.8
+ **/
+GHashTable *
+fwupd_client_get_all_upgrades (FwupdClient *self,
+			       GHashTable **errors,
+			       GCancellable *cancellable,
+			       GError **error)
+{
+	g_autoptr(FwupdClientHelper) helper = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* connect */
+	if (!fwupd_client_connect (self, cancellable, error))
+		return NULL;
+
+	/* call async version and run loop until complete */
+	helper = fwupd_client_helper_new (self);
+	fwupd_client_get_all_upgrades_async (self, cancellable,
+					     fwupd_client_get_all_upgrades_cb,
+					     helper);
+	g_main_loop_run (helper->loop);
+	if (helper->hash == NULL) {
+		g_propagate_error (error, g_steal_pointer (&helper->error));
+		return NULL;
+	}
+	if (errors != NULL)
+		*errors = g_steal_pointer (&helper->hash2);
+	return g_steal_pointer (&helper->hash);
+}
+
 static void
 fwupd_client_get_details_bytes_cb (GObject *source, GAsyncResult *res, gpointer user_data)
 {
@@ -2072,6 +2261,67 @@ fwupd_client_download_bytes (FwupdClient *self,
 	return g_steal_pointer (&helper->bytes);
 }
 
+static void
+fwupd_client_download_releases_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientHelper *helper = (FwupdClientHelper *) user_data;
+	helper->array = fwupd_client_download_releases_finish (FWUPD_CLIENT (source), res, &helper->error);
+	g_main_loop_quit (helper->loop);
+}
+
+/**
+ * fwupd_client_download_releases:
+ * @self: A #FwupdClient
+ * @releases: (element-type FwupdRelease): releases to download
+ * @flags: #FwupdClientDownloadFlags, e.g. %FWUPD_CLIENT_DOWNLOAD_FLAG_NONE
+ * @cancellable: the #GCancellable, or %NULL
+ * @error: the #GError, or %NULL
+ *
+ * Downloads the firmware for several releases in parallel. The
+ * fwupd_client_set_user_agent() function should be called before this method
+ * is used.
+ *
+ * Returns: (element-type utf8) (transfer container): the local filenames,
+ * in the same order as the releases, or %NULL for error
+ *
+ * Since: 1.5.8
+ **/
+GPtrArray *
+fwupd_client_download_releases (FwupdClient *self,
+				GPtrArray *releases,
+				FwupdClientDownloadFlags flags,
+				GCancellable *cancellable,
+				GError **error)
+{
+	g_autoptr(FwupdClientHelper) helper = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	g_return_val_if_fail (releases != NULL, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* connect only if the remotes are required to build the URIs */
+	for (guint i = 0; i < releases->len; i++) {
+		FwupdRelease *release = g_ptr_array_index (releases, i);
+		if (fwupd_release_get_remote_id (release) != NULL) {
+			if (!fwupd_client_connect (self, cancellable, error))
+				return NULL;
+			break;
+		}
+	}
+
+	/* call async version and run loop until complete */
+	helper = fwupd_client_helper_new (self);
+	fwupd_client_download_releases_async (self, releases, flags, cancellable,
+					      fwupd_client_download_releases_cb, helper);
+	g_main_loop_run (helper->loop);
+	if (helper->array == NULL) {
+		g_propagate_error (error, g_steal_pointer (&helper->error));
+		return NULL;
+	}
+	return g_steal_pointer (&helper->array);
+}
+
 /**
  * fwupd_client_download_file:
  * @self: A #FwupdClient
@@ -16,6 +16,14 @@ GPtrArray	*fwupd_client_get_devices		(FwupdClient	*self,
 							 GCancellable	*cancellable,
 							 GError		**error)
 							 G_GNUC_WARN_UNUSED_RESULT;
+gboolean	 fwupd_client_get_devices_since		(FwupdClient	*self,
+							 guint64	 generation,
+							 guint64	*generation_current,
+							 GPtrArray	**devices,
+							 GPtrArray	**removed_ids,
+							 GCancellable	*cancellable,
+							 GError		**error)
+							 G_GNUC_WARN_UNUSED_RESULT;
 GPtrArray	*fwupd_client_get_plugins		(FwupdClient	*self,
 							 GCancellable	*cancellable,
 							 GError		**error)
@@ -24,6 +32,16 @@ GPtrArray	*fwupd_client_get_history		(FwupdClient	*self,
 							 GCancellable	*cancellable,
 							 GError		**error)
 							 G_GNUC_WARN_UNUSED_RESULT;
+GPtrArray	*fwupd_client_get_history_full		(FwupdClient	*self,
+							 const gchar	*device_id,
+							 FwupdUpdateState update_state,
+							 guint64	 modified_min,
+							 guint64	 modified_max,
+							 guint		 offset,
+							 guint		 limit,
+							 GCancellable	*cancellable,
+							 GError		**error)
+							 G_GNUC_WARN_UNUSED_RESULT;
 GPtrArray	*fwupd_client_get_releases		(FwupdClient	*self,
 							 const gchar	*device_id,
 							 GCancellable	*cancellable,
@@ -39,6 +57,11 @@ GPtrArray	*fwupd_client_get_upgrades		(FwupdClient	*self,
 							 GCancellable	*cancellable,
 							 GError		**error)
 							 G_GNUC_WARN_UNUSED_RESULT;
+GHashTable	*fwupd_client_get_all_upgrades		(FwupdClient	*self,
+							 GHashTable	**errors,
+							 GCancellable	*cancellable,
+							 GError		**error)
+							 G_GNUC_WARN_UNUSED_RESULT;
 GPtrArray	*fwupd_client_get_details		(FwupdClient	*self,
 							 const gchar	*filename,
 							 GCancellable	*cancellable,
@@ -210,6 +233,12 @@ GBytes		*fwupd_client_download_bytes		(FwupdClient	*self,
 							 GCancellable	*cancellable,
 							 GError		**error)
 							 G_GNUC_WARN_UNUSED_RESULT;
+GPtrArray	*fwupd_client_download_releases		(FwupdClient	*self,
+							 GPtrArray	*releases,
+							 FwupdClientDownloadFlags flags,
+							 GCancellable	*cancellable,
+							 GError		**error)
+							 G_GNUC_WARN_UNUSED_RESULT;
 gboolean	 fwupd_client_download_file		(FwupdClient	*self,
 							 const gchar	*url,
 							 GFile		*file,
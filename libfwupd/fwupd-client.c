@@ -16,10 +16,16 @@
 #include <gio/gunixfdlist.h>
 #endif
 
+#include <errno.h>
 #include <fcntl.h>
+#include <glib/gstdio.h>
 #include <string.h>
+#ifdef HAVE_FLOCK
+#include <sys/file.h>
+#endif
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include "fwupd-client-private.h"
 #include "fwupd-client-sync.h"
@@ -33,6 +39,10 @@
 #include "fwupd-release-private.h"
 #include "fwupd-remote-private.h"
 
+#define FWUPD_CLIENT_DOWNLOAD_PARALLEL_MAX	4
+#define FWUPD_CLIENT_DOWNLOAD_RETRIES_MAX	5
+#define FWUPD_CLIENT_DOWNLOAD_CACHE_SIZE_MAX	(512 * 0x100000)
+
 typedef GObject		*(*FwupdClientObjectNewFunc)	(void);
 
 /**
@@ -62,6 +72,8 @@ typedef struct {
 	GMutex				 proxy_mutex;	/* for @proxy */
 	GDBusProxy			*proxy;
 	gchar				*user_agent;
+	gchar				*download_dir;
+	guint64				 download_cache_size_max;
 #ifdef SOUP_SESSION_COMPAT
 	GObject				*soup_session;
 	GModule				*soup_module;	/* we leak this */
@@ -83,6 +95,7 @@ enum {
 	SIGNAL_DEVICE_ADDED,
 	SIGNAL_DEVICE_REMOVED,
 	SIGNAL_DEVICE_CHANGED,
+	SIGNAL_DEVICES_CHANGED,
 	SIGNAL_LAST
 };
 
@@ -97,6 +110,7 @@ enum {
 	PROP_HOST_MACHINE_ID,
 	PROP_HOST_SECURITY_ID,
 	PROP_INTERACTIVE,
+	PROP_DOWNLOAD_CACHE_SIZE_MAX,
 	PROP_LAST
 };
 
@@ -132,12 +146,14 @@ typedef struct {
 	gchar		*property_name;
 	guint		 signal_id;
 	FwupdDevice	*device;
+	GPtrArray	*devices;
 } FwupdClientContextHelper;
 
 static void
 fwupd_client_context_helper_free (FwupdClientContextHelper *helper)
 {
 	g_clear_object (&helper->device);
+	g_clear_pointer (&helper->devices, g_ptr_array_unref);
 	g_object_unref (helper->self);
 	g_free (helper->property_name);
 	g_free (helper);
@@ -179,6 +195,8 @@ fwupd_client_context_idle_cb (gpointer user_data)
 		/* device signal */
 		if (helper->signal_id !=0 && helper->device != NULL)
 			g_signal_emit (self, signals[helper->signal_id], 0, helper->device);
+		if (helper->signal_id !=0 && helper->devices != NULL)
+			g_signal_emit (self, signals[helper->signal_id], 0, helper->devices);
 	}
 
 	/* all done */
@@ -247,6 +265,27 @@ fwupd_client_signal_emit_device (FwupdClient *self, guint signal_id, FwupdDevice
 	fwupd_client_context_helper (self, helper);
 }
 
+/* run callback in the correct thread */
+static void
+fwupd_client_signal_emit_devices (FwupdClient *self, guint signal_id, GPtrArray *devices)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	FwupdClientContextHelper *helper = NULL;
+
+	/* shortcut */
+	if (g_main_context_is_owner (priv->main_ctx)) {
+		g_signal_emit (self, signals[signal_id], 0, devices);
+		return;
+	}
+
+	/* run in the correct GMainContext and thread */
+	helper = g_new0 (FwupdClientContextHelper, 1);
+	helper->self = g_object_ref (self);
+	helper->signal_id = signal_id;
+	helper->devices = g_ptr_array_ref (devices);
+	fwupd_client_context_helper (self, helper);
+}
+
 static void
 fwupd_client_set_host_product (FwupdClient *self, const gchar *host_product)
 {
@@ -388,6 +427,12 @@ fwupd_client_properties_changed_cb (GDBusProxy *proxy,
 		if (val != NULL)
 			fwupd_client_set_host_security_id (self, g_variant_get_string (val, NULL));
 	}
+	if (g_variant_dict_contains (dict, "DownloadCacheSizeMax")) {
+		g_autoptr(GVariant) val = NULL;
+		val = g_dbus_proxy_get_cached_property (proxy, "DownloadCacheSizeMax");
+		if (val != NULL)
+			fwupd_client_set_download_cache_size_max (self, g_variant_get_uint64 (val));
+	}
 }
 
 static void
@@ -424,6 +469,12 @@ fwupd_client_signal_cb (GDBusProxy *proxy,
 		fwupd_client_signal_emit_device (self, SIGNAL_DEVICE_CHANGED, dev);
 		return;
 	}
+	if (g_strcmp0 (signal_name, "DevicesChanged") == 0) {
+		g_autoptr(GPtrArray) devs = fwupd_device_array_from_variant (parameters);
+		g_debug ("Emitting ::devices-changed(%u)", devs->len);
+		fwupd_client_signal_emit_devices (self, SIGNAL_DEVICES_CHANGED, devs);
+		return;
+	}
 	g_debug ("Unknown signal name '%s' from %s", signal_name, sender_name);
 }
 
@@ -537,20 +588,20 @@ fwupd_client_progress_callback_cb (void *clientp,
 	return 0;
 }
 
-static FwupdCurlHelper *
-fwupd_client_curl_new (FwupdClient *self, GError **error)
+static CURL *
+fwupd_client_curl_easy_new (FwupdClient *self, GError **error)
 {
 	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	CURL *curl;
 	const gchar *http_proxy;
-	g_autoptr(FwupdCurlHelper) helper = g_new0 (FwupdCurlHelper, 1);
 
 	/* check the user agent is sane */
 	if (!fwupd_client_ensure_networking (self, error))
 		return NULL;
 
 	/* create the session */
-	helper->curl = curl_easy_init ();
-	if (helper->curl == NULL) {
+	curl = curl_easy_init ();
+	if (curl == NULL) {
 		g_set_error_literal (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_INTERNAL,
@@ -558,16 +609,16 @@ fwupd_client_curl_new (FwupdClient *self, GError **error)
 		return NULL;
 	}
 	if (g_getenv ("FWUPD_CURL_VERBOSE") != NULL)
-		curl_easy_setopt (helper->curl, CURLOPT_VERBOSE, 1L);
-	curl_easy_setopt (helper->curl, CURLOPT_XFERINFOFUNCTION, fwupd_client_progress_callback_cb);
-	curl_easy_setopt (helper->curl, CURLOPT_XFERINFODATA, self);
-	curl_easy_setopt (helper->curl, CURLOPT_USERAGENT, priv->user_agent);
-	curl_easy_setopt (helper->curl, CURLOPT_CONNECTTIMEOUT, 60L);
-	curl_easy_setopt (helper->curl, CURLOPT_NOPROGRESS, 0L);
+		curl_easy_setopt (curl, CURLOPT_VERBOSE, 1L);
+	curl_easy_setopt (curl, CURLOPT_XFERINFOFUNCTION, fwupd_client_progress_callback_cb);
+	curl_easy_setopt (curl, CURLOPT_XFERINFODATA, self);
+	curl_easy_setopt (curl, CURLOPT_USERAGENT, priv->user_agent);
+	curl_easy_setopt (curl, CURLOPT_CONNECTTIMEOUT, 60L);
+	curl_easy_setopt (curl, CURLOPT_NOPROGRESS, 0L);
 
 	/* relax the SSL checks for broken corporate proxies */
 	if (g_getenv ("DISABLE_SSL_STRICT") != NULL)
-		curl_easy_setopt (helper->curl, CURLOPT_SSL_VERIFYPEER, 0L);
+		curl_easy_setopt (curl, CURLOPT_SSL_VERIFYPEER, 0L);
 
 	/* set the proxy */
 	http_proxy = g_getenv ("https_proxy");
@@ -578,10 +629,20 @@ fwupd_client_curl_new (FwupdClient *self, GError **error)
 	if (http_proxy == NULL)
 		http_proxy = g_getenv ("HTTP_PROXY");
 	if (http_proxy != NULL && strlen (http_proxy) > 0)
-		curl_easy_setopt (helper->curl, CURLOPT_PROXY, http_proxy);
+		curl_easy_setopt (curl, CURLOPT_PROXY, http_proxy);
 
 	/* this disables the double-compression of the firmware.xml.gz file */
-	curl_easy_setopt (helper->curl, CURLOPT_HTTP_CONTENT_DECODING, 0L);
+	curl_easy_setopt (curl, CURLOPT_HTTP_CONTENT_DECODING, 0L);
+	return curl;
+}
+
+static FwupdCurlHelper *
+fwupd_client_curl_new (FwupdClient *self, GError **error)
+{
+	g_autoptr(FwupdCurlHelper) helper = g_new0 (FwupdCurlHelper, 1);
+	helper->curl = fwupd_client_curl_easy_new (self, error);
+	if (helper->curl == NULL)
+		return NULL;
 	return g_steal_pointer (&helper);
 }
 #endif
@@ -603,6 +664,7 @@ fwupd_client_connect_get_proxy_cb (GObject *source,
 	g_autoptr(GVariant) val5 = NULL;
 	g_autoptr(GVariant) val6 = NULL;
 	g_autoptr(GVariant) val7 = NULL;
+	g_autoptr(GVariant) val8 = NULL;
 	g_autoptr(GMutexLocker) locker = NULL;
 
 	proxy = g_dbus_proxy_new_finish (res, &error);
@@ -645,6 +707,9 @@ fwupd_client_connect_get_proxy_cb (GObject *source,
 	val7 = g_dbus_proxy_get_cached_property (priv->proxy, "HostSecurityId");
 	if (val7 != NULL)
 		fwupd_client_set_host_security_id (self, g_variant_get_string (val7, NULL));
+	val8 = g_dbus_proxy_get_cached_property (priv->proxy, "DownloadCacheSizeMax");
+	if (val8 != NULL)
+		fwupd_client_set_download_cache_size_max (self, g_variant_get_uint64 (val8));
 
 	/* success */
 	g_task_return_boolean (task, TRUE);
@@ -1007,6 +1072,158 @@ fwupd_client_get_devices_finish (FwupdClient *self, GAsyncResult *res, GError **
 	return g_task_propagate_pointer (G_TASK(res), error);
 }
 
+typedef struct {
+	guint64		 generation;
+	GPtrArray	*devices;	/* (element-type FwupdDevice) */
+	GPtrArray	*removed;	/* (element-type utf8) */
+} FwupdClientDevicesSinceHelper;
+
+static void
+fwupd_client_devices_since_helper_free (FwupdClientDevicesSinceHelper *helper)
+{
+	if (helper->devices != NULL)
+		g_ptr_array_unref (helper->devices);
+	if (helper->removed != NULL)
+		g_ptr_array_unref (helper->removed);
+	g_free (helper);
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FwupdClientDevicesSinceHelper, fwupd_client_devices_since_helper_free)
+#pragma clang diagnostic pop
+
+static void
+fwupd_client_get_devices_since_cb (GObject *source,
+				   GAsyncResult *res,
+				   gpointer user_data)
+{
+	g_autoptr(GTask) task = G_TASK (user_data);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GVariant) val = NULL;
+	g_autoptr(GVariant) val_devices = NULL;
+	g_autoptr(FwupdClientDevicesSinceHelper) helper = g_new0 (FwupdClientDevicesSinceHelper, 1);
+	g_autofree const gchar **removed = NULL;
+
+	val = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), res, &error);
+	if (val == NULL) {
+		fwupd_client_fixup_dbus_error (error);
+		g_task_return_error (task, g_steal_pointer (&error));
+		return;
+	}
+
+	/* parse each part */
+	g_variant_get_child (val, 0, "t", &helper->generation);
+	val_devices = g_variant_get_child_value (val, 1);
+	helper->devices = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	for (gsize i = 0; i < g_variant_n_children (val_devices); i++) {
+		FwupdDevice *dev;
+		g_autoptr(GVariant) data = g_variant_get_child_value (val_devices, i);
+		dev = fwupd_device_from_variant (data);
+		if (dev == NULL)
+			continue;
+		g_ptr_array_add (helper->devices, dev);
+	}
+	fwupd_device_array_ensure_parents (helper->devices);
+	g_variant_get_child (val, 2, "^a&s", &removed);
+	helper->removed = g_ptr_array_new_with_free_func (g_free);
+	for (guint i = 0; removed[i] != NULL; i++)
+		g_ptr_array_add (helper->removed, g_strdup (removed[i]));
+
+	/* success */
+	g_task_return_pointer (task,
+			       g_steal_pointer (&helper),
+			       (GDestroyNotify) fwupd_client_devices_since_helper_free);
+}
+
+/**
+ * fwupd_client_get_devices_since_async:
+ * @self: A #FwupdClient
+ * @generation: the generation returned from a previous call, or 0
+ * @cancellable: the #GCancellable, or %NULL
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Gets the devices that have been added or changed since @generation, and the
+ * IDs of any devices that have been removed.
+ *
+ * This is much cheaper than fwupd_client_get_devices_async() for clients that
+ * poll the daemon, as unchanged devices are not sent over the bus.
+ *
+ * If @generation is too old for the daemon to know which devices have been
+ * removed then %FWUPD_ERROR_NOT_FOUND is returned, and the caller should
+ * start again using a generation of 0.
+ *
+ * You must have called fwupd_client_connect_async() on @self before using
+ * this method.
+ *
+ * Since: 1.5.8
+ **/
+void
+fwupd_client_get_devices_since_async (FwupdClient *self,
+				      guint64 generation,
+				      GCancellable *cancellable,
+				      GAsyncReadyCallback callback,
+				      gpointer callback_data)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	g_autoptr(GTask) task = NULL;
+
+	g_return_if_fail (FWUPD_IS_CLIENT (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (priv->proxy != NULL);
+
+	/* call into daemon */
+	task = g_task_new (self, cancellable, callback, callback_data);
+	g_dbus_proxy_call (priv->proxy, "GetDevicesSince",
+			   g_variant_new ("(t)", generation),
+			   G_DBUS_CALL_FLAGS_NONE,
+			   -1, cancellable,
+			   fwupd_client_get_devices_since_cb,
+			   g_steal_pointer (&task));
+}
+
+/**
+ * fwupd_client_get_devices_since_finish:
+ * @self: A #FwupdClient
+ * @res: the #GAsyncResult
+ * @generation: (out) (optional): the current generation to use for the next call
+ * @devices: (out) (optional) (element-type FwupdDevice) (transfer container): added or changed devices
+ * @removed_ids: (out) (optional) (element-type utf8) (transfer container): removed device IDs
+ * @error: the #GError, or %NULL
+ *
+ * Gets the result of fwupd_client_get_devices_since_async().
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fwupd_client_get_devices_since_finish (FwupdClient *self,
+				       GAsyncResult *res,
+				       guint64 *generation,
+				       GPtrArray **devices,
+				       GPtrArray **removed_ids,
+				       GError **error)
+{
+	g_autoptr(FwupdClientDevicesSinceHelper) helper = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), FALSE);
+	g_return_val_if_fail (g_task_is_valid (res, self), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	helper = g_task_propagate_pointer (G_TASK(res), error);
+	if (helper == NULL)
+		return FALSE;
+	if (generation != NULL)
+		*generation = helper->generation;
+	if (devices != NULL)
+		*devices = g_steal_pointer (&helper->devices);
+	if (removed_ids != NULL)
+		*removed_ids = g_steal_pointer (&helper->removed);
+	return TRUE;
+}
+
 static void
 fwupd_client_get_plugins_cb (GObject *source,
 			     GAsyncResult *res,
@@ -1161,6 +1378,98 @@ fwupd_client_get_history_finish (FwupdClient *self, GAsyncResult *res, GError **
 	return g_task_propagate_pointer (G_TASK(res), error);
 }
 
+/**
+ * fwupd_client_get_history_full_async:
+ * @self: A #FwupdClient
+ * @device_id: (nullable): the device ID to match, or %NULL for any
+ * @update_state: the #FwupdUpdateState to match, or %FWUPD_UPDATE_STATE_UNKNOWN for any
+ * @modified_min: the earliest modification time to include, or 0
+ * @modified_max: the latest modification time to include, or 0
+ * @offset: the number of matching entries to skip
+ * @limit: the maximum number of entries to return, or 0 for no limit
+ * @cancellable: the #GCancellable, or %NULL
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Gets a filtered page of the history, where the filtering is done by the
+ * daemon. Unlike fwupd_client_get_history_async() an empty page is not an
+ * error.
+ *
+ * You must have called fwupd_client_connect_async() on @self before using
+ * this method.
+ *
+ * Since: 1.5.8
+ **/
+void
+fwupd_client_get_history_full_async (FwupdClient *self,
+				     const gchar *device_id,
+				     FwupdUpdateState update_state,
+				     guint64 modified_min,
+				     guint64 modified_max,
+				     guint offset,
+				     guint limit,
+				     GCancellable *cancellable,
+				     GAsyncReadyCallback callback,
+				     gpointer callback_data)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	GVariantBuilder builder;
+	g_autoptr(GTask) task = NULL;
+
+	g_return_if_fail (FWUPD_IS_CLIENT (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (priv->proxy != NULL);
+
+	/* only send the filters that are set */
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_ARRAY);
+	if (device_id != NULL) {
+		g_variant_builder_add (&builder, "{sv}",
+				       "device-id", g_variant_new_string (device_id));
+	}
+	if (update_state != FWUPD_UPDATE_STATE_UNKNOWN) {
+		g_variant_builder_add (&builder, "{sv}",
+				       "update-state", g_variant_new_uint32 (update_state));
+	}
+	if (modified_min != 0) {
+		g_variant_builder_add (&builder, "{sv}",
+				       "modified-min", g_variant_new_uint64 (modified_min));
+	}
+	if (modified_max != 0) {
+		g_variant_builder_add (&builder, "{sv}",
+				       "modified-max", g_variant_new_uint64 (modified_max));
+	}
+
+	/* call into daemon */
+	task = g_task_new (self, cancellable, callback, callback_data);
+	g_dbus_proxy_call (priv->proxy, "GetHistoryFull",
+			   g_variant_new ("(uua{sv})", offset, limit, &builder),
+			   G_DBUS_CALL_FLAGS_NONE,
+			   -1, cancellable,
+			   fwupd_client_get_history_cb,
+			   g_steal_pointer (&task));
+}
+
+/**
+ * fwupd_client_get_history_full_finish:
+ * @self: A #FwupdClient
+ * @res: the #GAsyncResult
+ * @error: the #GError, or %NULL
+ *
+ * Gets the result of fwupd_client_get_history_full_async().
+ *
+ * Returns: (element-type FwupdDevice) (transfer container): results
+ *
+ * Since: 1.5.8
+ **/
+GPtrArray *
+fwupd_client_get_history_full_finish (FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	g_return_val_if_fail (g_task_is_valid (res, self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	return g_task_propagate_pointer (G_TASK(res), error);
+}
+
 static void
 fwupd_client_get_device_by_id_cb (GObject *source,
 				  GAsyncResult *res,
@@ -1599,14 +1908,42 @@ fwupd_client_get_upgrades_finish (FwupdClient *self, GAsyncResult *res, GError *
 	return g_task_propagate_pointer (G_TASK(res), error);
 }
 
+typedef struct {
+	GHashTable	*upgrades;	/* device-id:GPtrArray */
+	GHashTable	*errors;	/* device-id:GError */
+} FwupdClientAllUpgradesHelper;
+
 static void
-fwupd_client_modify_config_cb (GObject *source,
-			       GAsyncResult *res,
-			       gpointer user_data)
+fwupd_client_all_upgrades_helper_free (FwupdClientAllUpgradesHelper *helper)
+{
+	if (helper->upgrades != NULL)
+		g_hash_table_unref (helper->upgrades);
+	if (helper->errors != NULL)
+		g_hash_table_unref (helper->errors);
+	g_free (helper);
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FwupdClientAllUpgradesHelper, fwupd_client_all_upgrades_helper_free)
+#pragma clang diagnostic pop
+
+static void
+fwupd_client_get_all_upgrades_cb (GObject *source,
+				  GAsyncResult *res,
+				  gpointer user_data)
 {
 	g_autoptr(GTask) task = G_TASK (user_data);
 	g_autoptr(GError) error = NULL;
+	g_autoptr(FwupdClientAllUpgradesHelper) helper = g_new0 (FwupdClientAllUpgradesHelper, 1);
 	g_autoptr(GVariant) val = NULL;
+	g_autoptr(GVariant) dict = NULL;
+	g_autoptr(GVariant) dict_errors = NULL;
+	GVariantIter iter;
+	const gchar *device_id;
+	const gchar *message;
+	guint32 code;
+	GVariant *releases_val;
 
 	val = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), res, &error);
 	if (val == NULL) {
@@ -1615,76 +1952,120 @@ fwupd_client_modify_config_cb (GObject *source,
 		return;
 	}
 
+	/* convert each device ID to an array of releases */
+	helper->upgrades = g_hash_table_new_full (g_str_hash, g_str_equal,
+						  g_free, (GDestroyNotify) g_ptr_array_unref);
+	dict = g_variant_get_child_value (val, 0);
+	g_variant_iter_init (&iter, dict);
+	while (g_variant_iter_next (&iter, "{&s@aa{sv}}", &device_id, &releases_val)) {
+		GPtrArray *releases = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+		gsize sz = g_variant_n_children (releases_val);
+		for (guint i = 0; i < sz; i++) {
+			FwupdRelease *rel;
+			g_autoptr(GVariant) data = g_variant_get_child_value (releases_val, i);
+			rel = fwupd_release_from_variant (data);
+			if (rel == NULL)
+				continue;
+			g_ptr_array_add (releases, rel);
+		}
+		g_hash_table_insert (helper->upgrades, g_strdup (device_id), releases);
+		g_variant_unref (releases_val);
+	}
+
+	/* the reason each other device has no upgrades */
+	helper->errors = g_hash_table_new_full (g_str_hash, g_str_equal,
+						g_free, (GDestroyNotify) g_error_free);
+	dict_errors = g_variant_get_child_value (val, 1);
+	g_variant_iter_init (&iter, dict_errors);
+	while (g_variant_iter_next (&iter, "{&s(u&s)}", &device_id, &code, &message)) {
+		g_hash_table_insert (helper->errors,
+				     g_strdup (device_id),
+				     g_error_new_literal (FWUPD_ERROR, (gint) code, message));
+	}
+
 	/* success */
-	g_task_return_boolean (task, TRUE);
+	g_task_return_pointer (task,
+			       g_steal_pointer (&helper),
+			       (GDestroyNotify) fwupd_client_all_upgrades_helper_free);
 }
 
 /**
- * fwupd_client_modify_config_async:
+ * fwupd_client_get_all_upgrades_async:
  * @self: A #FwupdClient
- * @key: key, e.g. `DisabledPlugins`
- * @value: value, e.g. `*`
  * @cancellable: the #GCancellable, or %NULL
  * @callback: the function to run on completion
  * @callback_data: the data to pass to @callback
  *
- * Modifies a daemon config option.
- * The daemon will only respond to this request with proper permissions
+ * Gets all the upgrades for all the devices in one call, which is much faster
+ * than calling fwupd_client_get_upgrades_async() for each device.
  *
- * Since: 1.5.0
+ * You must have called fwupd_client_connect_async() on @self before using
+ * this method.
+ *
+ * Since: 1.5.8
  **/
 void
-fwupd_client_modify_config_async (FwupdClient *self,
-				  const gchar *key,
-				  const gchar *value,
-				  GCancellable *cancellable,
-				  GAsyncReadyCallback callback,
-				  gpointer callback_data)
+fwupd_client_get_all_upgrades_async (FwupdClient *self,
+				     GCancellable *cancellable,
+				     GAsyncReadyCallback callback,
+				     gpointer callback_data)
 {
 	FwupdClientPrivate *priv = GET_PRIVATE (self);
 	g_autoptr(GTask) task = NULL;
 
 	g_return_if_fail (FWUPD_IS_CLIENT (self));
-	g_return_if_fail (key != NULL);
-	g_return_if_fail (value != NULL);
 	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
 	g_return_if_fail (priv->proxy != NULL);
 
 	/* call into daemon */
 	task = g_task_new (self, cancellable, callback, callback_data);
-	g_dbus_proxy_call (priv->proxy, "ModifyConfig",
-			   g_variant_new ("(ss)", key, value),
-			   G_DBUS_CALL_FLAGS_NONE, -1,
-			   cancellable,
-			   fwupd_client_modify_config_cb,
+	g_dbus_proxy_call (priv->proxy, "GetAllUpgrades",
+			   NULL, G_DBUS_CALL_FLAGS_NONE,
+			   -1, cancellable,
+			   fwupd_client_get_all_upgrades_cb,
 			   g_steal_pointer (&task));
 }
 
 /**
- * fwupd_client_modify_config_finish:
+ * fwupd_client_get_all_upgrades_finish:
  * @self: A #FwupdClient
  * @res: the #GAsyncResult
+ * @errors: (out) (optional) (element-type utf8 GError) (transfer container): device ID:error
  * @error: the #GError, or %NULL
  *
- * Gets the result of fwupd_client_modify_config_async().
+ * Gets the result of fwupd_client_get_all_upgrades_async().
  *
- * Returns: %TRUE for success
+ * Devices with no upgrades available are not included in the results, and
+ * the reason for each is returned in @errors instead.
  *
- * Since: 1.5.0
+ * Returns: (element-type utf8 GPtrArray) (transfer container): device ID:releases
+ *
+ * Since: 1.5.8
  **/
-gboolean
-fwupd_client_modify_config_finish (FwupdClient *self, GAsyncResult *res, GError **error)
+GHashTable *
+fwupd_client_get_all_upgrades_finish (FwupdClient *self,
+				      GAsyncResult *res,
+				      GHashTable **errors,
+				      GError **error)
 {
-	g_return_val_if_fail (FWUPD_IS_CLIENT (self), FALSE);
-	g_return_val_if_fail (g_task_is_valid (res, self), FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
-	return g_task_propagate_boolean (G_TASK(res), error);
+	g_autoptr(FwupdClientAllUpgradesHelper) helper = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	g_return_val_if_fail (g_task_is_valid (res, self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	helper = g_task_propagate_pointer (G_TASK(res), error);
+	if (helper == NULL)
+		return NULL;
+	if (errors != NULL)
+		*errors = g_steal_pointer (&helper->errors);
+	return g_steal_pointer (&helper->upgrades);
 }
 
 static void
-fwupd_client_activate_cb (GObject *source,
-			  GAsyncResult *res,
-			  gpointer user_data)
+fwupd_client_modify_config_cb (GObject *source,
+			       GAsyncResult *res,
+			       gpointer user_data)
 {
 	g_autoptr(GTask) task = G_TASK (user_data);
 	g_autoptr(GError) error = NULL;
@@ -1702,16 +2083,98 @@ fwupd_client_activate_cb (GObject *source,
 }
 
 /**
- * fwupd_client_activate_async:
+ * fwupd_client_modify_config_async:
  * @self: A #FwupdClient
- * @device_id: a device
+ * @key: key, e.g. `DisabledPlugins`
+ * @value: value, e.g. `*`
  * @cancellable: the #GCancellable, or %NULL
  * @callback: the function to run on completion
  * @callback_data: the data to pass to @callback
  *
- * Activates up a device, which normally means the device switches to a new
- * firmware version. This should only be called when data loss cannot occur.
- *
+ * Modifies a daemon config option.
+ * The daemon will only respond to this request with proper permissions
+ *
+ * Since: 1.5.0
+ **/
+void
+fwupd_client_modify_config_async (FwupdClient *self,
+				  const gchar *key,
+				  const gchar *value,
+				  GCancellable *cancellable,
+				  GAsyncReadyCallback callback,
+				  gpointer callback_data)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	g_autoptr(GTask) task = NULL;
+
+	g_return_if_fail (FWUPD_IS_CLIENT (self));
+	g_return_if_fail (key != NULL);
+	g_return_if_fail (value != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (priv->proxy != NULL);
+
+	/* call into daemon */
+	task = g_task_new (self, cancellable, callback, callback_data);
+	g_dbus_proxy_call (priv->proxy, "ModifyConfig",
+			   g_variant_new ("(ss)", key, value),
+			   G_DBUS_CALL_FLAGS_NONE, -1,
+			   cancellable,
+			   fwupd_client_modify_config_cb,
+			   g_steal_pointer (&task));
+}
+
+/**
+ * fwupd_client_modify_config_finish:
+ * @self: A #FwupdClient
+ * @res: the #GAsyncResult
+ * @error: the #GError, or %NULL
+ *
+ * Gets the result of fwupd_client_modify_config_async().
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.0
+ **/
+gboolean
+fwupd_client_modify_config_finish (FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), FALSE);
+	g_return_val_if_fail (g_task_is_valid (res, self), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	return g_task_propagate_boolean (G_TASK(res), error);
+}
+
+static void
+fwupd_client_activate_cb (GObject *source,
+			  GAsyncResult *res,
+			  gpointer user_data)
+{
+	g_autoptr(GTask) task = G_TASK (user_data);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GVariant) val = NULL;
+
+	val = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), res, &error);
+	if (val == NULL) {
+		fwupd_client_fixup_dbus_error (error);
+		g_task_return_error (task, g_steal_pointer (&error));
+		return;
+	}
+
+	/* success */
+	g_task_return_boolean (task, TRUE);
+}
+
+/**
+ * fwupd_client_activate_async:
+ * @self: A #FwupdClient
+ * @device_id: a device
+ * @cancellable: the #GCancellable, or %NULL
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Activates up a device, which normally means the device switches to a new
+ * firmware version. This should only be called when data loss cannot occur.
+ *
  * Since: 1.5.0
  **/
 void
@@ -2446,60 +2909,32 @@ fwupd_client_install_release_cb (GObject *source, GAsyncResult *res, gpointer us
 	g_task_return_boolean (task, TRUE);
 }
 
-static void
-fwupd_client_install_release_bytes_cb (GObject *source, GAsyncResult *res, gpointer user_data)
-{
-	g_autoptr(GError) error = NULL;
-	g_autoptr(GTask) task = G_TASK (user_data);
-
-	if (!fwupd_client_install_bytes_finish (FWUPD_CLIENT (source), res, &error)) {
-		g_task_return_error (task, g_steal_pointer (&error));
-		return;
-	}
-
-	/* success */
-	g_task_return_boolean (task, TRUE);
-}
-
 static void
 fwupd_client_install_release_download_cb (GObject *source, GAsyncResult *res, gpointer user_data)
 {
-	g_autoptr(GBytes) blob = NULL;
 	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) filenames = NULL;
 	g_autoptr(GTask) task = G_TASK (user_data);
 	FwupdClientInstallReleaseData *data = g_task_get_task_data (task);
-	GChecksumType checksum_type;
 	GCancellable *cancellable = g_task_get_cancellable (task);
-	const gchar *checksum_expected;
-	g_autofree gchar *checksum_actual = NULL;
 
-	blob = fwupd_client_download_bytes_finish (FWUPD_CLIENT (source), res, &error);
-	if (blob == NULL) {
+	/* checksum has already been verified */
+	filenames = fwupd_client_download_releases_finish (FWUPD_CLIENT (source), res, &error);
+	if (filenames == NULL) {
 		g_task_return_error (task, g_steal_pointer (&error));
 		return;
 	}
 
-	/* verify checksum */
-	checksum_expected = fwupd_checksum_get_best (fwupd_release_get_checksums (data->release));
-	checksum_type = fwupd_checksum_guess_kind (checksum_expected);
-	checksum_actual = g_compute_checksum_for_bytes (checksum_type, blob);
-	if (g_strcmp0 (checksum_expected, checksum_actual) != 0) {
-		g_task_return_new_error (task,
-					 FWUPD_ERROR,
-					 FWUPD_ERROR_INVALID_FILE,
-					 "checksum invalid, expected %s got %s",
-					 checksum_expected, checksum_actual);
-		return;
-	}
-
 	/* if the device specifies ONLY_OFFLINE automatically set this flag */
 	if (fwupd_device_has_flag (data->device, FWUPD_DEVICE_FLAG_ONLY_OFFLINE))
 		data->install_flags |= FWUPD_INSTALL_FLAG_OFFLINE;
-	fwupd_client_install_bytes_async (FWUPD_CLIENT (source),
-					  fwupd_device_get_id (data->device), blob,
-					  data->install_flags, cancellable,
-					  fwupd_client_install_release_bytes_cb,
-					  g_steal_pointer (&task));
+	fwupd_client_install_async (FWUPD_CLIENT (source),
+				    fwupd_device_get_id (data->device),
+				    g_ptr_array_index (filenames, 0),
+				    data->install_flags,
+				    cancellable,
+				    fwupd_client_install_release_cb,
+				    g_steal_pointer (&task));
 }
 
 static gboolean
@@ -2521,86 +2956,6 @@ fwupd_client_is_url_ipfs (const gchar *perhaps_url)
 		g_str_has_prefix (perhaps_url, "ipns://");
 }
 
-static void
-fwupd_client_install_release_remote_cb (GObject *source, GAsyncResult *res, gpointer user_data)
-{
-	GPtrArray *locations;
-	const gchar *uri_tmp;
-	g_autofree gchar *fn = NULL;
-	g_autoptr(FwupdRemote) remote = NULL;
-	g_autoptr(GError) error = NULL;
-	g_autoptr(GTask) task = G_TASK (user_data);
-	g_autoptr(GPtrArray) uris_built = g_ptr_array_new_with_free_func (g_free);
-	FwupdClientInstallReleaseData *data = g_task_get_task_data (task);
-	GCancellable *cancellable = g_task_get_cancellable (task);
-
-	/* if a remote-id was specified, the remote has to exist */
-	remote = fwupd_client_get_remote_by_id_finish (FWUPD_CLIENT (source), res, &error);
-	if (remote == NULL) {
-		g_task_return_error (task, g_steal_pointer (&error));
-		return;
-	}
-
-	/* get the default release only until other parts of fwupd can cope */
-	locations = fwupd_release_get_locations (data->release);
-	if (locations->len == 0) {
-		g_task_return_new_error (task,
-					 FWUPD_ERROR,
-					 FWUPD_ERROR_INVALID_FILE,
-					 "release missing URI");
-		return;
-	}
-	uri_tmp = g_ptr_array_index (locations, 0);
-
-	/* local and directory remotes may have the firmware already */
-	if (fwupd_remote_get_kind (remote) == FWUPD_REMOTE_KIND_LOCAL &&
-	    !fwupd_client_is_url_http (uri_tmp)) {
-		const gchar *fn_cache = fwupd_remote_get_filename_cache (remote);
-		g_autofree gchar *path = g_path_get_dirname (fn_cache);
-		fn = g_build_filename (path, uri_tmp, NULL);
-	} else if (fwupd_remote_get_kind (remote) == FWUPD_REMOTE_KIND_DIRECTORY) {
-		fn = g_strdup (uri_tmp + 7);
-	}
-
-	/* install with flags chosen by the user */
-	if (fn != NULL) {
-		fwupd_client_install_async (FWUPD_CLIENT (source),
-					    fwupd_device_get_id (data->device),
-					    fn, data->install_flags,
-					    cancellable,
-					    fwupd_client_install_release_cb,
-					    g_steal_pointer (&task));
-		return;
-	}
-
-	/* remote file */
-	for (guint i = 0; i < locations->len; i++) {
-		uri_tmp = g_ptr_array_index (locations, i);
-		if (fwupd_client_is_url_ipfs (uri_tmp)) {
-			g_ptr_array_add (uris_built, g_strdup (uri_tmp));
-		} else if (fwupd_client_is_url_http (uri_tmp)) {
-			g_autofree gchar *uri_str = NULL;
-			uri_str = fwupd_remote_build_firmware_uri (remote,
-								   uri_tmp,
-								   &error);
-			if (uri_str == NULL) {
-				g_task_return_error (task, g_steal_pointer (&error));
-				return;
-			}
-			g_ptr_array_add (uris_built, g_steal_pointer (&uri_str));
-		}
-	}
-
-	/* download file */
-	fwupd_client_download_bytes2_async (FWUPD_CLIENT (source),
-					    uris_built,
-					    data->download_flags,
-					    cancellable,
-					    fwupd_client_install_release_download_cb,
-					    g_steal_pointer (&task));
-}
-
-#ifdef HAVE_LIBCURL
 static GPtrArray *
 fwupd_client_filter_locations (GPtrArray *locations,
 			       FwupdClientDownloadFlags download_flags,
@@ -2627,7 +2982,6 @@ fwupd_client_filter_locations (GPtrArray *locations,
 	}
 	return g_steal_pointer (&uris_filtered);
 }
-#endif
 
 /**
  * fwupd_client_install_release2_async:
@@ -2660,8 +3014,8 @@ fwupd_client_install_release2_async (FwupdClient *self,
 {
 	FwupdClientPrivate *priv = GET_PRIVATE (self);
 	g_autoptr(GTask) task = NULL;
+	g_autoptr(GPtrArray) releases = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
 	FwupdClientInstallReleaseData *data;
-	const gchar *remote_id;
 
 	g_return_if_fail (FWUPD_IS_CLIENT (self));
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
@@ -2678,22 +3032,12 @@ fwupd_client_install_release2_async (FwupdClient *self,
 	data->install_flags = install_flags;
 	g_task_set_task_data (task, data, (GDestroyNotify) fwupd_client_install_release_data_free);
 
-	/* work out what remote-specific URI fields this should use */
-	remote_id = fwupd_release_get_remote_id (release);
-	if (remote_id == NULL) {
-		fwupd_client_download_bytes2_async (self,
-						    fwupd_release_get_locations (release),
-						    download_flags,
-						    cancellable,
-						    fwupd_client_install_release_download_cb,
-						    g_steal_pointer (&task));
-		return;
-	}
-
-	/* if a remote-id was specified, the remote has to exist */
-	fwupd_client_get_remote_by_id_async (self, remote_id, cancellable,
-					     fwupd_client_install_release_remote_cb,
-					     g_steal_pointer (&task));
+	/* download, or use the local copy */
+	g_ptr_array_add (releases, g_object_ref (release));
+	fwupd_client_download_releases_async (self, releases, download_flags,
+					      cancellable,
+					      fwupd_client_install_release_download_cb,
+					      g_steal_pointer (&task));
 }
 
 /**
@@ -4323,6 +4667,95 @@ fwupd_client_set_user_agent_for_package (FwupdClient *self,
 	priv->user_agent = g_string_free (str, FALSE);
 }
 
+/**
+ * fwupd_client_get_download_dir:
+ * @self: A #FwupdClient
+ *
+ * Gets the directory used to store downloaded firmware.
+ *
+ * Returns: a path
+ *
+ * Since: 1.5.8
+ **/
+const gchar *
+fwupd_client_get_download_dir (FwupdClient *self)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	return priv->download_dir;
+}
+
+/**
+ * fwupd_client_set_download_dir:
+ * @self: A #FwupdClient
+ * @download_dir: a directory, e.g. `/var/cache/fwupd/downloads`
+ *
+ * Sets the directory used to store downloaded firmware, which defaults to a
+ * directory in the user cache.
+ *
+ * Since: 1.5.8
+ **/
+void
+fwupd_client_set_download_dir (FwupdClient *self, const gchar *download_dir)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+
+	g_return_if_fail (FWUPD_IS_CLIENT (self));
+	g_return_if_fail (download_dir != NULL);
+
+	/* not changed */
+	if (g_strcmp0 (priv->download_dir, download_dir) == 0)
+		return;
+
+	g_free (priv->download_dir);
+	priv->download_dir = g_strdup (download_dir);
+}
+
+/**
+ * fwupd_client_get_download_cache_size_max:
+ * @self: A #FwupdClient
+ *
+ * Gets the maximum size of the download directory.
+ *
+ * Returns: size in bytes, or 0 for unlimited
+ *
+ * Since: 1.5.8
+ **/
+guint64
+fwupd_client_get_download_cache_size_max (FwupdClient *self)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), 0);
+	return priv->download_cache_size_max;
+}
+
+/**
+ * fwupd_client_set_download_cache_size_max:
+ * @self: A #FwupdClient
+ * @download_cache_size_max: size in bytes, or 0 for unlimited
+ *
+ * Sets the maximum size of the download directory. When a download would
+ * exceed this then the least recently used firmware is deleted.
+ *
+ * This is set automatically from the daemon configuration when connecting.
+ *
+ * Since: 1.5.8
+ **/
+void
+fwupd_client_set_download_cache_size_max (FwupdClient *self, guint64 download_cache_size_max)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+
+	g_return_if_fail (FWUPD_IS_CLIENT (self));
+
+	/* not changed */
+	if (priv->download_cache_size_max == download_cache_size_max)
+		return;
+
+	priv->download_cache_size_max = download_cache_size_max;
+	fwupd_client_object_notify (self, "download-cache-size-max");
+}
+
 #ifdef HAVE_LIBCURL
 static size_t
 fwupd_client_download_write_callback_cb (char *ptr, size_t size, size_t nmemb, void *userdata)
@@ -4584,44 +5017,1128 @@ fwupd_client_download_bytes_finish (FwupdClient *self, GAsyncResult *res, GError
 	return g_task_propagate_pointer (G_TASK(res), error);
 }
 
+typedef enum {
+	FWUPD_CLIENT_DOWNLOAD_STATE_PENDING,
+	FWUPD_CLIENT_DOWNLOAD_STATE_RUNNING,
+	FWUPD_CLIENT_DOWNLOAD_STATE_DONE,
+	FWUPD_CLIENT_DOWNLOAD_STATE_FAILED,
+} FwupdClientDownloadState;
+
+typedef struct {
+	FwupdClient		*self;		/* noref */
+	GPtrArray		*items;		/* noref */
+	FwupdClientDownloadState state;
+	GPtrArray		*urls;		/* (element-type utf8) */
+	guint			 urls_idx;
+	guint			 retries;
+	gchar			*checksum;	/* expected, or %NULL */
+	GChecksum		*checksum_actual;
+	gchar			*filename;
+	gchar			*filename_part;
+	gint			 fd;
+	gboolean		 header_checked;
+	guint64			 size_expected;	/* from the metadata, or 0 */
+	guint64			 offset;	/* already on disk when started */
+	guint64			 written;	/* by this attempt */
+	guint64			 dlnow;
+	guint64			 dltotal;
+	GError			*error;
 #ifdef HAVE_LIBCURL
+	CURL			*curl;
+	gchar			 errbuf[CURL_ERROR_SIZE];
+#endif
+} FwupdClientDownloadItem;
+
+typedef struct {
+	GPtrArray		*releases;	/* (element-type FwupdRelease) */
+	GPtrArray		*items;		/* (element-type FwupdClientDownloadItem) */
+	GPtrArray		*items_release;	/* (element-type FwupdClientDownloadItem) (noref) */
+	FwupdClientDownloadFlags flags;
+	gchar			*download_dir;
+} FwupdClientDownloadReleasesHelper;
+
 static void
-fwupd_client_upload_bytes_thread_cb (GTask *task,
-				     gpointer source_object,
-				     gpointer task_data,
-				     GCancellable *cancellable)
+fwupd_client_download_item_free (FwupdClientDownloadItem *item)
 {
-	FwupdClient *self = FWUPD_CLIENT (source_object);
-	FwupdCurlHelper *helper = g_task_get_task_data (task);
-	CURLcode res;
-	gchar errbuf[CURL_ERROR_SIZE] = { '\0' };
-	g_autoptr(GByteArray) buf = g_byte_array_new ();
+#ifdef HAVE_LIBCURL
+	if (item->curl != NULL)
+		curl_easy_cleanup (item->curl);
+#endif
+	if (item->fd >= 0)
+		g_close (item->fd, NULL);
+	if (item->checksum_actual != NULL)
+		g_checksum_free (item->checksum_actual);
+	if (item->error != NULL)
+		g_error_free (item->error);
+	if (item->urls != NULL)
+		g_ptr_array_unref (item->urls);
+	g_free (item->checksum);
+	g_free (item->filename);
+	g_free (item->filename_part);
+	g_free (item);
+}
 
-	curl_easy_setopt (helper->curl, CURLOPT_ERRORBUFFER, errbuf);
-	curl_easy_setopt (helper->curl, CURLOPT_WRITEFUNCTION, fwupd_client_download_write_callback_cb);
-	curl_easy_setopt (helper->curl, CURLOPT_WRITEDATA, buf);
-	res = curl_easy_perform (helper->curl);
-	fwupd_client_set_status (self, FWUPD_STATUS_IDLE);
-	if (res != CURLE_OK) {
-		glong status_code = 0;
-		curl_easy_getinfo (helper->curl, CURLINFO_RESPONSE_CODE, &status_code);
-		g_debug ("status-code was %ld", status_code);
-		if (errbuf[0] != '\0') {
-			g_task_return_new_error (task,
-						 FWUPD_ERROR,
-						 FWUPD_ERROR_INVALID_FILE,
-						 "failed to upload file: %s",
-						 errbuf);
-			return;
-		}
-		g_task_return_new_error (task,
-					 FWUPD_ERROR,
-					 FWUPD_ERROR_INVALID_FILE,
-					 "failed to upload file: %s",
-					 curl_easy_strerror (res));
+static void
+fwupd_client_download_releases_helper_free (FwupdClientDownloadReleasesHelper *helper)
+{
+	g_ptr_array_unref (helper->releases);
+	g_ptr_array_unref (helper->items_release);
+	g_ptr_array_unref (helper->items);
+	g_free (helper->download_dir);
+	g_free (helper);
+}
 
-		return;
-	}
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FwupdClientDownloadItem, fwupd_client_download_item_free)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FwupdClientDownloadReleasesHelper, fwupd_client_download_releases_helper_free)
+
+static FwupdRemote *
+fwupd_client_download_find_remote (GPtrArray *remotes, const gchar *remote_id)
+{
+	if (remotes == NULL)
+		return NULL;
+	for (guint i = 0; i < remotes->len; i++) {
+		FwupdRemote *remote = g_ptr_array_index (remotes, i);
+		if (g_strcmp0 (fwupd_remote_get_id (remote), remote_id) == 0)
+			return remote;
+	}
+	return NULL;
+}
+
+static FwupdClientDownloadItem *
+fwupd_client_download_item_new (FwupdClient *self,
+				 FwupdRelease *release,
+				 GPtrArray *remotes,
+				 FwupdClientDownloadReleasesHelper *helper,
+				 GError **error)
+{
+	FwupdRemote *remote = NULL;
+	GPtrArray *checksums;
+	GPtrArray *locations = fwupd_release_get_locations (release);
+	const gchar *remote_id = fwupd_release_get_remote_id (release);
+	const gchar *uri_tmp;
+	g_autofree gchar *basename = NULL;
+	g_autoptr(FwupdClientDownloadItem) item = g_new0 (FwupdClientDownloadItem, 1);
+	g_autoptr(GPtrArray) uris_built = g_ptr_array_new_with_free_func (g_free);
+
+	item->self = self;
+	item->items = helper->items;
+	item->fd = -1;
+	item->size_expected = fwupd_release_get_size (release);
+
+	/* get the default release only until other parts of fwupd can cope */
+	if (locations->len == 0) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "release missing URI");
+		return NULL;
+	}
+	uri_tmp = g_ptr_array_index (locations, 0);
+
+	/* if a remote-id was specified, the remote has to exist */
+	if (remote_id != NULL) {
+		remote = fwupd_client_download_find_remote (remotes, remote_id);
+		if (remote == NULL) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_NOT_FOUND,
+				     "no remote with ID %s",
+				     remote_id);
+			return NULL;
+		}
+	}
+
+	/* local and directory remotes may have the firmware already */
+	if (remote != NULL &&
+	    fwupd_remote_get_kind (remote) == FWUPD_REMOTE_KIND_LOCAL &&
+	    !fwupd_client_is_url_http (uri_tmp)) {
+		const gchar *fn_cache = fwupd_remote_get_filename_cache (remote);
+		g_autofree gchar *path = g_path_get_dirname (fn_cache);
+		item->filename = g_build_filename (path, uri_tmp, NULL);
+	} else if (remote != NULL &&
+		   fwupd_remote_get_kind (remote) == FWUPD_REMOTE_KIND_DIRECTORY) {
+		item->filename = g_strdup (uri_tmp + 7);
+	}
+	if (item->filename != NULL) {
+		item->urls = g_ptr_array_new_with_free_func (g_free);
+		item->state = FWUPD_CLIENT_DOWNLOAD_STATE_DONE;
+		return g_steal_pointer (&item);
+	}
+
+	/* remote file */
+	for (guint i = 0; i < locations->len; i++) {
+		uri_tmp = g_ptr_array_index (locations, i);
+		if (fwupd_client_is_url_ipfs (uri_tmp)) {
+			g_ptr_array_add (uris_built, g_strdup (uri_tmp));
+		} else if (fwupd_client_is_url_http (uri_tmp)) {
+			g_autofree gchar *uri_str = NULL;
+			if (remote == NULL) {
+				g_ptr_array_add (uris_built, g_strdup (uri_tmp));
+				continue;
+			}
+			uri_str = fwupd_remote_build_firmware_uri (remote, uri_tmp, error);
+			if (uri_str == NULL)
+				return NULL;
+			g_ptr_array_add (uris_built, g_steal_pointer (&uri_str));
+		} else {
+			g_debug ("ignoring unsupported URI %s", uri_tmp);
+		}
+	}
+	item->urls = fwupd_client_filter_locations (uris_built, helper->flags, error);
+	if (item->urls == NULL)
+		return NULL;
+
+	/* content-addressed so that any mirror can resume the partial file, and
+	 * so that identical firmware for different devices is only fetched once */
+	checksums = fwupd_release_get_checksums (release);
+	item->checksum = g_strdup (fwupd_checksum_get_by_kind (checksums, G_CHECKSUM_SHA256));
+	if (item->checksum == NULL)
+		item->checksum = g_strdup (fwupd_checksum_get_best (checksums));
+	if (item->checksum != NULL) {
+		basename = g_strdup (item->checksum);
+	} else {
+		basename = g_compute_checksum_for_string (G_CHECKSUM_SHA256,
+							  g_ptr_array_index (item->urls, 0),
+							  -1);
+	}
+	item->filename = g_build_filename (helper->download_dir, basename, NULL);
+	item->filename_part = g_strdup_printf ("%s.part", item->filename);
+	return g_steal_pointer (&item);
+}
+
+static FwupdClientDownloadItem *
+fwupd_client_download_items_find_filename (GPtrArray *items, const gchar *filename)
+{
+	for (guint i = 0; i < items->len; i++) {
+		FwupdClientDownloadItem *item = g_ptr_array_index (items, i);
+		if (g_strcmp0 (item->filename, filename) == 0)
+			return item;
+	}
+	return NULL;
+}
+
+static GPtrArray *
+fwupd_client_download_releases_get_filenames (FwupdClientDownloadReleasesHelper *helper)
+{
+	GPtrArray *filenames = g_ptr_array_new_with_free_func (g_free);
+	for (guint i = 0; i < helper->items_release->len; i++) {
+		FwupdClientDownloadItem *item = g_ptr_array_index (helper->items_release, i);
+		g_ptr_array_add (filenames, g_strdup (item->filename));
+	}
+	return filenames;
+}
+
+static gboolean
+fwupd_client_download_checksum_fd (gint fd, GChecksum *csum, GError **error)
+{
+	guint8 buf[0x8000];
+
+	/* read in 32kB chunks */
+	while (TRUE) {
+		gssize sz = read (fd, buf, sizeof(buf));
+		if (sz == 0)
+			break;
+		if (sz < 0) {
+			if (errno == EINTR)
+				continue;
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_READ,
+				     "failed to read: %s",
+				     g_strerror (errno));
+			return FALSE;
+		}
+		g_checksum_update (csum, buf, sz);
+	}
+	return TRUE;
+}
+
+/* a previous download of the same content can be used as-is */
+static gboolean
+fwupd_client_download_item_check_existing (FwupdClientDownloadItem *item)
+{
+	gboolean ret;
+	gint fd;
+	g_autoptr(GChecksum) csum = NULL;
+
+	if (item->checksum == NULL)
+		return FALSE;
+	fd = g_open (item->filename, O_RDONLY, 0);
+	if (fd < 0)
+		return FALSE;
+	csum = g_checksum_new (fwupd_checksum_guess_kind (item->checksum));
+	ret = fwupd_client_download_checksum_fd (fd, csum, NULL);
+	g_close (fd, NULL);
+	if (!ret || g_ascii_strcasecmp (g_checksum_get_string (csum), item->checksum) != 0) {
+		g_debug ("%s is invalid, removing", item->filename);
+		g_unlink (item->filename);
+		return FALSE;
+	}
+
+	/* the modification time is used as the last-used time */
+	if (g_utime (item->filename, NULL) != 0)
+		g_debug ("failed to touch %s: %s", item->filename, g_strerror (errno));
+	return TRUE;
+}
+
+typedef struct {
+	gchar		*filename;
+	guint64		 size;
+	gint64		 mtime;
+} FwupdClientDownloadCacheEntry;
+
+static void
+fwupd_client_download_cache_entry_free (FwupdClientDownloadCacheEntry *entry)
+{
+	g_free (entry->filename);
+	g_free (entry);
+}
+
+static gint
+fwupd_client_download_cache_entry_sort_cb (gconstpointer a, gconstpointer b)
+{
+	FwupdClientDownloadCacheEntry *entry1 = *((FwupdClientDownloadCacheEntry **) a);
+	FwupdClientDownloadCacheEntry *entry2 = *((FwupdClientDownloadCacheEntry **) b);
+	if (entry1->mtime < entry2->mtime)
+		return -1;
+	if (entry1->mtime > entry2->mtime)
+		return 1;
+	return 0;
+}
+
+static gboolean
+fwupd_client_download_items_has_filename (GPtrArray *items, const gchar *filename)
+{
+	for (guint i = 0; i < items->len; i++) {
+		FwupdClientDownloadItem *item = g_ptr_array_index (items, i);
+		if (g_strcmp0 (item->filename, filename) == 0 ||
+		    g_strcmp0 (item->filename_part, filename) == 0)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+/* delete the least recently used files until the directory fits, never
+ * deleting anything used by the current request */
+static void
+fwupd_client_download_dir_prune (const gchar *download_dir,
+				  guint64 size_max,
+				  GPtrArray *items)
+{
+	const gchar *fn;
+	guint64 size_total = 0;
+	g_autoptr(GDir) dir = NULL;
+	g_autoptr(GPtrArray) entries = NULL;
+
+	if (size_max == 0)
+		return;
+	dir = g_dir_open (download_dir, 0, NULL);
+	if (dir == NULL)
+		return;
+	entries = g_ptr_array_new_with_free_func ((GDestroyNotify) fwupd_client_download_cache_entry_free);
+	while ((fn = g_dir_read_name (dir)) != NULL) {
+		FwupdClientDownloadCacheEntry *entry;
+		GStatBuf st;
+		g_autofree gchar *filename = g_build_filename (download_dir, fn, NULL);
+		if (g_stat (filename, &st) != 0 || !S_ISREG (st.st_mode))
+			continue;
+		size_total += st.st_size;
+		if (fwupd_client_download_items_has_filename (items, filename))
+			continue;
+		entry = g_new0 (FwupdClientDownloadCacheEntry, 1);
+		entry->filename = g_steal_pointer (&filename);
+		entry->size = st.st_size;
+		entry->mtime = st.st_mtime;
+		g_ptr_array_add (entries, entry);
+	}
+	g_ptr_array_sort (entries, fwupd_client_download_cache_entry_sort_cb);
+	for (guint i = 0; i < entries->len && size_total > size_max; i++) {
+		FwupdClientDownloadCacheEntry *entry = g_ptr_array_index (entries, i);
+		g_debug ("removing least recently used %s", entry->filename);
+		if (g_unlink (entry->filename) != 0) {
+			g_debug ("failed to delete %s: %s",
+				 entry->filename, g_strerror (errno));
+			continue;
+		}
+		size_total -= entry->size;
+	}
+}
+
+#ifdef HAVE_LIBCURL
+
+static gboolean
+fwupd_client_download_item_truncate (FwupdClientDownloadItem *item, GError **error)
+{
+	if (ftruncate (item->fd, 0) < 0 || lseek (item->fd, 0, SEEK_SET) < 0) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_WRITE,
+			     "failed to truncate %s: %s",
+			     item->filename_part,
+			     g_strerror (errno));
+		return FALSE;
+	}
+	g_checksum_reset (item->checksum_actual);
+	item->offset = 0;
+	return TRUE;
+}
+
+/* another process may be downloading the same content into the same file */
+static gboolean
+fwupd_client_download_item_lock (FwupdClientDownloadItem *item, GError **error)
+{
+#ifdef HAVE_FLOCK
+	GStatBuf st;
+	struct stat st_fd;
+
+	if (flock (item->fd, LOCK_EX | LOCK_NB) < 0) {
+		if (errno == EWOULDBLOCK) {
+			g_set_error (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_BUSY,
+				     "%s is being written by another process",
+				     item->filename_part);
+			return FALSE;
+		}
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_WRITE,
+			     "failed to lock %s: %s",
+			     item->filename_part,
+			     g_strerror (errno));
+		return FALSE;
+	}
+
+	/* renamed into place by the other process before we got the lock */
+	if (fstat (item->fd, &st_fd) < 0 ||
+	    g_stat (item->filename_part, &st) != 0 ||
+	    st.st_dev != st_fd.st_dev ||
+	    st.st_ino != st_fd.st_ino) {
+		g_set_error (error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_BUSY,
+			     "%s was replaced by another process",
+			     item->filename_part);
+		return FALSE;
+	}
+#endif
+	return TRUE;
+}
+
+/* open the partial file and seed the checksum with any data already there */
+static gboolean
+fwupd_client_download_item_open (FwupdClientDownloadItem *item, GError **error)
+{
+	GChecksumType checksum_type = G_CHECKSUM_SHA256;
+	gint64 offset;
+
+	if (item->fd >= 0)
+		g_close (item->fd, NULL);
+	item->fd = g_open (item->filename_part, O_RDWR | O_CREAT, 0600);
+	if (item->fd < 0) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_WRITE,
+			     "failed to open %s: %s",
+			     item->filename_part,
+			     g_strerror (errno));
+		return FALSE;
+	}
+	if (!fwupd_client_download_item_lock (item, error)) {
+		g_close (item->fd, NULL);
+		item->fd = -1;
+		return FALSE;
+	}
+	if (item->checksum != NULL)
+		checksum_type = fwupd_checksum_guess_kind (item->checksum);
+	if (item->checksum_actual != NULL)
+		g_checksum_free (item->checksum_actual);
+	item->checksum_actual = g_checksum_new (checksum_type);
+	item->header_checked = FALSE;
+	item->written = 0;
+	item->dlnow = 0;
+	item->dltotal = 0;
+
+	/* without a checksum we cannot trust what is already there */
+	if (item->checksum == NULL)
+		return fwupd_client_download_item_truncate (item, error);
+	if (!fwupd_client_download_checksum_fd (item->fd, item->checksum_actual, error))
+		return FALSE;
+	offset = lseek (item->fd, 0, SEEK_END);
+	if (offset < 0) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_READ,
+			     "failed to seek %s: %s",
+			     item->filename_part,
+			     g_strerror (errno));
+		return FALSE;
+	}
+	item->offset = (guint64) offset;
+	return TRUE;
+}
+
+static gboolean
+fwupd_client_download_item_write (FwupdClientDownloadItem *item,
+				  const guint8 *buf,
+				  gsize bufsz,
+				  GError **error)
+{
+	gsize done = 0;
+	while (done < bufsz) {
+		gssize wrote = write (item->fd, buf + done, bufsz - done);
+		if (wrote < 0) {
+			if (errno == EINTR)
+				continue;
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_WRITE,
+				     "failed to write %s: %s",
+				     item->filename_part,
+				     g_strerror (errno));
+			return FALSE;
+		}
+		done += wrote;
+	}
+	g_checksum_update (item->checksum_actual, buf, bufsz);
+	item->written += bufsz;
+	return TRUE;
+}
+
+static size_t
+fwupd_client_download_item_write_cb (char *ptr, size_t size, size_t nmemb, void *userdata)
+{
+	FwupdClientDownloadItem *item = (FwupdClientDownloadItem *) userdata;
+	gsize realsize = size * nmemb;
+
+	/* the server ignored the range request, so start again */
+	if (!item->header_checked) {
+		glong status_code = 0;
+		item->header_checked = TRUE;
+		curl_easy_getinfo (item->curl, CURLINFO_RESPONSE_CODE, &status_code);
+		if (item->offset > 0 && status_code != 206) {
+			g_debug ("no resume support, restarting %s", item->filename);
+			if (!fwupd_client_download_item_truncate (item, &item->error))
+				return 0;
+		}
+	}
+	if (!fwupd_client_download_item_write (item, (const guint8 *) ptr, realsize, &item->error))
+		return 0;
+	return realsize;
+}
+
+/* one percentage for all the parallel transfers */
+static void
+fwupd_client_download_items_set_percentage (FwupdClient *self, GPtrArray *items)
+{
+	guint64 total = 0;
+	guint64 now = 0;
+
+	for (guint i = 0; i < items->len; i++) {
+		FwupdClientDownloadItem *item = g_ptr_array_index (items, i);
+		guint64 item_total = item->size_expected;
+		guint64 item_now = 0;
+		if (item->dltotal > 0)
+			item_total = item->offset + item->dltotal;
+		if (item->state == FWUPD_CLIENT_DOWNLOAD_STATE_DONE)
+			item_now = item_total;
+		else if (item->state == FWUPD_CLIENT_DOWNLOAD_STATE_RUNNING)
+			item_now = item->offset + item->dlnow;
+		total += item_total;
+		now += MIN (item_now, item_total);
+	}
+	if (total == 0)
+		return;
+	fwupd_client_set_percentage (self, (guint) ((100 * now) / total));
+}
+
+static int
+fwupd_client_download_item_progress_cb (void *clientp,
+					curl_off_t dltotal,
+					curl_off_t dlnow,
+					curl_off_t ultotal,
+					curl_off_t ulnow)
+{
+	FwupdClientDownloadItem *item = (FwupdClientDownloadItem *) clientp;
+	if (dltotal > 0 && dlnow >= 0 && dlnow <= dltotal) {
+		item->dltotal = dltotal;
+		item->dlnow = dlnow;
+		fwupd_client_download_items_set_percentage (item->self, item->items);
+	}
+	return 0;
+}
+
+static void
+fwupd_client_download_item_failed (FwupdClientDownloadItem *item)
+{
+	g_debug ("failed to download %s: %s",
+		 (const gchar *) g_ptr_array_index (item->urls, item->urls_idx),
+		 item->error->message);
+
+	/* resume from the same server if it sent anything at all */
+	if (item->written > 0 && item->retries < FWUPD_CLIENT_DOWNLOAD_RETRIES_MAX) {
+		item->retries++;
+		item->state = FWUPD_CLIENT_DOWNLOAD_STATE_PENDING;
+		return;
+	}
+
+	/* the next mirror can resume the same partial file */
+	if (item->urls_idx + 1 < item->urls->len) {
+		g_debug ("trying next URI…");
+		item->urls_idx++;
+		item->retries = 0;
+		item->state = FWUPD_CLIENT_DOWNLOAD_STATE_PENDING;
+		return;
+	}
+	item->state = FWUPD_CLIENT_DOWNLOAD_STATE_FAILED;
+}
+
+static void
+fwupd_client_download_item_succeeded (FwupdClientDownloadItem *item)
+{
+	const gchar *checksum_actual;
+
+	/* verified while streaming */
+	checksum_actual = g_checksum_get_string (item->checksum_actual);
+	if (item->checksum != NULL &&
+	    g_ascii_strcasecmp (item->checksum, checksum_actual) != 0) {
+		g_set_error (&item->error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "checksum invalid, expected %s got %s",
+			     item->checksum, checksum_actual);
+		g_unlink (item->filename_part);
+		g_close (item->fd, NULL);
+		item->fd = -1;
+		item->written = 0;
+		fwupd_client_download_item_failed (item);
+		return;
+	}
+
+	/* renamed while still holding the lock */
+	if (g_rename (item->filename_part, item->filename) != 0) {
+		g_set_error (&item->error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_WRITE,
+			     "failed to rename %s: %s",
+			     item->filename_part,
+			     g_strerror (errno));
+		g_close (item->fd, NULL);
+		item->fd = -1;
+		item->state = FWUPD_CLIENT_DOWNLOAD_STATE_FAILED;
+		return;
+	}
+	g_close (item->fd, NULL);
+	item->fd = -1;
+	item->state = FWUPD_CLIENT_DOWNLOAD_STATE_DONE;
+}
+
+static void
+fwupd_client_download_item_start (FwupdClientDownloadItem *item, CURLM *multi)
+{
+	const gchar *url = g_ptr_array_index (item->urls, item->urls_idx);
+
+	g_clear_error (&item->error);
+	if (!fwupd_client_download_item_open (item, &item->error)) {
+		if (g_error_matches (item->error, G_IO_ERROR, G_IO_ERROR_BUSY)) {
+			g_debug ("waiting: %s", item->error->message);
+			return;
+		}
+		item->state = FWUPD_CLIENT_DOWNLOAD_STATE_FAILED;
+		return;
+	}
+
+	/* completed by another process while we were waiting for the lock */
+	if (fwupd_client_download_item_check_existing (item)) {
+		g_debug ("using %s downloaded by another process", item->filename);
+		g_unlink (item->filename_part);
+		g_close (item->fd, NULL);
+		item->fd = -1;
+		item->state = FWUPD_CLIENT_DOWNLOAD_STATE_DONE;
+		return;
+	}
+
+	/* no partial support, so done synchronously */
+	if (fwupd_client_is_url_ipfs (url)) {
+		g_autoptr(GBytes) blob = NULL;
+		g_debug ("downloading %s", url);
+		blob = fwupd_client_download_ipfs (item->self, url, &item->error);
+		if (blob == NULL) {
+			fwupd_client_download_item_failed (item);
+			return;
+		}
+		if (!fwupd_client_download_item_truncate (item, &item->error) ||
+		    !fwupd_client_download_item_write (item,
+						       g_bytes_get_data (blob, NULL),
+						       g_bytes_get_size (blob),
+						       &item->error)) {
+			item->state = FWUPD_CLIENT_DOWNLOAD_STATE_FAILED;
+			return;
+		}
+		fwupd_client_download_item_succeeded (item);
+		return;
+	}
+	if (!fwupd_client_is_url_http (url)) {
+		g_set_error (&item->error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "not sure how to handle: %s", url);
+		fwupd_client_download_item_failed (item);
+		return;
+	}
+
+	/* reuse the connection when resuming */
+	if (item->curl == NULL) {
+		item->curl = fwupd_client_curl_easy_new (item->self, &item->error);
+		if (item->curl == NULL) {
+			item->state = FWUPD_CLIENT_DOWNLOAD_STATE_FAILED;
+			return;
+		}
+	}
+	g_debug ("downloading %s from offset 0x%x",
+		 url, (guint) item->offset);
+	item->errbuf[0] = '\0';
+	curl_easy_setopt (item->curl, CURLOPT_URL, url);
+	curl_easy_setopt (item->curl, CURLOPT_ERRORBUFFER, item->errbuf);
+	curl_easy_setopt (item->curl, CURLOPT_FAILONERROR, 1L);
+	curl_easy_setopt (item->curl, CURLOPT_WRITEFUNCTION, fwupd_client_download_item_write_cb);
+	curl_easy_setopt (item->curl, CURLOPT_WRITEDATA, item);
+	curl_easy_setopt (item->curl, CURLOPT_XFERINFOFUNCTION, fwupd_client_download_item_progress_cb);
+	curl_easy_setopt (item->curl, CURLOPT_XFERINFODATA, item);
+	curl_easy_setopt (item->curl, CURLOPT_PRIVATE, item);
+	curl_easy_setopt (item->curl, CURLOPT_RESUME_FROM_LARGE, (curl_off_t) item->offset);
+
+	/* a stalled server is treated like a disconnect */
+	curl_easy_setopt (item->curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+	curl_easy_setopt (item->curl, CURLOPT_LOW_SPEED_TIME, 60L);
+	curl_multi_add_handle (multi, item->curl);
+	item->state = FWUPD_CLIENT_DOWNLOAD_STATE_RUNNING;
+}
+
+static void
+fwupd_client_download_item_transfer_done (FwupdClientDownloadItem *item, CURLcode res)
+{
+	glong status_code = 0;
+
+	/* failed to write */
+	if (item->error != NULL) {
+		item->state = FWUPD_CLIENT_DOWNLOAD_STATE_FAILED;
+		return;
+	}
+	if (res == CURLE_OK) {
+		fwupd_client_download_item_succeeded (item);
+		return;
+	}
+
+	/* the partial file is invalid, or already complete */
+	curl_easy_getinfo (item->curl, CURLINFO_RESPONSE_CODE, &status_code);
+	g_debug ("status-code was %ld", status_code);
+	if (item->offset > 0 && (status_code == 416 || res == CURLE_RANGE_ERROR)) {
+		g_autoptr(GChecksum) csum = g_checksum_copy (item->checksum_actual);
+		if (item->checksum != NULL &&
+		    g_ascii_strcasecmp (g_checksum_get_string (csum), item->checksum) == 0) {
+			fwupd_client_download_item_succeeded (item);
+			return;
+		}
+		g_debug ("failed to resume %s, restarting", item->filename);
+		if (!fwupd_client_download_item_truncate (item, &item->error)) {
+			item->state = FWUPD_CLIENT_DOWNLOAD_STATE_FAILED;
+			return;
+		}
+		if (item->retries < FWUPD_CLIENT_DOWNLOAD_RETRIES_MAX) {
+			item->retries++;
+			item->state = FWUPD_CLIENT_DOWNLOAD_STATE_PENDING;
+			return;
+		}
+		g_set_error_literal (&item->error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "failed to resume download");
+		fwupd_client_download_item_failed (item);
+		return;
+	}
+	if (status_code == 429) {
+		g_set_error_literal (&item->error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "Failed to download due to server limit");
+	} else if (item->errbuf[0] != '\0') {
+		g_set_error (&item->error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "failed to download file: %s",
+			     item->errbuf);
+	} else {
+		g_set_error (&item->error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "failed to download file: %s",
+			     curl_easy_strerror (res));
+	}
+	fwupd_client_download_item_failed (item);
+}
+
+static void
+fwupd_client_download_items_remove_all (CURLM *multi, GPtrArray *items)
+{
+	for (guint i = 0; i < items->len; i++) {
+		FwupdClientDownloadItem *item = g_ptr_array_index (items, i);
+		if (item->state != FWUPD_CLIENT_DOWNLOAD_STATE_RUNNING)
+			continue;
+		curl_multi_remove_handle (multi, item->curl);
+		item->state = FWUPD_CLIENT_DOWNLOAD_STATE_PENDING;
+	}
+}
+
+static gboolean
+fwupd_client_download_items_perform (FwupdClient *self,
+				     CURLM *multi,
+				     GPtrArray *items,
+				     GCancellable *cancellable,
+				     GError **error)
+{
+	while (TRUE) {
+		CURLMcode mc;
+		CURLMsg *msg;
+		gboolean pending = FALSE;
+		gint msgs_left = 0;
+		gint running = 0;
+		guint active = 0;
+
+		/* start pending transfers up to the limit */
+		for (guint i = 0; i < items->len; i++) {
+			FwupdClientDownloadItem *item = g_ptr_array_index (items, i);
+			if (item->state == FWUPD_CLIENT_DOWNLOAD_STATE_RUNNING)
+				active++;
+		}
+		for (guint i = 0; i < items->len; i++) {
+			FwupdClientDownloadItem *item = g_ptr_array_index (items, i);
+			if (item->state != FWUPD_CLIENT_DOWNLOAD_STATE_PENDING)
+				continue;
+			if (active >= FWUPD_CLIENT_DOWNLOAD_PARALLEL_MAX) {
+				pending = TRUE;
+				continue;
+			}
+			fwupd_client_download_item_start (item, multi);
+			if (item->state == FWUPD_CLIENT_DOWNLOAD_STATE_RUNNING)
+				active++;
+			else if (item->state == FWUPD_CLIENT_DOWNLOAD_STATE_PENDING)
+				pending = TRUE;
+		}
+		if (active == 0 && !pending)
+			break;
+
+		/* transfer */
+		if (g_cancellable_set_error_if_cancelled (cancellable, error)) {
+			fwupd_client_download_items_remove_all (multi, items);
+			return FALSE;
+		}
+		mc = curl_multi_perform (multi, &running);
+		if (mc != CURLM_OK) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INTERNAL,
+				     "failed to download: %s",
+				     curl_multi_strerror (mc));
+			fwupd_client_download_items_remove_all (multi, items);
+			return FALSE;
+		}
+		while ((msg = curl_multi_info_read (multi, &msgs_left)) != NULL) {
+			CURL *curl = msg->easy_handle;
+			CURLcode res = msg->data.result;
+			gchar *item_ptr = NULL;
+			if (msg->msg != CURLMSG_DONE)
+				continue;
+			curl_easy_getinfo (curl, CURLINFO_PRIVATE, &item_ptr);
+			curl_multi_remove_handle (multi, curl);
+			fwupd_client_download_item_transfer_done ((FwupdClientDownloadItem *) item_ptr, res);
+		}
+		fwupd_client_download_items_set_percentage (self, items);
+		if (running > 0)
+			curl_multi_wait (multi, NULL, 0, 100, NULL);
+		else if (pending)
+			g_usleep (100 * 1000);
+	}
+	return TRUE;
+}
+
+#endif
+
+static void
+fwupd_client_download_releases_thread_cb (GTask *task,
+					  gpointer source_object,
+					  gpointer task_data,
+					  GCancellable *cancellable)
+{
+	FwupdClientDownloadReleasesHelper *helper = g_task_get_task_data (task);
+	gboolean network_required = FALSE;
+#ifdef HAVE_LIBCURL
+	FwupdClient *self = FWUPD_CLIENT (source_object);
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	CURLM *multi;
+	gboolean ret;
+	g_autoptr(GError) error = NULL;
+#endif
+
+	if (g_mkdir_with_parents (helper->download_dir, 0700) != 0) {
+		g_task_return_new_error (task,
+					 FWUPD_ERROR,
+					 FWUPD_ERROR_WRITE,
+					 "failed to create %s: %s",
+					 helper->download_dir,
+					 g_strerror (errno));
+		return;
+	}
+
+	/* the same firmware may have been downloaded before */
+	for (guint i = 0; i < helper->items->len; i++) {
+		FwupdClientDownloadItem *item = g_ptr_array_index (helper->items, i);
+		if (item->state != FWUPD_CLIENT_DOWNLOAD_STATE_PENDING)
+			continue;
+		if (fwupd_client_download_item_check_existing (item)) {
+			g_debug ("using cached %s", item->filename);
+			item->state = FWUPD_CLIENT_DOWNLOAD_STATE_DONE;
+			continue;
+		}
+		network_required = TRUE;
+	}
+	if (!network_required) {
+		g_task_return_pointer (task,
+				       fwupd_client_download_releases_get_filenames (helper),
+				       (GDestroyNotify) g_ptr_array_unref);
+		return;
+	}
+
+#ifdef HAVE_LIBCURL
+	if (!fwupd_client_ensure_networking (self, &error)) {
+		g_task_return_error (task, g_steal_pointer (&error));
+		return;
+	}
+
+	/* all in one thread, with the transfers multiplexed */
+	fwupd_client_set_status (self, FWUPD_STATUS_DOWNLOADING);
+	fwupd_client_set_percentage (self, 0);
+	multi = curl_multi_init ();
+	ret = fwupd_client_download_items_perform (self, multi, helper->items,
+						   cancellable, &error);
+	curl_multi_cleanup (multi);
+	fwupd_client_set_status (self, FWUPD_STATUS_IDLE);
+	fwupd_client_download_dir_prune (helper->download_dir,
+					 priv->download_cache_size_max,
+					 helper->items);
+	if (!ret) {
+		g_task_return_error (task, g_steal_pointer (&error));
+		return;
+	}
+	for (guint i = 0; i < helper->items->len; i++) {
+		FwupdClientDownloadItem *item = g_ptr_array_index (helper->items, i);
+		if (item->state == FWUPD_CLIENT_DOWNLOAD_STATE_FAILED) {
+			g_task_return_error (task, g_error_copy (item->error));
+			return;
+		}
+	}
+	g_task_return_pointer (task,
+			       fwupd_client_download_releases_get_filenames (helper),
+			       (GDestroyNotify) g_ptr_array_unref);
+#else
+	g_task_return_new_error (task,
+				 FWUPD_ERROR,
+				 FWUPD_ERROR_NOT_SUPPORTED,
+				 "no libcurl support");
+#endif
+}
+
+static void
+fwupd_client_download_releases_build (GTask *task, GPtrArray *remotes)
+{
+	FwupdClient *self = g_task_get_source_object (task);
+	FwupdClientDownloadReleasesHelper *helper = g_task_get_task_data (task);
+	gboolean network_required = FALSE;
+	g_autoptr(GError) error = NULL;
+
+	for (guint i = 0; i < helper->releases->len; i++) {
+		FwupdRelease *release = g_ptr_array_index (helper->releases, i);
+		FwupdClientDownloadItem *item;
+		FwupdClientDownloadItem *item_dup;
+
+		item = fwupd_client_download_item_new (self, release, remotes, helper, &error);
+		if (item == NULL) {
+			g_task_return_error (task, g_steal_pointer (&error));
+			return;
+		}
+
+		/* identical firmware for several devices is only queued once */
+		item_dup = fwupd_client_download_items_find_filename (helper->items, item->filename);
+		if (item_dup != NULL) {
+			fwupd_client_download_item_free (item);
+			g_ptr_array_add (helper->items_release, item_dup);
+			continue;
+		}
+		if (item->state != FWUPD_CLIENT_DOWNLOAD_STATE_DONE)
+			network_required = TRUE;
+		g_ptr_array_add (helper->items, item);
+		g_ptr_array_add (helper->items_release, item);
+	}
+
+	/* everything is already local */
+	if (!network_required) {
+		g_task_return_pointer (task,
+				       fwupd_client_download_releases_get_filenames (helper),
+				       (GDestroyNotify) g_ptr_array_unref);
+		return;
+	}
+	g_task_run_in_thread (task, fwupd_client_download_releases_thread_cb);
+}
+
+static void
+fwupd_client_download_releases_remotes_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(GTask) task = G_TASK (user_data);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) remotes = NULL;
+
+	remotes = fwupd_client_get_remotes_finish (FWUPD_CLIENT (source), res, &error);
+	if (remotes == NULL) {
+		g_task_return_error (task, g_steal_pointer (&error));
+		return;
+	}
+	fwupd_client_download_releases_build (task, remotes);
+}
+
+/**
+ * fwupd_client_download_releases_async:
+ * @self: A #FwupdClient
+ * @releases: (element-type FwupdRelease): releases to download
+ * @flags: #FwupdClientDownloadFlags, e.g. %FWUPD_CLIENT_DOWNLOAD_FLAG_NONE
+ * @cancellable: the #GCancellable, or %NULL
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Downloads the firmware for several releases in parallel into the directory
+ * set with fwupd_client_set_download_dir().
+ *
+ * Firmware is written to disk as it is received and the checksum is verified
+ * as it is streamed. Interrupted downloads are resumed where possible, either
+ * from the same server or from the next location of the release.
+ *
+ * If any release has a remote ID set then you must have called
+ * fwupd_client_connect_async() on @self before using this method.
+ *
+ * NOTE: This method is thread-safe, but progress signals will be
+ * emitted in the global default main context, if not explicitly set with
+ * fwupd_client_set_main_context().
+ *
+ * Since: 1.5.8
+ **/
+void
+fwupd_client_download_releases_async (FwupdClient *self,
+				      GPtrArray *releases,
+				      FwupdClientDownloadFlags flags,
+				      GCancellable *cancellable,
+				      GAsyncReadyCallback callback,
+				      gpointer callback_data)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	FwupdClientDownloadReleasesHelper *helper;
+	gboolean remotes_required = FALSE;
+	g_autoptr(GTask) task = NULL;
+
+	g_return_if_fail (FWUPD_IS_CLIENT (self));
+	g_return_if_fail (releases != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	task = g_task_new (self, cancellable, callback, callback_data);
+	helper = g_new0 (FwupdClientDownloadReleasesHelper, 1);
+	helper->releases = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	helper->items = g_ptr_array_new_with_free_func ((GDestroyNotify) fwupd_client_download_item_free);
+	helper->items_release = g_ptr_array_new ();
+	helper->flags = flags;
+	helper->download_dir = g_strdup (priv->download_dir);
+	for (guint i = 0; i < releases->len; i++) {
+		FwupdRelease *release = g_ptr_array_index (releases, i);
+		if (fwupd_release_get_remote_id (release) != NULL)
+			remotes_required = TRUE;
+		g_ptr_array_add (helper->releases, g_object_ref (release));
+	}
+	g_task_set_task_data (task, helper, (GDestroyNotify) fwupd_client_download_releases_helper_free);
+
+	/* the remote is needed to build the URI */
+	if (remotes_required) {
+		if (priv->proxy == NULL) {
+			g_task_return_new_error (task,
+						 FWUPD_ERROR,
+						 FWUPD_ERROR_INTERNAL,
+						 "not connected to the daemon");
+			return;
+		}
+		fwupd_client_get_remotes_async (self, cancellable,
+						fwupd_client_download_releases_remotes_cb,
+						g_steal_pointer (&task));
+		return;
+	}
+	fwupd_client_download_releases_build (task, NULL);
+}
+
+/**
+ * fwupd_client_download_releases_finish:
+ * @self: A #FwupdClient
+ * @res: the #GAsyncResult
+ * @error: the #GError, or %NULL
+ *
+ * Gets the result of fwupd_client_download_releases_async().
+ *
+ * Returns: (element-type utf8) (transfer container): the local filenames,
+ * in the same order as the releases, or %NULL for error
+ *
+ * Since: 1.5.8
+ **/
+GPtrArray *
+fwupd_client_download_releases_finish (FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	g_return_val_if_fail (g_task_is_valid (res, self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	return g_task_propagate_pointer (G_TASK(res), error);
+}
+
+#ifdef HAVE_LIBCURL
+static void
+fwupd_client_upload_bytes_thread_cb (GTask *task,
+				     gpointer source_object,
+				     gpointer task_data,
+				     GCancellable *cancellable)
+{
+	FwupdClient *self = FWUPD_CLIENT (source_object);
+	FwupdCurlHelper *helper = g_task_get_task_data (task);
+	CURLcode res;
+	gchar errbuf[CURL_ERROR_SIZE] = { '\0' };
+	g_autoptr(GByteArray) buf = g_byte_array_new ();
+
+	curl_easy_setopt (helper->curl, CURLOPT_ERRORBUFFER, errbuf);
+	curl_easy_setopt (helper->curl, CURLOPT_WRITEFUNCTION, fwupd_client_download_write_callback_cb);
+	curl_easy_setopt (helper->curl, CURLOPT_WRITEDATA, buf);
+	res = curl_easy_perform (helper->curl);
+	fwupd_client_set_status (self, FWUPD_STATUS_IDLE);
+	if (res != CURLE_OK) {
+		glong status_code = 0;
+		curl_easy_getinfo (helper->curl, CURLINFO_RESPONSE_CODE, &status_code);
+		g_debug ("status-code was %ld", status_code);
+		if (errbuf[0] != '\0') {
+			g_task_return_new_error (task,
+						 FWUPD_ERROR,
+						 FWUPD_ERROR_INVALID_FILE,
+						 "failed to upload file: %s",
+						 errbuf);
+			return;
+		}
+		g_task_return_new_error (task,
+					 FWUPD_ERROR,
+					 FWUPD_ERROR_INVALID_FILE,
+					 "failed to upload file: %s",
+					 curl_easy_strerror (res));
+
+		return;
+	}
 	g_task_return_pointer (task,
 			       g_byte_array_free_to_bytes (g_steal_pointer (&buf)),
 			       (GDestroyNotify) g_bytes_unref);
@@ -4822,6 +6339,9 @@ fwupd_client_get_property (GObject *object, guint prop_id,
 	case PROP_INTERACTIVE:
 		g_value_set_boolean (value, priv->interactive);
 		break;
+	case PROP_DOWNLOAD_CACHE_SIZE_MAX:
+		g_value_set_uint64 (value, priv->download_cache_size_max);
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -4842,6 +6362,9 @@ fwupd_client_set_property (GObject *object, guint prop_id,
 	case PROP_PERCENTAGE:
 		priv->percentage = g_value_get_uint (value);
 		break;
+	case PROP_DOWNLOAD_CACHE_SIZE_MAX:
+		fwupd_client_set_download_cache_size_max (self, g_value_get_uint64 (value));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -4941,6 +6464,24 @@ fwupd_client_class_init (FwupdClientClass *klass)
 			      NULL, NULL, g_cclosure_marshal_generic,
 			      G_TYPE_NONE, 1, FWUPD_TYPE_DEVICE);
 
+	/**
+	 * FwupdClient::devices-changed:
+	 * @self: the #FwupdClient instance that emitted the signal
+	 * @result: (element-type FwupdDevice): the changed devices
+	 *
+	 * The ::devices-changed signal is emitted when one or more devices
+	 * have been changed. The daemon only sends this to clients that set
+	 * %FWUPD_FEATURE_FLAG_DEVICES_CHANGED using
+	 * fwupd_client_set_feature_flags().
+	 *
+	 * Since: 1.5.8
+	 **/
+	signals [SIGNAL_DEVICES_CHANGED] =
+		g_signal_new ("devices-changed",
+			      G_TYPE_FROM_CLASS (object_class), G_SIGNAL_RUN_LAST,
+			      0, NULL, NULL, g_cclosure_marshal_generic,
+			      G_TYPE_NONE, 1, G_TYPE_PTR_ARRAY);
+
 	/**
 	 * FwupdClient:status:
 	 *
@@ -5041,6 +6582,18 @@ fwupd_client_class_init (FwupdClientClass *klass)
 	pspec = g_param_spec_string ("host-security-id", NULL, NULL,
 				     NULL, G_PARAM_READABLE | G_PARAM_STATIC_NAME);
 	g_object_class_install_property (object_class, PROP_HOST_SECURITY_ID, pspec);
+
+	/**
+	 * FwupdClient:download-cache-size-max:
+	 *
+	 * The maximum size of the download directory in bytes, or 0 for unlimited
+	 *
+	 * Since: 1.5.8
+	 */
+	pspec = g_param_spec_uint64 ("download-cache-size-max", NULL, NULL,
+				     0, G_MAXUINT64, FWUPD_CLIENT_DOWNLOAD_CACHE_SIZE_MAX,
+				     G_PARAM_READWRITE | G_PARAM_STATIC_NAME);
+	g_object_class_install_property (object_class, PROP_DOWNLOAD_CACHE_SIZE_MAX, pspec);
 }
 
 static void
@@ -5050,6 +6603,9 @@ fwupd_client_init (FwupdClient *self)
 	g_mutex_init (&priv->proxy_mutex);
 	g_mutex_init (&priv->idle_mutex);
 	priv->idle_sources = g_ptr_array_new_with_free_func ((GDestroyNotify) fwupd_client_context_helper_free);
+	priv->download_dir = g_build_filename (g_get_user_cache_dir (),
+					       "fwupd", "downloads", NULL);
+	priv->download_cache_size_max = FWUPD_CLIENT_DOWNLOAD_CACHE_SIZE_MAX;
 }
 
 static void
@@ -5060,6 +6616,7 @@ fwupd_client_finalize (GObject *object)
 
 	g_clear_pointer (&priv->main_ctx, g_main_context_unref);
 	g_free (priv->user_agent);
+	g_free (priv->download_dir);
 	g_free (priv->daemon_version);
 	g_free (priv->host_product);
 	g_free (priv->host_machine_id);
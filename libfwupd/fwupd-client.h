@@ -89,6 +89,18 @@ GPtrArray	*fwupd_client_get_devices_finish	(FwupdClient	*self,
 							 GAsyncResult	*res,
 							 GError		**error)
 							 G_GNUC_WARN_UNUSED_RESULT;
+void		 fwupd_client_get_devices_since_async	(FwupdClient	*self,
+							 guint64	 generation,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+gboolean	 fwupd_client_get_devices_since_finish	(FwupdClient	*self,
+							 GAsyncResult	*res,
+							 guint64	*generation,
+							 GPtrArray	**devices,
+							 GPtrArray	**removed_ids,
+							 GError		**error)
+							 G_GNUC_WARN_UNUSED_RESULT;
 void		 fwupd_client_get_plugins_async		(FwupdClient	*self,
 							 GCancellable	*cancellable,
 							 GAsyncReadyCallback callback,
@@ -105,6 +117,20 @@ GPtrArray	*fwupd_client_get_history_finish	(FwupdClient	*self,
 							 GAsyncResult	*res,
 							 GError		**error)
 							 G_GNUC_WARN_UNUSED_RESULT;
+void		 fwupd_client_get_history_full_async	(FwupdClient	*self,
+							 const gchar	*device_id,
+							 FwupdUpdateState update_state,
+							 guint64	 modified_min,
+							 guint64	 modified_max,
+							 guint		 offset,
+							 guint		 limit,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+GPtrArray	*fwupd_client_get_history_full_finish	(FwupdClient	*self,
+							 GAsyncResult	*res,
+							 GError		**error)
+							 G_GNUC_WARN_UNUSED_RESULT;
 void		 fwupd_client_get_releases_async	(FwupdClient	*self,
 							 const gchar	*device_id,
 							 GCancellable	*cancellable,
@@ -132,6 +158,15 @@ GPtrArray	*fwupd_client_get_upgrades_finish	(FwupdClient	*self,
 							 GAsyncResult	*res,
 							 GError		**error)
 							 G_GNUC_WARN_UNUSED_RESULT;
+void		 fwupd_client_get_all_upgrades_async	(FwupdClient	*self,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+GHashTable	*fwupd_client_get_all_upgrades_finish	(FwupdClient	*self,
+							 GAsyncResult	*res,
+							 GHashTable	**errors,
+							 GError		**error)
+							 G_GNUC_WARN_UNUSED_RESULT;
 void		 fwupd_client_get_details_bytes_async	(FwupdClient	*self,
 							 GBytes		*bytes,
 							 GCancellable	*cancellable,
@@ -409,6 +444,22 @@ void		 fwupd_client_set_user_agent		(FwupdClient	*self,
 void		 fwupd_client_set_user_agent_for_package(FwupdClient	*self,
 							 const gchar	*package_name,
 							 const gchar	*package_version);
+const gchar	*fwupd_client_get_download_dir		(FwupdClient	*self);
+void		 fwupd_client_set_download_dir		(FwupdClient	*self,
+							 const gchar	*download_dir);
+guint64		 fwupd_client_get_download_cache_size_max (FwupdClient	*self);
+void		 fwupd_client_set_download_cache_size_max (FwupdClient	*self,
+							 guint64	 download_cache_size_max);
+void		 fwupd_client_download_releases_async	(FwupdClient	*self,
+							 GPtrArray	*releases,
+							 FwupdClientDownloadFlags flags,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+GPtrArray	*fwupd_client_download_releases_finish	(FwupdClient	*self,
+							 GAsyncResult	*res,
+							 GError		**error)
+							 G_GNUC_WARN_UNUSED_RESULT;
 void		 fwupd_client_download_bytes_async	(FwupdClient	*self,
 							 const gchar	*url,
 							 FwupdClientDownloadFlags flags,
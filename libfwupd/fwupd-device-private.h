@@ -16,6 +16,7 @@ G_BEGIN_DECLS
 GVariant	*fwupd_device_to_variant		(FwupdDevice	*device);
 GVariant	*fwupd_device_to_variant_full		(FwupdDevice	*device,
 							 FwupdDeviceFlags flags);
+void		 fwupd_device_invalidate		(FwupdDevice	*device);
 void		 fwupd_device_incorporate		(FwupdDevice	*self,
 							 FwupdDevice	*donor);
 void		 fwupd_device_to_json			(FwupdDevice *device,
@@ -65,8 +65,16 @@ typedef struct {
 	FwupdStatus			 status;
 	GPtrArray			*releases;
 	FwupdDevice			*parent;	/* noref */
+	guint64				 change_count;
+	guint64				 variant_change_count[2];
+	GBytes				*variant_cache[2];	/* untrusted, trusted */
 } FwupdDevicePrivate;
 
+enum {
+	SIGNAL_CHANGED,
+	SIGNAL_LAST
+};
+
 enum {
 	PROP_0,
 	PROP_VERSION_FORMAT,
@@ -78,9 +86,20 @@ enum {
 	PROP_LAST
 };
 
+static guint signals [SIGNAL_LAST] = { 0 };
+
 G_DEFINE_TYPE_WITH_PRIVATE (FwupdDevice, fwupd_device, G_TYPE_OBJECT)
 #define GET_PRIVATE(o) (fwupd_device_get_instance_private (o))
 
+/* the serialized state has changed */
+static void
+fwupd_device_changed (FwupdDevice *device)
+{
+	FwupdDevicePrivate *priv = GET_PRIVATE (device);
+	priv->change_count++;
+	g_signal_emit (device, signals[SIGNAL_CHANGED], 0);
+}
+
 /**
  * fwupd_device_get_checksums:
  * @device: A #FwupdDevice
@@ -119,6 +138,7 @@ fwupd_device_add_checksum (FwupdDevice *device, const gchar *checksum)
 		if (g_strcmp0 (checksum_tmp, checksum) == 0)
 			return;
 	}
+	fwupd_device_changed (device);
 	g_ptr_array_add (priv->checksums, g_strdup (checksum));
 }
 
@@ -177,6 +197,7 @@ fwupd_device_set_summary (FwupdDevice *device, const gchar *summary)
 	if (g_strcmp0 (priv->summary, summary) == 0)
 		return;
 
+	fwupd_device_changed (device);
 	g_free (priv->summary);
 	priv->summary = g_strdup (summary);
 }
@@ -218,6 +239,7 @@ fwupd_device_set_branch (FwupdDevice *device, const gchar *branch)
 	if (g_strcmp0 (priv->branch, branch) == 0)
 		return;
 
+	fwupd_device_changed (device);
 	g_free (priv->branch);
 	priv->branch = g_strdup (branch);
 }
@@ -259,6 +281,7 @@ fwupd_device_set_serial (FwupdDevice *device, const gchar *serial)
 	if (g_strcmp0 (priv->serial, serial) == 0)
 		return;
 
+	fwupd_device_changed (device);
 	g_free (priv->serial);
 	priv->serial = g_strdup (serial);
 }
@@ -300,6 +323,7 @@ fwupd_device_set_id (FwupdDevice *device, const gchar *id)
 	if (g_strcmp0 (priv->id, id) == 0)
 		return;
 
+	fwupd_device_changed (device);
 	g_free (priv->id);
 	priv->id = g_strdup (id);
 }
@@ -341,6 +365,7 @@ fwupd_device_set_parent_id (FwupdDevice *device, const gchar *parent_id)
 	if (g_strcmp0 (priv->parent_id, parent_id) == 0)
 		return;
 
+	fwupd_device_changed (device);
 	g_free (priv->parent_id);
 	priv->parent_id = g_strdup (parent_id);
 }
@@ -382,6 +407,7 @@ fwupd_device_set_parent (FwupdDevice *device, FwupdDevice *parent)
 		g_object_remove_weak_pointer (G_OBJECT (priv->parent), (gpointer *) &priv->parent);
 	if (parent != NULL)
 		g_object_add_weak_pointer (G_OBJECT (parent), (gpointer *) &priv->parent);
+	fwupd_device_changed (device);
 	priv->parent = parent;
 
 	/* this is what goes over D-Bus */
@@ -425,6 +451,7 @@ fwupd_device_add_child (FwupdDevice *device, FwupdDevice *child)
 	g_object_weak_ref (G_OBJECT (child),
 			   fwupd_device_child_finalized_cb,
 			   device);
+	fwupd_device_changed (device);
 	g_ptr_array_add (priv->children, g_object_ref (child));
 }
 
@@ -488,6 +515,7 @@ fwupd_device_add_guid (FwupdDevice *device, const gchar *guid)
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
 	if (fwupd_device_has_guid (device, guid))
 		return;
+	fwupd_device_changed (device);
 	g_ptr_array_add (priv->guids, g_strdup (guid));
 }
 
@@ -571,6 +599,7 @@ fwupd_device_add_instance_id (FwupdDevice *device, const gchar *instance_id)
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
 	if (fwupd_device_has_instance_id (device, instance_id))
 		return;
+	fwupd_device_changed (device);
 	g_ptr_array_add (priv->instance_ids, g_strdup (instance_id));
 }
 
@@ -623,6 +652,7 @@ fwupd_device_add_icon (FwupdDevice *device, const gchar *icon)
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
 	if (fwupd_device_has_icon (device, icon))
 		return;
+	fwupd_device_changed (device);
 	g_ptr_array_add (priv->icons, g_strdup (icon));
 }
 
@@ -663,6 +693,7 @@ fwupd_device_set_name (FwupdDevice *device, const gchar *name)
 	if (g_strcmp0 (priv->name, name) == 0)
 		return;
 
+	fwupd_device_changed (device);
 	g_free (priv->name);
 	priv->name = g_strdup (name);
 }
@@ -704,6 +735,7 @@ fwupd_device_set_vendor (FwupdDevice *device, const gchar *vendor)
 	if (g_strcmp0 (priv->vendor, vendor) == 0)
 		return;
 
+	fwupd_device_changed (device);
 	g_free (priv->vendor);
 	priv->vendor = g_strdup (vendor);
 }
@@ -818,6 +850,7 @@ fwupd_device_add_vendor_id (FwupdDevice *device, const gchar *vendor_id)
 
 	if (fwupd_device_has_vendor_id (device, vendor_id))
 		return;
+	fwupd_device_changed (device);
 	g_ptr_array_add (priv->vendor_ids, g_strdup (vendor_id));
 
 	/* build for compatibility */
@@ -867,6 +900,7 @@ fwupd_device_set_description (FwupdDevice *device, const gchar *description)
 	if (g_strcmp0 (priv->description, description) == 0)
 		return;
 
+	fwupd_device_changed (device);
 	g_free (priv->description);
 	priv->description = g_strdup (description);
 }
@@ -908,6 +942,7 @@ fwupd_device_set_version (FwupdDevice *device, const gchar *version)
 	if (g_strcmp0 (priv->version, version) == 0)
 		return;
 
+	fwupd_device_changed (device);
 	g_free (priv->version);
 	priv->version = g_strdup (version);
 }
@@ -949,6 +984,7 @@ fwupd_device_set_version_lowest (FwupdDevice *device, const gchar *version_lowes
 	if (g_strcmp0 (priv->version_lowest, version_lowest) == 0)
 		return;
 
+	fwupd_device_changed (device);
 	g_free (priv->version_lowest);
 	priv->version_lowest = g_strdup (version_lowest);
 }
@@ -985,6 +1021,7 @@ fwupd_device_set_version_lowest_raw (FwupdDevice *device, guint64 version_lowest
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_changed (device);
 	priv->version_lowest_raw = version_lowest_raw;
 }
 
@@ -1025,6 +1062,7 @@ fwupd_device_set_version_bootloader (FwupdDevice *device, const gchar *version_b
 	if (g_strcmp0 (priv->version_bootloader, version_bootloader) == 0)
 		return;
 
+	fwupd_device_changed (device);
 	g_free (priv->version_bootloader);
 	priv->version_bootloader = g_strdup (version_bootloader);
 }
@@ -1061,6 +1099,7 @@ fwupd_device_set_version_bootloader_raw (FwupdDevice *device, guint64 version_bo
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_changed (device);
 	priv->version_bootloader_raw = version_bootloader_raw;
 }
 
@@ -1096,6 +1135,7 @@ fwupd_device_set_flashes_left (FwupdDevice *device, guint32 flashes_left)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_changed (device);
 	priv->flashes_left = flashes_left;
 }
 
@@ -1131,6 +1171,7 @@ fwupd_device_set_install_duration (FwupdDevice *device, guint32 duration)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_changed (device);
 	priv->install_duration = duration;
 }
 
@@ -1171,6 +1212,7 @@ fwupd_device_set_plugin (FwupdDevice *device, const gchar *plugin)
 	if (g_strcmp0 (priv->plugin, plugin) == 0)
 		return;
 
+	fwupd_device_changed (device);
 	g_free (priv->plugin);
 	priv->plugin = g_strdup (plugin);
 }
@@ -1212,6 +1254,7 @@ fwupd_device_set_protocol (FwupdDevice *device, const gchar *protocol)
 	if (g_strcmp0 (priv->protocol, protocol) == 0)
 		return;
 
+	fwupd_device_changed (device);
 	g_free (priv->protocol);
 	priv->protocol = g_strdup (protocol);
 }
@@ -1250,6 +1293,7 @@ fwupd_device_set_flags (FwupdDevice *device, guint64 flags)
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
 	if (priv->flags == flags)
 		return;
+	fwupd_device_changed (device);
 	priv->flags = flags;
 	g_object_notify (G_OBJECT (device), "flags");
 }
@@ -1272,6 +1316,7 @@ fwupd_device_add_flag (FwupdDevice *device, FwupdDeviceFlags flag)
 		return;
 	if ((priv->flags & flag) > 0)
 		return;
+	fwupd_device_changed (device);
 	priv->flags |= flag;
 	g_object_notify (G_OBJECT (device), "flags");
 }
@@ -1294,6 +1339,7 @@ fwupd_device_remove_flag (FwupdDevice *device, FwupdDeviceFlags flag)
 		return;
 	if ((priv->flags & flag) == 0)
 		return;
+	fwupd_device_changed (device);
 	priv->flags &= ~flag;
 	g_object_notify (G_OBJECT (device), "flags");
 }
@@ -1349,6 +1395,7 @@ fwupd_device_set_created (FwupdDevice *device, guint64 created)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_changed (device);
 	priv->created = created;
 }
 
@@ -1384,6 +1431,7 @@ fwupd_device_set_modified (FwupdDevice *device, guint64 modified)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_changed (device);
 	priv->modified = modified;
 }
 
@@ -1480,26 +1528,12 @@ fwupd_device_incorporate (FwupdDevice *self, FwupdDevice *donor)
 	}
 }
 
-/**
- * fwupd_device_to_variant_full:
- * @device: A #FwupdDevice
- * @flags: #FwupdDeviceFlags for the call
- *
- * Creates a GVariant from the device data.
- * Optionally provides additional data based upon flags
- *
- * Returns: the GVariant, or %NULL for error
- *
- * Since: 1.1.2
- **/
-GVariant *
-fwupd_device_to_variant_full (FwupdDevice *device, FwupdDeviceFlags flags)
+static GVariant *
+fwupd_device_build_variant (FwupdDevice *device, FwupdDeviceFlags flags)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	GVariantBuilder builder;
 
-	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
-
 	/* create an array with all the metadata in */
 	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
 	if (priv->id != NULL) {
@@ -1700,6 +1734,65 @@ fwupd_device_to_variant_full (FwupdDevice *device, FwupdDeviceFlags flags)
 	return g_variant_new ("a{sv}", &builder);
 }
 
+/**
+ * fwupd_device_invalidate:
+ * @device: A #FwupdDevice
+ *
+ * Marks the device as changed, which invalidates any cached serialization
+ * and emits ::changed. This is only required when modifying one of the
+ * arrays returned by fwupd_device_get_guids() or
+ * fwupd_device_get_instance_ids() directly.
+ *
+ * Since: 1.5.8
+ **/
+void
+fwupd_device_invalidate (FwupdDevice *device)
+{
+	FwupdDevicePrivate *priv = GET_PRIVATE (device);
+	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_changed (device);
+}
+
+/**
+ * fwupd_device_to_variant_full:
+ * @device: A #FwupdDevice
+ * @flags: #FwupdDeviceFlags for the call
+ *
+ * Creates a GVariant from the device data.
+ * Optionally provides additional data based upon flags
+ *
+ * Returns: the GVariant, or %NULL for error
+ *
+ * Since: 1.1.2
+ **/
+GVariant *
+fwupd_device_to_variant_full (FwupdDevice *device, FwupdDeviceFlags flags)
+{
+	FwupdDevicePrivate *priv = GET_PRIVATE (device);
+	guint idx = (flags & FWUPD_DEVICE_FLAG_TRUSTED) > 0 ? 1 : 0;
+	GVariant *val;
+
+	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+
+	/* releases are mutable objects we cannot track, so never cache */
+	if (priv->releases->len > 0)
+		return fwupd_device_build_variant (device, flags);
+
+	/* reuse the serialized data if nothing has changed */
+	if (priv->variant_cache[idx] != NULL &&
+	    priv->variant_change_count[idx] == priv->change_count) {
+		return g_variant_new_from_bytes (G_VARIANT_TYPE_VARDICT,
+						 priv->variant_cache[idx],
+						 TRUE);
+	}
+	val = fwupd_device_build_variant (device, flags);
+	if (priv->variant_cache[idx] != NULL)
+		g_bytes_unref (priv->variant_cache[idx]);
+	priv->variant_cache[idx] = g_variant_get_data_as_bytes (val);
+	priv->variant_change_count[idx] = priv->change_count;
+	return val;
+}
+
 /**
  * fwupd_device_to_variant:
  * @device: A #FwupdDevice
@@ -1966,6 +2059,7 @@ fwupd_device_set_update_state (FwupdDevice *device, FwupdUpdateState update_stat
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
 	if (priv->update_state == update_state)
 		return;
+	fwupd_device_changed (device);
 	priv->update_state = update_state;
 	g_object_notify (G_OBJECT (device), "update-state");
 }
@@ -2002,6 +2096,7 @@ fwupd_device_set_version_format (FwupdDevice *device, FwupdVersionFormat version
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_changed (device);
 	priv->version_format = version_format;
 }
 
@@ -2037,6 +2132,7 @@ fwupd_device_set_version_raw (FwupdDevice *device, guint64 version_raw)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_changed (device);
 	priv->version_raw = version_raw;
 }
 
@@ -2077,6 +2173,7 @@ fwupd_device_set_update_message (FwupdDevice *device, const gchar *update_messag
 	if (g_strcmp0 (priv->update_message, update_message) == 0)
 		return;
 
+	fwupd_device_changed (device);
 	g_free (priv->update_message);
 	priv->update_message = g_strdup (update_message);
 }
@@ -2118,6 +2215,7 @@ fwupd_device_set_update_image (FwupdDevice *device, const gchar *update_image)
 	if (g_strcmp0 (priv->update_image, update_image) == 0)
 		return;
 
+	fwupd_device_changed (device);
 	g_free (priv->update_image);
 	priv->update_image = g_strdup (update_image);
 }
@@ -2159,6 +2257,7 @@ fwupd_device_set_update_error (FwupdDevice *device, const gchar *update_error)
 	if (g_strcmp0 (priv->update_error, update_error) == 0)
 		return;
 
+	fwupd_device_changed (device);
 	g_free (priv->update_error);
 	priv->update_error = g_strdup (update_error);
 }
@@ -2215,6 +2314,7 @@ fwupd_device_add_release (FwupdDevice *device, FwupdRelease *release)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_changed (device);
 	g_ptr_array_add (priv->releases, g_object_ref (release));
 }
 /**
@@ -2251,6 +2351,7 @@ fwupd_device_set_status (FwupdDevice *self, FwupdStatus status)
 	g_return_if_fail (FWUPD_IS_DEVICE (self));
 	if (priv->status == status)
 		return;
+	priv->change_count++;
 	priv->status = status;
 	g_object_notify (G_OBJECT (self), "status");
 }
@@ -2591,6 +2692,22 @@ fwupd_device_class_init (FwupdDeviceClass *klass)
 	object_class->get_property = fwupd_device_get_property;
 	object_class->set_property = fwupd_device_set_property;
 
+	/**
+	 * FwupdDevice::changed:
+	 * @self: the #FwupdDevice instance that emitted the signal
+	 *
+	 * The ::changed signal is emitted when any of the serialized state of
+	 * the device has changed, including properties that have no
+	 * notification. Changes to the status are not included.
+	 *
+	 * Since: 1.5.8
+	 **/
+	signals [SIGNAL_CHANGED] =
+		g_signal_new ("changed",
+			      G_TYPE_FROM_CLASS (object_class), G_SIGNAL_RUN_LAST,
+			      0, NULL, NULL, g_cclosure_marshal_VOID__VOID,
+			      G_TYPE_NONE, 0);
+
 	pspec = g_param_spec_uint ("version-format", NULL, NULL,
 				   FWUPD_VERSION_FORMAT_UNKNOWN,
 				   FWUPD_VERSION_FORMAT_LAST,
@@ -2663,6 +2780,10 @@ fwupd_device_finalize (GObject *object)
 				     fwupd_device_child_finalized_cb,
 				     device);
 	}
+	for (guint i = 0; i < G_N_ELEMENTS (priv->variant_cache); i++) {
+		if (priv->variant_cache[i] != NULL)
+			g_bytes_unref (priv->variant_cache[i]);
+	}
 
 	g_free (priv->description);
 	g_free (priv->id);
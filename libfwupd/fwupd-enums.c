@@ -511,6 +511,8 @@ fwupd_feature_flag_to_string (FwupdFeatureFlags feature_flag)
 		return "update-action";
 	if (feature_flag == FWUPD_FEATURE_FLAG_SWITCH_BRANCH)
 		return "switch-branch";
+	if (feature_flag == FWUPD_FEATURE_FLAG_DEVICES_CHANGED)
+		return "devices-changed";
 	return NULL;
 }
 
@@ -537,6 +539,8 @@ fwupd_feature_flag_from_string (const gchar *feature_flag)
 		return FWUPD_FEATURE_FLAG_UPDATE_ACTION;
 	if (g_strcmp0 (feature_flag, "switch-branch") == 0)
 		return FWUPD_FEATURE_FLAG_SWITCH_BRANCH;
+	if (g_strcmp0 (feature_flag, "devices-changed") == 0)
+		return FWUPD_FEATURE_FLAG_DEVICES_CHANGED;
 	return FWUPD_FEATURE_FLAG_LAST;
 }
 
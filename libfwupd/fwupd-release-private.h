@@ -14,6 +14,8 @@
 G_BEGIN_DECLS
 
 GVariant	*fwupd_release_to_variant		(FwupdRelease	*release);
+void		 fwupd_release_incorporate		(FwupdRelease	*self,
+							 FwupdRelease	*donor);
 void		 fwupd_release_to_json			(FwupdRelease *release,
 							 JsonBuilder *builder);
 
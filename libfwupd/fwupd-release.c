@@ -1454,6 +1454,91 @@ fwupd_release_set_install_duration (FwupdRelease *release, guint32 duration)
 	priv->install_duration = duration;
 }
 
+/**
+ * fwupd_release_incorporate:
+ * @self: A #FwupdRelease
+ * @donor: Another #FwupdRelease
+ *
+ * Copy all properties from the donor object if they have not already been set.
+ *
+ * Since: 1.5.8
+ **/
+void
+fwupd_release_incorporate (FwupdRelease *self, FwupdRelease *donor)
+{
+	FwupdReleasePrivate *priv = GET_PRIVATE (self);
+	FwupdReleasePrivate *priv_donor = GET_PRIVATE (donor);
+
+	g_return_if_fail (FWUPD_IS_RELEASE (self));
+	g_return_if_fail (FWUPD_IS_RELEASE (donor));
+
+	if (priv->flags == 0)
+		fwupd_release_set_flags (self, priv_donor->flags);
+	if (priv->urgency == FWUPD_RELEASE_URGENCY_UNKNOWN)
+		fwupd_release_set_urgency (self, priv_donor->urgency);
+	if (priv->size == 0)
+		fwupd_release_set_size (self, priv_donor->size);
+	if (priv->created == 0)
+		fwupd_release_set_created (self, priv_donor->created);
+	if (priv->install_duration == 0)
+		fwupd_release_set_install_duration (self, priv_donor->install_duration);
+	if (priv->description == NULL)
+		fwupd_release_set_description (self, priv_donor->description);
+	if (priv->filename == NULL)
+		fwupd_release_set_filename (self, priv_donor->filename);
+	if (priv->protocol == NULL)
+		fwupd_release_set_protocol (self, priv_donor->protocol);
+	if (priv->homepage == NULL)
+		fwupd_release_set_homepage (self, priv_donor->homepage);
+	if (priv->details_url == NULL)
+		fwupd_release_set_details_url (self, priv_donor->details_url);
+	if (priv->source_url == NULL)
+		fwupd_release_set_source_url (self, priv_donor->source_url);
+	if (priv->appstream_id == NULL)
+		fwupd_release_set_appstream_id (self, priv_donor->appstream_id);
+	if (priv->detach_caption == NULL)
+		fwupd_release_set_detach_caption (self, priv_donor->detach_caption);
+	if (priv->detach_image == NULL)
+		fwupd_release_set_detach_image (self, priv_donor->detach_image);
+	if (priv->license == NULL)
+		fwupd_release_set_license (self, priv_donor->license);
+	if (priv->name == NULL)
+		fwupd_release_set_name (self, priv_donor->name);
+	if (priv->name_variant_suffix == NULL)
+		fwupd_release_set_name_variant_suffix (self, priv_donor->name_variant_suffix);
+	if (priv->summary == NULL)
+		fwupd_release_set_summary (self, priv_donor->summary);
+	if (priv->branch == NULL)
+		fwupd_release_set_branch (self, priv_donor->branch);
+	if (priv->vendor == NULL)
+		fwupd_release_set_vendor (self, priv_donor->vendor);
+	if (priv->version == NULL)
+		fwupd_release_set_version (self, priv_donor->version);
+	if (priv->remote_id == NULL)
+		fwupd_release_set_remote_id (self, priv_donor->remote_id);
+	if (priv->update_message == NULL)
+		fwupd_release_set_update_message (self, priv_donor->update_message);
+	if (priv->update_image == NULL)
+		fwupd_release_set_update_image (self, priv_donor->update_image);
+	for (guint i = 0; i < priv_donor->checksums->len; i++) {
+		const gchar *tmp = g_ptr_array_index (priv_donor->checksums, i);
+		fwupd_release_add_checksum (self, tmp);
+	}
+	for (guint i = 0; i < priv_donor->categories->len; i++) {
+		const gchar *tmp = g_ptr_array_index (priv_donor->categories, i);
+		fwupd_release_add_category (self, tmp);
+	}
+	for (guint i = 0; i < priv_donor->issues->len; i++) {
+		const gchar *tmp = g_ptr_array_index (priv_donor->issues, i);
+		fwupd_release_add_issue (self, tmp);
+	}
+	for (guint i = 0; i < priv_donor->locations->len; i++) {
+		const gchar *tmp = g_ptr_array_index (priv_donor->locations, i);
+		fwupd_release_add_location (self, tmp);
+	}
+	fwupd_release_add_metadata (self, priv_donor->metadata);
+}
+
 /**
  * fwupd_release_to_variant:
  * @release: A #FwupdRelease
@@ -7,7 +7,14 @@
 #include "config.h"
 
 #include <glib-object.h>
+#include <glib/gstdio.h>
+#include <fcntl.h>
 #include <string.h>
+#ifdef HAVE_FLOCK
+#include <sys/file.h>
+#endif
+#include <unistd.h>
+#include <utime.h>
 #ifdef HAVE_FNMATCH_H
 #include <fnmatch.h>
 #endif
@@ -443,6 +450,102 @@ fwupd_device_func (void)
 	g_assert (ret);
 }
 
+static void
+fwupd_device_variant_cache_func (void)
+{
+	gdouble elapsed_build;
+	gdouble elapsed_cached;
+	g_autoptr(GPtrArray) devices = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_autoptr(GTimer) timer = g_timer_new ();
+	g_autoptr(GVariant) val1 = NULL;
+	g_autoptr(GVariant) val2 = NULL;
+	g_autoptr(GVariant) val3 = NULL;
+	g_autoptr(GVariant) val4 = NULL;
+
+	/* create lots of realistic devices */
+	for (guint i = 0; i < 500; i++) {
+		g_autoptr(FwupdDevice) dev = fwupd_device_new ();
+		g_autofree gchar *id = g_strdup_printf ("USB:%04u", i);
+		fwupd_device_set_id (dev, id);
+		fwupd_device_set_name (dev, "ColorHug2");
+		fwupd_device_set_vendor (dev, "Hughski Limited");
+		fwupd_device_add_vendor_id (dev, "USB:0x273F");
+		fwupd_device_set_version (dev, "1.2.3");
+		fwupd_device_set_version_format (dev, FWUPD_VERSION_FORMAT_TRIPLET);
+		fwupd_device_set_plugin (dev, "colorhug");
+		fwupd_device_set_protocol (dev, "com.hughski.colorhug");
+		fwupd_device_add_flag (dev, FWUPD_DEVICE_FLAG_UPDATABLE);
+		fwupd_device_add_guid (dev, "2082b5e0-7a64-478a-b1b2-e3404fab6dad");
+		fwupd_device_add_guid (dev, "00000000-0000-0000-0000-000000000000");
+		fwupd_device_add_instance_id (dev, "USB\\VID_273F&PID_1004");
+		fwupd_device_add_icon (dev, "input-gaming");
+		fwupd_device_add_checksum (dev, "beefdead");
+		g_ptr_array_add (devices, g_steal_pointer (&dev));
+	}
+
+	/* first serialization builds the dictionary */
+	g_timer_reset (timer);
+	for (guint i = 0; i < devices->len; i++) {
+		FwupdDevice *dev = g_ptr_array_index (devices, i);
+		g_variant_unref (g_variant_ref_sink (fwupd_device_to_variant (dev)));
+	}
+	elapsed_build = g_timer_elapsed (timer, NULL) * 1000.f;
+
+	/* unchanged devices reuse the serialized data */
+	g_timer_reset (timer);
+	for (guint i = 0; i < devices->len; i++) {
+		FwupdDevice *dev = g_ptr_array_index (devices, i);
+		g_variant_unref (g_variant_ref_sink (fwupd_device_to_variant (dev)));
+	}
+	elapsed_cached = g_timer_elapsed (timer, NULL) * 1000.f;
+	g_print ("build=%.3fms cached=%.3fms ", elapsed_build, elapsed_cached);
+
+	/* same data is shared, and the trusted variant is separate */
+	val1 = g_variant_ref_sink (fwupd_device_to_variant (g_ptr_array_index (devices, 0)));
+	val2 = g_variant_ref_sink (fwupd_device_to_variant (g_ptr_array_index (devices, 0)));
+	g_assert_true (g_variant_get_data (val1) == g_variant_get_data (val2));
+	g_assert_true (g_variant_equal (val1, val2));
+	val3 = g_variant_ref_sink (fwupd_device_to_variant_full (g_ptr_array_index (devices, 0),
+								 FWUPD_DEVICE_FLAG_TRUSTED));
+	g_assert_false (g_variant_equal (val1, val3));
+
+	/* changing the device invalidates the cache */
+	fwupd_device_set_version (g_ptr_array_index (devices, 0), "1.2.4");
+	val4 = g_variant_ref_sink (fwupd_device_to_variant (g_ptr_array_index (devices, 0)));
+	g_assert_false (g_variant_equal (val1, val4));
+}
+
+static void
+fwupd_device_changed_cb (FwupdDevice *device, gpointer user_data)
+{
+	guint *cnt = (guint *) user_data;
+	(*cnt)++;
+}
+
+static void
+fwupd_device_changed_func (void)
+{
+	guint cnt = 0;
+	g_autoptr(FwupdDevice) dev = fwupd_device_new ();
+
+	g_signal_connect (dev, "changed",
+			  G_CALLBACK (fwupd_device_changed_cb), &cnt);
+
+	/* setters without a notification are included */
+	fwupd_device_set_summary (dev, "A device");
+	g_assert_cmpint (cnt, ==, 1);
+	fwupd_device_add_guid (dev, "2082b5e0-7a64-478a-b1b2-e3404fab6dad");
+	g_assert_cmpint (cnt, ==, 2);
+
+	/* setting the same value does not count */
+	fwupd_device_add_guid (dev, "2082b5e0-7a64-478a-b1b2-e3404fab6dad");
+	g_assert_cmpint (cnt, ==, 2);
+
+	/* the status is transient */
+	fwupd_device_set_status (dev, FWUPD_STATUS_DEVICE_WRITE);
+	g_assert_cmpint (cnt, ==, 2);
+}
+
 static void
 fwupd_client_devices_func (void)
 {
@@ -662,6 +765,295 @@ fwupd_common_guid_func (void)
 	g_assert_false (fwupd_guid_from_string ("0112233-4455-6677-8899-aabbccddeeff", NULL, 0, NULL));
 }
 
+#ifdef HAVE_LIBCURL
+typedef struct {
+	GBytes		*blob_a;
+	GBytes		*blob_b;
+	GBytes		*blob_c;
+	guint		 delay_us;		/* per kB */
+	gsize		 disconnect_after;	/* first request for /a.cab */
+	gint		 requests;		/* atomic */
+	gint		 requests_range;	/* atomic */
+	gint		 disconnects;		/* atomic */
+} FwupdTestHttpHelper;
+
+/* a minimal HTTP server that can be slow and unreliable */
+static gboolean
+fwupd_test_http_run_cb (GThreadedSocketService *service,
+			GSocketConnection *connection,
+			GObject *source_object,
+			gpointer user_data)
+{
+	FwupdTestHttpHelper *helper = (FwupdTestHttpHelper *) user_data;
+	GInputStream *istream = g_io_stream_get_input_stream (G_IO_STREAM (connection));
+	GOutputStream *ostream = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+	GBytes *blob = NULL;
+	const guint8 *buf;
+	gsize bufsz;
+	gsize limit;
+	gsize offset = 0;
+	g_autoptr(GDataInputStream) dstream = g_data_input_stream_new (istream);
+	g_autoptr(GString) hdr = g_string_new (NULL);
+
+	/* parse the request */
+	g_data_input_stream_set_newline_type (dstream, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+	while (TRUE) {
+		g_autofree gchar *line = g_data_input_stream_read_line (dstream, NULL, NULL, NULL);
+		if (line == NULL || line[0] == '\0')
+			break;
+		if (g_str_has_prefix (line, "GET /a.cab "))
+			blob = helper->blob_a;
+		else if (g_str_has_prefix (line, "GET /b.cab "))
+			blob = helper->blob_b;
+		else if (g_str_has_prefix (line, "GET /c.cab "))
+			blob = helper->blob_c;
+		else if (g_str_has_prefix (line, "Range: bytes="))
+			offset = g_ascii_strtoull (line + 13, NULL, 10);
+	}
+	g_atomic_int_inc (&helper->requests);
+	if (blob == NULL) {
+		g_string_append (hdr, "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+		g_output_stream_write_all (ostream, hdr->str, hdr->len, NULL, NULL, NULL);
+		return TRUE;
+	}
+	buf = g_bytes_get_data (blob, &bufsz);
+	limit = bufsz;
+	if (offset >= bufsz) {
+		g_string_append (hdr, "HTTP/1.1 416 Range Not Satisfiable\r\nContent-Length: 0\r\n\r\n");
+		g_output_stream_write_all (ostream, hdr->str, hdr->len, NULL, NULL, NULL);
+		return TRUE;
+	}
+	if (offset > 0) {
+		g_atomic_int_inc (&helper->requests_range);
+		g_string_append_printf (hdr,
+					"HTTP/1.1 206 Partial Content\r\n"
+					"Content-Range: bytes %" G_GSIZE_FORMAT "-%" G_GSIZE_FORMAT "/%" G_GSIZE_FORMAT "\r\n",
+					offset, bufsz - 1, bufsz);
+	} else {
+		g_string_append (hdr, "HTTP/1.1 200 OK\r\n");
+	}
+	g_string_append_printf (hdr,
+				"Content-Length: %" G_GSIZE_FORMAT "\r\n"
+				"Connection: close\r\n\r\n",
+				bufsz - offset);
+	if (!g_output_stream_write_all (ostream, hdr->str, hdr->len, NULL, NULL, NULL))
+		return TRUE;
+
+	/* drop the connection part way through the first transfer */
+	if (blob == helper->blob_a &&
+	    helper->disconnect_after > 0 &&
+	    g_atomic_int_add (&helper->disconnects, 1) == 0)
+		limit = helper->disconnect_after;
+
+	/* send slowly */
+	for (gsize i = offset; i < limit; i += 0x400) {
+		gsize chunksz = MIN (0x400, limit - i);
+		if (!g_output_stream_write_all (ostream, buf + i, chunksz, NULL, NULL, NULL))
+			break;
+		g_usleep (helper->delay_us);
+	}
+	g_io_stream_close (G_IO_STREAM (connection), NULL, NULL);
+	return TRUE;
+}
+
+static FwupdRelease *
+fwupd_test_release_new (guint16 port, const gchar *basename, GBytes *blob)
+{
+	FwupdRelease *rel = fwupd_release_new ();
+	g_autofree gchar *checksum = NULL;
+	g_autofree gchar *uri = NULL;
+
+	uri = g_strdup_printf ("http://127.0.0.1:%u/%s", port, basename);
+	fwupd_release_add_location (rel, uri);
+	checksum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, blob);
+	fwupd_release_add_checksum (rel, checksum);
+	fwupd_release_set_size (rel, g_bytes_get_size (blob));
+	return rel;
+}
+
+#ifdef HAVE_FLOCK
+typedef struct {
+	gint		 fd;
+	GBytes		*blob;
+	gchar		*filename;
+	gchar		*filename_part;
+} FwupdTestLockHelper;
+
+/* pretend to be another process completing the same download */
+static gpointer
+fwupd_test_lock_thread_cb (gpointer user_data)
+{
+	FwupdTestLockHelper *helper = (FwupdTestLockHelper *) user_data;
+	gsize bufsz = 0;
+	const guint8 *buf = g_bytes_get_data (helper->blob, &bufsz);
+	g_usleep (300 * 1000);
+	g_assert_cmpint (write (helper->fd, buf, bufsz), ==, (gssize) bufsz);
+	g_assert_cmpint (g_rename (helper->filename_part, helper->filename), ==, 0);
+	g_close (helper->fd, NULL);
+	return NULL;
+}
+#endif
+
+static void
+fwupd_client_download_releases_func (void)
+{
+	gint requests;
+	guint16 port;
+	struct utimbuf buf_old = { .actime = 1, .modtime = 1 };
+	g_autofree gchar *tmpdir = NULL;
+	g_autofree guint8 *buf_a = g_malloc (0x10000);
+	g_autofree guint8 *buf_b = g_malloc (0x8000);
+	g_autoptr(FwupdClient) client = fwupd_client_new ();
+	g_autoptr(FwupdRelease) rel_bad = NULL;
+	g_autoptr(GBytes) blob_bad = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) filenames = NULL;
+	g_autoptr(GPtrArray) filenames2 = NULL;
+	g_autoptr(GPtrArray) filenames3 = NULL;
+	g_autoptr(GPtrArray) filenames4 = NULL;
+	g_autoptr(GPtrArray) filenames5 = NULL;
+	g_autoptr(GPtrArray) rels_lru = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_autoptr(GPtrArray) rels = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_autoptr(GPtrArray) rels_bad = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_autoptr(GPtrArray) rels_dup = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_autoptr(GSocketService) service = g_threaded_socket_service_new (4);
+	FwupdTestHttpHelper helper = {
+		.delay_us = 500,
+		.disconnect_after = 0x4321,
+	};
+
+	/* start the HTTP stand-in */
+	for (guint i = 0; i < 0x10000; i++)
+		buf_a[i] = i % 0xfb;
+	for (guint i = 0; i < 0x8000; i++)
+		buf_b[i] = i % 0xf1;
+	helper.blob_a = g_bytes_new_static (buf_a, 0x10000);
+	helper.blob_b = g_bytes_new_static (buf_b, 0x8000);
+	helper.blob_c = g_bytes_new_static (buf_b, 0x1000);
+	port = g_socket_listener_add_any_inet_port (G_SOCKET_LISTENER (service), NULL, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (port, >, 0);
+	g_signal_connect (service, "run", G_CALLBACK (fwupd_test_http_run_cb), &helper);
+	g_socket_service_start (service);
+
+	/* download both in parallel, with the first being interrupted */
+	tmpdir = g_dir_make_tmp ("fwupd-self-test-XXXXXX", &error);
+	g_assert_no_error (error);
+	fwupd_client_set_download_dir (client, tmpdir);
+	fwupd_client_set_user_agent (client, "fwupd/" PACKAGE_VERSION);
+	g_ptr_array_add (rels, fwupd_test_release_new (port, "a.cab", helper.blob_a));
+	g_ptr_array_add (rels, fwupd_test_release_new (port, "b.cab", helper.blob_b));
+	filenames = fwupd_client_download_releases (client, rels,
+						    FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+						    NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (filenames);
+	g_assert_cmpint (filenames->len, ==, 2);
+	for (guint i = 0; i < filenames->len; i++) {
+		const gchar *fn = g_ptr_array_index (filenames, i);
+		GBytes *blob = i == 0 ? helper.blob_a : helper.blob_b;
+		g_autofree gchar *data = NULL;
+		g_autofree gchar *fn_part = g_strdup_printf ("%s.part", fn);
+		gsize datasz = 0;
+		g_assert_true (g_file_get_contents (fn, &data, &datasz, &error));
+		g_assert_no_error (error);
+		g_assert_cmpint (datasz, ==, g_bytes_get_size (blob));
+		g_assert_cmpint (memcmp (data, g_bytes_get_data (blob, NULL), datasz), ==, 0);
+		g_assert_false (g_file_test (fn_part, G_FILE_TEST_EXISTS));
+	}
+	g_assert_cmpint (g_atomic_int_get (&helper.requests_range), >=, 1);
+
+	/* already downloaded */
+	requests = g_atomic_int_get (&helper.requests);
+	filenames2 = fwupd_client_download_releases (client, rels,
+						     FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+						     NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (filenames2);
+	g_assert_cmpint (g_atomic_int_get (&helper.requests), ==, requests);
+
+	/* checksum is verified */
+	blob_bad = g_bytes_new_static ("hello", 5);
+	rel_bad = fwupd_test_release_new (port, "b.cab", blob_bad);
+	g_ptr_array_add (rels_bad, g_object_ref (rel_bad));
+	filenames3 = fwupd_client_download_releases (client, rels_bad,
+						     FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+						     NULL, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_null (filenames3);
+	g_clear_error (&error);
+
+	/* the least recently used firmware is deleted to make space */
+	g_assert_cmpint (g_utime (g_ptr_array_index (filenames, 1), &buf_old), ==, 0);
+	fwupd_client_set_download_cache_size_max (client, 0x10000 + 0x8000);
+	g_ptr_array_add (rels_lru, fwupd_test_release_new (port, "c.cab", helper.blob_c));
+	filenames4 = fwupd_client_download_releases (client, rels_lru,
+						     FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+						     NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (filenames4);
+	g_assert_true (g_file_test (g_ptr_array_index (filenames, 0), G_FILE_TEST_EXISTS));
+	g_assert_false (g_file_test (g_ptr_array_index (filenames, 1), G_FILE_TEST_EXISTS));
+	g_assert_true (g_file_test (g_ptr_array_index (filenames4, 0), G_FILE_TEST_EXISTS));
+
+	/* the same firmware for two devices is only transferred once */
+	g_assert_cmpint (g_unlink (g_ptr_array_index (filenames4, 0)), ==, 0);
+	g_ptr_array_add (rels_dup, fwupd_test_release_new (port, "c.cab", helper.blob_c));
+	g_ptr_array_add (rels_dup, fwupd_test_release_new (port, "c.cab", helper.blob_c));
+	requests = g_atomic_int_get (&helper.requests);
+	filenames5 = fwupd_client_download_releases (client, rels_dup,
+						     FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+						     NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (filenames5);
+	g_assert_cmpint (filenames5->len, ==, 2);
+	g_assert_cmpstr (g_ptr_array_index (filenames5, 0), ==, g_ptr_array_index (filenames5, 1));
+	g_assert_true (g_file_test (g_ptr_array_index (filenames5, 0), G_FILE_TEST_EXISTS));
+	g_assert_cmpint (g_atomic_int_get (&helper.requests), ==, requests + 1);
+
+#ifdef HAVE_FLOCK
+	/* a partial file locked by another process is never written to */
+	{
+		FwupdTestLockHelper helper_lock = { 0 };
+		g_autoptr(GPtrArray) filenames6 = NULL;
+		g_autoptr(GThread) thread = NULL;
+
+		helper_lock.blob = helper.blob_c;
+		helper_lock.filename = g_strdup (g_ptr_array_index (filenames5, 0));
+		helper_lock.filename_part = g_strdup_printf ("%s.part", helper_lock.filename);
+		g_assert_cmpint (g_unlink (helper_lock.filename), ==, 0);
+		helper_lock.fd = g_open (helper_lock.filename_part, O_RDWR | O_CREAT, 0600);
+		g_assert_cmpint (helper_lock.fd, >=, 0);
+		g_assert_cmpint (flock (helper_lock.fd, LOCK_EX | LOCK_NB), ==, 0);
+		thread = g_thread_new ("lock", fwupd_test_lock_thread_cb, &helper_lock);
+		requests = g_atomic_int_get (&helper.requests);
+		filenames6 = fwupd_client_download_releases (client, rels_lru,
+							     FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+							     NULL, &error);
+		g_thread_join (g_steal_pointer (&thread));
+		g_assert_no_error (error);
+		g_assert_nonnull (filenames6);
+		g_assert_true (g_file_test (helper_lock.filename, G_FILE_TEST_EXISTS));
+		g_assert_false (g_file_test (helper_lock.filename_part, G_FILE_TEST_EXISTS));
+		g_assert_cmpint (g_atomic_int_get (&helper.requests), ==, requests);
+		g_free (helper_lock.filename);
+		g_free (helper_lock.filename_part);
+	}
+#endif
+
+	/* clean up */
+	g_socket_service_stop (service);
+	g_socket_listener_close (G_SOCKET_LISTENER (service));
+	for (guint i = 0; i < filenames->len; i++)
+		g_unlink (g_ptr_array_index (filenames, i));
+	g_unlink (g_ptr_array_index (filenames5, 0));
+	g_rmdir (tmpdir);
+	g_bytes_unref (helper.blob_a);
+	g_bytes_unref (helper.blob_b);
+	g_bytes_unref (helper.blob_c);
+}
+#endif
+
 int
 main (int argc, char **argv)
 {
@@ -678,10 +1070,15 @@ main (int argc, char **argv)
 	g_test_add_func ("/fwupd/common{guid}", fwupd_common_guid_func);
 	g_test_add_func ("/fwupd/release", fwupd_release_func);
 	g_test_add_func ("/fwupd/device", fwupd_device_func);
+	g_test_add_func ("/fwupd/device{variant-cache}", fwupd_device_variant_cache_func);
+	g_test_add_func ("/fwupd/device{changed}", fwupd_device_changed_func);
 	g_test_add_func ("/fwupd/remote{download}", fwupd_remote_download_func);
 	g_test_add_func ("/fwupd/remote{base-uri}", fwupd_remote_baseuri_func);
 	g_test_add_func ("/fwupd/remote{no-path}", fwupd_remote_nopath_func);
 	g_test_add_func ("/fwupd/remote{local}", fwupd_remote_local_func);
+#ifdef HAVE_LIBCURL
+	g_test_add_func ("/fwupd/client{download-releases}", fwupd_client_download_releases_func);
+#endif
 	if (fwupd_has_system_bus ()) {
 		g_test_add_func ("/fwupd/client{remotes}", fwupd_client_remotes_func);
 		g_test_add_func ("/fwupd/client{devices}", fwupd_client_devices_func);
@@ -26,6 +26,7 @@ struct _FuCabinet {
 	XbSilo			*silo;
 	JcatContext		*jcat_context;
 	JcatFile		*jcat_file;
+	FuVerifyCache		*verify_cache;
 };
 
 G_DEFINE_TYPE (FuCabinet, fu_cabinet, G_TYPE_OBJECT)
@@ -42,6 +43,8 @@ fu_cabinet_finalize (GObject *obj)
 	g_object_unref (self->gcab_cabinet);
 	g_object_unref (self->jcat_context);
 	g_object_unref (self->jcat_file);
+	if (self->verify_cache != NULL)
+		g_object_unref (self->verify_cache);
 	G_OBJECT_CLASS (fu_cabinet_parent_class)->finalize (obj);
 }
 
@@ -96,6 +99,25 @@ fu_cabinet_set_jcat_context (FuCabinet *self, JcatContext *jcat_context)
 	g_set_object (&self->jcat_context, jcat_context);
 }
 
+/**
+ * fu_cabinet_set_verify_cache: (skip):
+ * @self: A #FuCabinet
+ * @verify_cache: (nullable): A #FuVerifyCache
+ *
+ * Sets the cache used for the Jcat verification results, which allows the
+ * signatures of an archive that has already been parsed to not be verified
+ * again.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_cabinet_set_verify_cache (FuCabinet *self, FuVerifyCache *verify_cache)
+{
+	g_return_if_fail (FU_IS_CABINET (self));
+	g_return_if_fail (verify_cache == NULL || FU_IS_VERIFY_CACHE (verify_cache));
+	g_set_object (&self->verify_cache, verify_cache);
+}
+
 /**
  * fu_cabinet_get_silo: (skip):
  * @self: A #FuCabinet
@@ -116,6 +138,36 @@ fu_cabinet_get_silo (FuCabinet *self)
 	return g_object_ref (self->silo);
 }
 
+static GPtrArray *
+fu_cabinet_verify_item (FuCabinet *self,
+			GBytes *blob,
+			JcatItem *item,
+			JcatVerifyFlags flags,
+			GError **error)
+{
+	if (self->verify_cache != NULL) {
+		return fu_verify_cache_verify_item (self->verify_cache,
+						    self->jcat_context,
+						    blob, item, flags, error);
+	}
+	return jcat_context_verify_item (self->jcat_context, blob, item, flags, error);
+}
+
+static JcatResult *
+fu_cabinet_verify_blob (FuCabinet *self,
+			GBytes *blob,
+			JcatBlob *blob_signature,
+			JcatVerifyFlags flags,
+			GError **error)
+{
+	if (self->verify_cache != NULL) {
+		return fu_verify_cache_verify_blob (self->verify_cache,
+						    self->jcat_context,
+						    blob, blob_signature, flags, error);
+	}
+	return jcat_context_verify_blob (self->jcat_context, blob, blob_signature, flags, error);
+}
+
 static GCabFile *
 fu_cabinet_get_file_by_name (FuCabinet *self, const gchar *basename)
 {
@@ -221,11 +273,10 @@ fu_cabinet_parse_release (FuCabinet *self, XbNode *release, GError **error)
 	if (item != NULL) {
 		g_autoptr(GError) error_local = NULL;
 		g_autoptr(GPtrArray) results = NULL;
-		results = jcat_context_verify_item (self->jcat_context,
-						    blob, item,
-						    JCAT_VERIFY_FLAG_REQUIRE_CHECKSUM |
-						    JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE,
-						    &error_local);
+		results = fu_cabinet_verify_item (self, blob, item,
+						  JCAT_VERIFY_FLAG_REQUIRE_CHECKSUM |
+						  JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE,
+						  &error_local);
 		if (results == NULL) {
 			g_debug ("failed to verify payload %s: %s",
 				 basename, error_local->message);
@@ -256,10 +307,9 @@ fu_cabinet_parse_release (FuCabinet *self, XbNode *release, GError **error)
 				return FALSE;
 			}
 			jcat_blob = jcat_blob_new (JCAT_BLOB_KIND_GPG, data_sig);
-			jcat_result = jcat_context_verify_blob (self->jcat_context,
-								blob, jcat_blob,
-								JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE,
-								&error_local);
+			jcat_result = fu_cabinet_verify_blob (self, blob, jcat_blob,
+							      JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE,
+							      &error_local);
 			if (jcat_result == NULL) {
 				g_debug ("failed to verify payload %s using detached: %s",
 					 basename, error_local->message);
@@ -411,12 +461,12 @@ fu_cabinet_build_silo_metainfo (FuCabinet *self, GCabFile *cabfile, GError **err
 	} else {
 		g_autoptr(GError) error_local = NULL;
 		g_autoptr(GPtrArray) results = NULL;
-		results = jcat_context_verify_item (self->jcat_context,
-						    gcab_file_get_bytes (cabfile),
-						    item,
-						    JCAT_VERIFY_FLAG_REQUIRE_CHECKSUM |
-						    JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE,
-						    &error_local);
+		results = fu_cabinet_verify_item (self,
+						  gcab_file_get_bytes (cabfile),
+						  item,
+						  JCAT_VERIFY_FLAG_REQUIRE_CHECKSUM |
+						  JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE,
+						  &error_local);
 		if (results == NULL) {
 			g_debug ("failed to verify %s: %s",
 				 fn, error_local->message);
@@ -10,6 +10,8 @@
 #include <xmlb.h>
 #include <jcat.h>
 
+#include "fu-verify-cache.h"
+
 #define FU_TYPE_CABINET (fu_cabinet_get_type ())
 
 G_DECLARE_FINAL_TYPE (FuCabinet, fu_cabinet, FU, CABINET, GObject)
@@ -31,6 +33,8 @@ void		 fu_cabinet_set_size_max	(FuCabinet		*self,
 						 guint64		 size_max);
 void		 fu_cabinet_set_jcat_context	(FuCabinet		*self,
 						 JcatContext		*jcat_context);
+void		 fu_cabinet_set_verify_cache	(FuCabinet		*self,
+						 FuVerifyCache		*verify_cache);
 gboolean	 fu_cabinet_parse		(FuCabinet		*self,
 						 GBytes			*data,
 						 FuCabinetParseFlags	 flags,
@@ -587,3 +587,253 @@ fu_common_vercmp_full (const gchar *version_a,
 	}
 	return fu_common_vercmp_safe (version_a, version_b);
 }
+
+typedef struct {
+	gint64		 num;
+	const gchar	*alpha;		/* trailing non-numeric part, or "" */
+} FuVersionKeySegment;
+
+struct _FuVersionKey {
+	FwupdVersionFormat	 fmt;
+	gchar			*str;		/* (nullable) */
+	gchar			*buf;		/* (nullable): @str split in-place */
+	guint			 segments_len;
+	FuVersionKeySegment	*segments;
+};
+
+/**
+ * fu_common_version_key_new:
+ * @version: (nullable): the release version, e.g. 1.2.3
+ * @fmt: a #FwupdVersionFormat, e.g. %FWUPD_VERSION_FORMAT_PLAIN
+ *
+ * Parses a version number once so that it can be compared many times, for
+ * instance when sorting a large number of releases. Comparing two keys
+ * with fu_common_version_key_compare() gives the same result as calling
+ * fu_common_vercmp_full() on the original strings.
+ *
+ * Returns: (transfer full): a #FuVersionKey
+ *
+ * Since: 1.5.8
+ **/
+FuVersionKey *
+fu_common_version_key_new (const gchar *version, FwupdVersionFormat fmt)
+{
+	FuVersionKey *key = g_new0 (FuVersionKey, 1);
+	gchar *p;
+
+	key->fmt = fmt;
+	if (version == NULL)
+		return key;
+	if (fmt == FWUPD_VERSION_FORMAT_HEX)
+		key->str = fu_common_version_parse_from_format (version, fmt);
+	else
+		key->str = g_strdup (version);
+	if (fmt == FWUPD_VERSION_FORMAT_PLAIN || key->str[0] == '\0')
+		return key;
+
+	/* split into sections, and parse the integer prefix of each */
+	key->buf = g_strdup (key->str);
+	key->segments_len = 1;
+	for (guint i = 0; key->buf[i] != '\0'; i++) {
+		if (key->buf[i] == '.')
+			key->segments_len++;
+	}
+	key->segments = g_new0 (FuVersionKeySegment, key->segments_len);
+	p = key->buf;
+	for (guint i = 0; i < key->segments_len; i++) {
+		gchar *endptr = NULL;
+		gchar *dot = strchr (p, '.');
+		if (dot != NULL)
+			*dot = '\0';
+		key->segments[i].num = g_ascii_strtoll (p, &endptr, 10);
+		key->segments[i].alpha = endptr != NULL ? endptr : "";
+		if (dot == NULL)
+			break;
+		p = dot + 1;
+	}
+	return key;
+}
+
+/**
+ * fu_common_version_key_free:
+ * @key: a #FuVersionKey
+ *
+ * Frees a version key.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_common_version_key_free (FuVersionKey *key)
+{
+	if (key == NULL)
+		return;
+	g_free (key->segments);
+	g_free (key->buf);
+	g_free (key->str);
+	g_free (key);
+}
+
+/**
+ * fu_common_version_key_get_version:
+ * @key: a #FuVersionKey
+ *
+ * Gets the version the key was created from, after any format conversion.
+ *
+ * Returns: a version number, or %NULL if unset
+ *
+ * Since: 1.5.8
+ **/
+const gchar *
+fu_common_version_key_get_version (const FuVersionKey *key)
+{
+	g_return_val_if_fail (key != NULL, NULL);
+	return key->str;
+}
+
+/**
+ * fu_common_version_key_compare:
+ * @key_a: a #FuVersionKey
+ * @key_b: a #FuVersionKey created using the same version format
+ *
+ * Compares pre-parsed version numbers for sorting without allocating.
+ *
+ * Returns: -1 if a < b, +1 if a > b, 0 if they are equal, and %G_MAXINT on error
+ *
+ * Since: 1.5.8
+ **/
+gint
+fu_common_version_key_compare (const FuVersionKey *key_a, const FuVersionKey *key_b)
+{
+	guint longest_split;
+
+	g_return_val_if_fail (key_a != NULL, G_MAXINT);
+	g_return_val_if_fail (key_b != NULL, G_MAXINT);
+
+	if (key_a->fmt == FWUPD_VERSION_FORMAT_PLAIN)
+		return g_strcmp0 (key_a->str, key_b->str);
+
+	/* sanity check */
+	if (key_a->str == NULL || key_b->str == NULL)
+		return G_MAXINT;
+
+	longest_split = MAX (key_a->segments_len, key_b->segments_len);
+	for (guint i = 0; i < longest_split; i++) {
+		const FuVersionKeySegment *seg_a;
+		const FuVersionKeySegment *seg_b;
+
+		/* we lost or gained a dot */
+		if (i >= key_a->segments_len)
+			return -1;
+		if (i >= key_b->segments_len)
+			return 1;
+
+		/* compare integers */
+		seg_a = &key_a->segments[i];
+		seg_b = &key_b->segments[i];
+		if (seg_a->num < seg_b->num)
+			return -1;
+		if (seg_a->num > seg_b->num)
+			return 1;
+
+		/* compare strings */
+		if (seg_a->alpha[0] != '\0' || seg_b->alpha[0] != '\0') {
+			gint rc = fu_common_vercmp_chunk (seg_a->alpha, seg_b->alpha);
+			if (rc < 0)
+				return -1;
+			if (rc > 0)
+				return 1;
+		}
+	}
+	return 0;
+}
+
+static gint
+fu_common_vercmp_chunk_len (const gchar *str1, const gchar *str2, gsize str2_len)
+{
+	gsize i;
+	for (i = 0; str1[i] != '\0' && i < str2_len; i++) {
+		gint rc = fu_common_vercmp_char (str1[i], str2[i]);
+		if (rc != 0)
+			return rc;
+	}
+	return fu_common_vercmp_char (str1[i], i < str2_len ? str2[i] : '\0');
+}
+
+static gint
+fu_common_version_key_compare_version_safe (const FuVersionKey *key, const gchar *version)
+{
+	const gchar *p = version;
+	gboolean done = version[0] == '\0';
+
+	for (guint i = 0;; i++) {
+		const FuVersionKeySegment *seg;
+		const gchar *alpha;
+		gchar *endptr = NULL;
+		gint64 ver;
+		gsize alpha_len = 0;
+
+		/* we lost or gained a dot */
+		if (i >= key->segments_len)
+			return done ? 0 : -1;
+		if (done)
+			return 1;
+
+		/* compare integers */
+		seg = &key->segments[i];
+		ver = g_ascii_strtoll (p, &endptr, 10);
+		if (seg->num < ver)
+			return -1;
+		if (seg->num > ver)
+			return 1;
+
+		/* compare strings */
+		alpha = endptr != NULL ? endptr : p;
+		while (alpha[alpha_len] != '\0' && alpha[alpha_len] != '.')
+			alpha_len++;
+		if (seg->alpha[0] != '\0' || alpha_len > 0) {
+			gint rc = fu_common_vercmp_chunk_len (seg->alpha, alpha, alpha_len);
+			if (rc < 0)
+				return -1;
+			if (rc > 0)
+				return 1;
+		}
+
+		/* next section */
+		p = alpha + alpha_len;
+		if (*p == '.')
+			p++;
+		else
+			done = TRUE;
+	}
+}
+
+/**
+ * fu_common_version_key_compare_version:
+ * @key: a #FuVersionKey
+ * @version: (nullable): the release version, e.g. 1.2.3
+ *
+ * Compares a pre-parsed version number with a version string in the same
+ * format as the key, without allocating unless the format is
+ * %FWUPD_VERSION_FORMAT_HEX.
+ *
+ * Returns: -1 if key < version, +1 if key > version, 0 if they are equal, and %G_MAXINT on error
+ *
+ * Since: 1.5.8
+ **/
+gint
+fu_common_version_key_compare_version (const FuVersionKey *key, const gchar *version)
+{
+	g_return_val_if_fail (key != NULL, G_MAXINT);
+
+	if (key->fmt == FWUPD_VERSION_FORMAT_PLAIN)
+		return g_strcmp0 (key->str, version);
+
+	/* sanity check */
+	if (key->str == NULL || version == NULL)
+		return G_MAXINT;
+	if (key->fmt == FWUPD_VERSION_FORMAT_HEX) {
+		g_autofree gchar *hex = fu_common_version_parse_from_format (version, key->fmt);
+		return fu_common_version_key_compare_version_safe (key, hex);
+	}
+	return fu_common_version_key_compare_version_safe (key, version);
+}
@@ -9,6 +9,8 @@
 #include <gio/gio.h>
 #include <fwupd.h>
 
+typedef struct _FuVersionKey FuVersionKey;
+
 gint		 fu_common_vercmp		(const gchar	*version_a,
 						 const gchar	*version_b)
 G_DEPRECATED_FOR(fu_common_vercmp_full);
@@ -31,3 +33,14 @@ gboolean	 fu_common_version_verify_format	(const gchar	*version,
 							 FwupdVersionFormat fmt,
 							 GError		**error)
 							 G_GNUC_WARN_UNUSED_RESULT;
+
+FuVersionKey	*fu_common_version_key_new		(const gchar	*version,
+							 FwupdVersionFormat fmt);
+void		 fu_common_version_key_free		(FuVersionKey	*key);
+const gchar	*fu_common_version_key_get_version	(const FuVersionKey *key);
+gint		 fu_common_version_key_compare		(const FuVersionKey *key_a,
+							 const FuVersionKey *key_b);
+gint		 fu_common_version_key_compare_version	(const FuVersionKey *key,
+							 const gchar	*version);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuVersionKey, fu_common_version_key_free)
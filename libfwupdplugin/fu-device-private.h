@@ -34,3 +34,7 @@ gchar		*fu_device_get_guids_as_str		(FuDevice	*self);
 GPtrArray	*fu_device_get_possible_plugins		(FuDevice	*self);
 void		 fu_device_add_possible_plugin		(FuDevice	*self,
 							 const gchar	*plugin);
+void		 fu_device_reset_io_stats		(FuDevice	*self);
+void		 fu_device_incorporate_io_stats		(FuDevice	*self,
+							 FuDevice	*donor);
+GHashTable	*fu_device_report_io_stats		(FuDevice	*self);
@@ -34,6 +34,20 @@
 
 static void fu_device_finalize			 (GObject *object);
 
+/* upper bounds of each latency bucket in us, the last is unbounded */
+#define FU_DEVICE_IO_LATENCY_BUCKETS		6
+static const gint64 fu_device_io_latency_bounds[] = {
+	100, 1000, 10000, 100000, 1000000, G_MAXINT64 };
+
+typedef struct {
+	guint64				 bytes_read;
+	guint64				 bytes_written;
+	guint64				 transfers;
+	guint64				 retries;
+	guint64				 recoveries;
+	guint64				 latency[FU_DEVICE_IO_LATENCY_BUCKETS];
+} FuDeviceIoStats;
+
 typedef struct {
 	gchar				*alternate_id;
 	gchar				*equivalent_id;
@@ -63,6 +77,8 @@ typedef struct {
 	GPtrArray			*retry_recs;	/* of FuDeviceRetryRecovery */
 	guint				 retry_delay;
 	FuDeviceInternalFlags		 internal_flags;
+	FuDeviceIoStats			 io_stats;
+	GHashTable			*phase_durations; /* (nullable) phase:ms */
 } FuDevicePrivate;
 
 typedef struct {
@@ -351,6 +367,110 @@ fu_device_retry_set_delay (FuDevice *self, guint delay)
 	priv->retry_delay = delay;
 }
 
+/* returns %TRUE if another try should be made, or %FALSE with @error set */
+static gboolean
+fu_device_retry_check (FuDevice *self,
+		       guint i,
+		       guint count,
+		       gpointer user_data,
+		       GError *error_local,
+		       GError **error)
+{
+	FuDevicePrivate *priv = GET_PRIVATE (self);
+
+	/* sanity check */
+	if (error_local == NULL) {
+		g_set_error (error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_FAILED,
+			     "exec failed but no error set!");
+		return FALSE;
+	}
+
+	/* too many retries */
+	if (i >= count - 1) {
+		g_propagate_prefixed_error (error,
+					    g_error_copy (error_local),
+					    "failed after %u retries: ",
+					    count);
+		return FALSE;
+	}
+	priv->io_stats.retries++;
+
+	/* show recoverable error on the console */
+	if (priv->retry_recs->len == 0) {
+		g_debug ("failed on try %u of %u: %s",
+			 i + 1, count, error_local->message);
+		return TRUE;
+	}
+
+	/* find the condition that matches */
+	for (guint j = 0; j < priv->retry_recs->len; j++) {
+		FuDeviceRetryRecovery *rec = g_ptr_array_index (priv->retry_recs, j);
+		if (g_error_matches (error_local, rec->domain, rec->code)) {
+			if (rec->recovery_func != NULL) {
+				priv->io_stats.recoveries++;
+				if (!rec->recovery_func (self, user_data, error))
+					return FALSE;
+			} else {
+				g_set_error (error,
+					     G_IO_ERROR,
+					     G_IO_ERROR_FAILED,
+					     "device recovery not possible");
+				return FALSE;
+			}
+		}
+	}
+	return TRUE;
+}
+
+/* the delay before try @i, doubling each time up to @delay_max with up to 25%
+ * subtracted so that devices on the same bus do not retry in lockstep */
+static guint
+fu_device_retry_get_delay (guint delay, guint delay_max, guint i)
+{
+	guint64 tmp;
+
+	if (i == 0 || delay == 0)
+		return 0;
+	if (delay_max == 0)
+		return delay;
+	tmp = (guint64) delay << MIN (i - 1, 16);
+	if (tmp > delay_max)
+		tmp = delay_max;
+	if (tmp >= 4)
+		tmp -= g_random_int_range (0, (gint32) (tmp / 4) + 1);
+	return (guint) tmp;
+}
+
+static gboolean
+fu_device_retry_internal (FuDevice *self,
+			  FuDeviceRetryFunc func,
+			  guint count,
+			  guint delay,
+			  guint delay_max,
+			  gpointer user_data,
+			  GError **error)
+{
+	for (guint i = 0; ; i++) {
+		guint delay_tmp = fu_device_retry_get_delay (delay, delay_max, i);
+		g_autoptr(GError) error_local =	NULL;
+
+		/* delay */
+		if (delay_tmp > 0)
+			fu_device_sleep_iterate (self, delay_tmp);
+
+		/* run function, if success return success */
+		if (func (self, user_data, &error_local))
+			break;
+		if (!fu_device_retry_check (self, i, count, user_data, error_local, error))
+			return FALSE;
+	}
+
+	/* success */
+	return TRUE;
+}
+
 /**
  * fu_device_retry_full:
  * @self: A #FuDevice
@@ -369,6 +489,9 @@ fu_device_retry_set_delay (FuDevice *self, guint delay)
  * If the reset function returns %FALSE, then the function returns straight away
  * without processing any pending retries.
  *
+ * The delay is done using fu_device_sleep_iterate(), so other sources may be
+ * dispatched between each try.
+ *
  * Since: 1.5.5
  **/
 gboolean
@@ -379,69 +502,241 @@ fu_device_retry_full (FuDevice *self,
 		      gpointer user_data,
 		      GError **error)
 {
-	FuDevicePrivate *priv = GET_PRIVATE (self);
+	g_return_val_if_fail (FU_IS_DEVICE (self), FALSE);
+	g_return_val_if_fail (func != NULL, FALSE);
+	g_return_val_if_fail (count >= 1, FALSE);
+	g_return_val_if_fail (error != NULL, FALSE);
+	return fu_device_retry_internal (self, func, count, delay, 0, user_data, error);
+}
 
+/**
+ * fu_device_retry_backoff:
+ * @self: A #FuDevice
+ * @func: (scope async): A function to execute
+ * @count: The number of tries to try the function
+ * @delay: The delay before the first retry in ms
+ * @delay_max: The maximum delay between each try in ms
+ * @user_data: (nullable): a helper to pass to @user_data
+ * @error: A #GError
+ *
+ * Calls a specific function a number of times like fu_device_retry_full(),
+ * but doubling the delay after each failure up to @delay_max. A small random
+ * jitter is applied to each delay.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_device_retry_backoff (FuDevice *self,
+			 FuDeviceRetryFunc func,
+			 guint count,
+			 guint delay,
+			 guint delay_max,
+			 gpointer user_data,
+			 GError **error)
+{
 	g_return_val_if_fail (FU_IS_DEVICE (self), FALSE);
 	g_return_val_if_fail (func != NULL, FALSE);
 	g_return_val_if_fail (count >= 1, FALSE);
+	g_return_val_if_fail (delay_max >= delay, FALSE);
 	g_return_val_if_fail (error != NULL, FALSE);
+	return fu_device_retry_internal (self, func, count, delay, delay_max, user_data, error);
+}
 
-	for (guint i = 0; ; i++) {
-		g_autoptr(GError) error_local =	NULL;
+typedef struct {
+	FuDeviceRetryFunc	 func;
+	guint			 count;
+	guint			 delay;
+	guint			 delay_max;
+	gpointer		 user_data;
+	guint			 i;
+	GSource			*source;
+	gulong			 cancellable_id;
+	gboolean		 done;
+} FuDeviceRetryAsyncHelper;
 
-		/* delay */
-		if (i > 0 && delay > 0)
-			g_usleep (delay * 1000);
+static void
+fu_device_retry_async_helper_free (FuDeviceRetryAsyncHelper *helper)
+{
+	if (helper->source != NULL) {
+		g_source_destroy (helper->source);
+		g_source_unref (helper->source);
+	}
+	g_free (helper);
+}
 
-		/* run function, if success return success */
-		if (func (self, user_data, &error_local))
-			break;
+/* consumes the reference held while the retry is running */
+static void
+fu_device_retry_async_return (GTask *task, GError *error)
+{
+	FuDeviceRetryAsyncHelper *helper = g_task_get_task_data (task);
 
-		/* sanity check */
-		if (error_local == NULL) {
-			g_set_error (error,
-				     G_IO_ERROR,
-				     G_IO_ERROR_FAILED,
-				     "exec failed but no error set!");
-			return FALSE;
-		}
+	helper->done = TRUE;
+	if (helper->source != NULL) {
+		g_source_destroy (helper->source);
+		g_clear_pointer (&helper->source, g_source_unref);
+	}
+	if (helper->cancellable_id != 0) {
+		g_cancellable_disconnect (g_task_get_cancellable (task),
+					  helper->cancellable_id);
+		helper->cancellable_id = 0;
+	}
+	if (error != NULL)
+		g_task_return_error (task, error);
+	else
+		g_task_return_boolean (task, TRUE);
+	g_object_unref (task);
+}
 
-		/* too many retries */
-		if (i >= count - 1) {
-			g_propagate_prefixed_error (error,
-						    g_steal_pointer (&error_local),
-						    "failed after %u retries: ",
-						    count);
-			return FALSE;
-		}
+static void fu_device_retry_async_schedule (GTask *task);
 
-		/* show recoverable error on the console */
-		if (priv->retry_recs->len == 0) {
-			g_debug ("failed on try %u of %u: %s",
-				 i + 1, count, error_local->message);
-			continue;
-		}
+static gboolean
+fu_device_retry_async_cb (gpointer user_data)
+{
+	GTask *task = G_TASK (user_data);
+	FuDevice *self = FU_DEVICE (g_task_get_source_object (task));
+	FuDeviceRetryAsyncHelper *helper = g_task_get_task_data (task);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GError) error_local = NULL;
 
-		/* find the condition that matches */
-		for (guint j = 0; j < priv->retry_recs->len; j++) {
-			FuDeviceRetryRecovery *rec = g_ptr_array_index (priv->retry_recs, j);
-			if (g_error_matches (error_local, rec->domain, rec->code)) {
-				if (rec->recovery_func != NULL) {
-					if (!rec->recovery_func (self, user_data, error))
-						return FALSE;
-				} else {
-					g_set_error (error,
-						     G_IO_ERROR,
-						     G_IO_ERROR_FAILED,
-						     "device recovery not possible");
-					return FALSE;
-				}
-			}
-		}
+	/* the task owns the source */
+	g_clear_pointer (&helper->source, g_source_unref);
+
+	if (g_cancellable_set_error_if_cancelled (g_task_get_cancellable (task), &error)) {
+		fu_device_retry_async_return (task, g_steal_pointer (&error));
+		return G_SOURCE_REMOVE;
+	}
+	if (helper->func (self, helper->user_data, &error_local)) {
+		fu_device_retry_async_return (task, NULL);
+		return G_SOURCE_REMOVE;
+	}
+	if (!fu_device_retry_check (self, helper->i, helper->count,
+				    helper->user_data, error_local, &error)) {
+		fu_device_retry_async_return (task, g_steal_pointer (&error));
+		return G_SOURCE_REMOVE;
 	}
 
-	/* success */
-	return TRUE;
+	/* try again */
+	helper->i++;
+	fu_device_retry_async_schedule (task);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+fu_device_retry_async_schedule (GTask *task)
+{
+	FuDeviceRetryAsyncHelper *helper = g_task_get_task_data (task);
+	guint delay_tmp = fu_device_retry_get_delay (helper->delay,
+						     helper->delay_max,
+						     helper->i);
+	helper->source = g_timeout_source_new (delay_tmp);
+	g_task_attach_source (task, helper->source, fu_device_retry_async_cb);
+}
+
+static gboolean
+fu_device_retry_async_cancelled_idle_cb (gpointer user_data)
+{
+	GTask *task = G_TASK (user_data);
+	FuDeviceRetryAsyncHelper *helper = g_task_get_task_data (task);
+	GError *error = NULL;
+
+	/* already finished before the idle was dispatched */
+	if (helper->done)
+		return G_SOURCE_REMOVE;
+	g_cancellable_set_error_if_cancelled (g_task_get_cancellable (task), &error);
+	fu_device_retry_async_return (task, error);
+	return G_SOURCE_REMOVE;
+}
+
+/* this may be called from any thread, so return on the task context */
+static void
+fu_device_retry_async_cancelled_cb (GCancellable *cancellable, GTask *task)
+{
+	g_main_context_invoke_full (g_task_get_context (task),
+				    G_PRIORITY_DEFAULT,
+				    fu_device_retry_async_cancelled_idle_cb,
+				    g_object_ref (task),
+				    (GDestroyNotify) g_object_unref);
+}
+
+/**
+ * fu_device_retry_async:
+ * @self: A #FuDevice
+ * @func: (scope async): A function to execute
+ * @count: The number of tries to try the function
+ * @delay: The delay before the first retry in ms
+ * @delay_max: The maximum delay between each try in ms, or 0 for a fixed @delay
+ * @user_data: (nullable): a helper to pass to @user_data
+ * @cancellable: (nullable): A #GCancellable
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Calls a specific function a number of times like fu_device_retry_backoff(),
+ * but from the thread-default main context so that no other sources are
+ * blocked while waiting for the device.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_device_retry_async (FuDevice *self,
+		       FuDeviceRetryFunc func,
+		       guint count,
+		       guint delay,
+		       guint delay_max,
+		       gpointer user_data,
+		       GCancellable *cancellable,
+		       GAsyncReadyCallback callback,
+		       gpointer callback_data)
+{
+	FuDeviceRetryAsyncHelper *helper;
+	GTask *task;
+
+	g_return_if_fail (FU_IS_DEVICE (self));
+	g_return_if_fail (func != NULL);
+	g_return_if_fail (count >= 1);
+	g_return_if_fail (delay_max == 0 || delay_max >= delay);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	/* the reference is dropped by fu_device_retry_async_return() */
+	task = g_task_new (self, cancellable, callback, callback_data);
+	helper = g_new0 (FuDeviceRetryAsyncHelper, 1);
+	helper->func = func;
+	helper->count = count;
+	helper->delay = delay;
+	helper->delay_max = delay_max;
+	helper->user_data = user_data;
+	g_task_set_task_data (task, helper, (GDestroyNotify) fu_device_retry_async_helper_free);
+	fu_device_retry_async_schedule (task);
+
+	/* stop waiting as soon as cancelled */
+	if (cancellable != NULL) {
+		helper->cancellable_id =
+			g_cancellable_connect (cancellable,
+					       G_CALLBACK (fu_device_retry_async_cancelled_cb),
+					       task, NULL);
+	}
+}
+
+/**
+ * fu_device_retry_finish:
+ * @self: A #FuDevice
+ * @res: the #GAsyncResult
+ * @error: A #GError
+ *
+ * Gets the result of fu_device_retry_async().
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_device_retry_finish (FuDevice *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail (FU_IS_DEVICE (self), FALSE);
+	g_return_val_if_fail (g_task_is_valid (res, self), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	return g_task_propagate_boolean (G_TASK (res), error);
 }
 
 /**
@@ -476,6 +771,194 @@ fu_device_retry (FuDevice *self,
 				     user_data, error);
 }
 
+/**
+ * fu_device_add_io_transfer:
+ * @self: A #FuDevice
+ * @bytes_read: number of bytes read from the device
+ * @bytes_written: number of bytes written to the device
+ * @duration: time taken for the transfer in us
+ *
+ * Records a low-level transfer with the hardware, which is used to build
+ * statistics about the device that are saved in the history database.
+ *
+ * This is called automatically by helpers such as fu_udev_device_pwrite_full(),
+ * fu_usb_device_bulk_transfer() and fu_hid_device_set_report().
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_device_add_io_transfer (FuDevice *self,
+			   gsize bytes_read,
+			   gsize bytes_written,
+			   gint64 duration)
+{
+	FuDevicePrivate *priv = GET_PRIVATE (self);
+	g_return_if_fail (FU_IS_DEVICE (self));
+	priv->io_stats.bytes_read += bytes_read;
+	priv->io_stats.bytes_written += bytes_written;
+	priv->io_stats.transfers++;
+	for (guint i = 0; i < FU_DEVICE_IO_LATENCY_BUCKETS; i++) {
+		if (duration < fu_device_io_latency_bounds[i]) {
+			priv->io_stats.latency[i]++;
+			break;
+		}
+	}
+}
+
+/**
+ * fu_device_add_phase_duration:
+ * @self: A #FuDevice
+ * @phase: a phase name, e.g. `Detach`
+ * @duration: time taken in ms
+ *
+ * Records how long a phase of the update took, adding to any existing value.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_device_add_phase_duration (FuDevice *self, const gchar *phase, guint64 duration)
+{
+	FuDevicePrivate *priv = GET_PRIVATE (self);
+	guint64 *value;
+
+	g_return_if_fail (FU_IS_DEVICE (self));
+	g_return_if_fail (phase != NULL);
+
+	if (priv->phase_durations == NULL) {
+		priv->phase_durations = g_hash_table_new_full (g_str_hash, g_str_equal,
+							       g_free, g_free);
+	}
+	value = g_hash_table_lookup (priv->phase_durations, phase);
+	if (value == NULL) {
+		value = g_new0 (guint64, 1);
+		g_hash_table_insert (priv->phase_durations, g_strdup (phase), value);
+	}
+	*value += duration;
+}
+
+/**
+ * fu_device_reset_io_stats:
+ * @self: A #FuDevice
+ *
+ * Clears all the transfer statistics and phase durations.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_device_reset_io_stats (FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE (self);
+	g_return_if_fail (FU_IS_DEVICE (self));
+	memset (&priv->io_stats, 0x0, sizeof(priv->io_stats));
+	if (priv->phase_durations != NULL)
+		g_hash_table_remove_all (priv->phase_durations);
+}
+
+/**
+ * fu_device_incorporate_io_stats:
+ * @self: A #FuDevice
+ * @donor: Another #FuDevice
+ *
+ * Moves the transfer statistics and phase durations from the donor device,
+ * typically when the device has been replugged into a different mode.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_device_incorporate_io_stats (FuDevice *self, FuDevice *donor)
+{
+	FuDevicePrivate *priv = GET_PRIVATE (self);
+	FuDevicePrivate *priv_donor = GET_PRIVATE (donor);
+
+	g_return_if_fail (FU_IS_DEVICE (self));
+	g_return_if_fail (FU_IS_DEVICE (donor));
+
+	if (self == donor)
+		return;
+	priv->io_stats.bytes_read += priv_donor->io_stats.bytes_read;
+	priv->io_stats.bytes_written += priv_donor->io_stats.bytes_written;
+	priv->io_stats.transfers += priv_donor->io_stats.transfers;
+	priv->io_stats.retries += priv_donor->io_stats.retries;
+	priv->io_stats.recoveries += priv_donor->io_stats.recoveries;
+	for (guint i = 0; i < FU_DEVICE_IO_LATENCY_BUCKETS; i++)
+		priv->io_stats.latency[i] += priv_donor->io_stats.latency[i];
+	if (priv_donor->phase_durations != NULL) {
+		GHashTableIter iter;
+		gpointer key, value;
+		g_hash_table_iter_init (&iter, priv_donor->phase_durations);
+		while (g_hash_table_iter_next (&iter, &key, &value))
+			fu_device_add_phase_duration (self, key, *((guint64 *) value));
+	}
+	fu_device_reset_io_stats (donor);
+}
+
+/**
+ * fu_device_report_io_stats:
+ * @self: A #FuDevice
+ *
+ * Exports the transfer statistics and phase durations as metadata suitable
+ * for the history database.
+ *
+ * The `IoLatencyHistogram` value is a comma separated list of the number of
+ * transfers that took less than 100us, 1ms, 10ms, 100ms, 1s and longer.
+ *
+ * Returns: (transfer full): A #GHashTable, which may be empty
+ *
+ * Since: 1.5.8
+ **/
+GHashTable *
+fu_device_report_io_stats (FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE (self);
+	GHashTable *metadata;
+
+	g_return_val_if_fail (FU_IS_DEVICE (self), NULL);
+
+	metadata = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	if (priv->io_stats.transfers > 0) {
+		GString *str = g_string_new (NULL);
+		g_hash_table_insert (metadata, g_strdup ("IoBytesRead"),
+				     g_strdup_printf ("%" G_GUINT64_FORMAT,
+						      priv->io_stats.bytes_read));
+		g_hash_table_insert (metadata, g_strdup ("IoBytesWritten"),
+				     g_strdup_printf ("%" G_GUINT64_FORMAT,
+						      priv->io_stats.bytes_written));
+		g_hash_table_insert (metadata, g_strdup ("IoTransfers"),
+				     g_strdup_printf ("%" G_GUINT64_FORMAT,
+						      priv->io_stats.transfers));
+		for (guint i = 0; i < FU_DEVICE_IO_LATENCY_BUCKETS; i++) {
+			if (str->len > 0)
+				g_string_append (str, ",");
+			g_string_append_printf (str, "%" G_GUINT64_FORMAT,
+						priv->io_stats.latency[i]);
+		}
+		g_hash_table_insert (metadata, g_strdup ("IoLatencyHistogram"),
+				     g_string_free (str, FALSE));
+	}
+	if (priv->io_stats.retries > 0) {
+		g_hash_table_insert (metadata, g_strdup ("IoRetries"),
+				     g_strdup_printf ("%" G_GUINT64_FORMAT,
+						      priv->io_stats.retries));
+	}
+	if (priv->io_stats.recoveries > 0) {
+		g_hash_table_insert (metadata, g_strdup ("IoRecoveries"),
+				     g_strdup_printf ("%" G_GUINT64_FORMAT,
+						      priv->io_stats.recoveries));
+	}
+	if (priv->phase_durations != NULL) {
+		GHashTableIter iter;
+		gpointer key, value;
+		g_hash_table_iter_init (&iter, priv->phase_durations);
+		while (g_hash_table_iter_next (&iter, &key, &value)) {
+			g_hash_table_insert (metadata,
+					     g_strdup_printf ("Duration%s", (const gchar *) key),
+					     g_strdup_printf ("%" G_GUINT64_FORMAT,
+							      *((guint64 *) value)));
+		}
+	}
+	return metadata;
+}
+
 /**
  * fu_device_poll:
  * @self: A #FuDevice
@@ -2441,6 +2924,54 @@ fu_device_set_progress_full (FuDevice *self, gsize progress_done, gsize progress
 	fu_device_set_progress (self, (guint) percentage);
 }
 
+static gboolean
+fu_device_sleep_cb (gpointer user_data)
+{
+	GMainLoop *loop = (GMainLoop *) user_data;
+	g_main_loop_quit (loop);
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * fu_device_sleep_iterate:
+ * @self: A #FuDevice
+ * @delay_ms: the delay in milliseconds
+ *
+ * Waits for the device, iterating the main context so that other sources such
+ * as D-Bus requests and udev events are still processed. This must only be
+ * used by callers that can cope with being re-entered while waiting.
+ *
+ * The main context is only iterated if the calling thread already owns it,
+ * for instance when called from a callback dispatched by that context;
+ * otherwise this blocks the calling thread like g_usleep().
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_device_sleep_iterate (FuDevice *self, guint delay_ms)
+{
+	GMainContext *context = g_main_context_get_thread_default ();
+	g_autoptr(GMainLoop) loop = NULL;
+	g_autoptr(GSource) source = NULL;
+
+	g_return_if_fail (FU_IS_DEVICE (self));
+
+	if (delay_ms == 0)
+		return;
+	if (context == NULL)
+		context = g_main_context_default ();
+	if (!g_main_context_is_owner (context)) {
+		g_usleep (delay_ms * 1000);
+		return;
+	}
+	loop = g_main_loop_new (context, FALSE);
+	source = g_timeout_source_new (delay_ms);
+	g_source_set_callback (source, fu_device_sleep_cb, loop, NULL);
+	g_source_attach (source, context);
+	g_main_loop_run (loop);
+	g_source_destroy (source);
+}
+
 /**
  * fu_device_sleep_with_progress:
  * @self: A #FuDevice
@@ -2450,19 +2981,22 @@ fu_device_set_progress_full (FuDevice *self, gsize progress_done, gsize progress
  * The value is gven in whole seconds as it does not make sense to show the
  * progressbar advancing so quickly for durations of less than one second.
  *
+ * This uses fu_device_sleep_iterate(), so other sources may be dispatched
+ * while waiting.
+ *
  * Since: 1.5.0
  **/
 void
 fu_device_sleep_with_progress (FuDevice *self, guint delay_secs)
 {
-	gulong delay_us_pc = (delay_secs * G_USEC_PER_SEC) / 100;
+	guint delay_ms_pc = (delay_secs * 1000) / 100;
 
 	g_return_if_fail (FU_IS_DEVICE (self));
 	g_return_if_fail (delay_secs > 0);
 
 	fu_device_set_progress (self, 0);
 	for (guint i = 0; i < 100; i++) {
-		g_usleep (delay_us_pc);
+		fu_device_sleep_iterate (self, delay_ms_pc);
 		fu_device_set_progress (self, i + 1);
 	}
 }
@@ -2532,6 +3066,11 @@ fu_device_add_string (FuDevice *self, guint idt, GString *str)
 			g_string_truncate (tmp2, tmp2->len - 1);
 		fu_common_string_append_kv (str, idt + 1, "PrivateFlags", tmp2->str);
 	}
+	if (priv->io_stats.transfers > 0) {
+		fu_common_string_append_ku (str, idt + 1, "IoTransfers", priv->io_stats.transfers);
+		fu_common_string_append_ku (str, idt + 1, "IoBytesRead", priv->io_stats.bytes_read);
+		fu_common_string_append_ku (str, idt + 1, "IoBytesWritten", priv->io_stats.bytes_written);
+	}
 
 	/* subclassed */
 	if (klass->to_string != NULL)
@@ -3142,6 +3681,7 @@ fu_device_rescan (FuDevice *self, GError **error)
 	/* remove all GUIDs */
 	g_ptr_array_set_size (fu_device_get_instance_ids (self), 0);
 	g_ptr_array_set_size (fu_device_get_guids (self), 0);
+	fwupd_device_invalidate (FWUPD_DEVICE (self));
 
 	/* subclassed */
 	if (klass->rescan != NULL) {
@@ -3603,6 +4143,8 @@ fu_device_finalize (GObject *object)
 		g_source_remove (priv->poll_id);
 	if (priv->metadata != NULL)
 		g_hash_table_unref (priv->metadata);
+	if (priv->phase_durations != NULL)
+		g_hash_table_unref (priv->phase_durations);
 	g_ptr_array_unref (priv->parent_guids);
 	g_ptr_array_unref (priv->possible_plugins);
 	g_ptr_array_unref (priv->retry_recs);
@@ -322,6 +322,15 @@ void		 fu_device_set_progress			(FuDevice	*self,
 void		 fu_device_set_progress_full		(FuDevice	*self,
 							 gsize		 progress_done,
 							 gsize		 progress_total);
+void		 fu_device_sleep_iterate		(FuDevice	*self,
+							 guint		 delay_ms);
+void		 fu_device_add_io_transfer		(FuDevice	*self,
+							 gsize		 bytes_read,
+							 gsize		 bytes_written,
+							 gint64		 duration);
+void		 fu_device_add_phase_duration		(FuDevice	*self,
+							 const gchar	*phase,
+							 guint64	 duration);
 void		 fu_device_sleep_with_progress		(FuDevice	*self,
 							 guint		 delay_secs);
 void		 fu_device_set_quirks			(FuDevice	*self,
@@ -416,6 +425,27 @@ gboolean	 fu_device_retry_full			(FuDevice	*self,
 							 gpointer	 user_data,
 							 GError		**error)
 							 G_GNUC_WARN_UNUSED_RESULT;
+gboolean	 fu_device_retry_backoff		(FuDevice	*self,
+							 FuDeviceRetryFunc func,
+							 guint		 count,
+							 guint		 delay,
+							 guint		 delay_max,
+							 gpointer	 user_data,
+							 GError		**error)
+							 G_GNUC_WARN_UNUSED_RESULT;
+void		 fu_device_retry_async			(FuDevice	*self,
+							 FuDeviceRetryFunc func,
+							 guint		 count,
+							 guint		 delay,
+							 guint		 delay_max,
+							 gpointer	 user_data,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+gboolean	 fu_device_retry_finish			(FuDevice	*self,
+							 GAsyncResult	*res,
+							 GError		**error)
+							 G_GNUC_WARN_UNUSED_RESULT;
 gboolean	 fu_device_bind_driver			(FuDevice	*self,
 							 const gchar	*subsystem,
 							 const gchar	*driver,
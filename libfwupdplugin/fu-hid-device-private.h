@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#pragma once
+
+#include "fu-hid-device.h"
+
+typedef struct _FuHidDevicePipeline FuHidDevicePipeline;
+
+typedef void	(*FuHidDevicePipelineWriteFunc)		(FuHidDevicePipeline *pipeline,
+							 GByteArray	*report,
+							 GCancellable	*cancellable,
+							 gpointer	 user_data);
+typedef void	(*FuHidDevicePipelineReadFunc)		(FuHidDevicePipeline *pipeline,
+							 guint8		*buf,
+							 gsize		 bufsz,
+							 GCancellable	*cancellable,
+							 gpointer	 user_data);
+
+gboolean	 fu_hid_device_run_pipeline		(FuHidDevice	*self,
+							 GPtrArray	*reports,
+							 FuHidDeviceAckFunc ack_func,
+							 gpointer	 ack_user_data,
+							 gsize		 ack_bufsz,
+							 FuHidDevicePipelineWriteFunc write_func,
+							 FuHidDevicePipelineReadFunc read_func,
+							 gpointer	 user_data,
+							 GError		**error)
+							 G_GNUC_WARN_UNUSED_RESULT;
+void		 fu_hid_device_pipeline_write_done	(FuHidDevicePipeline *pipeline,
+							 gssize		 actual_len,
+							 GError		*error);
+void		 fu_hid_device_pipeline_read_done	(FuHidDevicePipeline *pipeline,
+							 gssize		 actual_len,
+							 GError		*error);
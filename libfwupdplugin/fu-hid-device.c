@@ -8,7 +8,7 @@
 
 #include "config.h"
 
-#include "fu-hid-device.h"
+#include "fu-hid-device-private.h"
 
 #define FU_HID_REPORT_GET				0x01
 #define FU_HID_REPORT_SET				0x09
@@ -18,6 +18,7 @@
 #define FU_HID_REPORT_TYPE_FEATURE			0x03
 
 #define FU_HID_DEVICE_RETRIES				10
+#define FU_HID_DEVICE_PIPELINE_WINDOW			8
 
 /**
  * SECTION:fu-hid-device
@@ -34,6 +35,10 @@ typedef struct
 	guint8			 interface;
 	gboolean		 interface_autodetect;
 	FuHidDeviceFlags	 flags;
+	guint8			 ep_in;		/* interrupt, or 0x0 */
+	guint8			 ep_out;	/* interrupt, or 0x0 */
+	gsize			 ep_in_sz;
+	guint			 pipeline_window;
 } FuHidDevicePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (FuHidDevice, fu_hid_device, FU_TYPE_USB_DEVICE)
@@ -77,6 +82,46 @@ fu_hid_device_set_property (GObject *object, guint prop_id,
 	}
 }
 
+#ifdef HAVE_GUSB
+static void
+fu_hid_device_ensure_endpoints (FuHidDevice *self)
+{
+	FuHidDevicePrivate *priv = GET_PRIVATE (self);
+	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
+	g_autoptr(GPtrArray) ifaces = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	priv->ep_in = 0x0;
+	priv->ep_out = 0x0;
+	priv->ep_in_sz = 0;
+	ifaces = g_usb_device_get_interfaces (usb_device, &error_local);
+	if (ifaces == NULL) {
+		g_debug ("failed to get interfaces: %s", error_local->message);
+		return;
+	}
+	for (guint i = 0; i < ifaces->len; i++) {
+		GUsbInterface *iface = g_ptr_array_index (ifaces, i);
+		g_autoptr(GPtrArray) endpoints = NULL;
+		if (g_usb_interface_get_number (iface) != priv->interface)
+			continue;
+		endpoints = g_usb_interface_get_endpoints (iface);
+		if (endpoints == NULL)
+			continue;
+		for (guint j = 0; j < endpoints->len; j++) {
+			GUsbEndpoint *ep = g_ptr_array_index (endpoints, j);
+			if ((g_usb_endpoint_get_attributes (ep) & 0x03) != 0x03)
+				continue;
+			if (g_usb_endpoint_get_direction (ep) == G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE) {
+				priv->ep_out = g_usb_endpoint_get_address (ep);
+			} else {
+				priv->ep_in = g_usb_endpoint_get_address (ep);
+				priv->ep_in_sz = g_usb_endpoint_get_maximum_packet_size (ep);
+			}
+		}
+	}
+}
+#endif
+
 static gboolean
 fu_hid_device_open (FuUsbDevice *device, GError **error)
 {
@@ -118,6 +163,9 @@ fu_hid_device_open (FuUsbDevice *device, GError **error)
 		g_prefix_error (error, "failed to claim HID interface: ");
 		return FALSE;
 	}
+
+	/* optional interrupt endpoints used for pipelined transfers */
+	fu_hid_device_ensure_endpoints (self);
 #endif
 
 	/* subclassed */
@@ -213,6 +261,25 @@ fu_hid_device_get_interface (FuHidDevice *self)
 	return priv->interface;
 }
 
+/**
+ * fu_hid_device_set_pipeline_window:
+ * @self: A #FuHidDevice
+ * @window: number of reports, e.g. 8
+ *
+ * Sets the maximum number of output reports that can be sent but not yet
+ * acknowledged when using fu_hid_device_set_reports().
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_hid_device_set_pipeline_window (FuHidDevice *self, guint window)
+{
+	FuHidDevicePrivate *priv = GET_PRIVATE (self);
+	g_return_if_fail (FU_HID_DEVICE (self));
+	g_return_if_fail (window > 0);
+	priv->pipeline_window = window;
+}
+
 /**
  * fu_hid_device_add_flag:
  * @self: A #FuHidDevice
@@ -246,6 +313,8 @@ fu_hid_device_set_report_internal (FuHidDevice *self,
 #ifdef HAVE_GUSB
 	FuHidDevicePrivate *priv = GET_PRIVATE (self);
 	GUsbDevice *usb_device;
+	gboolean ret;
+	gint64 start;
 	gsize actual_len = 0;
 	guint16 wvalue = (FU_HID_REPORT_TYPE_OUTPUT << 8) | helper->value;
 
@@ -261,16 +330,20 @@ fu_hid_device_set_report_internal (FuHidDevice *self,
 				    helper->buf, helper->bufsz);
 	}
 	usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_INTERFACE,
-					    FU_HID_REPORT_SET,
-					    wvalue, priv->interface,
-					    helper->buf, helper->bufsz,
-					    &actual_len,
-					    helper->timeout,
-					    NULL, error)) {
+	start = g_get_monotonic_time ();
+	ret = g_usb_device_control_transfer (usb_device,
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     FU_HID_REPORT_SET,
+					     wvalue, priv->interface,
+					     helper->buf, helper->bufsz,
+					     &actual_len,
+					     helper->timeout,
+					     NULL, error);
+	fu_device_add_io_transfer (FU_DEVICE (self), 0, actual_len,
+				   g_get_monotonic_time () - start);
+	if (!ret) {
 		g_prefix_error (error, "failed to SetReport: ");
 		return FALSE;
 	}
@@ -345,6 +418,469 @@ fu_hid_device_set_report (FuHidDevice *self,
 	return fu_hid_device_set_report_internal (self, &helper, error);
 }
 
+struct _FuHidDevicePipeline {
+	FuHidDevice		*self;
+	GMainContext		*context;
+	GMainLoop		*loop;
+	GCancellable		*cancellable;
+	GPtrArray		*reports;	/* element-type GByteArray */
+	guint16			 wvalue;
+	guint			 timeout;
+	FuHidDeviceFlags	 flags;
+	FuHidDeviceAckFunc	 ack_func;
+	gpointer		 ack_user_data;
+	FuHidDevicePipelineWriteFunc write_func;
+	FuHidDevicePipelineReadFunc read_func;
+	gpointer		 user_data;
+	guint			 idx_submit;	/* next report to send */
+	guint			 idx_ack;	/* reports acknowledged */
+	guint			 idx_written;	/* writes completed */
+	gint64			*write_start;	/* submit time of each report */
+	gint64			 read_start;
+	guint			 pending;	/* transfers in flight */
+	gboolean		 reading;
+	guint8			*ack_buf;
+	gsize			 ack_bufsz;
+	GError			*error;
+};
+
+static void
+fu_hid_device_pipeline_free (FuHidDevicePipeline *pipeline)
+{
+	g_main_context_pop_thread_default (pipeline->context);
+	g_main_loop_unref (pipeline->loop);
+	g_main_context_unref (pipeline->context);
+	g_object_unref (pipeline->cancellable);
+	if (pipeline->error != NULL)
+		g_error_free (pipeline->error);
+	g_free (pipeline->ack_buf);
+	g_free (pipeline->write_start);
+	g_free (pipeline);
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuHidDevicePipeline, fu_hid_device_pipeline_free)
+#pragma clang diagnostic pop
+
+/* the transfers are run in a private context so nothing else is dispatched */
+static FuHidDevicePipeline *
+fu_hid_device_pipeline_new (FuHidDevice *self,
+			    GPtrArray *reports,
+			    FuHidDeviceAckFunc ack_func,
+			    gpointer ack_user_data,
+			    gsize ack_bufsz,
+			    FuHidDevicePipelineWriteFunc write_func,
+			    FuHidDevicePipelineReadFunc read_func,
+			    gpointer user_data)
+{
+	FuHidDevicePipeline *pipeline = g_new0 (FuHidDevicePipeline, 1);
+	pipeline->self = self;
+	pipeline->context = g_main_context_new ();
+	pipeline->loop = g_main_loop_new (pipeline->context, FALSE);
+	pipeline->cancellable = g_cancellable_new ();
+	pipeline->reports = reports;
+	pipeline->write_start = g_new0 (gint64, MAX (reports->len, 1));
+	pipeline->ack_func = ack_func;
+	pipeline->ack_user_data = ack_user_data;
+	pipeline->ack_bufsz = ack_bufsz;
+	pipeline->ack_buf = g_malloc0 (MAX (ack_bufsz, 1));
+	pipeline->write_func = write_func;
+	pipeline->read_func = read_func;
+	pipeline->user_data = user_data;
+	g_main_context_push_thread_default (pipeline->context);
+	return pipeline;
+}
+
+/* the first error wins, and everything still in flight is cancelled */
+static void
+fu_hid_device_pipeline_set_error (FuHidDevicePipeline *pipeline, GError *error)
+{
+	if (pipeline->error != NULL) {
+		g_error_free (error);
+		return;
+	}
+	pipeline->error = error;
+	g_cancellable_cancel (pipeline->cancellable);
+}
+
+static void
+fu_hid_device_pipeline_pump (FuHidDevicePipeline *pipeline)
+{
+	FuHidDevicePrivate *priv = GET_PRIVATE (pipeline->self);
+
+	/* fill the window */
+	while (pipeline->error == NULL &&
+	       pipeline->idx_submit < pipeline->reports->len &&
+	       pipeline->idx_submit - pipeline->idx_ack < priv->pipeline_window) {
+		GByteArray *report = g_ptr_array_index (pipeline->reports,
+							pipeline->idx_submit);
+		pipeline->write_start[pipeline->idx_submit++] = g_get_monotonic_time ();
+		pipeline->pending++;
+		pipeline->write_func (pipeline, report,
+				      pipeline->cancellable,
+				      pipeline->user_data);
+	}
+
+	/* wait for the next acknowledgement */
+	if (pipeline->error == NULL && pipeline->ack_func != NULL &&
+	    !pipeline->reading && pipeline->idx_ack < pipeline->idx_submit) {
+		pipeline->reading = TRUE;
+		pipeline->read_start = g_get_monotonic_time ();
+		pipeline->pending++;
+		pipeline->read_func (pipeline,
+				     pipeline->ack_buf,
+				     pipeline->ack_bufsz,
+				     pipeline->cancellable,
+				     pipeline->user_data);
+	}
+
+	/* all done, or all cancelled */
+	if (pipeline->pending == 0)
+		g_main_loop_quit (pipeline->loop);
+}
+
+/**
+ * fu_hid_device_pipeline_write_done:
+ * @pipeline: A #FuHidDevicePipeline
+ * @actual_len: number of bytes written, or -1 on error
+ * @error: (transfer full) (nullable): a #GError
+ *
+ * Completes a write started by a #FuHidDevicePipelineWriteFunc.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_hid_device_pipeline_write_done (FuHidDevicePipeline *pipeline,
+				   gssize actual_len,
+				   GError *error)
+{
+	/* writes on the same endpoint complete in the order they were sent */
+	gint64 start = pipeline->write_start[pipeline->idx_written++];
+
+	pipeline->pending--;
+	if (error != NULL) {
+		g_prefix_error (&error, "failed to SetReport: ");
+		fu_hid_device_pipeline_set_error (pipeline, error);
+	} else {
+		fu_device_add_io_transfer (FU_DEVICE (pipeline->self), 0, actual_len,
+					   g_get_monotonic_time () - start);
+		if (pipeline->ack_func == NULL)
+			pipeline->idx_ack++;
+	}
+	fu_hid_device_pipeline_pump (pipeline);
+}
+
+/**
+ * fu_hid_device_pipeline_read_done:
+ * @pipeline: A #FuHidDevicePipeline
+ * @actual_len: number of bytes read, or -1 on error
+ * @error: (transfer full) (nullable): a #GError
+ *
+ * Completes a read started by a #FuHidDevicePipelineReadFunc.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_hid_device_pipeline_read_done (FuHidDevicePipeline *pipeline,
+				  gssize actual_len,
+				  GError *error)
+{
+	pipeline->pending--;
+	pipeline->reading = FALSE;
+	if (error != NULL) {
+		g_prefix_error (&error, "failed to get acknowledgement: ");
+		fu_hid_device_pipeline_set_error (pipeline, error);
+	} else if (pipeline->error == NULL) {
+		fu_device_add_io_transfer (FU_DEVICE (pipeline->self), actual_len, 0,
+					   g_get_monotonic_time () - pipeline->read_start);
+		if (!pipeline->ack_func (pipeline->self, pipeline->ack_buf, actual_len,
+					 pipeline->ack_user_data, &error)) {
+			g_prefix_error (&error, "report 0x%x not acknowledged: ",
+					pipeline->idx_ack);
+			fu_hid_device_pipeline_set_error (pipeline, error);
+		} else {
+			pipeline->idx_ack++;
+		}
+	}
+	fu_hid_device_pipeline_pump (pipeline);
+}
+
+static gboolean
+fu_hid_device_pipeline_run (FuHidDevicePipeline *pipeline, guint *n_acked, GError **error)
+{
+	FuHidDevicePrivate *priv = GET_PRIVATE (pipeline->self);
+	gint64 start = g_get_monotonic_time ();
+
+	fu_hid_device_pipeline_pump (pipeline);
+	if (pipeline->pending > 0)
+		g_main_loop_run (pipeline->loop);
+	g_debug ("sent %u reports with window %u in %.1fms",
+		 pipeline->idx_ack, priv->pipeline_window,
+		 (g_get_monotonic_time () - start) / 1000.f);
+	if (n_acked != NULL)
+		*n_acked = pipeline->idx_ack;
+	if (pipeline->error != NULL) {
+		g_propagate_error (error, g_steal_pointer (&pipeline->error));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * fu_hid_device_run_pipeline:
+ * @self: A #FuHidDevice
+ * @reports: (element-type GByteArray): output reports to send in order
+ * @ack_func: (scope call) (nullable): function to check each acknowledgement
+ * @ack_user_data: user data for @ack_func
+ * @ack_bufsz: maximum size of each acknowledgement
+ * @write_func: (scope call): function to start writing a report
+ * @read_func: (scope call): function to start reading an acknowledgement
+ * @user_data: user data for @write_func and @read_func
+ * @error: a #GError or %NULL
+ *
+ * Sends reports using the same windowing, acknowledgement and cancellation
+ * logic as fu_hid_device_set_reports() but with a custom transport, which
+ * is only useful for the self tests.
+ *
+ * Each @write_func or @read_func must eventually call
+ * fu_hid_device_pipeline_write_done() or fu_hid_device_pipeline_read_done()
+ * from the thread-default main context, even when cancelled.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_hid_device_run_pipeline (FuHidDevice *self,
+			    GPtrArray *reports,
+			    FuHidDeviceAckFunc ack_func,
+			    gpointer ack_user_data,
+			    gsize ack_bufsz,
+			    FuHidDevicePipelineWriteFunc write_func,
+			    FuHidDevicePipelineReadFunc read_func,
+			    gpointer user_data,
+			    GError **error)
+{
+	g_autoptr(FuHidDevicePipeline) pipeline = NULL;
+
+	g_return_val_if_fail (FU_IS_HID_DEVICE (self), FALSE);
+	g_return_val_if_fail (reports != NULL, FALSE);
+	g_return_val_if_fail (write_func != NULL, FALSE);
+	g_return_val_if_fail (ack_func == NULL || read_func != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	pipeline = fu_hid_device_pipeline_new (self, reports,
+					       ack_func, ack_user_data, ack_bufsz,
+					       write_func, read_func, user_data);
+	return fu_hid_device_pipeline_run (pipeline, NULL, error);
+}
+
+#ifdef HAVE_GUSB
+static gboolean
+fu_hid_device_pipeline_use_interrupt (FuHidDevicePipeline *pipeline)
+{
+	FuHidDevicePrivate *priv = GET_PRIVATE (pipeline->self);
+	return priv->ep_out != 0x0 && (pipeline->flags & FU_HID_DEVICE_FLAG_IS_FEATURE) == 0;
+}
+
+static void
+fu_hid_device_pipeline_usb_write_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FuHidDevicePipeline *pipeline = (FuHidDevicePipeline *) user_data;
+	GError *error = NULL;
+	gssize actual_len;
+
+	if (fu_hid_device_pipeline_use_interrupt (pipeline)) {
+		actual_len = g_usb_device_interrupt_transfer_finish (G_USB_DEVICE (source),
+								      res, &error);
+	} else {
+		actual_len = g_usb_device_control_transfer_finish (G_USB_DEVICE (source),
+								    res, &error);
+	}
+	fu_hid_device_pipeline_write_done (pipeline, actual_len, error);
+}
+
+static void
+fu_hid_device_pipeline_usb_write (FuHidDevicePipeline *pipeline,
+				  GByteArray *report,
+				  GCancellable *cancellable,
+				  gpointer user_data)
+{
+	FuHidDevicePrivate *priv = GET_PRIVATE (pipeline->self);
+	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (pipeline->self));
+
+	if (fu_hid_device_pipeline_use_interrupt (pipeline)) {
+		g_usb_device_interrupt_transfer_async (usb_device,
+						       priv->ep_out,
+						       report->data,
+						       report->len,
+						       pipeline->timeout,
+						       cancellable,
+						       fu_hid_device_pipeline_usb_write_cb,
+						       pipeline);
+		return;
+	}
+	g_usb_device_control_transfer_async (usb_device,
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     FU_HID_REPORT_SET,
+					     pipeline->wvalue, priv->interface,
+					     report->data, report->len,
+					     pipeline->timeout,
+					     cancellable,
+					     fu_hid_device_pipeline_usb_write_cb,
+					     pipeline);
+}
+
+static void
+fu_hid_device_pipeline_usb_read_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FuHidDevicePipeline *pipeline = (FuHidDevicePipeline *) user_data;
+	GError *error = NULL;
+	gssize actual_len;
+
+	actual_len = g_usb_device_interrupt_transfer_finish (G_USB_DEVICE (source),
+							      res, &error);
+	fu_hid_device_pipeline_read_done (pipeline, actual_len, error);
+}
+
+static void
+fu_hid_device_pipeline_usb_read (FuHidDevicePipeline *pipeline,
+				 guint8 *buf,
+				 gsize bufsz,
+				 GCancellable *cancellable,
+				 gpointer user_data)
+{
+	FuHidDevicePrivate *priv = GET_PRIVATE (pipeline->self);
+	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (pipeline->self));
+	g_usb_device_interrupt_transfer_async (usb_device,
+					       priv->ep_in,
+					       buf, bufsz,
+					       pipeline->timeout,
+					       cancellable,
+					       fu_hid_device_pipeline_usb_read_cb,
+					       pipeline);
+}
+#endif
+
+/**
+ * fu_hid_device_set_reports:
+ * @self: A #FuHidDevice
+ * @value: low byte of wValue
+ * @reports: (element-type GByteArray): output reports to send in order
+ * @timeout: timeout in ms for each report
+ * @flags: #FuHidDeviceFlags e.g. %FU_HID_DEVICE_FLAG_IS_FEATURE
+ * @ack_func: (scope call) (nullable): function to check each acknowledgement
+ * @user_data: user data for @ack_func
+ * @n_acked: (out) (optional): location to store the number of reports
+ *  acknowledged, which is also set on error
+ * @error: a #GError or %NULL
+ *
+ * Sends multiple reports to the hardware. If @ack_func is set then an input
+ * report is read from the interrupt IN endpoint for each report sent.
+ *
+ * If the device has the `hid-pipeline` custom flag, typically set using the
+ * `Flags` quirk, then up to the pipeline window of reports are sent before
+ * waiting for the first to be acknowledged, using the interrupt OUT endpoint
+ * if the device has one. %FU_HID_DEVICE_FLAG_RETRY_FAILURE is ignored in this
+ * mode. Otherwise each report is sent using fu_hid_device_set_report().
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_hid_device_set_reports (FuHidDevice *self,
+			   guint8 value,
+			   GPtrArray *reports,
+			   guint timeout,
+			   FuHidDeviceFlags flags,
+			   FuHidDeviceAckFunc ack_func,
+			   gpointer user_data,
+			   guint *n_acked,
+			   GError **error)
+{
+#ifdef HAVE_GUSB
+	FuHidDevicePrivate *priv = GET_PRIVATE (self);
+	gint64 start;
+	g_autoptr(FuHidDevicePipeline) pipeline = NULL;
+#endif
+
+	g_return_val_if_fail (FU_HID_DEVICE (self), FALSE);
+	g_return_val_if_fail (reports != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	if (n_acked != NULL)
+		*n_acked = 0;
+
+#ifdef HAVE_GUSB
+	/* acknowledgements are input reports */
+	if (ack_func != NULL && priv->ep_in == 0x0) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_NOT_SUPPORTED,
+				     "no interrupt IN endpoint for acknowledgements");
+		return FALSE;
+	}
+
+	/* one at a time */
+	if (!fu_device_has_custom_flag (FU_DEVICE (self), "hid-pipeline")) {
+		GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
+		g_autofree guint8 *ack_buf = g_malloc0 (MAX (priv->ep_in_sz, 1));
+		for (guint i = 0; i < reports->len; i++) {
+			GByteArray *report = g_ptr_array_index (reports, i);
+			gsize actual_len = 0;
+			if (n_acked != NULL)
+				*n_acked = i;
+			if (!fu_hid_device_set_report (self, value,
+						       report->data, report->len,
+						       timeout, flags, error))
+				return FALSE;
+			if (ack_func == NULL)
+				continue;
+			start = g_get_monotonic_time ();
+			if (!g_usb_device_interrupt_transfer (usb_device, priv->ep_in,
+							      ack_buf, priv->ep_in_sz,
+							      &actual_len, timeout,
+							      NULL, error)) {
+				g_prefix_error (error, "failed to get acknowledgement: ");
+				return FALSE;
+			}
+			fu_device_add_io_transfer (FU_DEVICE (self), actual_len, 0,
+						   g_get_monotonic_time () - start);
+			if (!ack_func (self, ack_buf, actual_len, user_data, error)) {
+				g_prefix_error (error, "report 0x%x not acknowledged: ", i);
+				return FALSE;
+			}
+		}
+		if (n_acked != NULL)
+			*n_acked = reports->len;
+		return TRUE;
+	}
+
+	/* pipelined */
+	pipeline = fu_hid_device_pipeline_new (self, reports,
+					       ack_func, user_data, priv->ep_in_sz,
+					       fu_hid_device_pipeline_usb_write,
+					       fu_hid_device_pipeline_usb_read,
+					       NULL);
+	pipeline->wvalue = (FU_HID_REPORT_TYPE_OUTPUT << 8) | value;
+	if ((priv->flags | flags) & FU_HID_DEVICE_FLAG_IS_FEATURE)
+		pipeline->wvalue = (FU_HID_REPORT_TYPE_FEATURE << 8) | value;
+	pipeline->timeout = timeout;
+	pipeline->flags = priv->flags | flags;
+	return fu_hid_device_pipeline_run (pipeline, n_acked, error);
+#else
+	g_set_error_literal (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_SUPPORTED,
+			     "GUsb support is unavailable");
+	return FALSE;
+#endif
+}
+
 static gboolean
 fu_hid_device_get_report_internal (FuHidDevice *self,
 				   FuHidDeviceRetryHelper *helper,
@@ -353,6 +889,8 @@ fu_hid_device_get_report_internal (FuHidDevice *self,
 #ifdef HAVE_GUSB
 	FuHidDevicePrivate *priv = GET_PRIVATE (self);
 	GUsbDevice *usb_device;
+	gboolean ret;
+	gint64 start;
 	gsize actual_len = 0;
 	guint16 wvalue = (FU_HID_REPORT_TYPE_INPUT << 8) | helper->value;
 
@@ -368,16 +906,20 @@ fu_hid_device_get_report_internal (FuHidDevice *self,
 				    helper->buf, actual_len);
 	}
 	usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_INTERFACE,
-					    FU_HID_REPORT_GET,
-					    wvalue, priv->interface,
-					    helper->buf, helper->bufsz,
-					    &actual_len, /* actual length */
-					    helper->timeout,
-					    NULL, error)) {
+	start = g_get_monotonic_time ();
+	ret = g_usb_device_control_transfer (usb_device,
+					     G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     FU_HID_REPORT_GET,
+					     wvalue, priv->interface,
+					     helper->buf, helper->bufsz,
+					     &actual_len, /* actual length */
+					     helper->timeout,
+					     NULL, error);
+	fu_device_add_io_transfer (FU_DEVICE (self), actual_len, 0,
+				   g_get_monotonic_time () - start);
+	if (!ret) {
 		g_prefix_error (error, "failed to GetReport: ");
 		return FALSE;
 	}
@@ -463,6 +1005,7 @@ fu_hid_device_init (FuHidDevice *self)
 {
 	FuHidDevicePrivate *priv = GET_PRIVATE (self);
 	priv->interface_autodetect = TRUE;
+	priv->pipeline_window = FU_HID_DEVICE_PIPELINE_WINDOW;
 }
 
 /**
@@ -45,12 +45,32 @@ typedef enum {
 	FU_HID_DEVICE_FLAG_LAST
 } FuHidDeviceFlags;
 
+/**
+ * FuHidDeviceAckFunc:
+ * @self: A #FuHidDevice
+ * @buf: the input report
+ * @bufsz: size of @buf
+ * @user_data: user data
+ * @error: a #GError or %NULL
+ *
+ * Checks an input report sent by the device to acknowledge one output report.
+ *
+ * Returns: %TRUE if the report was acknowledged successfully
+ **/
+typedef gboolean (*FuHidDeviceAckFunc)			(FuHidDevice	*self,
+							 const guint8	*buf,
+							 gsize		 bufsz,
+							 gpointer	 user_data,
+							 GError		**error);
+
 FuHidDevice	*fu_hid_device_new			(GUsbDevice	*usb_device);
 void		 fu_hid_device_add_flag			(FuHidDevice	*self,
 							 FuHidDeviceFlags flag);
 void		 fu_hid_device_set_interface		(FuHidDevice	*self,
 							 guint8		 interface);
 guint8		 fu_hid_device_get_interface		(FuHidDevice	*self);
+void		 fu_hid_device_set_pipeline_window	(FuHidDevice	*self,
+							 guint		 window);
 gboolean	 fu_hid_device_set_report		(FuHidDevice	*self,
 							 guint8		 value,
 							 guint8		*buf,
@@ -59,6 +79,16 @@ gboolean	 fu_hid_device_set_report		(FuHidDevice	*self,
 							 FuHidDeviceFlags flags,
 							 GError		**error)
 							 G_GNUC_WARN_UNUSED_RESULT;
+gboolean	 fu_hid_device_set_reports		(FuHidDevice	*self,
+							 guint8		 value,
+							 GPtrArray	*reports,
+							 guint		 timeout,
+							 FuHidDeviceFlags flags,
+							 FuHidDeviceAckFunc ack_func,
+							 gpointer	 user_data,
+							 guint		*n_acked,
+							 GError		**error)
+							 G_GNUC_WARN_UNUSED_RESULT;
 gboolean	 fu_hid_device_get_report		(FuHidDevice	*self,
 							 guint8		 value,
 							 guint8		*buf,
@@ -0,0 +1,15 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#pragma once
+
+#include "fu-hwids.h"
+
+gboolean	 fu_hwids_setup_with_cache	(FuHwids	*self,
+						 FuSmbios	*smbios,
+						 const gchar	*filename,
+						 GError		**error)
+						 G_GNUC_WARN_UNUSED_RESULT;
@@ -13,7 +13,8 @@
 #include <string.h>
 
 #include "fu-common.h"
-#include "fu-hwids.h"
+#include "fu-hwids-private.h"
+#include "fu-smbios-private.h"
 #include "fwupd-common.h"
 #include "fwupd-error.h"
 
@@ -28,6 +29,8 @@ struct _FuHwids {
 
 G_DEFINE_TYPE (FuHwids, fu_hwids, G_TYPE_OBJECT)
 
+#define FU_HWIDS_CACHE_FORMAT		"(sa{ss}a{ss}as)"
+
 /**
  * fu_hwids_get_value:
  * @self: A #FuHwids
@@ -479,6 +482,168 @@ fu_hwids_setup (FuHwids *self, FuSmbios *smbios, GError **error)
 	return TRUE;
 }
 
+/* the GUIDs depend on the tables, on any overrides, and on the algorithm
+ * which may change in a new version */
+static gchar *
+fu_hwids_get_cache_key (FuHwids *self, FuSmbios *smbios)
+{
+	const gchar *checksum = fu_smbios_get_checksum (smbios);
+	g_autoptr(GChecksum) csum = NULL;
+	g_autoptr(GList) keys = NULL;
+
+	if (checksum == NULL)
+		return NULL;
+	csum = g_checksum_new (G_CHECKSUM_SHA256);
+	g_checksum_update (csum, (const guchar *) PACKAGE_VERSION, -1);
+	g_checksum_update (csum, (const guchar *) "\n", 1);
+	g_checksum_update (csum, (const guchar *) checksum, -1);
+	g_checksum_update (csum, (const guchar *) "\n", 1);
+	keys = g_hash_table_get_keys (self->hash_smbios_override);
+	keys = g_list_sort (keys, (GCompareFunc) g_strcmp0);
+	for (GList *l = keys; l != NULL; l = l->next) {
+		const gchar *key = l->data;
+		const gchar *value = g_hash_table_lookup (self->hash_smbios_override, key);
+		g_checksum_update (csum, (const guchar *) key, -1);
+		if (value != NULL) {
+			g_checksum_update (csum, (const guchar *) "=", 1);
+			g_checksum_update (csum, (const guchar *) value, -1);
+		}
+		g_checksum_update (csum, (const guchar *) "\n", 1);
+	}
+	return g_strdup (g_checksum_get_string (csum));
+}
+
+static GVariant *
+fu_hwids_hash_to_variant (GHashTable *hash)
+{
+	GHashTableIter iter;
+	gpointer key, value;
+	GVariantBuilder builder;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{ss}"));
+	g_hash_table_iter_init (&iter, hash);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+		g_variant_builder_add (&builder, "{ss}", key, value);
+	return g_variant_builder_end (&builder);
+}
+
+static void
+fu_hwids_hash_from_variant (GHashTable *hash, GVariant *value)
+{
+	const gchar *key;
+	const gchar *val;
+	GVariantIter iter;
+
+	g_hash_table_remove_all (hash);
+	g_variant_iter_init (&iter, value);
+	while (g_variant_iter_next (&iter, "{&s&s}", &key, &val))
+		g_hash_table_insert (hash, g_strdup (key), g_strdup (val));
+}
+
+static gboolean
+fu_hwids_load_cache (FuHwids *self, const gchar *filename, const gchar *key, GError **error)
+{
+	const gchar *key_cache = NULL;
+	gsize bufsz = 0;
+	gchar *buf = NULL;
+	g_autofree const gchar **guids = NULL;
+	g_autoptr(GVariant) value = NULL;
+	g_autoptr(GVariant) value_tmp = NULL;
+	g_autoptr(GVariant) dmi_hw = NULL;
+	g_autoptr(GVariant) dmi_display = NULL;
+
+	if (!g_file_get_contents (filename, &buf, &bufsz, error))
+		return FALSE;
+	value_tmp = g_variant_new_from_data (G_VARIANT_TYPE (FU_HWIDS_CACHE_FORMAT),
+					     buf, bufsz, FALSE, g_free, buf);
+	value = g_variant_get_normal_form (value_tmp);
+	g_variant_get (value, "(&s@a{ss}@a{ss}^a&s)",
+		       &key_cache, &dmi_hw, &dmi_display, &guids);
+	if (g_strcmp0 (key_cache, key) != 0) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "SMBIOS data has changed");
+		return FALSE;
+	}
+
+	/* success */
+	fu_hwids_hash_from_variant (self->hash_dmi_hw, dmi_hw);
+	fu_hwids_hash_from_variant (self->hash_dmi_display, dmi_display);
+	g_hash_table_remove_all (self->hash_guid);
+	g_ptr_array_set_size (self->array_guids, 0);
+	for (guint i = 0; guids[i] != NULL; i++) {
+		g_hash_table_insert (self->hash_guid,
+				     g_strdup (guids[i]),
+				     GUINT_TO_POINTER (1));
+		g_ptr_array_add (self->array_guids, g_strdup (guids[i]));
+	}
+	return TRUE;
+}
+
+static gboolean
+fu_hwids_save_cache (FuHwids *self, const gchar *filename, const gchar *key, GError **error)
+{
+	g_autofree const gchar **guids = g_new0 (const gchar *, self->array_guids->len + 1);
+	g_autoptr(GVariant) value = NULL;
+
+	for (guint i = 0; i < self->array_guids->len; i++)
+		guids[i] = g_ptr_array_index (self->array_guids, i);
+	value = g_variant_ref_sink (g_variant_new (FU_HWIDS_CACHE_FORMAT,
+						   key,
+						   fu_hwids_hash_to_variant (self->hash_dmi_hw),
+						   fu_hwids_hash_to_variant (self->hash_dmi_display),
+						   guids));
+	if (!fu_common_mkdir_parent (filename, error))
+		return FALSE;
+	return g_file_set_contents (filename,
+				    g_variant_get_data (value),
+				    g_variant_get_size (value),
+				    error);
+}
+
+/**
+ * fu_hwids_setup_with_cache:
+ * @self: A #FuHwids
+ * @smbios: A #FuSmbios
+ * @filename: A cache filename, e.g. `/var/cache/fwupd/hwids.cache`
+ * @error: A #GError or %NULL
+ *
+ * Sets up the hardware IDs, using the previously computed values if the raw
+ * DMI tables and SMBIOS overrides have not changed since @filename was saved.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_hwids_setup_with_cache (FuHwids *self, FuSmbios *smbios, const gchar *filename, GError **error)
+{
+	g_autofree gchar *key = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	g_return_val_if_fail (FU_IS_HWIDS (self), FALSE);
+	g_return_val_if_fail (FU_IS_SMBIOS (smbios), FALSE);
+	g_return_val_if_fail (filename != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* not from DMI tables */
+	key = fu_hwids_get_cache_key (self, smbios);
+	if (key == NULL)
+		return fu_hwids_setup (self, smbios, error);
+	if (fu_hwids_load_cache (self, filename, key, &error_local))
+		return TRUE;
+	g_debug ("ignoring HWIDs cache: %s", error_local->message);
+
+	/* compute and save for next time */
+	if (!fu_hwids_setup (self, smbios, error))
+		return FALSE;
+	g_clear_error (&error_local);
+	if (!fu_hwids_save_cache (self, filename, key, &error_local))
+		g_debug ("failed to save HWIDs cache: %s", error_local->message);
+	return TRUE;
+}
+
 static void
 fu_hwids_finalize (GObject *object)
 {
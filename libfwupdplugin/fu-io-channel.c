@@ -17,6 +17,9 @@
 #endif
 #include <string.h>
 #include <sys/stat.h>
+#ifdef HAVE_UIO_H
+#include <sys/uio.h>
+#endif
 
 #include "fwupd-error.h"
 #include "fu-common.h"
@@ -25,8 +28,18 @@
 struct _FuIOChannel {
 	GObject			 parent_instance;
 	gint			 fd;
+	FuDevice		*device;	/* weak */
+	guint8			*rbuf;		/* (nullable) ring buffer */
+	gsize			 rbufsz;
+	gsize			 rbuf_head;
+	gsize			 rbuf_len;
+	GByteArray		*wbuf;		/* (nullable) pending writes */
+	gsize			 wbufsz;
 };
 
+#define FU_IO_CHANNEL_BUFFER_SIZE_DEFAULT	4096
+#define FU_IO_CHANNEL_FLUSH_TIMEOUT		1500	/* ms */
+
 G_DEFINE_TYPE (FuIOChannel, fu_io_channel, G_TYPE_OBJECT)
 
 /**
@@ -53,6 +66,8 @@ fu_io_channel_unix_get_fd (FuIOChannel *self)
  *
  * Closes the file descriptor for the device.
  *
+ * In buffered mode any pending writes are sent first.
+ *
  * Returns: %TRUE if all the FD was closed.
  *
  * Since: 1.2.2
@@ -62,12 +77,53 @@ fu_io_channel_shutdown (FuIOChannel *self, GError **error)
 {
 	g_return_val_if_fail (FU_IS_IO_CHANNEL (self), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	if (self->wbuf != NULL && self->wbuf->len > 0) {
+		g_autoptr(GError) error_local = NULL;
+		if (!fu_io_channel_flush (self, FU_IO_CHANNEL_FLUSH_TIMEOUT, &error_local))
+			g_warning ("failed to flush on shutdown: %s", error_local->message);
+	}
 	if (!g_close (self->fd, error))
 		return FALSE;
 	self->fd = -1;
 	return TRUE;
 }
 
+/**
+ * fu_io_channel_set_device:
+ * @self: a #FuIOChannel
+ * @device: (nullable): a #FuDevice
+ *
+ * Sets the device that owns the channel, which is used to record the number
+ * of bytes transferred and the time taken for each read and write.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_io_channel_set_device (FuIOChannel *self, FuDevice *device)
+{
+	g_return_if_fail (FU_IS_IO_CHANNEL (self));
+	g_return_if_fail (device == NULL || FU_IS_DEVICE (device));
+	if (self->device == device)
+		return;
+	if (self->device != NULL)
+		g_object_remove_weak_pointer (G_OBJECT (self->device), (gpointer *) &self->device);
+	self->device = device;
+	if (self->device != NULL)
+		g_object_add_weak_pointer (G_OBJECT (self->device), (gpointer *) &self->device);
+}
+
+static void
+fu_io_channel_add_io_transfer (FuIOChannel *self,
+			       gsize bytes_read,
+			       gsize bytes_written,
+			       gint64 start)
+{
+	if (self->device == NULL)
+		return;
+	fu_device_add_io_transfer (self->device, bytes_read, bytes_written,
+				   g_get_monotonic_time () - start);
+}
+
 static gboolean
 fu_io_channel_flush_input (FuIOChannel *self, GError **error)
 {
@@ -75,6 +131,8 @@ fu_io_channel_flush_input (FuIOChannel *self, GError **error)
 		.fd = self->fd,
 		.events = G_IO_IN | G_IO_ERR,
 	};
+	self->rbuf_head = 0;
+	self->rbuf_len = 0;
 	while (g_poll (&poll, 1, 0) > 0) {
 		gchar c;
 		gint r = read (self->fd, &c, 1);
@@ -84,6 +142,444 @@ fu_io_channel_flush_input (FuIOChannel *self, GError **error)
 	return TRUE;
 }
 
+static void
+fu_io_channel_ensure_rbuf (FuIOChannel *self)
+{
+	if (self->rbuf != NULL)
+		return;
+	self->rbufsz = FU_IO_CHANNEL_BUFFER_SIZE_DEFAULT;
+	self->rbuf = g_malloc (self->rbufsz);
+}
+
+/* copy out up to @bufsz bytes from the ring buffer */
+static gsize
+fu_io_channel_rbuf_pop (FuIOChannel *self, guint8 *buf, gsize bufsz)
+{
+	gsize sz = MIN (bufsz, self->rbuf_len);
+	gsize sz1 = MIN (sz, self->rbufsz - self->rbuf_head);
+	if (sz == 0)
+		return 0;
+	if (buf != NULL) {
+		memcpy (buf, self->rbuf + self->rbuf_head, sz1);
+		memcpy (buf + sz1, self->rbuf, sz - sz1);
+	}
+	self->rbuf_head = (self->rbuf_head + sz) % self->rbufsz;
+	self->rbuf_len -= sz;
+	if (self->rbuf_len == 0)
+		self->rbuf_head = 0;
+	return sz;
+}
+
+static void
+fu_io_channel_rbuf_pop_byte_array (FuIOChannel *self, GByteArray *buf, gsize bufsz)
+{
+	guint len = buf->len;
+	g_byte_array_set_size (buf, len + MIN (bufsz, self->rbuf_len));
+	fu_io_channel_rbuf_pop (self, buf->data + len, buf->len - len);
+}
+
+/* returns the number of bytes up to and including the delimiter, or 0 */
+static gsize
+fu_io_channel_rbuf_find (FuIOChannel *self,
+			 const guint8 *delim,
+			 gsize delimsz,
+			 gsize limit)
+{
+	gsize len = MIN (self->rbuf_len, limit);
+	for (gsize i = 0; i + delimsz <= len; i++) {
+		gsize j;
+		for (j = 0; j < delimsz; j++) {
+			gsize idx = (self->rbuf_head + i + j) % self->rbufsz;
+			if (self->rbuf[idx] != delim[j])
+				break;
+		}
+		if (j == delimsz)
+			return i + delimsz;
+	}
+	return 0;
+}
+
+/* read as much as will fit into the free space of the ring buffer */
+static gssize
+fu_io_channel_rbuf_fill (FuIOChannel *self)
+{
+	gsize tail = (self->rbuf_head + self->rbuf_len) % self->rbufsz;
+	gsize sz_free = self->rbufsz - self->rbuf_len;
+	gsize sz1 = MIN (sz_free, self->rbufsz - tail);
+	gssize len;
+#ifdef HAVE_UIO_H
+	struct iovec iov[2] = {
+		{ .iov_base = self->rbuf + tail, .iov_len = sz1 },
+		{ .iov_base = self->rbuf, .iov_len = sz_free - sz1 },
+	};
+	len = readv (self->fd, iov, iov[1].iov_len > 0 ? 2 : 1);
+#else
+	len = read (self->fd, self->rbuf + tail, sz1);
+#endif
+	if (len > 0)
+		self->rbuf_len += len;
+	return len;
+}
+
+/* wait for data to be allowed to read without blocking */
+static gboolean
+fu_io_channel_wait_readable (FuIOChannel *self, guint timeout_ms, GError **error)
+{
+	GPollFD fds = {
+		.fd = self->fd,
+		.events = G_IO_IN | G_IO_PRI | G_IO_ERR,
+	};
+	while (TRUE) {
+		gint rc = g_poll (&fds, 1, (gint) timeout_ms);
+		if (rc == 0) {
+			g_set_error (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_TIMED_OUT,
+				     "timeout");
+			return FALSE;
+		}
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_READ,
+				     "failed to poll %i", self->fd);
+			return FALSE;
+		}
+		break;
+	}
+	if (fds.revents & G_IO_IN)
+		return TRUE;
+	if (fds.revents & G_IO_ERR) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_READ,
+				     "error condition");
+		return FALSE;
+	}
+	if (fds.revents & G_IO_HUP) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_READ,
+				     "connection hung up");
+		return FALSE;
+	}
+	if (fds.revents & G_IO_NVAL) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_READ,
+				     "invalid request");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static gssize
+fu_io_channel_writev (FuIOChannel *self, GOutputVector *vectors, guint n_vectors)
+{
+#ifdef HAVE_UIO_H
+	struct iovec iov[2];
+	g_return_val_if_fail (n_vectors <= G_N_ELEMENTS (iov), -1);
+	for (guint i = 0; i < n_vectors; i++) {
+		iov[i].iov_base = (gpointer) vectors[i].buffer;
+		iov[i].iov_len = vectors[i].size;
+	}
+	return writev (self->fd, iov, n_vectors);
+#else
+	return write (self->fd, vectors[0].buffer, vectors[0].size);
+#endif
+}
+
+static gboolean
+fu_io_channel_write_vectors (FuIOChannel *self,
+			     GOutputVector *vectors,
+			     guint n_vectors,
+			     guint timeout_ms,
+			     FuIOChannelFlags flags,
+			     GError **error)
+{
+	gsize datasz = 0;
+	gsize idx = 0;
+	guint vidx = 0;
+	gint64 start = g_get_monotonic_time ();
+
+	for (guint i = 0; i < n_vectors; i++)
+		datasz += vectors[i].size;
+
+	/* blocking IO */
+	if (flags & FU_IO_CHANNEL_FLAG_USE_BLOCKING_IO) {
+		gssize wrote = fu_io_channel_writev (self, vectors, n_vectors);
+		if (wrote != (gssize) datasz) {
+			g_set_error (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_FAILED,
+				     "failed to write: "
+				     "wrote %" G_GSSIZE_FORMAT " of %" G_GSIZE_FORMAT,
+				     wrote, datasz);
+			return FALSE;
+		}
+		fu_io_channel_add_io_transfer (self, 0, datasz, start);
+		return TRUE;
+	}
+
+	/* nonblocking IO */
+	while (idx < datasz) {
+		gint rc;
+		GPollFD fds = {
+			.fd = self->fd,
+			.events = G_IO_OUT | G_IO_ERR,
+		};
+
+		/* wait for data to be allowed to write without blocking; in
+		 * buffered mode the caller has no other way to find out that
+		 * the queued data was not sent */
+		rc = g_poll (&fds, 1, (gint) timeout_ms);
+		if (rc == 0) {
+			if (self->wbuf == NULL)
+				break;
+			g_set_error (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_TIMED_OUT,
+				     "timeout, wrote %" G_GSIZE_FORMAT " of %" G_GSIZE_FORMAT,
+				     idx, datasz);
+			fu_io_channel_add_io_transfer (self, 0, idx, start);
+			return FALSE;
+		}
+		if (rc < 0) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_READ,
+				     "failed to poll %i",
+				     self->fd);
+			return FALSE;
+		}
+
+		/* we can write data */
+		if (fds.revents & G_IO_OUT) {
+			gssize len = fu_io_channel_writev (self,
+							   vectors + vidx,
+							   n_vectors - vidx);
+			if (len < 0) {
+				if (errno == EAGAIN) {
+					g_debug ("got EAGAIN, trying harder");
+					continue;
+				}
+				g_set_error (error,
+					     FWUPD_ERROR,
+					     FWUPD_ERROR_WRITE,
+					     "failed to write %" G_GSIZE_FORMAT
+					     " bytes to %i: %s" ,
+					     datasz,
+					     self->fd,
+					     strerror (errno));
+				return FALSE;
+			}
+			idx += len;
+			if (flags & FU_IO_CHANNEL_FLAG_SINGLE_SHOT)
+				break;
+
+			/* skip over what was written */
+			while (len > 0 && vidx < n_vectors) {
+				if ((gsize) len >= vectors[vidx].size) {
+					len -= vectors[vidx].size;
+					vidx++;
+					continue;
+				}
+				vectors[vidx].buffer = (const guint8 *) vectors[vidx].buffer + len;
+				vectors[vidx].size -= len;
+				len = 0;
+			}
+		}
+	}
+
+	fu_io_channel_add_io_transfer (self, 0, idx, start);
+	return TRUE;
+}
+
+/**
+ * fu_io_channel_flush:
+ * @self: a #FuIOChannel
+ * @timeout_ms: timeout in ms
+ * @error: a #GError, or %NULL
+ *
+ * Writes any data queued by fu_io_channel_write_raw() when the channel is
+ * in buffered mode.
+ *
+ * Returns: %TRUE if all the pending bytes were written, or %FALSE with
+ * %G_IO_ERROR_TIMED_OUT if the device did not accept them all in time
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_io_channel_flush (FuIOChannel *self, guint timeout_ms, GError **error)
+{
+	GOutputVector vectors[1] = { { NULL, 0 } };
+
+	g_return_val_if_fail (FU_IS_IO_CHANNEL (self), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	if (self->wbuf == NULL || self->wbuf->len == 0)
+		return TRUE;
+	vectors[0].buffer = self->wbuf->data;
+	vectors[0].size = self->wbuf->len;
+	if (!fu_io_channel_write_vectors (self, vectors, 1, timeout_ms,
+					  FU_IO_CHANNEL_FLAG_NONE, error)) {
+		g_byte_array_set_size (self->wbuf, 0);
+		return FALSE;
+	}
+	g_byte_array_set_size (self->wbuf, 0);
+	return TRUE;
+}
+
+/**
+ * fu_io_channel_set_buffer_size:
+ * @self: a #FuIOChannel
+ * @bufsz: size in bytes, or 0 to disable buffering
+ *
+ * Sets the channel into buffered mode, where small writes are coalesced until
+ * the next read or fu_io_channel_flush() and reads fetch as much data as is
+ * available from the kernel in one syscall.
+ *
+ * This should be set before any data is transferred.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_io_channel_set_buffer_size (FuIOChannel *self, gsize bufsz)
+{
+	g_return_if_fail (FU_IS_IO_CHANNEL (self));
+	g_return_if_fail (self->rbuf_len == 0);
+	g_return_if_fail (self->wbuf == NULL || self->wbuf->len == 0);
+
+	g_clear_pointer (&self->rbuf, g_free);
+	g_clear_pointer (&self->wbuf, g_byte_array_unref);
+	self->rbuf_head = 0;
+	self->rbufsz = 0;
+	self->wbufsz = bufsz;
+	if (bufsz == 0)
+		return;
+	self->rbufsz = bufsz;
+	self->rbuf = g_malloc (self->rbufsz);
+	self->wbuf = g_byte_array_sized_new (bufsz);
+}
+
+/**
+ * fu_io_channel_read_until:
+ * @self: a #FuIOChannel
+ * @buf: buffer
+ * @bufsz: size of @buf
+ * @bytes_read: (out) (optional): data written to @buf, or %NULL
+ * @delim: (nullable): delimiter, e.g. `\n`
+ * @delimsz: size of @delim
+ * @timeout_ms: timeout in ms
+ * @flags: some #FuIOChannelFlags, e.g. %FU_IO_CHANNEL_FLAG_NONE
+ * @error: a #GError, or %NULL
+ *
+ * Reads bytes from the TTY into @buf until the delimiter has been received,
+ * or if @delim is %NULL until exactly @bufsz bytes have been read. Any extra
+ * data that was received is kept for the next read.
+ *
+ * The @timeout_ms is the maximum time for the whole operation.
+ *
+ * Returns: %TRUE if the delimiter or the requested length was received
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_io_channel_read_until (FuIOChannel *self,
+			  guint8 *buf,
+			  gsize bufsz,
+			  gsize *bytes_read,
+			  const guint8 *delim,
+			  gsize delimsz,
+			  guint timeout_ms,
+			  FuIOChannelFlags flags,
+			  GError **error)
+{
+	gint64 start = g_get_monotonic_time ();
+	gint64 deadline = start + (gint64) timeout_ms * 1000;
+
+	g_return_val_if_fail (FU_IS_IO_CHANNEL (self), FALSE);
+	g_return_val_if_fail (buf != NULL, FALSE);
+	g_return_val_if_fail (bufsz > 0, FALSE);
+	g_return_val_if_fail (delim == NULL || delimsz > 0, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* send the request */
+	if (!fu_io_channel_flush (self, timeout_ms, error))
+		return FALSE;
+
+	/* the data may not be read past the delimiter */
+	fu_io_channel_ensure_rbuf (self);
+	if (bufsz > self->rbufsz) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_SUPPORTED,
+			     "requested %" G_GSIZE_FORMAT " bytes, "
+			     "but buffer is %" G_GSIZE_FORMAT,
+			     bufsz, self->rbufsz);
+		return FALSE;
+	}
+	while (TRUE) {
+		gssize len;
+		gint64 now;
+		gsize sz = 0;
+
+		/* already buffered */
+		if (delim != NULL)
+			sz = fu_io_channel_rbuf_find (self, delim, delimsz, bufsz);
+		else if (self->rbuf_len >= bufsz)
+			sz = bufsz;
+		if (sz > 0) {
+			fu_io_channel_rbuf_pop (self, buf, sz);
+			if (bytes_read != NULL)
+				*bytes_read = sz;
+			fu_io_channel_add_io_transfer (self, sz, 0, start);
+			return TRUE;
+		}
+		if (self->rbuf_len >= bufsz) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_READ,
+				     "no delimiter in %" G_GSIZE_FORMAT " bytes",
+				     bufsz);
+			return FALSE;
+		}
+
+		/* wait for more */
+		now = g_get_monotonic_time ();
+		if (now >= deadline) {
+			g_set_error (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_TIMED_OUT,
+				     "timeout");
+			return FALSE;
+		}
+		if ((flags & FU_IO_CHANNEL_FLAG_USE_BLOCKING_IO) == 0 &&
+		    !fu_io_channel_wait_readable (self, (deadline - now) / 1000, error))
+			return FALSE;
+		len = fu_io_channel_rbuf_fill (self);
+		if (len < 0) {
+			if (errno == EINTR || errno == EAGAIN)
+				continue;
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_READ,
+				     "failed to read %i: %s", self->fd,
+				     strerror (errno));
+			return FALSE;
+		}
+		if (len == 0) {
+			g_set_error_literal (error,
+					     FWUPD_ERROR,
+					     FWUPD_ERROR_READ,
+					     "connection hung up");
+			return FALSE;
+		}
+	}
+}
+
 /**
  * fu_io_channel_write_bytes:
  * @self: a #FuIOChannel
@@ -157,7 +653,7 @@ fu_io_channel_write_raw (FuIOChannel *self,
 			 FuIOChannelFlags flags,
 			 GError **error)
 {
-	gsize idx = 0;
+	GOutputVector vectors[2] = { { NULL, 0 } };
 
 	g_return_val_if_fail (FU_IS_IO_CHANNEL (self), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
@@ -168,67 +664,37 @@ fu_io_channel_write_raw (FuIOChannel *self,
 			return FALSE;
 	}
 
-	/* blocking IO */
-	if (flags & FU_IO_CHANNEL_FLAG_USE_BLOCKING_IO) {
-		gssize wrote = write (self->fd, data, datasz);
-		if (wrote != (gssize) datasz) {
-			g_set_error (error,
-				     G_IO_ERROR,
-				     G_IO_ERROR_FAILED,
-				     "failed to write: "
-				     "wrote %" G_GSSIZE_FORMAT " of %" G_GSIZE_FORMAT,
-				     wrote, datasz);
-			return FALSE;
-		}
-		return TRUE;
-	}
-
-	/* nonblocking IO */
-	while (idx < datasz) {
-		gint rc;
-		GPollFD fds = {
-			.fd = self->fd,
-			.events = G_IO_OUT | G_IO_ERR,
-		};
+	/* buffered mode */
+	if (self->wbuf != NULL &&
+	    (flags & (FU_IO_CHANNEL_FLAG_SINGLE_SHOT |
+		      FU_IO_CHANNEL_FLAG_USE_BLOCKING_IO)) == 0) {
+		gboolean ret;
 
-		/* wait for data to be allowed to write without blocking */
-		rc = g_poll (&fds, 1, (gint) timeout_ms);
-		if (rc == 0)
-			break;
-		if (rc < 0) {
-			g_set_error (error,
-				     FWUPD_ERROR,
-				     FWUPD_ERROR_READ,
-				     "failed to poll %i",
-				     self->fd);
-			return FALSE;
+		/* coalesce small writes */
+		if (self->wbuf->len + datasz <= self->wbufsz) {
+			g_byte_array_append (self->wbuf, data, datasz);
+			return TRUE;
 		}
 
-		/* we can write data */
-		if (fds.revents & G_IO_OUT) {
-			gssize len = write (self->fd, data + idx, datasz - idx);
-			if (len < 0) {
-				if (errno == EAGAIN) {
-					g_debug ("got EAGAIN, trying harder");
-					continue;
-				}
-				g_set_error (error,
-					     FWUPD_ERROR,
-					     FWUPD_ERROR_WRITE,
-					     "failed to write %" G_GSIZE_FORMAT
-					     " bytes to %i: %s" ,
-					     datasz,
-					     self->fd,
-					     strerror (errno));
-				return FALSE;
-			}
-			if (flags & FU_IO_CHANNEL_FLAG_SINGLE_SHOT)
-				break;
-			idx += len;
-		}
+		/* send the pending data and this buffer in one syscall */
+		vectors[0].buffer = self->wbuf->data;
+		vectors[0].size = self->wbuf->len;
+		vectors[1].buffer = data;
+		vectors[1].size = datasz;
+		ret = fu_io_channel_write_vectors (self,
+						   self->wbuf->len > 0 ? vectors : vectors + 1,
+						   self->wbuf->len > 0 ? 2 : 1,
+						   timeout_ms, flags, error);
+		g_byte_array_set_size (self->wbuf, 0);
+		return ret;
 	}
 
-	return TRUE;
+	/* keep the order */
+	if (!fu_io_channel_flush (self, timeout_ms, error))
+		return FALSE;
+	vectors[0].buffer = data;
+	vectors[0].size = datasz;
+	return fu_io_channel_write_vectors (self, vectors, 1, timeout_ms, flags, error);
 }
 
 
@@ -284,14 +750,26 @@ fu_io_channel_read_byte_array (FuIOChannel *self,
 			       FuIOChannelFlags flags,
 			       GError **error)
 {
-	GPollFD fds = {
-		.fd = self->fd,
-		.events = G_IO_IN | G_IO_PRI | G_IO_ERR,
-	};
+	gint64 start = g_get_monotonic_time ();
 	g_autoptr(GByteArray) buf2 = g_byte_array_new ();
 
 	g_return_val_if_fail (FU_IS_IO_CHANNEL (self), NULL);
 
+	/* send the request */
+	if (!fu_io_channel_flush (self, timeout_ms, error))
+		return NULL;
+
+	/* left over from a previous read */
+	if (self->rbuf_len > 0) {
+		fu_io_channel_rbuf_pop_byte_array (self, buf2,
+						   max_size > 0 ? (gsize) max_size : G_MAXSIZE);
+		if ((max_size > 0 && buf2->len >= (guint) max_size) ||
+		    (flags & FU_IO_CHANNEL_FLAG_SINGLE_SHOT)) {
+			fu_io_channel_add_io_transfer (self, buf2->len, 0, start);
+			return g_steal_pointer (&buf2);
+		}
+	}
+
 	/* blocking IO */
 	if (flags & FU_IO_CHANNEL_FLAG_USE_BLOCKING_IO) {
 		guint8 buf[1024];
@@ -306,77 +784,51 @@ fu_io_channel_read_byte_array (FuIOChannel *self,
 		}
 		if (len > 0)
 			g_byte_array_append (buf2, buf, len);
+		fu_io_channel_add_io_transfer (self, buf2->len, 0, start);
 		return g_steal_pointer (&buf2);
 	}
 
 	/* nonblocking IO */
 	while (TRUE) {
+		gssize len;
+
 		/* wait for data to appear */
-		gint rc = g_poll (&fds, 1, (gint) timeout_ms);
-		if (rc == 0) {
-			g_set_error (error,
-				     G_IO_ERROR,
-				     G_IO_ERROR_TIMED_OUT,
-				     "timeout");
+		if (!fu_io_channel_wait_readable (self, timeout_ms, error))
 			return NULL;
+
+		/* we have data to read */
+		if (self->rbuf != NULL) {
+			len = fu_io_channel_rbuf_fill (self);
+			if (len > 0) {
+				fu_io_channel_rbuf_pop_byte_array (self, buf2,
+								   max_size > 0 ?
+								   max_size - buf2->len :
+								   G_MAXSIZE);
+			}
+		} else {
+			guint8 buf[1024];
+			len = read (self->fd, buf, sizeof (buf));
+			if (len > 0)
+				g_byte_array_append (buf2, buf, len);
 		}
-		if (rc < 0) {
+		if (len < 0) {
 			if (errno == EINTR)
 				continue;
+			if (errno == EAGAIN)
+				continue;
 			g_set_error (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_READ,
-				     "failed to poll %i", self->fd);
+				     "failed to read %i: %s", self->fd,
+				     strerror (errno));
 			return NULL;
 		}
 
-		/* we have data to read */
-		if (fds.revents & G_IO_IN) {
-			guint8 buf[1024];
-			gssize len = read (self->fd, buf, sizeof (buf));
-			if (len < 0) {
-				if (errno == EINTR)
-					continue;
-				if (errno == EAGAIN)
-					continue;
-				g_set_error (error,
-					     FWUPD_ERROR,
-					     FWUPD_ERROR_READ,
-					     "failed to read %i: %s", self->fd,
-					     strerror (errno));
-				return NULL;
-			}
-			if (len > 0)
-				g_byte_array_append (buf2, buf, len);
-
-			/* check maximum size */
-			if (max_size > 0 && buf2->len >= (guint) max_size)
-				break;
-			if (flags & FU_IO_CHANNEL_FLAG_SINGLE_SHOT)
-				break;
-			continue;
-		}
-		if (fds.revents & G_IO_ERR) {
-			g_set_error_literal (error,
-					     FWUPD_ERROR,
-					     FWUPD_ERROR_READ,
-					     "error condition");
-			return NULL;
-		}
-		if (fds.revents & G_IO_HUP) {
-			g_set_error_literal (error,
-					     FWUPD_ERROR,
-					     FWUPD_ERROR_READ,
-					     "connection hung up");
-			return NULL;
-		}
-		if (fds.revents & G_IO_NVAL) {
-			g_set_error_literal (error,
-					     FWUPD_ERROR,
-					     FWUPD_ERROR_READ,
-					     "invalid request");
-			return NULL;
-		}
+		/* check maximum size */
+		if (max_size > 0 && buf2->len >= (guint) max_size)
+			break;
+		if (flags & FU_IO_CHANNEL_FLAG_SINGLE_SHOT)
+			break;
 	}
 
 	/* no data */
@@ -390,6 +842,7 @@ fu_io_channel_read_byte_array (FuIOChannel *self,
 	}
 
 	/* return blob */
+	fu_io_channel_add_io_transfer (self, buf2->len, 0, start);
 	return g_steal_pointer (&buf2);
 }
 
@@ -439,8 +892,17 @@ static void
 fu_io_channel_finalize (GObject *object)
 {
 	FuIOChannel *self = FU_IO_CHANNEL (object);
+	fu_io_channel_set_device (self, NULL);
 	if (self->fd != -1)
 		g_close (self->fd, NULL);
+	g_free (self->rbuf);
+	if (self->wbuf != NULL) {
+		if (self->wbuf->len > 0) {
+			g_warning ("dropping %u bytes not flushed before shutdown",
+				   self->wbuf->len);
+		}
+		g_byte_array_unref (self->wbuf);
+	}
 	G_OBJECT_CLASS (fu_io_channel_parent_class)->finalize (object);
 }
 
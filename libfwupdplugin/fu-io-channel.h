@@ -6,7 +6,7 @@
 
 #pragma once
 
-#include <glib-object.h>
+#include "fu-device.h"
 
 #define FU_TYPE_IO_CHANNEL (fu_io_channel_get_type ())
 
@@ -36,6 +36,14 @@ FuIOChannel	*fu_io_channel_new_file		(const gchar	*filename,
 						 G_GNUC_WARN_UNUSED_RESULT;
 
 gint		 fu_io_channel_unix_get_fd	(FuIOChannel	*self);
+void		 fu_io_channel_set_device	(FuIOChannel	*self,
+						 FuDevice	*device);
+void		 fu_io_channel_set_buffer_size	(FuIOChannel	*self,
+						 gsize		 bufsz);
+gboolean	 fu_io_channel_flush		(FuIOChannel	*self,
+						 guint		 timeout_ms,
+						 GError		**error)
+						 G_GNUC_WARN_UNUSED_RESULT;
 gboolean	 fu_io_channel_shutdown		(FuIOChannel	*self,
 						 GError		**error)
 						 G_GNUC_WARN_UNUSED_RESULT;
@@ -66,6 +74,16 @@ gboolean	 fu_io_channel_write_byte_array	(FuIOChannel	*self,
 						 FuIOChannelFlags flags,
 						 GError		**error)
 						 G_GNUC_WARN_UNUSED_RESULT;
+gboolean	 fu_io_channel_read_until	(FuIOChannel	*self,
+						 guint8		*buf,
+						 gsize		 bufsz,
+						 gsize		*bytes_read,
+						 const guint8	*delim,
+						 gsize		 delimsz,
+						 guint		 timeout_ms,
+						 FuIOChannelFlags flags,
+						 GError		**error)
+						 G_GNUC_WARN_UNUSED_RESULT;
 GBytes		*fu_io_channel_read_bytes	(FuIOChannel	*self,
 						 gssize		 max_size,
 						 guint		 timeout_ms,
@@ -6,7 +6,13 @@
 
 #include "config.h"
 
+#include <fcntl.h>
+#include <stdlib.h>
 #include <string.h>
+#ifdef HAVE_POSIX_OPENPT
+#include <termios.h>
+#endif
+#include <unistd.h>
 #include <xmlb.h>
 #include <fwupd.h>
 #include <fwupdplugin.h>
@@ -14,9 +20,13 @@
 #include <glib/gstdio.h>
 
 #include "fu-device-private.h"
+#include "fu-hid-device-private.h"
+#include "fu-hwids-private.h"
 #include "fu-plugin-private.h"
 #include "fu-security-attrs-private.h"
 #include "fu-smbios-private.h"
+#include "fu-usb-bulk-pipeline-private.h"
+#include "fu-verify-cache.h"
 #include "fwupd-security-attr-private.h"
 
 static GMainLoop *_test_loop = NULL;
@@ -437,6 +447,69 @@ fu_hwids_func (void)
 		g_assert (fu_hwids_has_guid (hwids, guids[i].value));
 }
 
+static void
+fu_hwids_cache_func (void)
+{
+	GPtrArray *guids1;
+	GPtrArray *guids2;
+	gboolean ret;
+	g_autofree gchar *fn_hwids = NULL;
+	g_autofree gchar *fn_smbios = NULL;
+	g_autofree gchar *tmpdir = NULL;
+	g_autoptr(FuHwids) hwids1 = fu_hwids_new ();
+	g_autoptr(FuHwids) hwids2 = fu_hwids_new ();
+	g_autoptr(FuHwids) hwids3 = fu_hwids_new ();
+	g_autoptr(FuSmbios) smbios1 = fu_smbios_new ();
+	g_autoptr(FuSmbios) smbios2 = fu_smbios_new ();
+	g_autoptr(GError) error = NULL;
+
+	tmpdir = g_dir_make_tmp ("fwupd-self-test-XXXXXX", &error);
+	g_assert_no_error (error);
+	fn_smbios = g_build_filename (tmpdir, "smbios.cache", NULL);
+	fn_hwids = g_build_filename (tmpdir, "hwids.cache", NULL);
+
+	/* parsed and saved */
+	ret = fu_smbios_setup_with_cache (smbios1, fn_smbios, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_nonnull (fu_smbios_get_checksum (smbios1));
+	g_assert_true (g_file_test (fn_smbios, G_FILE_TEST_EXISTS));
+	ret = fu_hwids_setup_with_cache (hwids1, smbios1, fn_hwids, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_true (g_file_test (fn_hwids, G_FILE_TEST_EXISTS));
+
+	/* loaded from the cache */
+	ret = fu_smbios_setup_with_cache (smbios2, fn_smbios, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpstr (fu_smbios_get_checksum (smbios2), ==, fu_smbios_get_checksum (smbios1));
+	g_assert_cmpstr (fu_smbios_get_string (smbios2, FU_SMBIOS_STRUCTURE_TYPE_BIOS, 0x04, NULL),
+			 ==, "LENOVO");
+	ret = fu_hwids_setup_with_cache (hwids2, smbios2, fn_hwids, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpstr (fu_hwids_get_value (hwids2, FU_HWIDS_KEY_MANUFACTURER), ==, "LENOVO");
+	guids1 = fu_hwids_get_guids (hwids1);
+	guids2 = fu_hwids_get_guids (hwids2);
+	g_assert_cmpint (guids1->len, ==, guids2->len);
+	for (guint i = 0; i < guids1->len; i++)
+		g_assert_true (fu_hwids_has_guid (hwids2, g_ptr_array_index (guids1, i)));
+
+	/* an override invalidates the cache */
+	fu_hwids_add_smbios_override (hwids3, FU_HWIDS_KEY_MANUFACTURER, "HUGHSKI");
+	ret = fu_hwids_setup_with_cache (hwids3, smbios2, fn_hwids, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpstr (fu_hwids_get_value (hwids3, FU_HWIDS_KEY_MANUFACTURER), ==, "HUGHSKI");
+	g_assert_false (fu_hwids_has_guid (hwids3, "6de5d951-d755-576b-bd09-c5cf66b27234"));
+
+	/* clean up */
+	ret = fu_common_rmtree (tmpdir, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+}
+
 static void
 _plugin_device_added_cb (FuPlugin *plugin, FuDevice *device, gpointer user_data)
 {
@@ -820,6 +893,98 @@ _build_cab (GCabCompression compression, ...)
 	return g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (op));
 }
 
+static void
+fu_verify_cache_func (void)
+{
+	g_autofree gchar *csum = NULL;
+	g_autoptr(FuVerifyCache) verify_cache = fu_verify_cache_new ();
+	g_autoptr(GBytes) blob = g_bytes_new_static ("hello", 5);
+	g_autoptr(GBytes) blob_bad = g_bytes_new_static ("world", 5);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) results1 = NULL;
+	g_autoptr(GPtrArray) results2 = NULL;
+	g_autoptr(GPtrArray) results3 = NULL;
+	g_autoptr(JcatBlob) jcat_blob = NULL;
+	g_autoptr(JcatContext) jcat_context = jcat_context_new ();
+	g_autoptr(JcatItem) jcat_item = jcat_item_new ("firmware.bin");
+
+	csum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, blob);
+	jcat_blob = jcat_blob_new_utf8 (JCAT_BLOB_KIND_SHA256, csum);
+	jcat_item_add_blob (jcat_item, jcat_blob);
+
+	/* verified, and stored */
+	results1 = fu_verify_cache_verify_item (verify_cache, jcat_context,
+						blob, jcat_item,
+						JCAT_VERIFY_FLAG_REQUIRE_CHECKSUM,
+						&error);
+	g_assert_no_error (error);
+	g_assert_nonnull (results1);
+	g_assert_cmpint (results1->len, ==, 1);
+	g_assert_cmpint (fu_verify_cache_get_size (verify_cache), ==, 1);
+
+	/* same payload and signature returns the same result */
+	results2 = fu_verify_cache_verify_item (verify_cache, jcat_context,
+						blob, jcat_item,
+						JCAT_VERIFY_FLAG_REQUIRE_CHECKSUM,
+						&error);
+	g_assert_no_error (error);
+	g_assert_nonnull (results2);
+	g_assert_cmpint (results2->len, ==, 1);
+	g_assert_true (g_ptr_array_index (results1, 0) == g_ptr_array_index (results2, 0));
+	g_assert_cmpint (fu_verify_cache_get_size (verify_cache), ==, 1);
+
+	/* different payload fails, and the failure is also stored */
+	results3 = fu_verify_cache_verify_item (verify_cache, jcat_context,
+						blob_bad, jcat_item,
+						JCAT_VERIFY_FLAG_REQUIRE_CHECKSUM,
+						&error);
+	g_assert_null (results3);
+	g_assert_nonnull (error);
+	g_clear_error (&error);
+	g_assert_cmpint (fu_verify_cache_get_size (verify_cache), ==, 2);
+
+	/* keyring changed */
+	fu_verify_cache_invalidate (verify_cache);
+	g_assert_cmpint (fu_verify_cache_get_size (verify_cache), ==, 0);
+
+	/* bounded */
+	fu_verify_cache_set_max_items (verify_cache, 1);
+	g_clear_pointer (&results1, g_ptr_array_unref);
+	results1 = fu_verify_cache_verify_item (verify_cache, jcat_context,
+						blob, jcat_item,
+						JCAT_VERIFY_FLAG_REQUIRE_CHECKSUM,
+						&error);
+	g_assert_no_error (error);
+	g_assert_nonnull (results1);
+	g_clear_pointer (&results3, g_ptr_array_unref);
+	results3 = fu_verify_cache_verify_item (verify_cache, jcat_context,
+						blob_bad, jcat_item,
+						JCAT_VERIFY_FLAG_REQUIRE_CHECKSUM,
+						&error);
+	g_assert_null (results3);
+	g_clear_error (&error);
+	g_assert_cmpint (fu_verify_cache_get_size (verify_cache), ==, 1);
+
+	/* expired results are verified again */
+	fu_verify_cache_set_max_age (verify_cache, 0);
+	g_clear_pointer (&results1, g_ptr_array_unref);
+	results1 = fu_verify_cache_verify_item (verify_cache, jcat_context,
+						blob, jcat_item,
+						JCAT_VERIFY_FLAG_REQUIRE_CHECKSUM,
+						&error);
+	g_assert_no_error (error);
+	g_assert_nonnull (results1);
+	g_clear_pointer (&results2, g_ptr_array_unref);
+	results2 = fu_verify_cache_verify_item (verify_cache, jcat_context,
+						blob, jcat_item,
+						JCAT_VERIFY_FLAG_REQUIRE_CHECKSUM,
+						&error);
+	g_assert_no_error (error);
+	g_assert_nonnull (results2);
+	g_assert_true (g_ptr_array_index (results1, 0) != g_ptr_array_index (results2, 0));
+	g_assert_cmpint (fu_verify_cache_get_size (verify_cache), ==, 1);
+}
+
 static void
 fu_common_store_cab_func (void)
 {
@@ -1626,6 +1791,128 @@ fu_common_vercmp_func (void)
 	g_assert_cmpint (fu_common_vercmp_full (NULL, NULL, FWUPD_VERSION_FORMAT_UNKNOWN), ==, G_MAXINT);
 }
 
+static void
+fu_common_version_key_func (void)
+{
+	struct {
+		const gchar *a;
+		const gchar *b;
+		FwupdVersionFormat fmt;
+	} map[] = {
+		{ "1.2.3",	"1.2.3",	FWUPD_VERSION_FORMAT_UNKNOWN },
+		{ "1.2.3",	"1.2.4",	FWUPD_VERSION_FORMAT_TRIPLET },
+		{ "1.2.3",	"1.2.3.1",	FWUPD_VERSION_FORMAT_UNKNOWN },
+		{ "1.2.3a",	"1.2.3b",	FWUPD_VERSION_FORMAT_UNKNOWN },
+		{ "1.2.3",	"1.2.3a",	FWUPD_VERSION_FORMAT_UNKNOWN },
+		{ "alpha",	"beta",		FWUPD_VERSION_FORMAT_UNKNOWN },
+		{ "1.2a.3",	"1.2b.3",	FWUPD_VERSION_FORMAT_UNKNOWN },
+		{ "1.2.3~rc1",	"1.2.3",	FWUPD_VERSION_FORMAT_UNKNOWN },
+		{ "1.2.3~rc2",	"1.2.3~rc1",	FWUPD_VERSION_FORMAT_UNKNOWN },
+		{ "0x00000002",	"0x2",		FWUPD_VERSION_FORMAT_HEX },
+		{ "0x0000000a",	"0x2",		FWUPD_VERSION_FORMAT_HEX },
+		{ "B",		"a",		FWUPD_VERSION_FORMAT_PLAIN },
+		{ "",		"1",		FWUPD_VERSION_FORMAT_UNKNOWN },
+		{ "1.",		"1",		FWUPD_VERSION_FORMAT_UNKNOWN },
+		{ NULL,		"1",		FWUPD_VERSION_FORMAT_UNKNOWN },
+		{ NULL,		"1",		FWUPD_VERSION_FORMAT_PLAIN },
+		{ NULL,		NULL,		0 }
+	};
+
+	/* the keys sort exactly like the strings */
+	for (guint i = 0; map[i].a != NULL || map[i].b != NULL; i++) {
+		g_autoptr(FuVersionKey) key_a = fu_common_version_key_new (map[i].a, map[i].fmt);
+		g_autoptr(FuVersionKey) key_b = fu_common_version_key_new (map[i].b, map[i].fmt);
+		gint rc = fu_common_vercmp_full (map[i].a, map[i].b, map[i].fmt);
+		gint rc_rev = fu_common_vercmp_full (map[i].b, map[i].a, map[i].fmt);
+		g_assert_cmpint (fu_common_version_key_compare (key_a, key_b), ==, rc);
+		g_assert_cmpint (fu_common_version_key_compare (key_b, key_a), ==, rc_rev);
+		g_assert_cmpint (fu_common_version_key_compare_version (key_a, map[i].b), ==, rc);
+		g_assert_cmpint (fu_common_version_key_compare_version (key_b, map[i].a), ==, rc_rev);
+	}
+}
+
+static gint
+fu_common_version_key_sort_cb (gconstpointer a, gconstpointer b)
+{
+	FuVersionKey *key_a = *((FuVersionKey **) a);
+	FuVersionKey *key_b = *((FuVersionKey **) b);
+	return fu_common_version_key_compare (key_a, key_b);
+}
+
+static gint
+fu_common_vercmp_sort_cb (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	const gchar *str_a = *((const gchar **) a);
+	const gchar *str_b = *((const gchar **) b);
+	return fu_common_vercmp_full (str_a, str_b, GPOINTER_TO_UINT (user_data));
+}
+
+static void
+fu_common_version_key_performance_func (void)
+{
+	FwupdVersionFormat fmts[] = {
+		FWUPD_VERSION_FORMAT_PLAIN,
+		FWUPD_VERSION_FORMAT_PAIR,
+		FWUPD_VERSION_FORMAT_TRIPLET,
+		FWUPD_VERSION_FORMAT_QUAD,
+		FWUPD_VERSION_FORMAT_BCD,
+		FWUPD_VERSION_FORMAT_INTEL_ME,
+		FWUPD_VERSION_FORMAT_HEX,
+		FWUPD_VERSION_FORMAT_UNKNOWN,
+	};
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	for (guint j = 0; j < G_N_ELEMENTS (fmts); j++) {
+		FwupdVersionFormat fmt = fmts[j];
+		gdouble elapsed_str;
+		g_autoptr(GPtrArray) versions = g_ptr_array_new_with_free_func (g_free);
+		g_autoptr(GPtrArray) keys = NULL;
+
+		/* create a large release set in a pseudo-random order */
+		for (guint i = 0; i < 5000; i++) {
+			guint32 val = (i * 2654435761u) & 0x00ffffff;
+			if (fmt == FWUPD_VERSION_FORMAT_HEX) {
+				g_ptr_array_add (versions, g_strdup_printf ("0x%08x", val));
+				continue;
+			}
+			if (fmt == FWUPD_VERSION_FORMAT_PLAIN ||
+			    fmt == FWUPD_VERSION_FORMAT_UNKNOWN) {
+				g_ptr_array_add (versions,
+						 fu_common_version_from_uint32 (val, FWUPD_VERSION_FORMAT_TRIPLET));
+				continue;
+			}
+			g_ptr_array_add (versions, fu_common_version_from_uint32 (val, fmt));
+		}
+
+		/* parse on every comparison */
+		g_timer_reset (timer);
+		g_ptr_array_sort_with_data (versions, fu_common_vercmp_sort_cb,
+					    GUINT_TO_POINTER (fmt));
+		elapsed_str = g_timer_elapsed (timer, NULL) * 1000.f;
+
+		/* parse once */
+		g_timer_reset (timer);
+		keys = g_ptr_array_new_with_free_func ((GDestroyNotify) fu_common_version_key_free);
+		for (guint i = 0; i < versions->len; i++) {
+			const gchar *version = g_ptr_array_index (versions, i);
+			g_ptr_array_add (keys, fu_common_version_key_new (version, fmt));
+		}
+		g_ptr_array_sort (keys, fu_common_version_key_sort_cb);
+		g_print ("%s: vercmp=%.3fms key=%.3fms ",
+			 fwupd_version_format_to_string (fmt),
+			 elapsed_str,
+			 g_timer_elapsed (timer, NULL) * 1000.f);
+
+		/* same order */
+		for (guint i = 0; i < versions->len; i++) {
+			FuVersionKey *key = g_ptr_array_index (keys, i);
+			const gchar *version = g_ptr_array_index (versions, i);
+			g_autoptr(FuVersionKey) key_tmp = fu_common_version_key_new (version, fmt);
+			g_assert_cmpint (fu_common_version_key_compare (key, key_tmp), ==, 0);
+		}
+	}
+}
+
 static void
 fu_firmware_ihex_func (void)
 {
@@ -2358,6 +2645,927 @@ fu_device_retry_hardware_func (void)
 	g_assert_cmpint (helper.cnt_failed, ==, 2);
 }
 
+static gboolean
+fu_device_retry_dispatched_cb (gpointer user_data)
+{
+	gboolean *dispatched = (gboolean *) user_data;
+	*dispatched = TRUE;
+	return G_SOURCE_REMOVE;
+}
+
+static void
+fu_device_retry_backoff_func (void)
+{
+	gboolean ret;
+	g_autoptr(FuDevice) device = fu_device_new ();
+	g_autoptr(GError) error = NULL;
+	FuDeviceRetryHelper helper = {
+		.cnt_success = 0,
+		.cnt_failed = 0,
+	};
+
+	ret = fu_device_retry_backoff (device, fu_device_retry_success_3rd_try,
+				       3, 5, 20, &helper, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (helper.cnt_success, ==, 1);
+	g_assert_cmpint (helper.cnt_failed, ==, 2);
+}
+
+static void
+fu_device_sleep_iterate_func (void)
+{
+	gboolean dispatched = FALSE;
+	guint idle_id;
+	g_autoptr(FuDevice) device = fu_device_new ();
+
+	/* not owned by this thread, so just blocks */
+	idle_id = g_idle_add (fu_device_retry_dispatched_cb, &dispatched);
+	fu_device_sleep_iterate (device, 5);
+	g_assert_false (dispatched);
+	g_source_remove (idle_id);
+
+	/* other sources are dispatched while waiting */
+	g_assert_true (g_main_context_acquire (NULL));
+	g_idle_add (fu_device_retry_dispatched_cb, &dispatched);
+	fu_device_sleep_iterate (device, 5);
+	g_assert_true (dispatched);
+	g_main_context_release (NULL);
+}
+
+static void
+fu_device_retry_async_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	GError **error = (GError **) user_data;
+	if (!fu_device_retry_finish (FU_DEVICE (source), res, error))
+		g_assert_nonnull (*error);
+	fu_test_loop_quit ();
+}
+
+static gboolean
+fu_device_retry_async_cancel_cb (gpointer user_data)
+{
+	g_cancellable_cancel (G_CANCELLABLE (user_data));
+	return G_SOURCE_REMOVE;
+}
+
+static void
+fu_device_retry_async_func (void)
+{
+	g_autoptr(FuDevice) device = fu_device_new ();
+	g_autoptr(GCancellable) cancellable = g_cancellable_new ();
+	g_autoptr(GError) error = NULL;
+	FuDeviceRetryHelper helper = {
+		.cnt_success = 0,
+		.cnt_failed = 0,
+	};
+
+	/* success */
+	fu_device_retry_async (device, fu_device_retry_success_3rd_try,
+			       3, 5, 20, &helper, NULL,
+			       fu_device_retry_async_cb, &error);
+	fu_test_loop_run_with_timeout (5000);
+	g_assert_no_error (error);
+	g_assert_cmpint (helper.cnt_success, ==, 1);
+	g_assert_cmpint (helper.cnt_failed, ==, 2);
+
+	/* too many failures */
+	helper.cnt_failed = 0;
+	fu_device_retry_async (device, fu_device_retry_failed,
+			       3, 5, 0, &helper, NULL,
+			       fu_device_retry_async_cb, &error);
+	fu_test_loop_run_with_timeout (5000);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL);
+	g_assert_cmpint (helper.cnt_failed, ==, 3);
+	g_clear_error (&error);
+
+	/* cancelled while waiting for the next try */
+	helper.cnt_failed = 0;
+	fu_device_retry_async (device, fu_device_retry_failed,
+			       3, 60000, 0, &helper, cancellable,
+			       fu_device_retry_async_cb, &error);
+	g_timeout_add (10, fu_device_retry_async_cancel_cb, cancellable);
+	fu_test_loop_run_with_timeout (5000);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	g_assert_cmpint (helper.cnt_failed, ==, 1);
+}
+
+static void
+fu_device_io_stats_func (void)
+{
+	g_autoptr(FuDevice) device = fu_device_new ();
+	g_autoptr(FuDevice) donor = fu_device_new ();
+	g_autoptr(GHashTable) metadata1 = NULL;
+	g_autoptr(GHashTable) metadata2 = NULL;
+	g_autoptr(GHashTable) metadata3 = NULL;
+
+	/* nothing recorded */
+	metadata1 = fu_device_report_io_stats (device);
+	g_assert_cmpint (g_hash_table_size (metadata1), ==, 0);
+
+	/* one transfer in the first, third and last buckets */
+	fu_device_add_io_transfer (device, 64, 0, 50);
+	fu_device_add_io_transfer (device, 0, 32, 5000);
+	fu_device_add_io_transfer (device, 0, 32, 5 * G_USEC_PER_SEC);
+	fu_device_add_phase_duration (device, "Write", 100);
+	fu_device_add_phase_duration (device, "Write", 20);
+	metadata2 = fu_device_report_io_stats (device);
+	g_assert_cmpstr (g_hash_table_lookup (metadata2, "IoBytesRead"), ==, "64");
+	g_assert_cmpstr (g_hash_table_lookup (metadata2, "IoBytesWritten"), ==, "64");
+	g_assert_cmpstr (g_hash_table_lookup (metadata2, "IoTransfers"), ==, "3");
+	g_assert_cmpstr (g_hash_table_lookup (metadata2, "IoLatencyHistogram"), ==, "1,0,1,0,0,1");
+	g_assert_cmpstr (g_hash_table_lookup (metadata2, "DurationWrite"), ==, "120");
+	g_assert_null (g_hash_table_lookup (metadata2, "IoRetries"));
+
+	/* moved from the donor, e.g. after a replug */
+	fu_device_add_io_transfer (donor, 16, 0, 500);
+	fu_device_add_phase_duration (donor, "Detach", 7);
+	fu_device_incorporate_io_stats (device, donor);
+	fu_device_incorporate_io_stats (device, device);
+	metadata3 = fu_device_report_io_stats (device);
+	g_assert_cmpstr (g_hash_table_lookup (metadata3, "IoBytesRead"), ==, "80");
+	g_assert_cmpstr (g_hash_table_lookup (metadata3, "IoTransfers"), ==, "4");
+	g_assert_cmpstr (g_hash_table_lookup (metadata3, "IoLatencyHistogram"), ==, "1,1,1,0,0,1");
+	g_assert_cmpstr (g_hash_table_lookup (metadata3, "DurationDetach"), ==, "7");
+	g_hash_table_unref (metadata1);
+	metadata1 = fu_device_report_io_stats (donor);
+	g_assert_cmpint (g_hash_table_size (metadata1), ==, 0);
+
+	/* cleared */
+	fu_device_reset_io_stats (device);
+	g_hash_table_unref (metadata1);
+	metadata1 = fu_device_report_io_stats (device);
+	g_assert_cmpint (g_hash_table_size (metadata1), ==, 0);
+}
+
+#ifdef HAVE_POSIX_OPENPT
+static void
+fu_io_channel_pty_new (FuIOChannel **host, FuIOChannel **dev)
+{
+	gint fd_master;
+	gint fd_slave;
+	struct termios tio;
+
+	fd_master = posix_openpt (O_RDWR | O_NOCTTY | O_NONBLOCK);
+	g_assert_cmpint (fd_master, >=, 0);
+	g_assert_cmpint (grantpt (fd_master), ==, 0);
+	g_assert_cmpint (unlockpt (fd_master), ==, 0);
+	fd_slave = g_open (ptsname (fd_master), O_RDWR | O_NOCTTY | O_NONBLOCK, 0);
+	g_assert_cmpint (fd_slave, >=, 0);
+	g_assert_cmpint (tcgetattr (fd_slave, &tio), ==, 0);
+	cfmakeraw (&tio);
+	g_assert_cmpint (tcsetattr (fd_slave, TCSANOW, &tio), ==, 0);
+	*host = fu_io_channel_unix_new (fd_master);
+	*dev = fu_io_channel_unix_new (fd_slave);
+}
+
+/* send a 4 byte command and get a 256 byte response, like altos */
+static gdouble
+fu_io_channel_pty_roundtrip (gsize bufsz, guint loops)
+{
+	gboolean ret;
+	guint8 page[0x100] = { 0x0 };
+	g_autoptr(FuIOChannel) dev = NULL;
+	g_autoptr(FuIOChannel) host = NULL;
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	fu_io_channel_pty_new (&host, &dev);
+	fu_io_channel_set_buffer_size (host, bufsz);
+	for (guint i = 0; i < loops; i++) {
+		guint8 cmd[0x10] = { 0x0 };
+		gsize cmdsz = 0;
+		g_autoptr(GError) error = NULL;
+
+		ret = fu_io_channel_write_raw (host, (const guint8 *) "R ", 2, 500,
+					       FU_IO_CHANNEL_FLAG_NONE, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+		ret = fu_io_channel_write_raw (host, (const guint8 *) "0\n", 2, 500,
+					       FU_IO_CHANNEL_FLAG_NONE, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+		ret = fu_io_channel_flush (host, 500, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+		ret = fu_io_channel_read_until (dev, cmd, sizeof(cmd), &cmdsz,
+						(const guint8 *) "\n", 1, 500,
+						FU_IO_CHANNEL_FLAG_NONE, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+		g_assert_cmpint (cmdsz, ==, 4);
+		ret = fu_io_channel_write_raw (dev, page, sizeof(page), 500,
+					       FU_IO_CHANNEL_FLAG_NONE, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+		ret = fu_io_channel_read_until (host, page, sizeof(page), NULL,
+						NULL, 0, 500,
+						FU_IO_CHANNEL_FLAG_NONE, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+	}
+	return (loops * (sizeof(page) + 4)) / (g_timer_elapsed (timer, NULL) * 1024.f);
+}
+#endif
+
+static void
+fu_io_channel_pty_func (void)
+{
+#ifdef HAVE_POSIX_OPENPT
+	gboolean ret;
+	gsize sz = 0;
+	guint8 buf[0x20] = { 0x0 };
+	g_autofree guint8 *big = NULL;
+	g_autoptr(FuIOChannel) dev = NULL;
+	g_autoptr(FuIOChannel) host = NULL;
+	g_autoptr(GError) error = NULL;
+
+	fu_io_channel_pty_new (&host, &dev);
+	fu_io_channel_set_buffer_size (host, 0x100);
+
+	/* coalesced until flushed */
+	ret = fu_io_channel_write_raw (host, (const guint8 *) "R 10", 4, 500,
+				       FU_IO_CHANNEL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = fu_io_channel_read_until (dev, buf, sizeof(buf), NULL,
+					(const guint8 *) "\n", 1, 10,
+					FU_IO_CHANNEL_FLAG_NONE, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT);
+	g_assert_false (ret);
+	g_clear_error (&error);
+	ret = fu_io_channel_write_raw (host, (const guint8 *) "\n", 1, 500,
+				       FU_IO_CHANNEL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = fu_io_channel_flush (host, 500, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = fu_io_channel_read_until (dev, buf, sizeof(buf), &sz,
+					(const guint8 *) "\n", 1, 500,
+					FU_IO_CHANNEL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (sz, ==, 5);
+	g_assert_cmpint (memcmp (buf, "R 10\n", 5), ==, 0);
+
+	/* fixed length, keeping the extra data for the next read */
+	ret = fu_io_channel_write_raw (dev, (const guint8 *) "0123456789ab", 12, 500,
+				       FU_IO_CHANNEL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = fu_io_channel_read_until (host, buf, 8, &sz, NULL, 0, 500,
+					FU_IO_CHANNEL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (sz, ==, 8);
+	g_assert_cmpint (memcmp (buf, "01234567", 8), ==, 0);
+	ret = fu_io_channel_read_until (host, buf, 4, &sz, NULL, 0, 500,
+					FU_IO_CHANNEL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (memcmp (buf, "89ab", 4), ==, 0);
+
+	/* larger than the buffer is written straight away */
+	memset (buf, 'x', sizeof(buf));
+	ret = fu_io_channel_write_raw (host, (const guint8 *) "W", 1, 500,
+				       FU_IO_CHANNEL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	for (guint i = 0; i < 0x10; i++) {
+		ret = fu_io_channel_write_raw (host, buf, sizeof(buf), 500,
+					       FU_IO_CHANNEL_FLAG_NONE, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+	}
+	ret = fu_io_channel_read_until (dev, buf, 1, &sz, NULL, 0, 500,
+					FU_IO_CHANNEL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (buf[0], ==, 'W');
+
+	/* the other end never reads, so the queued data cannot all be sent */
+	big = g_malloc0 (0x100000);
+	ret = fu_io_channel_write_raw (host, big, 0x100000, 50,
+				       FU_IO_CHANNEL_FLAG_NONE, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT);
+	g_assert_false (ret);
+#else
+	g_test_skip ("no posix_openpt() support");
+#endif
+}
+
+static void
+fu_io_channel_pty_performance_func (void)
+{
+#ifdef HAVE_POSIX_OPENPT
+	gdouble unbuffered = fu_io_channel_pty_roundtrip (0, 1000);
+	gdouble buffered = fu_io_channel_pty_roundtrip (0x1000, 1000);
+	g_print ("unbuffered=%.0fKiB/s buffered=%.0fKiB/s ", unbuffered, buffered);
+#else
+	g_test_skip ("no posix_openpt() support");
+#endif
+}
+
+#ifdef HAVE_PWRITE
+/* a regular file stands in for /dev/port, where the offset is the port */
+static FuUdevDevice *
+fu_udev_device_port_new (void)
+{
+	gint fd;
+	guint8 buf[0x400] = { 0x0 };
+	g_autofree gchar *fn = NULL;
+	g_autoptr(FuUdevDevice) udev_device = fu_udev_device_new (NULL);
+	g_autoptr(GError) error = NULL;
+
+	fd = g_file_open_tmp ("fwupd-port-XXXXXX", &fn, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (fd, >, 0);
+	g_assert_cmpint (write (fd, buf, sizeof(buf)), ==, sizeof(buf));
+	g_unlink (fn);
+	fu_udev_device_set_fd (udev_device, fd);
+	return g_steal_pointer (&udev_device);
+}
+#endif
+
+static void
+fu_udev_device_port_transfer_func (void)
+{
+#ifdef HAVE_PWRITE
+	gboolean ret;
+	g_autoptr(FuUdevDevice) udev_device = fu_udev_device_port_new ();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(FuUdevDevice) udev_device_ec = fu_udev_device_port_new ();
+	g_autoptr(GHashTable) metadata = NULL;
+	g_autoptr(GHashTable) metadata_ec = NULL;
+	FuUdevDevicePortIo ops_write[] = {
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WRITE,	  0x2e,	0x20 },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WRITE,	  0x2f,	0x85 },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WRITE,	  0x30,	0x12 },
+	};
+	FuUdevDevicePortIo ops_read[] = {
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_CLEAR, 0x66,	0x02 },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_READ,	  0x2f,	0x0 },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_READ,	  0x30,	0x0 },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_SET,	  0x2e,	0x20 },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_READ,	  0x2e,	0x0 },
+	};
+	FuUdevDevicePortIo ops_timeout[] = {
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_SET,	  0x66,	0x01 },
+	};
+	FuUdevDevicePortIo ops_ec[] = {
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_CLEAR, 0x66,	0x02 },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WRITE,	  0x66,	0x00 },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_CLEAR, 0x66,	0x01 },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_READ,	  0x62,	0x0 },
+	};
+
+	/* writes to consecutive ports are coalesced */
+	ret = fu_udev_device_port_transfer (udev_device, ops_write,
+					    G_N_ELEMENTS(ops_write), 50, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	metadata = fu_device_report_io_stats (FU_DEVICE (udev_device));
+	g_assert_cmpstr (g_hash_table_lookup (metadata, "IoTransfers"), ==, "1");
+	g_assert_cmpstr (g_hash_table_lookup (metadata, "IoBytesWritten"), ==, "3");
+
+	/* status waits and reads */
+	ret = fu_udev_device_port_transfer (udev_device, ops_read,
+					    G_N_ELEMENTS(ops_read), 50, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (ops_read[1].value, ==, 0x85);
+	g_assert_cmpint (ops_read[2].value, ==, 0x12);
+	g_assert_cmpint (ops_read[4].value, ==, 0x20);
+
+	/* the status bit is never set */
+	ret = fu_udev_device_port_transfer (udev_device, ops_timeout,
+					    G_N_ELEMENTS(ops_timeout), 10, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT);
+	g_assert_false (ret);
+	g_clear_error (&error);
+
+	/* the EC status/data handshake uses non-consecutive ports and so
+	 * still needs one syscall for each operation without ioperm() */
+	ret = fu_udev_device_port_transfer (udev_device_ec, ops_ec,
+					    G_N_ELEMENTS(ops_ec), 50, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	metadata_ec = fu_device_report_io_stats (FU_DEVICE (udev_device_ec));
+	g_assert_cmpstr (g_hash_table_lookup (metadata_ec, "IoTransfers"), ==, "4");
+#else
+	g_test_skip ("no pwrite() support");
+#endif
+}
+
+static void
+fu_udev_device_port_transfer_performance_func (void)
+{
+#ifdef HAVE_PWRITE
+	gdouble elapsed_single;
+	gdouble elapsed_batch;
+	const guint loops = 10000;
+	FuUdevDevicePortIo ops[] = {
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_CLEAR, 0x66,	0x02 },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WRITE,	  0x66,	0x00 },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_CLEAR, 0x66,	0x01 },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_READ,	  0x62,	0x0 },
+	};
+	g_autofree FuUdevDevicePortIo *ops_batch = g_new0 (FuUdevDevicePortIo, loops * 4);
+	g_autoptr(FuUdevDevice) udev_device = fu_udev_device_port_new ();
+	gboolean ret;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	/* one transfer for each byte */
+	for (guint i = 0; i < loops; i++) {
+		ret = fu_udev_device_port_transfer (udev_device, ops,
+						    G_N_ELEMENTS(ops), 50, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+	}
+	elapsed_single = g_timer_elapsed (timer, NULL);
+
+	/* one transfer for all bytes */
+	for (guint i = 0; i < loops; i++)
+		memcpy (&ops_batch[i * 4], ops, sizeof(ops));
+	g_timer_reset (timer);
+	ret = fu_udev_device_port_transfer (udev_device, ops_batch,
+					    loops * 4, 50, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	elapsed_batch = g_timer_elapsed (timer, NULL);
+	g_print ("single=%.0fKiB/s batched=%.0fKiB/s ",
+		 loops / (elapsed_single * 1024.f),
+		 loops / (elapsed_batch * 1024.f));
+#else
+	g_test_skip ("no pwrite() support");
+#endif
+}
+
+typedef struct {
+	guint			 n_writes;
+	guint			 n_reads;
+	guint			 n_acks;
+	guint			 n_completed;
+	guint			 in_flight;
+	guint			 in_flight_max;
+	guint			 fail_write;	/* G_MAXUINT for never */
+	guint			 nak_report;	/* G_MAXUINT for never */
+	gboolean		 failed;
+	guint			 writes_after_failure;
+} FuHidDevicePipelineTestHelper;
+
+typedef struct {
+	FuHidDevicePipeline	*pipeline;
+	FuHidDevicePipelineTestHelper *helper;
+	GCancellable		*cancellable;
+	guint8			*buf;		/* for reads */
+	guint			 idx;
+	gboolean		 is_read;
+} FuHidDevicePipelineTestTransfer;
+
+static gboolean
+fu_hid_device_pipeline_test_done_cb (gpointer user_data)
+{
+	FuHidDevicePipelineTestTransfer *xfer = (FuHidDevicePipelineTestTransfer *) user_data;
+	FuHidDevicePipelineTestHelper *helper = xfer->helper;
+	GError *error = NULL;
+
+	/* complete the transfer from the pipeline context, like GUsb does */
+	helper->n_completed++;
+	if (g_cancellable_set_error_if_cancelled (xfer->cancellable, &error)) {
+		/* nothing else to do */
+	} else if (!xfer->is_read && xfer->idx == helper->fail_write) {
+		g_set_error (&error, G_IO_ERROR, G_IO_ERROR_BROKEN_PIPE,
+			     "stall on write 0x%x", xfer->idx);
+		helper->failed = TRUE;
+	} else if (xfer->is_read) {
+		xfer->buf[0] = xfer->idx;
+	}
+	if (!xfer->is_read) {
+		helper->in_flight--;
+		fu_hid_device_pipeline_write_done (xfer->pipeline,
+						   error != NULL ? -1 : 64,
+						   error);
+	} else {
+		fu_hid_device_pipeline_read_done (xfer->pipeline,
+						  error != NULL ? -1 : 1,
+						  error);
+	}
+	g_object_unref (xfer->cancellable);
+	g_free (xfer);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+fu_hid_device_pipeline_test_complete (FuHidDevicePipeline *pipeline,
+				      FuHidDevicePipelineTestHelper *helper,
+				      GCancellable *cancellable,
+				      guint idx,
+				      guint8 *buf)
+{
+	FuHidDevicePipelineTestTransfer *xfer = g_new0 (FuHidDevicePipelineTestTransfer, 1);
+	g_autoptr(GSource) source = g_idle_source_new ();
+	xfer->pipeline = pipeline;
+	xfer->helper = helper;
+	xfer->cancellable = g_object_ref (cancellable);
+	xfer->idx = idx;
+	xfer->buf = buf;
+	xfer->is_read = buf != NULL;
+	g_source_set_callback (source, fu_hid_device_pipeline_test_done_cb, xfer, NULL);
+	g_source_attach (source, g_main_context_get_thread_default ());
+}
+
+static void
+fu_hid_device_pipeline_test_write (FuHidDevicePipeline *pipeline,
+				   GByteArray *report,
+				   GCancellable *cancellable,
+				   gpointer user_data)
+{
+	FuHidDevicePipelineTestHelper *helper = (FuHidDevicePipelineTestHelper *) user_data;
+
+	/* reports are always sent in order */
+	g_assert_cmpint (report->data[0], ==, helper->n_writes);
+	if (helper->failed)
+		helper->writes_after_failure++;
+	helper->in_flight++;
+	helper->in_flight_max = MAX (helper->in_flight_max, helper->in_flight);
+	fu_hid_device_pipeline_test_complete (pipeline, helper, cancellable,
+					      helper->n_writes++, NULL);
+}
+
+static void
+fu_hid_device_pipeline_test_read (FuHidDevicePipeline *pipeline,
+				  guint8 *buf,
+				  gsize bufsz,
+				  GCancellable *cancellable,
+				  gpointer user_data)
+{
+	FuHidDevicePipelineTestHelper *helper = (FuHidDevicePipelineTestHelper *) user_data;
+
+	/* only one acknowledgement is read at a time */
+	g_assert_cmpint (helper->n_reads, ==, helper->n_acks);
+	g_assert_cmpint (helper->n_reads, <, helper->n_writes);
+	g_assert_cmpint (bufsz, >=, 1);
+	fu_hid_device_pipeline_test_complete (pipeline, helper, cancellable,
+					      helper->n_reads++, buf);
+}
+
+static gboolean
+fu_hid_device_pipeline_test_ack (FuHidDevice *self,
+				 const guint8 *buf,
+				 gsize bufsz,
+				 gpointer user_data,
+				 GError **error)
+{
+	FuHidDevicePipelineTestHelper *helper = (FuHidDevicePipelineTestHelper *) user_data;
+
+	/* acknowledged in order */
+	g_assert_cmpint (bufsz, ==, 1);
+	g_assert_cmpint (buf[0], ==, helper->n_acks);
+	if (buf[0] == helper->nak_report) {
+		helper->failed = TRUE;
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+			     "got NAK for 0x%x", buf[0]);
+		return FALSE;
+	}
+	helper->n_acks++;
+	return TRUE;
+}
+
+static GPtrArray *
+fu_hid_device_pipeline_test_reports (guint n)
+{
+	GPtrArray *reports = g_ptr_array_new_with_free_func ((GDestroyNotify) g_byte_array_unref);
+	for (guint i = 0; i < n; i++) {
+		GByteArray *report = g_byte_array_new ();
+		fu_byte_array_append_uint8 (report, i);
+		g_ptr_array_add (reports, report);
+	}
+	return reports;
+}
+
+static void
+fu_hid_device_pipeline_func (void)
+{
+	gboolean ret;
+	g_autoptr(FuHidDevice) hid_device = fu_hid_device_new (NULL);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) reports = fu_hid_device_pipeline_test_reports (20);
+	FuHidDevicePipelineTestHelper helper = {
+		.fail_write = G_MAXUINT,
+		.nak_report = G_MAXUINT,
+	};
+
+	/* the completion of the write is the acknowledgement */
+	fu_hid_device_set_pipeline_window (hid_device, 4);
+	ret = fu_hid_device_run_pipeline (hid_device, reports, NULL, NULL, 0,
+					  fu_hid_device_pipeline_test_write,
+					  fu_hid_device_pipeline_test_read,
+					  &helper, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (helper.n_writes, ==, 20);
+	g_assert_cmpint (helper.n_reads, ==, 0);
+	g_assert_cmpint (helper.in_flight_max, ==, 4);
+	g_assert_cmpint (helper.n_completed, ==, 20);
+}
+
+static void
+fu_hid_device_pipeline_ack_func (void)
+{
+	gboolean ret;
+	g_autoptr(FuHidDevice) hid_device = fu_hid_device_new (NULL);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) reports = fu_hid_device_pipeline_test_reports (20);
+	FuHidDevicePipelineTestHelper helper = {
+		.fail_write = G_MAXUINT,
+		.nak_report = G_MAXUINT,
+	};
+
+	/* no more than the window are sent without an acknowledgement */
+	fu_hid_device_set_pipeline_window (hid_device, 4);
+	ret = fu_hid_device_run_pipeline (hid_device, reports,
+					  fu_hid_device_pipeline_test_ack, &helper, 64,
+					  fu_hid_device_pipeline_test_write,
+					  fu_hid_device_pipeline_test_read,
+					  &helper, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (helper.n_writes, ==, 20);
+	g_assert_cmpint (helper.n_reads, ==, 20);
+	g_assert_cmpint (helper.n_acks, ==, 20);
+	g_assert_cmpint (helper.in_flight_max, <=, 4);
+	g_assert_cmpint (helper.n_completed, ==, 40);
+}
+
+static void
+fu_hid_device_pipeline_cancel_func (void)
+{
+	gboolean ret;
+	g_autoptr(FuHidDevice) hid_device = fu_hid_device_new (NULL);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GError) error_write = NULL;
+	g_autoptr(GPtrArray) reports = fu_hid_device_pipeline_test_reports (20);
+	FuHidDevicePipelineTestHelper helper = {
+		.fail_write = G_MAXUINT,
+		.nak_report = 5,
+	};
+	FuHidDevicePipelineTestHelper helper_write = {
+		.fail_write = 3,
+		.nak_report = G_MAXUINT,
+	};
+
+	/* a NAK stops the pipeline, and the cancelled transfers do not
+	 * replace the first error */
+	fu_hid_device_set_pipeline_window (hid_device, 4);
+	ret = fu_hid_device_run_pipeline (hid_device, reports,
+					  fu_hid_device_pipeline_test_ack, &helper, 64,
+					  fu_hid_device_pipeline_test_write,
+					  fu_hid_device_pipeline_test_read,
+					  &helper, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+	g_assert_false (ret);
+	g_assert_nonnull (g_strstr_len (error->message, -1, "report 0x5 not acknowledged"));
+	g_assert_cmpint (helper.n_acks, ==, 5);
+	g_assert_cmpint (helper.n_writes, ==, 5 + 4);
+	g_assert_cmpint (helper.writes_after_failure, ==, 0);
+
+	/* everything in flight completed before returning */
+	g_assert_cmpint (helper.n_completed, ==, helper.n_writes + helper.n_reads);
+
+	/* a failed write stops the pipeline too */
+	ret = fu_hid_device_run_pipeline (hid_device, reports, NULL, NULL, 0,
+					  fu_hid_device_pipeline_test_write,
+					  fu_hid_device_pipeline_test_read,
+					  &helper_write, &error_write);
+	g_assert_error (error_write, G_IO_ERROR, G_IO_ERROR_BROKEN_PIPE);
+	g_assert_false (ret);
+	g_assert_cmpint (helper_write.n_writes, <=, 3 + 4);
+	g_assert_cmpint (helper_write.writes_after_failure, ==, 0);
+	g_assert_cmpint (helper_write.n_completed, ==, helper_write.n_writes);
+}
+
+typedef struct {
+	guint			 n_submitted;
+	guint			 n_completed;
+	guint			 in_flight;
+	guint			 in_flight_max;
+	guint			 fail_idx;	/* G_MAXUINT for never */
+	guint			 partial_idx;	/* G_MAXUINT for never */
+	guint			 cancel_idx;	/* G_MAXUINT for never */
+	gboolean		 ignore_cancel;
+	gboolean		 failed;
+	goffset			 progress;
+	GCancellable		*cancellable;	/* external */
+} FuUsbBulkPipelineTestHelper;
+
+typedef struct {
+	FuUsbBulkPipelineTransfer *transfer;
+	FuUsbBulkPipelineTestHelper *helper;
+	GCancellable		*cancellable;
+	gsize			 bufsz;
+	guint			 idx;
+} FuUsbBulkPipelineTestTransfer;
+
+static gboolean
+fu_usb_bulk_pipeline_test_done_cb (gpointer user_data)
+{
+	FuUsbBulkPipelineTestTransfer *xfer = (FuUsbBulkPipelineTestTransfer *) user_data;
+	FuUsbBulkPipelineTestHelper *helper = xfer->helper;
+	GError *error = NULL;
+	gssize actual_len = xfer->bufsz;
+
+	/* hardware that already finished cannot be cancelled */
+	helper->in_flight--;
+	helper->n_completed++;
+	if (!helper->ignore_cancel &&
+	    g_cancellable_set_error_if_cancelled (xfer->cancellable, &error)) {
+		actual_len = -1;
+	} else if (xfer->idx == helper->fail_idx) {
+		g_set_error (&error, G_IO_ERROR, G_IO_ERROR_BROKEN_PIPE,
+			     "stall on 0x%x", xfer->idx);
+		actual_len = -1;
+		helper->failed = TRUE;
+	} else if (xfer->idx == helper->partial_idx) {
+		actual_len = xfer->bufsz - 1;
+		helper->failed = TRUE;
+	}
+	fu_usb_bulk_pipeline_transfer_done (xfer->transfer, actual_len, error);
+	g_object_unref (xfer->cancellable);
+	g_free (xfer);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+fu_usb_bulk_pipeline_test_submit (FuUsbBulkPipeline *self,
+				  FuUsbBulkPipelineTransfer *transfer,
+				  guint8 *buf,
+				  gsize bufsz,
+				  GCancellable *cancellable,
+				  gpointer user_data)
+{
+	FuUsbBulkPipelineTestHelper *helper = (FuUsbBulkPipelineTestHelper *) user_data;
+	FuUsbBulkPipelineTestTransfer *xfer = g_new0 (FuUsbBulkPipelineTestTransfer, 1);
+	g_autoptr(GSource) source = g_idle_source_new ();
+
+	/* sent in order, and nothing new after an error */
+	g_assert_false (helper->failed);
+	g_assert_cmpint (buf[0], ==, (helper->n_submitted * 64) & 0xff);
+	if (helper->n_submitted == helper->cancel_idx)
+		g_cancellable_cancel (helper->cancellable);
+
+	/* complete from the pipeline context, like GUsb does */
+	xfer->transfer = transfer;
+	xfer->helper = helper;
+	xfer->cancellable = g_object_ref (cancellable);
+	xfer->bufsz = bufsz;
+	xfer->idx = helper->n_submitted++;
+	helper->in_flight++;
+	helper->in_flight_max = MAX (helper->in_flight_max, helper->in_flight);
+	g_source_set_callback (source, fu_usb_bulk_pipeline_test_done_cb, xfer, NULL);
+	g_source_attach (source, g_main_context_get_thread_default ());
+}
+
+static void
+fu_usb_bulk_pipeline_test_progress_cb (goffset current, goffset total, gpointer user_data)
+{
+	FuUsbBulkPipelineTestHelper *helper = (FuUsbBulkPipelineTestHelper *) user_data;
+	g_assert_cmpint (current, >, helper->progress);
+	helper->progress = current;
+}
+
+static GBytes *
+fu_usb_bulk_pipeline_test_blob (gsize sz)
+{
+	guint8 *buf = g_malloc (sz);
+	for (gsize i = 0; i < sz; i++)
+		buf[i] = i & 0xff;
+	return g_bytes_new_take (buf, sz);
+}
+
+static FuUsbBulkPipeline *
+fu_usb_bulk_pipeline_test_new (FuUsbDevice *usb_device, FuUsbBulkPipelineTestHelper *helper)
+{
+	FuUsbBulkPipeline *pipeline = fu_usb_bulk_pipeline_new (usb_device, 0x01);
+	fu_usb_bulk_pipeline_set_depth (pipeline, 4);
+	fu_usb_bulk_pipeline_set_transfer_size (pipeline, 64);
+	fu_usb_bulk_pipeline_set_submit_func (pipeline, fu_usb_bulk_pipeline_test_submit, helper);
+	return pipeline;
+}
+
+static void
+fu_usb_bulk_pipeline_func (void)
+{
+	gboolean ret;
+	g_autoptr(FuUsbDevice) usb_device = fu_usb_device_new (NULL);
+	g_autoptr(FuUsbBulkPipeline) pipeline = NULL;
+	g_autoptr(GBytes) blob = fu_usb_bulk_pipeline_test_blob (1000);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GHashTable) metadata = NULL;
+	FuUsbBulkPipelineTestHelper helper = {
+		.fail_idx = G_MAXUINT,
+		.partial_idx = G_MAXUINT,
+		.cancel_idx = G_MAXUINT,
+	};
+
+	/* the last transfer is short */
+	pipeline = fu_usb_bulk_pipeline_test_new (usb_device, &helper);
+	ret = fu_usb_bulk_pipeline_write (pipeline, blob,
+					  fu_usb_bulk_pipeline_test_progress_cb, &helper,
+					  NULL, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (helper.n_submitted, ==, 16);
+	g_assert_cmpint (helper.n_completed, ==, 16);
+	g_assert_cmpint (helper.in_flight_max, ==, 4);
+	g_assert_cmpint (helper.progress, ==, 1000);
+	g_assert_cmpfloat (fu_usb_bulk_pipeline_get_throughput (pipeline), >, 0.f);
+	metadata = fu_device_report_io_stats (FU_DEVICE (usb_device));
+	g_assert_cmpstr (g_hash_table_lookup (metadata, "IoTransfers"), ==, "16");
+	g_assert_cmpstr (g_hash_table_lookup (metadata, "IoBytesWritten"), ==, "1000");
+}
+
+static void
+fu_usb_bulk_pipeline_partial_func (void)
+{
+	gboolean ret;
+	g_autoptr(FuUsbDevice) usb_device = fu_usb_device_new (NULL);
+	g_autoptr(FuUsbBulkPipeline) pipeline = NULL;
+	g_autoptr(GBytes) blob = fu_usb_bulk_pipeline_test_blob (1024);
+	g_autoptr(GError) error = NULL;
+	FuUsbBulkPipelineTestHelper helper = {
+		.fail_idx = G_MAXUINT,
+		.partial_idx = 2,
+		.cancel_idx = G_MAXUINT,
+	};
+
+	/* a short transfer cannot be resent, and cancels the rest */
+	pipeline = fu_usb_bulk_pipeline_test_new (usb_device, &helper);
+	ret = fu_usb_bulk_pipeline_write (pipeline, blob,
+					  fu_usb_bulk_pipeline_test_progress_cb, &helper,
+					  NULL, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT);
+	g_assert_false (ret);
+	g_assert_nonnull (g_strstr_len (error->message, -1, "only sent 0x3f/0x40 bytes at 0x80"));
+	g_assert_cmpint (helper.n_submitted, ==, 2 + 4);
+	g_assert_cmpint (helper.n_completed, ==, helper.n_submitted);
+	g_assert_cmpint (helper.progress, ==, 2 * 64);
+}
+
+static void
+fu_usb_bulk_pipeline_first_error_func (void)
+{
+	gboolean ret;
+	g_autoptr(FuUsbDevice) usb_device = fu_usb_device_new (NULL);
+	g_autoptr(FuUsbBulkPipeline) pipeline = NULL;
+	g_autoptr(GBytes) blob = fu_usb_bulk_pipeline_test_blob (1024);
+	g_autoptr(GError) error = NULL;
+	FuUsbBulkPipelineTestHelper helper = {
+		.fail_idx = 1,
+		.partial_idx = 2,
+		.cancel_idx = G_MAXUINT,
+		.ignore_cancel = TRUE,
+	};
+
+	/* the later short transfer does not replace the stall */
+	pipeline = fu_usb_bulk_pipeline_test_new (usb_device, &helper);
+	ret = fu_usb_bulk_pipeline_write (pipeline, blob, NULL, NULL, NULL, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_BROKEN_PIPE);
+	g_assert_false (ret);
+	g_assert_nonnull (g_strstr_len (error->message, -1, "failed to send 0x40 bytes at 0x40"));
+	g_assert_cmpint (helper.n_submitted, ==, 1 + 4);
+	g_assert_cmpint (helper.n_completed, ==, helper.n_submitted);
+}
+
+static void
+fu_usb_bulk_pipeline_cancel_func (void)
+{
+	gboolean ret;
+	g_autoptr(FuUsbDevice) usb_device = fu_usb_device_new (NULL);
+	g_autoptr(FuUsbBulkPipeline) pipeline = NULL;
+	g_autoptr(GBytes) blob = fu_usb_bulk_pipeline_test_blob (1024);
+	g_autoptr(GCancellable) cancellable = g_cancellable_new ();
+	g_autoptr(GError) error = NULL;
+	FuUsbBulkPipelineTestHelper helper = {
+		.fail_idx = G_MAXUINT,
+		.partial_idx = G_MAXUINT,
+		.cancel_idx = 5,
+		.cancellable = cancellable,
+	};
+
+	/* cancelled by the caller while transfers are in flight */
+	pipeline = fu_usb_bulk_pipeline_test_new (usb_device, &helper);
+	ret = fu_usb_bulk_pipeline_write (pipeline, blob,
+					  fu_usb_bulk_pipeline_test_progress_cb, &helper,
+					  cancellable, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	g_assert_false (ret);
+	g_assert_cmpint (helper.n_submitted, ==, 6);
+	g_assert_cmpint (helper.n_completed, ==, helper.n_submitted);
+	g_assert_cmpint (helper.progress, ==, 2 * 64);
+}
+
 static void
 fu_security_attrs_hsi_func (void)
 {
@@ -2487,8 +3695,11 @@ main (int argc, char **argv)
 	g_test_add_func ("/fwupd/common{version}", fu_common_version_func);
 	g_test_add_func ("/fwupd/common{version-semver}", fu_common_version_semver_func);
 	g_test_add_func ("/fwupd/common{vercmp}", fu_common_vercmp_func);
+	g_test_add_func ("/fwupd/common{version-key}", fu_common_version_key_func);
+	g_test_add_func ("/fwupd/common{version-key-performance}", fu_common_version_key_performance_func);
 	g_test_add_func ("/fwupd/common{strstrip}", fu_common_strstrip_func);
 	g_test_add_func ("/fwupd/common{endian}", fu_common_endian_func);
+	g_test_add_func ("/fwupd/verify-cache", fu_verify_cache_func);
 	g_test_add_func ("/fwupd/common{cab-success}", fu_common_store_cab_func);
 	g_test_add_func ("/fwupd/common{cab-success-unsigned}", fu_common_store_cab_unsigned_func);
 	g_test_add_func ("/fwupd/common{cab-success-folder}", fu_common_store_cab_folder_func);
@@ -2505,6 +3716,7 @@ main (int argc, char **argv)
 	g_test_add_func ("/fwupd/common{uri-scheme}", fu_common_uri_scheme_func);
 	g_test_add_func ("/fwupd/efivar", fu_efivar_func);
 	g_test_add_func ("/fwupd/hwids", fu_hwids_func);
+	g_test_add_func ("/fwupd/hwids{cache}", fu_hwids_cache_func);
 	g_test_add_func ("/fwupd/smbios", fu_smbios_func);
 	g_test_add_func ("/fwupd/smbios3", fu_smbios3_func);
 	g_test_add_func ("/fwupd/smbios{dt}", fu_smbios_dt_func);
@@ -2538,5 +3750,20 @@ main (int argc, char **argv)
 	g_test_add_func ("/fwupd/device{retry-success}", fu_device_retry_success_func);
 	g_test_add_func ("/fwupd/device{retry-failed}", fu_device_retry_failed_func);
 	g_test_add_func ("/fwupd/device{retry-hardware}", fu_device_retry_hardware_func);
+	g_test_add_func ("/fwupd/device{retry-backoff}", fu_device_retry_backoff_func);
+	g_test_add_func ("/fwupd/device{retry-async}", fu_device_retry_async_func);
+	g_test_add_func ("/fwupd/device{sleep-iterate}", fu_device_sleep_iterate_func);
+	g_test_add_func ("/fwupd/device{io-stats}", fu_device_io_stats_func);
+	g_test_add_func ("/fwupd/io-channel{pty}", fu_io_channel_pty_func);
+	g_test_add_func ("/fwupd/io-channel{pty-performance}", fu_io_channel_pty_performance_func);
+	g_test_add_func ("/fwupd/udev-device{port-transfer}", fu_udev_device_port_transfer_func);
+	g_test_add_func ("/fwupd/udev-device{port-transfer-performance}", fu_udev_device_port_transfer_performance_func);
+	g_test_add_func ("/fwupd/hid-device{pipeline}", fu_hid_device_pipeline_func);
+	g_test_add_func ("/fwupd/hid-device{pipeline-ack}", fu_hid_device_pipeline_ack_func);
+	g_test_add_func ("/fwupd/hid-device{pipeline-cancel}", fu_hid_device_pipeline_cancel_func);
+	g_test_add_func ("/fwupd/usb-bulk-pipeline", fu_usb_bulk_pipeline_func);
+	g_test_add_func ("/fwupd/usb-bulk-pipeline{partial}", fu_usb_bulk_pipeline_partial_func);
+	g_test_add_func ("/fwupd/usb-bulk-pipeline{first-error}", fu_usb_bulk_pipeline_first_error_func);
+	g_test_add_func ("/fwupd/usb-bulk-pipeline{cancel}", fu_usb_bulk_pipeline_cancel_func);
 	return g_test_run ();
 }
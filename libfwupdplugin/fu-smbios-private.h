@@ -21,3 +21,8 @@ gboolean	 fu_smbios_setup_from_file	(FuSmbios	*self,
 						 const gchar	*filename,
 						 GError		**error)
 						 G_GNUC_WARN_UNUSED_RESULT;
+gboolean	 fu_smbios_setup_with_cache	(FuSmbios	*self,
+						 const gchar	*filename,
+						 GError		**error)
+						 G_GNUC_WARN_UNUSED_RESULT;
+const gchar	*fu_smbios_get_checksum		(FuSmbios	*self);
@@ -9,6 +9,7 @@
 #include "config.h"
 
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 #include <string.h>
 
 #include "fu-common.h"
@@ -19,8 +20,11 @@ struct _FuSmbios {
 	FuFirmware		 parent_instance;
 	guint32			 structure_table_len;
 	GPtrArray		*items;
+	gchar			*checksum;	/* of the raw tables */
 };
 
+#define FU_SMBIOS_CACHE_FORMAT		"(sstua(yqayas))"
+
 /* little endian */
 typedef struct __attribute__((packed)) {
 	gchar			 anchor_str[4];
@@ -332,20 +336,41 @@ fu_smbios_parse_ep64 (FuSmbios *self, const gchar *buf, gsize sz, GError **error
 }
 
 static gboolean
-fu_smbios_setup_from_path_dmi (FuSmbios *self, const gchar *path, GError **error)
+fu_smbios_read_dmi (const gchar *path, GBytes **ep, GBytes **dmi, GError **error)
 {
 	gsize sz = 0;
+	gchar *buf = NULL;
 	g_autofree gchar *dmi_fn = NULL;
-	g_autofree gchar *dmi_raw = NULL;
 	g_autofree gchar *ep_fn = NULL;
-	g_autofree gchar *ep_raw = NULL;
-
-	g_return_val_if_fail (FU_IS_SMBIOS (self), FALSE);
 
 	/* get the smbios entry point */
 	ep_fn = g_build_filename (path, "smbios_entry_point", NULL);
-	if (!g_file_get_contents (ep_fn, &ep_raw, &sz, error))
+	if (!g_file_get_contents (ep_fn, &buf, &sz, error))
 		return FALSE;
+	*ep = g_bytes_new_take (buf, sz);
+
+	/* get the DMI data */
+	dmi_fn = g_build_filename (path, "DMI", NULL);
+	if (!g_file_get_contents (dmi_fn, &buf, &sz, error))
+		return FALSE;
+	*dmi = g_bytes_new_take (buf, sz);
+	return TRUE;
+}
+
+static gchar *
+fu_smbios_compute_checksum (GBytes *ep, GBytes *dmi)
+{
+	g_autoptr(GChecksum) csum = g_checksum_new (G_CHECKSUM_SHA256);
+	g_checksum_update (csum, g_bytes_get_data (ep, NULL), g_bytes_get_size (ep));
+	g_checksum_update (csum, g_bytes_get_data (dmi, NULL), g_bytes_get_size (dmi));
+	return g_strdup (g_checksum_get_string (csum));
+}
+
+static gboolean
+fu_smbios_setup_from_dmi (FuSmbios *self, GBytes *ep, GBytes *dmi, GError **error)
+{
+	gsize sz = 0;
+	const gchar *ep_raw = g_bytes_get_data (ep, &sz);
 
 	/* check we got enough data to read the signature */
 	if (sz < 5) {
@@ -376,10 +401,8 @@ fu_smbios_setup_from_path_dmi (FuSmbios *self, const gchar *path, GError **error
 		return FALSE;
 	}
 
-	/* get the DMI data */
-	dmi_fn = g_build_filename (path, "DMI", NULL);
-	if (!g_file_get_contents (dmi_fn, &dmi_raw, &sz, error))
-		return FALSE;
+	/* check the DMI data */
+	sz = g_bytes_get_size (dmi);
 	if (sz != self->structure_table_len) {
 		g_set_error (error,
 			     FWUPD_ERROR,
@@ -391,7 +414,24 @@ fu_smbios_setup_from_path_dmi (FuSmbios *self, const gchar *path, GError **error
 	}
 
 	/* parse blob */
-	return fu_smbios_setup_from_data (self, (guint8 *) dmi_raw, sz, error);
+	if (!fu_smbios_setup_from_data (self, g_bytes_get_data (dmi, NULL), sz, error))
+		return FALSE;
+	g_free (self->checksum);
+	self->checksum = fu_smbios_compute_checksum (ep, dmi);
+	return TRUE;
+}
+
+static gboolean
+fu_smbios_setup_from_path_dmi (FuSmbios *self, const gchar *path, GError **error)
+{
+	g_autoptr(GBytes) dmi = NULL;
+	g_autoptr(GBytes) ep = NULL;
+
+	g_return_val_if_fail (FU_IS_SMBIOS (self), FALSE);
+
+	if (!fu_smbios_read_dmi (path, &ep, &dmi, error))
+		return FALSE;
+	return fu_smbios_setup_from_dmi (self, ep, dmi, error);
 }
 
 static gboolean
@@ -478,6 +518,185 @@ fu_smbios_setup (FuSmbios *self, GError **error)
 
 }
 
+/* the parser may change in a new version, so the tables are not enough */
+static gchar *
+fu_smbios_get_cache_key (const gchar *checksum)
+{
+	return g_strdup_printf ("%s:%s", PACKAGE_VERSION, checksum);
+}
+
+static gboolean
+fu_smbios_load_cache (FuSmbios *self, const gchar *filename, const gchar *checksum, GError **error)
+{
+	const gchar *key_cache = NULL;
+	const gchar *version = NULL;
+	gsize bufsz = 0;
+	gchar *buf = NULL;
+	guint32 structure_table_len = 0;
+	guint64 version_raw = 0;
+	g_autofree gchar *key = fu_smbios_get_cache_key (checksum);
+	g_autoptr(GVariant) value = NULL;
+	g_autoptr(GVariant) value_tmp = NULL;
+	g_autoptr(GVariantIter) iter = NULL;
+
+	if (!g_file_get_contents (filename, &buf, &bufsz, error))
+		return FALSE;
+	value_tmp = g_variant_new_from_data (G_VARIANT_TYPE (FU_SMBIOS_CACHE_FORMAT),
+					     buf, bufsz, FALSE, g_free, buf);
+	value = g_variant_get_normal_form (value_tmp);
+	g_variant_get (value, FU_SMBIOS_CACHE_FORMAT,
+		       &key_cache, &version, &version_raw,
+		       &structure_table_len, &iter);
+	if (g_strcmp0 (key_cache, key) != 0) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "DMI tables or fwupd version have changed");
+		return FALSE;
+	}
+
+	/* success */
+	g_ptr_array_set_size (self->items, 0);
+	while (TRUE) {
+		FuSmbiosItem *item;
+		const guint8 *data;
+		gsize datasz = 0;
+		guint8 type = 0;
+		guint16 handle = 0;
+		g_autofree const gchar **strings = NULL;
+		g_autoptr(GVariant) data_value = NULL;
+
+		if (!g_variant_iter_next (iter, "(yq@ay^a&s)",
+					  &type, &handle, &data_value, &strings))
+			break;
+		data = g_variant_get_fixed_array (data_value, &datasz, sizeof(guint8));
+		item = g_new0 (FuSmbiosItem, 1);
+		item->type = type;
+		item->handle = handle;
+		item->buf = g_byte_array_sized_new (datasz);
+		item->strings = g_ptr_array_new_with_free_func (g_free);
+		g_byte_array_append (item->buf, data, datasz);
+		for (guint i = 0; strings[i] != NULL; i++)
+			g_ptr_array_add (item->strings, g_strdup (strings[i]));
+		g_ptr_array_add (self->items, item);
+	}
+	self->structure_table_len = structure_table_len;
+	if (version[0] != '\0')
+		fu_firmware_set_version (FU_FIRMWARE (self), version);
+	fu_firmware_set_version_raw (FU_FIRMWARE (self), version_raw);
+	g_free (self->checksum);
+	self->checksum = g_strdup (checksum);
+	return TRUE;
+}
+
+static gboolean
+fu_smbios_save_cache (FuSmbios *self, const gchar *filename, GError **error)
+{
+	const gchar *version = fu_firmware_get_version (FU_FIRMWARE (self));
+	g_autofree gchar *key = fu_smbios_get_cache_key (self->checksum);
+	g_autoptr(GVariant) value = NULL;
+	GVariantBuilder builder;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(yqayas)"));
+	for (guint i = 0; i < self->items->len; i++) {
+		FuSmbiosItem *item = g_ptr_array_index (self->items, i);
+		g_autofree const gchar **strings = g_new0 (const gchar *, item->strings->len + 1);
+		for (guint j = 0; j < item->strings->len; j++)
+			strings[j] = g_ptr_array_index (item->strings, j);
+		g_variant_builder_add (&builder, "(yq@ay^as)",
+				       item->type,
+				       item->handle,
+				       g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE,
+								  item->buf->data,
+								  item->buf->len,
+								  sizeof(guint8)),
+				       strings);
+	}
+	value = g_variant_ref_sink (g_variant_new (FU_SMBIOS_CACHE_FORMAT,
+						   key,
+						   version != NULL ? version : "",
+						   fu_firmware_get_version_raw (FU_FIRMWARE (self)),
+						   self->structure_table_len,
+						   &builder));
+	if (!fu_common_mkdir_parent (filename, error))
+		return FALSE;
+	return g_file_set_contents (filename,
+				    g_variant_get_data (value),
+				    g_variant_get_size (value),
+				    error);
+}
+
+/**
+ * fu_smbios_setup_with_cache:
+ * @self: A #FuSmbios
+ * @filename: A cache filename, e.g. `/var/cache/fwupd/smbios.cache`
+ * @error: A #GError or %NULL
+ *
+ * Reads all the SMBIOS values from the hardware, using the previously parsed
+ * values if the raw DMI tables have not changed since @filename was saved.
+ *
+ * The cache is only used for DMI tables, and @filename is updated if the
+ * tables have changed.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_smbios_setup_with_cache (FuSmbios *self, const gchar *filename, GError **error)
+{
+	g_autofree gchar *checksum = NULL;
+	g_autofree gchar *path = NULL;
+	g_autofree gchar *sysfsfwdir = NULL;
+	g_autoptr(GBytes) dmi = NULL;
+	g_autoptr(GBytes) ep = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	g_return_val_if_fail (FU_IS_SMBIOS (self), FALSE);
+	g_return_val_if_fail (filename != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* DT is not cached */
+	sysfsfwdir = fu_common_get_path (FU_PATH_KIND_SYSFSDIR_FW);
+	path = g_build_filename (sysfsfwdir, "dmi", "tables", NULL);
+	if (!g_file_test (path, G_FILE_TEST_EXISTS))
+		return fu_smbios_setup (self, error);
+
+	/* the raw tables have to be read anyway to validate the cache */
+	if (!fu_smbios_read_dmi (path, &ep, &dmi, error))
+		return FALSE;
+	checksum = fu_smbios_compute_checksum (ep, dmi);
+	if (fu_smbios_load_cache (self, filename, checksum, &error_local))
+		return TRUE;
+	g_debug ("ignoring SMBIOS cache: %s", error_local->message);
+
+	/* parse and save for next time */
+	if (!fu_smbios_setup_from_dmi (self, ep, dmi, error))
+		return FALSE;
+	g_clear_error (&error_local);
+	if (!fu_smbios_save_cache (self, filename, &error_local))
+		g_debug ("failed to save SMBIOS cache: %s", error_local->message);
+	return TRUE;
+}
+
+/**
+ * fu_smbios_get_checksum:
+ * @self: A #FuSmbios
+ *
+ * Gets the SHA256 checksum of the raw DMI tables, which changes when the
+ * system firmware is updated.
+ *
+ * Returns: a checksum, or %NULL if not loaded from DMI tables
+ *
+ * Since: 1.5.8
+ **/
+const gchar *
+fu_smbios_get_checksum (FuSmbios *self)
+{
+	g_return_val_if_fail (FU_IS_SMBIOS (self), NULL);
+	return self->checksum;
+}
+
 static void
 fu_smbios_to_string_internal (FuFirmware *firmware, guint idt, GString *str)
 {
@@ -679,6 +898,7 @@ fu_smbios_finalize (GObject *object)
 {
 	FuSmbios *self = FU_SMBIOS (object);
 	g_ptr_array_unref (self->items);
+	g_free (self->checksum);
 	G_OBJECT_CLASS (fu_smbios_parent_class)->finalize (object);
 }
 
@@ -9,3 +9,7 @@
 #include "fu-udev-device.h"
 
 void		 fu_udev_device_emit_changed		(FuUdevDevice	*self);
+void		 fu_udev_device_prefetch_prepare	(FuUdevDevice	*self);
+gboolean	 fu_udev_device_prefetch		(FuUdevDevice	*self,
+							 GError		**error);
+void		 fu_udev_device_prefetch_clear		(FuUdevDevice	*self);
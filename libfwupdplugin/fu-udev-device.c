@@ -16,6 +16,10 @@
 #ifdef HAVE_IOCTL_H
 #include <sys/ioctl.h>
 #endif
+#if defined(HAVE_IO_H) && (defined(__i386__) || defined(__x86_64__))
+#include <sys/io.h>
+#define FU_UDEV_DEVICE_HAVE_IOPERM
+#endif
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -47,8 +51,19 @@ typedef struct
 	gchar			*device_file;
 	gint			 fd;
 	FuUdevDeviceFlags	 flags;
+	gboolean		 ioperm_denied;
+	GPtrArray		*prefetch;	/* (nullable) of FuUdevDevicePrefetchItem */
 } FuUdevDevicePrivate;
 
+typedef struct {
+	gchar			*sysfs_path;
+	gchar			*subsystem;
+	gchar			*name;
+	GHashTable		*attrs;		/* name : value (nullable) */
+	GHashTable		*props;		/* (nullable) key : value */
+	gint			 parent_i2c;	/* -1 for unknown */
+} FuUdevDevicePrefetchItem;
+
 G_DEFINE_TYPE_WITH_PRIVATE (FuUdevDevice, fu_udev_device, FU_TYPE_DEVICE)
 
 enum {
@@ -69,6 +84,290 @@ static guint signals[SIGNAL_LAST] = { 0 };
 
 #define GET_PRIVATE(o) (fu_udev_device_get_instance_private (o))
 
+static void
+fu_udev_device_prefetch_item_free (FuUdevDevicePrefetchItem *item)
+{
+	g_free (item->sysfs_path);
+	g_free (item->subsystem);
+	g_free (item->name);
+	g_hash_table_unref (item->attrs);
+	if (item->props != NULL)
+		g_hash_table_unref (item->props);
+	g_free (item);
+}
+
+#ifdef HAVE_GUDEV
+/* everything that fu_udev_device_probe() reads from sysfs */
+static const gchar *fu_udev_device_prefetch_attrs[] = {
+	"vendor",
+	"device",
+	"revision",
+	"subsystem_vendor",
+	"subsystem_device",
+	"class",
+	"name",
+	NULL };
+
+static FuUdevDevicePrefetchItem *
+fu_udev_device_prefetch_item_new (GUdevDevice *udev_device)
+{
+	FuUdevDevicePrefetchItem *item = g_new0 (FuUdevDevicePrefetchItem, 1);
+	item->sysfs_path = g_strdup (g_udev_device_get_sysfs_path (udev_device));
+	item->subsystem = g_strdup (g_udev_device_get_subsystem (udev_device));
+	item->name = g_strdup (g_udev_device_get_name (udev_device));
+	item->attrs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	item->parent_i2c = -1;
+	return item;
+}
+
+static FuUdevDevicePrefetchItem *
+fu_udev_device_prefetch_find (FuUdevDevice *self, GUdevDevice *udev_device)
+{
+	FuUdevDevicePrivate *priv = GET_PRIVATE (self);
+	if (priv->prefetch == NULL || udev_device == NULL)
+		return NULL;
+	for (guint i = 0; i < priv->prefetch->len; i++) {
+		FuUdevDevicePrefetchItem *item = g_ptr_array_index (priv->prefetch, i);
+		if (g_strcmp0 (item->sysfs_path,
+			       g_udev_device_get_sysfs_path (udev_device)) == 0)
+			return item;
+	}
+	return NULL;
+}
+
+/* use the prefetched value if there is one, otherwise ask libudev */
+static const gchar *
+fu_udev_device_get_sysfs_attr_cached (FuUdevDevice *self,
+				      GUdevDevice *udev_device,
+				      const gchar *name)
+{
+	FuUdevDevicePrefetchItem *item = fu_udev_device_prefetch_find (self, udev_device);
+	gpointer value = NULL;
+	if (item != NULL &&
+	    g_hash_table_lookup_extended (item->attrs, name, NULL, &value))
+		return value;
+	return g_udev_device_get_sysfs_attr (udev_device, name);
+}
+
+static const gchar *
+fu_udev_device_get_property_cached (FuUdevDevice *self,
+				    GUdevDevice *udev_device,
+				    const gchar *key)
+{
+	FuUdevDevicePrefetchItem *item = fu_udev_device_prefetch_find (self, udev_device);
+	if (item != NULL && item->props != NULL)
+		return g_hash_table_lookup (item->props, key);
+	return g_udev_device_get_property (udev_device, key);
+}
+
+static void
+fu_udev_device_prefetch_parse_props (GHashTable *props,
+				     const gchar *buf,
+				     const gchar *prefix)
+{
+	g_auto(GStrv) lines = g_strsplit (buf, "\n", -1);
+	for (guint i = 0; lines[i] != NULL; i++) {
+		const gchar *line = lines[i];
+		const gchar *eq;
+		if (prefix != NULL) {
+			if (!g_str_has_prefix (line, prefix))
+				continue;
+			line += strlen (prefix);
+		}
+		eq = strchr (line, '=');
+		if (eq == NULL)
+			continue;
+		g_hash_table_insert (props,
+				     g_strndup (line, eq - line),
+				     g_strdup (eq + 1));
+	}
+}
+
+/* the kernel properties are in uevent and the ones added by the udev rules
+ * are in the udev database, which is what libudev reads too */
+static gboolean
+fu_udev_device_prefetch_item_load_props (FuUdevDevicePrefetchItem *item, GError **error)
+{
+	const gchar *major;
+	const gchar *minor;
+	g_autofree gchar *buf = NULL;
+	g_autofree gchar *db_fn = NULL;
+	g_autofree gchar *uevent_fn = NULL;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GHashTable) props = NULL;
+
+	/* the database file name needs the ifindex, so let libudev do this */
+	if (item->subsystem == NULL || g_strcmp0 (item->subsystem, "net") == 0)
+		return TRUE;
+
+	props = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	uevent_fn = g_build_filename (item->sysfs_path, "uevent", NULL);
+	if (!g_file_get_contents (uevent_fn, &buf, NULL, error))
+		return FALSE;
+	fu_udev_device_prefetch_parse_props (props, buf, NULL);
+	g_clear_pointer (&buf, g_free);
+
+	major = g_hash_table_lookup (props, "MAJOR");
+	minor = g_hash_table_lookup (props, "MINOR");
+	if (major != NULL && minor != NULL && g_strcmp0 (major, "0") != 0) {
+		db_fn = g_strdup_printf ("/run/udev/data/%c%s:%s",
+					 g_strcmp0 (item->subsystem, "block") == 0 ? 'b' : 'c',
+					 major, minor);
+	} else {
+		db_fn = g_strdup_printf ("/run/udev/data/+%s:%s",
+					 item->subsystem, item->name);
+	}
+	if (!g_file_get_contents (db_fn, &buf, NULL, &error_local)) {
+		if (!g_error_matches (error_local, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+			g_propagate_error (error, g_steal_pointer (&error_local));
+			return FALSE;
+		}
+	} else {
+		fu_udev_device_prefetch_parse_props (props, buf, "E:");
+	}
+
+	/* success */
+	item->props = g_steal_pointer (&props);
+	return TRUE;
+}
+
+/* same as g_udev_device_get_parent_with_subsystem() but only using sysfs */
+static gboolean
+fu_udev_device_prefetch_has_parent_subsystem (const gchar *sysfs_path,
+					      const gchar *subsystem)
+{
+	g_autofree gchar *path = g_path_get_dirname (sysfs_path);
+	while (g_str_has_prefix (path, "/sys/")) {
+		g_autofree gchar *fn = g_build_filename (path, "subsystem", NULL);
+		g_autofree gchar *target = g_file_read_link (fn, NULL);
+		gchar *tmp;
+		if (target != NULL) {
+			g_autofree gchar *basename = g_path_get_basename (target);
+			if (g_strcmp0 (basename, subsystem) == 0)
+				return TRUE;
+		}
+		tmp = g_path_get_dirname (path);
+		g_free (path);
+		path = tmp;
+	}
+	return FALSE;
+}
+#endif
+
+/**
+ * fu_udev_device_prefetch_prepare:
+ * @self: A #FuUdevDevice
+ *
+ * Gets the sysfs paths of the device and the parent ready for
+ * fu_udev_device_prefetch(). This uses libudev and so has to be called from
+ * the main thread.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_udev_device_prefetch_prepare (FuUdevDevice *self)
+{
+	FuUdevDevicePrivate *priv = GET_PRIVATE (self);
+#ifdef HAVE_GUDEV
+	g_autoptr(GUdevDevice) udev_parent = NULL;
+#endif
+
+	g_return_if_fail (FU_IS_UDEV_DEVICE (self));
+
+	if (priv->prefetch != NULL)
+		g_ptr_array_unref (priv->prefetch);
+	priv->prefetch = g_ptr_array_new_with_free_func ((GDestroyNotify) fu_udev_device_prefetch_item_free);
+#ifdef HAVE_GUDEV
+	if (priv->udev_device == NULL)
+		return;
+	g_ptr_array_add (priv->prefetch,
+			 fu_udev_device_prefetch_item_new (priv->udev_device));
+	udev_parent = g_udev_device_get_parent (priv->udev_device);
+	if (udev_parent != NULL) {
+		g_ptr_array_add (priv->prefetch,
+				 fu_udev_device_prefetch_item_new (udev_parent));
+	}
+#endif
+}
+
+/**
+ * fu_udev_device_prefetch:
+ * @self: A #FuUdevDevice
+ * @error: A #GError, or %NULL
+ *
+ * Reads the sysfs attributes and properties that are used by
+ * fu_device_probe() for the device and the parent, without using libudev.
+ * This is safe to call from a worker thread as long as nothing else is
+ * using the device.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_udev_device_prefetch (FuUdevDevice *self, GError **error)
+{
+	FuUdevDevicePrivate *priv = GET_PRIVATE (self);
+
+	g_return_val_if_fail (FU_IS_UDEV_DEVICE (self), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* not prepared */
+	if (priv->prefetch == NULL)
+		return TRUE;
+
+#ifdef HAVE_GUDEV
+	for (guint i = 0; i < priv->prefetch->len; i++) {
+		FuUdevDevicePrefetchItem *item = g_ptr_array_index (priv->prefetch, i);
+		for (guint j = 0; fu_udev_device_prefetch_attrs[j] != NULL; j++) {
+			const gchar *attr = fu_udev_device_prefetch_attrs[j];
+			g_autofree gchar *fn = g_build_filename (item->sysfs_path, attr, NULL);
+			gchar *value = NULL;
+
+			/* libudev only strips the trailing newlines */
+			if (g_file_get_contents (fn, &value, NULL, NULL)) {
+				gsize len = strlen (value);
+				while (len > 0 && value[len - 1] == '\n')
+					value[--len] = '\0';
+			}
+			g_hash_table_insert (item->attrs, g_strdup (attr), value);
+		}
+		if (!fu_udev_device_prefetch_item_load_props (item, error)) {
+			g_prefix_error (error, "failed to load %s: ", item->sysfs_path);
+			return FALSE;
+		}
+	}
+
+	/* determine if we're wired internally */
+	if (priv->prefetch->len > 0) {
+		FuUdevDevicePrefetchItem *item = g_ptr_array_index (priv->prefetch, 0);
+		item->parent_i2c = fu_udev_device_prefetch_has_parent_subsystem (item->sysfs_path, "i2c");
+	}
+#endif
+
+	/* success */
+	return TRUE;
+}
+
+/**
+ * fu_udev_device_prefetch_clear:
+ * @self: A #FuUdevDevice
+ *
+ * Drops the values read by fu_udev_device_prefetch(), which are shared with
+ * any device that has incorporated this one, so that a rescan reads the
+ * current values.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_udev_device_prefetch_clear (FuUdevDevice *self)
+{
+	FuUdevDevicePrivate *priv = GET_PRIVATE (self);
+	g_return_if_fail (FU_IS_UDEV_DEVICE (self));
+	if (priv->prefetch != NULL)
+		g_ptr_array_set_size (priv->prefetch, 0);
+}
+
 /**
  * fu_udev_device_emit_changed:
  * @self: A #FuUdevDevice
@@ -89,10 +388,12 @@ fu_udev_device_emit_changed (FuUdevDevice *self)
 }
 
 static guint32
-fu_udev_device_get_sysfs_attr_as_uint32 (GUdevDevice *udev_device, const gchar *name)
+fu_udev_device_get_sysfs_attr_as_uint32 (FuUdevDevice *self,
+					 GUdevDevice *udev_device,
+					 const gchar *name)
 {
 #ifdef HAVE_GUDEV
-	guint64 tmp = fu_common_strtoull (g_udev_device_get_sysfs_attr (udev_device, name));
+	guint64 tmp = fu_common_strtoull (fu_udev_device_get_sysfs_attr_cached (self, udev_device, name));
 	if (tmp > G_MAXUINT32) {
 		g_warning ("reading %s for %s overflowed",
 			   name,
@@ -106,10 +407,12 @@ fu_udev_device_get_sysfs_attr_as_uint32 (GUdevDevice *udev_device, const gchar *
 }
 
 static guint8
-fu_udev_device_get_sysfs_attr_as_uint8 (GUdevDevice *udev_device, const gchar *name)
+fu_udev_device_get_sysfs_attr_as_uint8 (FuUdevDevice *self,
+					GUdevDevice *udev_device,
+					const gchar *name)
 {
 #ifdef HAVE_GUDEV
-	guint64 tmp = fu_common_strtoull (g_udev_device_get_sysfs_attr (udev_device, name));
+	guint64 tmp = fu_common_strtoull (fu_udev_device_get_sysfs_attr_cached (self, udev_device, name));
 	if (tmp > G_MAXUINT8) {
 		g_warning ("reading %s for %s overflowed",
 			   name,
@@ -218,13 +521,13 @@ fu_udev_device_set_device_file (FuUdevDevice *self, const gchar *device_file)
 
 #ifdef HAVE_GUDEV
 static const gchar *
-fu_udev_device_get_vendor_fallback (GUdevDevice *udev_device)
+fu_udev_device_get_vendor_fallback (FuUdevDevice *self, GUdevDevice *udev_device)
 {
 	const gchar *tmp;
-	tmp = g_udev_device_get_property (udev_device, "ID_VENDOR_FROM_DATABASE");
+	tmp = fu_udev_device_get_property_cached (self, udev_device, "ID_VENDOR_FROM_DATABASE");
 	if (tmp != NULL)
 		return tmp;
-	tmp = g_udev_device_get_property (udev_device, "ID_VENDOR");
+	tmp = fu_udev_device_get_property_cached (self, udev_device, "ID_VENDOR");
 	if (tmp != NULL)
 		return tmp;
 	return NULL;
@@ -236,7 +539,7 @@ static gboolean
 fu_udev_device_probe_i2c_dev (FuUdevDevice *self, GError **error)
 {
 	FuUdevDevicePrivate *priv = GET_PRIVATE (self);
-	const gchar *name = g_udev_device_get_sysfs_attr (priv->udev_device, "name");
+	const gchar *name = fu_udev_device_get_sysfs_attr_cached (self, priv->udev_device, "name");
 	if (name != NULL) {
 		g_autofree gchar *devid = NULL;
 		g_autofree gchar *name_safe = g_strdup (name);
@@ -254,7 +557,7 @@ fu_udev_device_probe_serio (FuUdevDevice *self, GError **error)
 	const gchar *tmp;
 
 	/* firmware ID */
-	tmp = g_udev_device_get_property (priv->udev_device, "SERIO_FIRMWARE_ID");
+	tmp = fu_udev_device_get_property_cached (self, priv->udev_device, "SERIO_FIRMWARE_ID");
 	if (tmp != NULL) {
 		g_autofree gchar *devid = NULL;
 		g_autofree gchar *id_safe = NULL;
@@ -277,6 +580,7 @@ fu_udev_device_probe (FuDevice *device, GError **error)
 	FuUdevDevice *self = FU_UDEV_DEVICE (device);
 	FuUdevDevicePrivate *priv = GET_PRIVATE (self);
 #ifdef HAVE_GUDEV
+	FuUdevDevicePrefetchItem *item;
 	const gchar *tmp;
 	g_autofree gchar *subsystem = NULL;
 	g_autoptr(GUdevDevice) udev_parent = NULL;
@@ -288,11 +592,11 @@ fu_udev_device_probe (FuDevice *device, GError **error)
 		return TRUE;
 
 	/* set ven:dev:rev */
-	priv->vendor = fu_udev_device_get_sysfs_attr_as_uint32 (priv->udev_device, "vendor");
-	priv->model = fu_udev_device_get_sysfs_attr_as_uint32 (priv->udev_device, "device");
-	priv->revision = fu_udev_device_get_sysfs_attr_as_uint8 (priv->udev_device, "revision");
-	priv->subsystem_vendor = fu_udev_device_get_sysfs_attr_as_uint32 (priv->udev_device, "subsystem_vendor");
-	priv->subsystem_model = fu_udev_device_get_sysfs_attr_as_uint32 (priv->udev_device, "subsystem_device");
+	priv->vendor = fu_udev_device_get_sysfs_attr_as_uint32 (self, priv->udev_device, "vendor");
+	priv->model = fu_udev_device_get_sysfs_attr_as_uint32 (self, priv->udev_device, "device");
+	priv->revision = fu_udev_device_get_sysfs_attr_as_uint8 (self, priv->udev_device, "revision");
+	priv->subsystem_vendor = fu_udev_device_get_sysfs_attr_as_uint32 (self, priv->udev_device, "subsystem_vendor");
+	priv->subsystem_model = fu_udev_device_get_sysfs_attr_as_uint32 (self, priv->udev_device, "subsystem_device");
 
 #ifdef HAVE_GUDEV
 	/* fallback to the parent */
@@ -300,18 +604,18 @@ fu_udev_device_probe (FuDevice *device, GError **error)
 	if (udev_parent != NULL &&
 	    priv->flags & FU_UDEV_DEVICE_FLAG_VENDOR_FROM_PARENT &&
 	    priv->vendor == 0x0 && priv->model == 0x0 && priv->revision == 0x0) {
-		priv->vendor = fu_udev_device_get_sysfs_attr_as_uint32 (udev_parent, "vendor");
-		priv->model = fu_udev_device_get_sysfs_attr_as_uint32 (udev_parent, "device");
-		priv->revision = fu_udev_device_get_sysfs_attr_as_uint8 (udev_parent, "revision");
-		priv->subsystem_vendor = fu_udev_device_get_sysfs_attr_as_uint32 (udev_parent, "subsystem_vendor");
-		priv->subsystem_model = fu_udev_device_get_sysfs_attr_as_uint32 (udev_parent, "subsystem_device");
+		priv->vendor = fu_udev_device_get_sysfs_attr_as_uint32 (self, udev_parent, "vendor");
+		priv->model = fu_udev_device_get_sysfs_attr_as_uint32 (self, udev_parent, "device");
+		priv->revision = fu_udev_device_get_sysfs_attr_as_uint8 (self, udev_parent, "revision");
+		priv->subsystem_vendor = fu_udev_device_get_sysfs_attr_as_uint32 (self, udev_parent, "subsystem_vendor");
+		priv->subsystem_model = fu_udev_device_get_sysfs_attr_as_uint32 (self, udev_parent, "subsystem_device");
 	}
 
 	/* hidraw helpfully encodes the information in a different place */
 	if (udev_parent != NULL &&
 	    priv->vendor == 0x0 && priv->model == 0x0 && priv->revision == 0x0 &&
 	    g_strcmp0 (priv->subsystem, "hidraw") == 0) {
-		tmp = g_udev_device_get_property (udev_parent, "HID_ID");
+		tmp = fu_udev_device_get_property_cached (self, udev_parent, "HID_ID");
 		if (tmp != NULL) {
 			g_auto(GStrv) split = g_strsplit (tmp, ":", -1);
 			if (g_strv_length (split) == 3) {
@@ -333,7 +637,7 @@ fu_udev_device_probe (FuDevice *device, GError **error)
 				}
 			}
 		}
-		tmp = g_udev_device_get_property (udev_parent, "HID_NAME");
+		tmp = fu_udev_device_get_property_cached (self, udev_parent, "HID_NAME");
 		if (tmp != NULL) {
 			if (fu_device_get_name (device) == NULL)
 				fu_device_set_name (device, tmp);
@@ -352,18 +656,18 @@ fu_udev_device_probe (FuDevice *device, GError **error)
 
 	/* set model */
 	if (fu_device_get_name (device) == NULL) {
-		tmp = g_udev_device_get_property (priv->udev_device, "ID_MODEL_FROM_DATABASE");
+		tmp = fu_udev_device_get_property_cached (self, priv->udev_device, "ID_MODEL_FROM_DATABASE");
 		if (tmp == NULL)
-			tmp = g_udev_device_get_property (priv->udev_device, "ID_MODEL");
+			tmp = fu_udev_device_get_property_cached (self, priv->udev_device, "ID_MODEL");
 		if (tmp == NULL)
-			tmp = g_udev_device_get_property (priv->udev_device, "ID_PCI_CLASS_FROM_DATABASE");
+			tmp = fu_udev_device_get_property_cached (self, priv->udev_device, "ID_PCI_CLASS_FROM_DATABASE");
 		if (tmp != NULL)
 			fu_device_set_name (device, tmp);
 	}
 
 	/* set vendor */
 	if (fu_device_get_vendor (device) == NULL) {
-		tmp = fu_udev_device_get_vendor_fallback (priv->udev_device);
+		tmp = fu_udev_device_get_vendor_fallback (self, priv->udev_device);
 		if (tmp != NULL)
 			fu_device_set_vendor (device, tmp);
 	}
@@ -374,7 +678,7 @@ fu_udev_device_probe (FuDevice *device, GError **error)
 		g_autoptr(GUdevDevice) device_tmp = g_object_ref (udev_parent);
 		for (guint i = 0; i < 0xff; i++) {
 			g_autoptr(GUdevDevice) parent = NULL;
-			tmp = fu_udev_device_get_vendor_fallback (device_tmp);
+			tmp = fu_udev_device_get_vendor_fallback (self, device_tmp);
 			if (tmp != NULL) {
 				fu_device_set_vendor (device, tmp);
 				break;
@@ -388,9 +692,9 @@ fu_udev_device_probe (FuDevice *device, GError **error)
 
 	/* set serial */
 	if (fu_device_get_serial (device) == NULL) {
-		tmp = g_udev_device_get_property (priv->udev_device, "ID_SERIAL_SHORT");
+		tmp = fu_udev_device_get_property_cached (self, priv->udev_device, "ID_SERIAL_SHORT");
 		if (tmp == NULL)
-			tmp = g_udev_device_get_property (priv->udev_device, "ID_SERIAL");
+			tmp = fu_udev_device_get_property_cached (self, priv->udev_device, "ID_SERIAL");
 		if (tmp != NULL)
 			fu_device_set_serial (device, tmp);
 	}
@@ -398,7 +702,7 @@ fu_udev_device_probe (FuDevice *device, GError **error)
 	/* set revision */
 	if (fu_device_get_version (device) == NULL &&
 	    fu_device_get_version_format (device) == FWUPD_VERSION_FORMAT_UNKNOWN) {
-		tmp = g_udev_device_get_property (priv->udev_device, "ID_REVISION");
+		tmp = fu_udev_device_get_property_cached (self, priv->udev_device, "ID_REVISION");
 		if (tmp != NULL)
 			fu_device_set_version (device, tmp);
 	}
@@ -449,7 +753,7 @@ fu_udev_device_probe (FuDevice *device, GError **error)
 	}
 
 	/* add device class */
-	tmp = g_udev_device_get_sysfs_attr (priv->udev_device, "class");
+	tmp = fu_udev_device_get_sysfs_attr_cached (self, priv->udev_device, "class");
 	if (tmp != NULL && g_str_has_prefix (tmp, "0x")) {
 		g_autofree gchar *class_id = g_utf8_strup (tmp + 2, -1);
 		g_autofree gchar *devid = NULL;
@@ -490,10 +794,16 @@ fu_udev_device_probe (FuDevice *device, GError **error)
 	}
 
 	/* determine if we're wired internally */
-	parent_i2c = g_udev_device_get_parent_with_subsystem (priv->udev_device,
-							      "i2c", NULL);
-	if (parent_i2c != NULL)
-		fu_device_add_flag (device, FWUPD_DEVICE_FLAG_INTERNAL);
+	item = fu_udev_device_prefetch_find (self, priv->udev_device);
+	if (item != NULL && item->parent_i2c != -1) {
+		if (item->parent_i2c)
+			fu_device_add_flag (device, FWUPD_DEVICE_FLAG_INTERNAL);
+	} else {
+		parent_i2c = g_udev_device_get_parent_with_subsystem (priv->udev_device,
+								      "i2c", NULL);
+		if (parent_i2c != NULL)
+			fu_device_add_flag (device, FWUPD_DEVICE_FLAG_INTERNAL);
+	}
 #endif
 
 	/* subclassed */
@@ -735,11 +1045,17 @@ fu_udev_device_incorporate (FuDevice *self, FuDevice *donor)
 	FuUdevDevice *uself = FU_UDEV_DEVICE (self);
 	FuUdevDevice *udonor = FU_UDEV_DEVICE (donor);
 	FuUdevDevicePrivate *priv = GET_PRIVATE (uself);
+	FuUdevDevicePrivate *priv_donor = GET_PRIVATE (udonor);
 
 	g_return_if_fail (FU_IS_UDEV_DEVICE (self));
 	g_return_if_fail (FU_IS_UDEV_DEVICE (donor));
 
 	fu_udev_device_set_dev (uself, fu_udev_device_get_dev (udonor));
+	if (priv_donor->prefetch != NULL) {
+		if (priv->prefetch != NULL)
+			g_ptr_array_unref (priv->prefetch);
+		priv->prefetch = g_ptr_array_ref (priv_donor->prefetch);
+	}
 	if (priv->device_file == NULL) {
 		fu_udev_device_set_subsystem (uself, fu_udev_device_get_subsystem (udonor));
 		fu_udev_device_set_device_file (uself, fu_udev_device_get_device_file (udonor));
@@ -1292,6 +1608,24 @@ fu_udev_device_close (FuDevice *device, GError **error)
 	return TRUE;
 }
 
+#ifdef HAVE_IOCTL_H
+/* requests that send a command to the device and read the result back, such
+ * as the HID feature reports and the MMC and NVMe passthrough commands; the
+ * others, e.g. I2C_SLAVE or HIDIOCGRAWINFO, only get or set driver state */
+static gboolean
+fu_udev_device_ioctl_is_transfer (gulong request)
+{
+	/* SG_IO predates the direction and size encoding */
+	if (request == 0x2285)
+		return TRUE;
+#if defined(_IOC_DIR) && defined(_IOC_READ) && defined(_IOC_WRITE)
+	return _IOC_DIR (request) == (_IOC_READ | _IOC_WRITE);
+#else
+	return TRUE;
+#endif
+}
+#endif
+
 /**
  * fu_udev_device_ioctl:
  * @self: A #FuUdevDevice
@@ -1316,6 +1650,7 @@ fu_udev_device_ioctl (FuUdevDevice *self,
 #ifdef HAVE_IOCTL_H
 	FuUdevDevicePrivate *priv = GET_PRIVATE (self);
 	gint rc_tmp;
+	gint64 start;
 
 	g_return_val_if_fail (FU_IS_UDEV_DEVICE (self), FALSE);
 	g_return_val_if_fail (request != 0x0, FALSE);
@@ -1323,7 +1658,12 @@ fu_udev_device_ioctl (FuUdevDevice *self,
 	g_return_val_if_fail (priv->fd > 0, FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
+	start = g_get_monotonic_time ();
 	rc_tmp = ioctl (priv->fd, request, buf);
+	if (fu_udev_device_ioctl_is_transfer (request)) {
+		fu_device_add_io_transfer (FU_DEVICE (self), 0, 0,
+					   g_get_monotonic_time () - start);
+	}
 	if (rc != NULL)
 		*rc = rc_tmp;
 	if (rc_tmp < 0) {
@@ -1378,6 +1718,10 @@ fu_udev_device_pread_full (FuUdevDevice *self, goffset port,
 			   GError **error)
 {
 	FuUdevDevicePrivate *priv = GET_PRIVATE (self);
+#ifdef HAVE_PWRITE
+	gssize rc;
+	gint64 start;
+#endif
 
 	g_return_val_if_fail (FU_IS_UDEV_DEVICE (self), FALSE);
 	g_return_val_if_fail (buf != NULL, FALSE);
@@ -1385,7 +1729,11 @@ fu_udev_device_pread_full (FuUdevDevice *self, goffset port,
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
 #ifdef HAVE_PWRITE
-	if (pread (priv->fd, buf, bufsz, port) != (gssize) bufsz) {
+	start = g_get_monotonic_time ();
+	rc = pread (priv->fd, buf, bufsz, port);
+	fu_device_add_io_transfer (FU_DEVICE (self), rc > 0 ? (gsize) rc : 0, 0,
+				   g_get_monotonic_time () - start);
+	if (rc != (gssize) bufsz) {
 		g_set_error (error,
 			     G_IO_ERROR,
 			     G_IO_ERROR_FAILED,
@@ -1424,13 +1772,21 @@ fu_udev_device_pwrite_full (FuUdevDevice *self, goffset port,
 			    GError **error)
 {
 	FuUdevDevicePrivate *priv = GET_PRIVATE (self);
+#ifdef HAVE_PWRITE
+	gssize rc;
+	gint64 start;
+#endif
 
 	g_return_val_if_fail (FU_IS_UDEV_DEVICE (self), FALSE);
 	g_return_val_if_fail (priv->fd > 0, FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
 #ifdef HAVE_PWRITE
-	if (pwrite (priv->fd, buf, bufsz, port) != (gssize) bufsz) {
+	start = g_get_monotonic_time ();
+	rc = pwrite (priv->fd, buf, bufsz, port);
+	fu_device_add_io_transfer (FU_DEVICE (self), 0, rc > 0 ? (gsize) rc : 0,
+				   g_get_monotonic_time () - start);
+	if (rc != (gssize) bufsz) {
 		g_set_error (error,
 			     G_IO_ERROR,
 			     G_IO_ERROR_FAILED,
@@ -1468,6 +1824,178 @@ fu_udev_device_pwrite (FuUdevDevice *self, goffset port, guint8 data, GError **e
 	return fu_udev_device_pwrite_full (self, port, &data, 0x01, error);
 }
 
+static gboolean
+fu_udev_device_port_check (FuUdevDevicePortIo *op, guint8 value)
+{
+	if (op->kind == FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_SET)
+		return (value & op->value) != 0;
+	return (value & op->value) == 0;
+}
+
+static gboolean
+fu_udev_device_port_timeout (FuUdevDevicePortIo *op, GError **error)
+{
+	g_set_error (error,
+		     G_IO_ERROR,
+		     G_IO_ERROR_TIMED_OUT,
+		     "timed out whilst waiting for port 0x%04x to %s 0x%02x",
+		     op->port,
+		     op->kind == FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_SET ? "set" : "clear",
+		     op->value);
+	return FALSE;
+}
+
+#ifdef FU_UDEV_DEVICE_HAVE_IOPERM
+/* no syscalls are required once the process has been granted access */
+static void
+fu_udev_device_port_transfer_ioperm (FuUdevDevicePortIo *ops,
+				     gsize n_ops,
+				     guint timeout_ms,
+				     gsize *n_done)
+{
+	for (gsize i = 0; i < n_ops; i++) {
+		FuUdevDevicePortIo *op = &ops[i];
+		if (op->kind == FU_UDEV_DEVICE_PORT_IO_KIND_WRITE) {
+			outb (op->value, op->port);
+		} else if (op->kind == FU_UDEV_DEVICE_PORT_IO_KIND_READ) {
+			op->value = inb (op->port);
+		} else {
+			gint64 deadline = g_get_monotonic_time () + (gint64) timeout_ms * 1000;
+			while (!fu_udev_device_port_check (op, inb (op->port))) {
+				if (g_get_monotonic_time () > deadline)
+					return;
+			}
+		}
+		*n_done = i + 1;
+	}
+}
+#endif
+
+static gboolean
+fu_udev_device_port_transfer_fd (FuUdevDevice *self,
+				 FuUdevDevicePortIo *ops,
+				 gsize n_ops,
+				 guint timeout_ms,
+				 GError **error)
+{
+	for (gsize i = 0; i < n_ops;) {
+		FuUdevDevicePortIo *op = &ops[i];
+		guint8 buf[0x100] = { 0x0 };
+		gsize n = 1;
+
+		/* poll the status */
+		if (op->kind == FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_SET ||
+		    op->kind == FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_CLEAR) {
+			gint64 deadline = g_get_monotonic_time () + (gint64) timeout_ms * 1000;
+			do {
+				if (!fu_udev_device_pread_full (self, op->port, buf, 1, error))
+					return FALSE;
+				if (g_get_monotonic_time () > deadline)
+					return fu_udev_device_port_timeout (op, error);
+			} while (!fu_udev_device_port_check (op, buf[0]));
+			i++;
+			continue;
+		}
+
+		/* coalesce accesses to consecutive ports into one syscall */
+		while (i + n < n_ops && n < sizeof(buf) &&
+		       ops[i + n].kind == op->kind &&
+		       ops[i + n].port == op->port + n)
+			n++;
+		if (op->kind == FU_UDEV_DEVICE_PORT_IO_KIND_WRITE) {
+			for (gsize j = 0; j < n; j++)
+				buf[j] = ops[i + j].value;
+			if (!fu_udev_device_pwrite_full (self, op->port, buf, n, error))
+				return FALSE;
+		} else {
+			if (!fu_udev_device_pread_full (self, op->port, buf, n, error))
+				return FALSE;
+			for (gsize j = 0; j < n; j++)
+				ops[i + j].value = buf[j];
+		}
+		i += n;
+	}
+	return TRUE;
+}
+
+/**
+ * fu_udev_device_port_transfer:
+ * @self: A #FuUdevDevice
+ * @ops: (array length=n_ops): I/O port operations
+ * @n_ops: number of @ops
+ * @timeout_ms: timeout in ms for each %FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_SET
+ *  or %FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_CLEAR operation
+ * @error: A #GError, or %NULL
+ *
+ * Runs a list of I/O port operations in order, where the value of each read
+ * operation is updated in place.
+ *
+ * If the device file is `/dev/port` and the process is allowed to use
+ * `ioperm()` then the ports are accessed directly without a syscall for each
+ * operation. Otherwise reads and writes to consecutive ports are coalesced
+ * into a single pread() or pwrite() on the device file; status waits and
+ * accesses to non-consecutive ports, for instance an EC status and data port
+ * handshake, still need one syscall for each operation.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_udev_device_port_transfer (FuUdevDevice *self,
+			      FuUdevDevicePortIo *ops,
+			      gsize n_ops,
+			      guint timeout_ms,
+			      GError **error)
+{
+#ifdef FU_UDEV_DEVICE_HAVE_IOPERM
+	FuUdevDevicePrivate *priv = GET_PRIVATE (self);
+	guint16 port_min = G_MAXUINT16;
+	guint16 port_max = 0;
+#endif
+
+	g_return_val_if_fail (FU_IS_UDEV_DEVICE (self), FALSE);
+	g_return_val_if_fail (ops != NULL || n_ops == 0, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+#ifdef FU_UDEV_DEVICE_HAVE_IOPERM
+	/* only the first 0x400 ports can be granted using ioperm() */
+	for (gsize i = 0; i < n_ops; i++) {
+		port_min = MIN (port_min, ops[i].port);
+		port_max = MAX (port_max, ops[i].port);
+	}
+	if (n_ops > 0 && port_max < 0x400 && !priv->ioperm_denied &&
+	    g_strcmp0 (priv->device_file, "/dev/port") == 0) {
+		gsize n_done = 0;
+		gint64 start = g_get_monotonic_time ();
+		guint num = (guint) port_max - port_min + 1;
+		if (ioperm (port_min, num, 1) == 0) {
+			guint64 bytes_read = 0;
+			guint64 bytes_written = 0;
+			fu_udev_device_port_transfer_ioperm (ops, n_ops, timeout_ms, &n_done);
+			ioperm (port_min, num, 0);
+			for (gsize i = 0; i < n_done; i++) {
+				if (ops[i].kind == FU_UDEV_DEVICE_PORT_IO_KIND_WRITE)
+					bytes_written++;
+				else
+					bytes_read++;
+			}
+			fu_device_add_io_transfer (FU_DEVICE (self),
+						   bytes_read, bytes_written,
+						   g_get_monotonic_time () - start);
+			if (n_done < n_ops)
+				return fu_udev_device_port_timeout (&ops[n_done], error);
+			return TRUE;
+		}
+		g_debug ("failed to get I/O port permission, using %s: %s",
+			 priv->device_file, g_strerror (errno));
+		priv->ioperm_denied = TRUE;
+	}
+#endif
+
+	return fu_udev_device_port_transfer_fd (self, ops, n_ops, timeout_ms, error);
+}
+
 /**
  * fu_udev_device_get_parent_name
  * @self: A #FuUdevDevice
@@ -1721,6 +2249,8 @@ fu_udev_device_finalize (GObject *object)
 	g_free (priv->device_file);
 	if (priv->udev_device != NULL)
 		g_object_unref (priv->udev_device);
+	if (priv->prefetch != NULL)
+		g_ptr_array_unref (priv->prefetch);
 	if (priv->fd > 0)
 		g_close (priv->fd, NULL);
 
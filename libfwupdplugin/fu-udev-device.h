@@ -57,6 +57,38 @@ typedef enum {
 	FU_UDEV_DEVICE_FLAG_LAST
 } FuUdevDeviceFlags;
 
+/**
+ * FuUdevDevicePortIoKind:
+ * @FU_UDEV_DEVICE_PORT_IO_KIND_WRITE:		Write the value to the port
+ * @FU_UDEV_DEVICE_PORT_IO_KIND_READ:		Read the port into the value
+ * @FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_SET:	Poll the port until any bit of the value is set
+ * @FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_CLEAR:	Poll the port until all bits of the value are clear
+ *
+ * The kind of I/O port operation used with fu_udev_device_port_transfer().
+ **/
+typedef enum {
+	FU_UDEV_DEVICE_PORT_IO_KIND_WRITE,		/* Since: 1.5.8 */
+	FU_UDEV_DEVICE_PORT_IO_KIND_READ,		/* Since: 1.5.8 */
+	FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_SET,		/* Since: 1.5.8 */
+	FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_CLEAR,		/* Since: 1.5.8 */
+	/*< private >*/
+	FU_UDEV_DEVICE_PORT_IO_KIND_LAST
+} FuUdevDevicePortIoKind;
+
+/**
+ * FuUdevDevicePortIo:
+ * @kind: a #FuUdevDevicePortIoKind, e.g. %FU_UDEV_DEVICE_PORT_IO_KIND_WRITE
+ * @port: the I/O port address
+ * @value: the value to write, the value that was read, or the bitmask to poll
+ *
+ * A single I/O port operation.
+ **/
+typedef struct {
+	FuUdevDevicePortIoKind	 kind;
+	guint16			 port;
+	guint8			 value;
+} FuUdevDevicePortIo;
+
 FuUdevDevice	*fu_udev_device_new			(GUdevDevice	*udev_device);
 GUdevDevice	*fu_udev_device_get_dev			(FuUdevDevice	*self);
 const gchar	*fu_udev_device_get_device_file		(FuUdevDevice	*self);
@@ -112,6 +144,12 @@ gboolean	 fu_udev_device_pread_full		(FuUdevDevice	*self,
 							 gsize		 bufsz,
 							 GError		**error)
 							 G_GNUC_WARN_UNUSED_RESULT;
+gboolean	 fu_udev_device_port_transfer		(FuUdevDevice	*self,
+							 FuUdevDevicePortIo *ops,
+							 gsize		 n_ops,
+							 guint		 timeout_ms,
+							 GError		**error)
+							 G_GNUC_WARN_UNUSED_RESULT;
 const gchar	*fu_udev_device_get_sysfs_attr		 (FuUdevDevice	*self,
 							  const gchar	*attr,
 							  GError	**error);
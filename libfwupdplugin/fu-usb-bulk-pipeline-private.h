@@ -0,0 +1,25 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#pragma once
+
+#include "fu-usb-bulk-pipeline.h"
+
+typedef struct _FuUsbBulkPipelineTransfer FuUsbBulkPipelineTransfer;
+
+typedef void	(*FuUsbBulkPipelineSubmitFunc)		(FuUsbBulkPipeline	*self,
+							 FuUsbBulkPipelineTransfer *transfer,
+							 guint8			*buf,
+							 gsize			 bufsz,
+							 GCancellable		*cancellable,
+							 gpointer		 user_data);
+
+void		 fu_usb_bulk_pipeline_set_submit_func	(FuUsbBulkPipeline	*self,
+							 FuUsbBulkPipelineSubmitFunc submit_func,
+							 gpointer		 user_data);
+void		 fu_usb_bulk_pipeline_transfer_done	(FuUsbBulkPipelineTransfer *transfer,
+							 gssize			 actual_len,
+							 GError			*error);
@@ -0,0 +1,460 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#define G_LOG_DOMAIN				"FuUsbBulkPipeline"
+
+#include "config.h"
+
+#include "fwupd-error.h"
+
+#include "fu-common.h"
+#include "fu-usb-bulk-pipeline-private.h"
+
+/**
+ * SECTION:fu-usb-bulk-pipeline
+ * @short_description: a pipeline of USB bulk transfers
+ *
+ * Sending a large payload one synchronous bulk transfer at a time leaves the
+ * bus idle while each transfer is completed and the next one is submitted.
+ *
+ * This object splits the payload into transfers of a fixed size and keeps up
+ * to a set number of them in flight at the same time. The transfers are
+ * submitted in order on the same endpoint and so are also completed in order.
+ *
+ * See also: #FuUsbDevice
+ */
+
+struct _FuUsbBulkPipeline {
+	GObject			 parent_instance;
+	FuUsbDevice		*device;
+	guint8			 endpoint;
+	guint			 depth;
+	gsize			 transfer_size;
+	guint			 timeout;	/* ms */
+	gsize			 bytes;		/* of last write */
+	gint64			 elapsed;	/* µs */
+	FuUsbBulkPipelineSubmitFunc submit_func;
+	gpointer		 submit_data;
+};
+
+G_DEFINE_TYPE (FuUsbBulkPipeline, fu_usb_bulk_pipeline, G_TYPE_OBJECT)
+
+#define FU_USB_BULK_PIPELINE_DEPTH_DEFAULT		4
+#define FU_USB_BULK_PIPELINE_TRANSFER_SIZE_DEFAULT	512
+#define FU_USB_BULK_PIPELINE_TIMEOUT_DEFAULT		1000 /* ms */
+
+/**
+ * fu_usb_bulk_pipeline_set_depth:
+ * @self: A #FuUsbBulkPipeline
+ * @depth: number of transfers, e.g. 4
+ *
+ * Sets the maximum number of transfers that can be in flight at the same time.
+ * A depth of 1 is equivalent to using synchronous transfers.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_usb_bulk_pipeline_set_depth (FuUsbBulkPipeline *self, guint depth)
+{
+	g_return_if_fail (FU_IS_USB_BULK_PIPELINE (self));
+	g_return_if_fail (depth > 0);
+	self->depth = depth;
+}
+
+/**
+ * fu_usb_bulk_pipeline_set_transfer_size:
+ * @self: A #FuUsbBulkPipeline
+ * @transfer_size: size in bytes, e.g. 512
+ *
+ * Sets the size of each transfer. The last transfer may be smaller.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_usb_bulk_pipeline_set_transfer_size (FuUsbBulkPipeline *self, gsize transfer_size)
+{
+	g_return_if_fail (FU_IS_USB_BULK_PIPELINE (self));
+	g_return_if_fail (transfer_size > 0);
+	self->transfer_size = transfer_size;
+}
+
+/**
+ * fu_usb_bulk_pipeline_set_timeout:
+ * @self: A #FuUsbBulkPipeline
+ * @timeout: timeout in ms
+ *
+ * Sets the timeout used for each transfer.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_usb_bulk_pipeline_set_timeout (FuUsbBulkPipeline *self, guint timeout)
+{
+	g_return_if_fail (FU_IS_USB_BULK_PIPELINE (self));
+	self->timeout = timeout;
+}
+
+/**
+ * fu_usb_bulk_pipeline_get_throughput:
+ * @self: A #FuUsbBulkPipeline
+ *
+ * Gets the throughput of the last successful fu_usb_bulk_pipeline_write().
+ *
+ * Returns: bytes per second, or 0 if unknown
+ *
+ * Since: 1.5.8
+ **/
+gdouble
+fu_usb_bulk_pipeline_get_throughput (FuUsbBulkPipeline *self)
+{
+	g_return_val_if_fail (FU_IS_USB_BULK_PIPELINE (self), 0.f);
+	if (self->elapsed <= 0)
+		return 0.f;
+	return (gdouble) self->bytes * G_USEC_PER_SEC / (gdouble) self->elapsed;
+}
+
+typedef struct {
+	FuUsbBulkPipeline	*self;
+	GMainContext		*context;
+	GMainLoop		*loop;
+	GCancellable		*cancellable;
+	guint8			*buf;
+	gsize			 bufsz;
+	gsize			 offset_submit;
+	gsize			 offset_done;
+	guint			 pending;
+	GFileProgressCallback	 progress_cb;
+	gpointer		 progress_data;
+	GError			*error;
+} FuUsbBulkPipelineHelper;
+
+struct _FuUsbBulkPipelineTransfer {
+	FuUsbBulkPipelineHelper	*helper;
+	gsize			 offset;
+	gsize			 length;
+	gint64			 start;
+};
+
+/* the transfers are run in a private context so nothing else is dispatched */
+static FuUsbBulkPipelineHelper *
+fu_usb_bulk_pipeline_helper_new (FuUsbBulkPipeline *self, guint8 *buf, gsize bufsz)
+{
+	FuUsbBulkPipelineHelper *helper = g_new0 (FuUsbBulkPipelineHelper, 1);
+	helper->self = self;
+	helper->context = g_main_context_new ();
+	helper->loop = g_main_loop_new (helper->context, FALSE);
+	helper->cancellable = g_cancellable_new ();
+	helper->buf = buf;
+	helper->bufsz = bufsz;
+	g_main_context_push_thread_default (helper->context);
+	return helper;
+}
+
+static void
+fu_usb_bulk_pipeline_helper_free (FuUsbBulkPipelineHelper *helper)
+{
+	g_main_context_pop_thread_default (helper->context);
+	g_main_loop_unref (helper->loop);
+	g_main_context_unref (helper->context);
+	g_object_unref (helper->cancellable);
+	if (helper->error != NULL)
+		g_error_free (helper->error);
+	g_free (helper->buf);
+	g_free (helper);
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuUsbBulkPipelineHelper, fu_usb_bulk_pipeline_helper_free)
+#pragma clang diagnostic pop
+
+static void
+fu_usb_bulk_pipeline_cancelled_cb (GCancellable *cancellable, gpointer user_data)
+{
+	GCancellable *cancellable_internal = G_CANCELLABLE (user_data);
+	g_cancellable_cancel (cancellable_internal);
+}
+
+/* the first error wins, and everything still in flight is cancelled */
+static void
+fu_usb_bulk_pipeline_set_error (FuUsbBulkPipelineHelper *helper, GError *error)
+{
+	if (helper->error != NULL) {
+		g_error_free (error);
+		return;
+	}
+	helper->error = error;
+	g_cancellable_cancel (helper->cancellable);
+}
+
+static void
+fu_usb_bulk_pipeline_pump (FuUsbBulkPipelineHelper *helper)
+{
+	FuUsbBulkPipeline *self = helper->self;
+
+	/* keep the pipeline full */
+	while (helper->error == NULL &&
+	       !g_cancellable_is_cancelled (helper->cancellable) &&
+	       helper->offset_submit < helper->bufsz &&
+	       helper->pending < self->depth) {
+		FuUsbBulkPipelineTransfer *transfer = g_new0 (FuUsbBulkPipelineTransfer, 1);
+		transfer->helper = helper;
+		transfer->offset = helper->offset_submit;
+		transfer->length = MIN (self->transfer_size,
+					helper->bufsz - helper->offset_submit);
+		transfer->start = g_get_monotonic_time ();
+		helper->offset_submit += transfer->length;
+		helper->pending++;
+		self->submit_func (self, transfer,
+				   helper->buf + transfer->offset,
+				   transfer->length,
+				   helper->cancellable,
+				   self->submit_data);
+	}
+
+	/* all done, or all cancelled */
+	if (helper->pending == 0)
+		g_main_loop_quit (helper->loop);
+}
+
+/**
+ * fu_usb_bulk_pipeline_transfer_done:
+ * @transfer: A #FuUsbBulkPipelineTransfer
+ * @actual_len: number of bytes sent, or -1 on error
+ * @error: (transfer full) (nullable): a #GError
+ *
+ * Completes a transfer started by a #FuUsbBulkPipelineSubmitFunc.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_usb_bulk_pipeline_transfer_done (FuUsbBulkPipelineTransfer *transfer,
+				    gssize actual_len,
+				    GError *error)
+{
+	FuUsbBulkPipelineHelper *helper = transfer->helper;
+	FuUsbBulkPipeline *self = helper->self;
+
+	helper->pending--;
+	if (error != NULL) {
+		g_prefix_error (&error, "failed to send 0x%x bytes at 0x%x: ",
+				(guint) transfer->length, (guint) transfer->offset);
+		fu_usb_bulk_pipeline_set_error (helper, error);
+	} else if ((gsize) actual_len != transfer->length) {
+		/* later transfers may already be on the bus, so this cannot be resent */
+		fu_usb_bulk_pipeline_set_error (helper,
+						g_error_new (G_IO_ERROR,
+							     G_IO_ERROR_PARTIAL_INPUT,
+							     "only sent 0x%x/0x%x bytes at 0x%x",
+							     (guint) actual_len,
+							     (guint) transfer->length,
+							     (guint) transfer->offset));
+	} else {
+		fu_device_add_io_transfer (FU_DEVICE (self->device), 0, actual_len,
+					   g_get_monotonic_time () - transfer->start);
+		helper->offset_done += actual_len;
+		if (helper->progress_cb != NULL && helper->error == NULL) {
+			helper->progress_cb ((goffset) helper->offset_done,
+					     (goffset) helper->bufsz,
+					     helper->progress_data);
+		}
+	}
+	g_free (transfer);
+	fu_usb_bulk_pipeline_pump (helper);
+}
+
+/**
+ * fu_usb_bulk_pipeline_set_submit_func:
+ * @self: A #FuUsbBulkPipeline
+ * @submit_func: function to start a transfer
+ * @user_data: user data for @submit_func
+ *
+ * Replaces the GUsb bulk transfers with a custom transport, which is only
+ * useful for the self tests. Each transfer must eventually be completed
+ * using fu_usb_bulk_pipeline_transfer_done() from the thread-default main
+ * context, even when cancelled.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_usb_bulk_pipeline_set_submit_func (FuUsbBulkPipeline *self,
+				      FuUsbBulkPipelineSubmitFunc submit_func,
+				      gpointer user_data)
+{
+	g_return_if_fail (FU_IS_USB_BULK_PIPELINE (self));
+	g_return_if_fail (submit_func != NULL);
+	self->submit_func = submit_func;
+	self->submit_data = user_data;
+}
+
+#ifdef HAVE_GUSB
+static void
+fu_usb_bulk_pipeline_usb_transfer_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FuUsbBulkPipelineTransfer *transfer = (FuUsbBulkPipelineTransfer *) user_data;
+	GError *error = NULL;
+	gssize actual_len;
+
+	actual_len = g_usb_device_bulk_transfer_finish (G_USB_DEVICE (source), res, &error);
+	fu_usb_bulk_pipeline_transfer_done (transfer, actual_len, error);
+}
+
+static void
+fu_usb_bulk_pipeline_usb_submit (FuUsbBulkPipeline *self,
+				 FuUsbBulkPipelineTransfer *transfer,
+				 guint8 *buf,
+				 gsize bufsz,
+				 GCancellable *cancellable,
+				 gpointer user_data)
+{
+	GUsbDevice *usb_device = fu_usb_device_get_dev (self->device);
+	g_usb_device_bulk_transfer_async (usb_device,
+					  self->endpoint,
+					  buf, bufsz,
+					  self->timeout,
+					  cancellable,
+					  fu_usb_bulk_pipeline_usb_transfer_cb,
+					  transfer);
+}
+#endif
+
+/**
+ * fu_usb_bulk_pipeline_write:
+ * @self: A #FuUsbBulkPipeline
+ * @blob: data to send
+ * @progress_cb: (scope call) (nullable): optional progress callback
+ * @progress_data: user data for @progress_cb
+ * @cancellable: (nullable): optional #GCancellable
+ * @error: A #GError, or %NULL
+ *
+ * Sends data to the bulk OUT endpoint, keeping multiple transfers in flight.
+ *
+ * If any transfer fails, times out or only completes partially then the
+ * remaining transfers are cancelled and an error is returned. The device
+ * may then have received some of the transfers after the one that failed.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_usb_bulk_pipeline_write (FuUsbBulkPipeline *self,
+			    GBytes *blob,
+			    GFileProgressCallback progress_cb,
+			    gpointer progress_data,
+			    GCancellable *cancellable,
+			    GError **error)
+{
+	gint64 start;
+	gsize bufsz;
+	gulong cancellable_id = 0;
+	g_autofree guint8 *buf = NULL;
+	g_autoptr(FuUsbBulkPipelineHelper) helper = NULL;
+
+	g_return_val_if_fail (FU_IS_USB_BULK_PIPELINE (self), FALSE);
+	g_return_val_if_fail (blob != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* no transport */
+	if (self->submit_func == NULL) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_NOT_SUPPORTED,
+				     "GUsb support is unavailable");
+		return FALSE;
+	}
+
+	/* GUsb needs a mutable buffer */
+	bufsz = g_bytes_get_size (blob);
+	buf = fu_memdup_safe (g_bytes_get_data (blob, NULL), bufsz, error);
+	if (buf == NULL && bufsz > 0)
+		return FALSE;
+	helper = fu_usb_bulk_pipeline_helper_new (self, g_steal_pointer (&buf), bufsz);
+	helper->progress_cb = progress_cb;
+	helper->progress_data = progress_data;
+	if (cancellable != NULL) {
+		cancellable_id = g_cancellable_connect (cancellable,
+							G_CALLBACK (fu_usb_bulk_pipeline_cancelled_cb),
+							helper->cancellable, NULL);
+	}
+
+	/* run the transfers */
+	start = g_get_monotonic_time ();
+	fu_usb_bulk_pipeline_pump (helper);
+	if (helper->pending > 0)
+		g_main_loop_run (helper->loop);
+	if (cancellable != NULL)
+		g_cancellable_disconnect (cancellable, cancellable_id);
+	if (helper->error != NULL) {
+		g_propagate_error (error, g_steal_pointer (&helper->error));
+		return FALSE;
+	}
+
+	/* cancelled between transfers */
+	if (helper->offset_done < helper->bufsz) {
+		g_set_error (error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_CANCELLED,
+			     "cancelled after sending 0x%x/0x%x bytes",
+			     (guint) helper->offset_done,
+			     (guint) helper->bufsz);
+		return FALSE;
+	}
+
+	/* success */
+	self->bytes = helper->bufsz;
+	self->elapsed = g_get_monotonic_time () - start;
+	return TRUE;
+}
+
+static void
+fu_usb_bulk_pipeline_init (FuUsbBulkPipeline *self)
+{
+	self->depth = FU_USB_BULK_PIPELINE_DEPTH_DEFAULT;
+	self->transfer_size = FU_USB_BULK_PIPELINE_TRANSFER_SIZE_DEFAULT;
+	self->timeout = FU_USB_BULK_PIPELINE_TIMEOUT_DEFAULT;
+#ifdef HAVE_GUSB
+	self->submit_func = fu_usb_bulk_pipeline_usb_submit;
+#endif
+}
+
+static void
+fu_usb_bulk_pipeline_finalize (GObject *object)
+{
+	FuUsbBulkPipeline *self = FU_USB_BULK_PIPELINE (object);
+	g_object_unref (self->device);
+	G_OBJECT_CLASS (fu_usb_bulk_pipeline_parent_class)->finalize (object);
+}
+
+static void
+fu_usb_bulk_pipeline_class_init (FuUsbBulkPipelineClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	object_class->finalize = fu_usb_bulk_pipeline_finalize;
+}
+
+/**
+ * fu_usb_bulk_pipeline_new:
+ * @device: A #FuUsbDevice
+ * @endpoint: the bulk OUT endpoint address, e.g. 0x01
+ *
+ * Creates a new pipeline for an opened USB device.
+ *
+ * Returns: (transfer full): a #FuUsbBulkPipeline
+ *
+ * Since: 1.5.8
+ **/
+FuUsbBulkPipeline *
+fu_usb_bulk_pipeline_new (FuUsbDevice *device, guint8 endpoint)
+{
+	FuUsbBulkPipeline *self;
+	g_return_val_if_fail (FU_IS_USB_DEVICE (device), NULL);
+	self = g_object_new (FU_TYPE_USB_BULK_PIPELINE, NULL);
+	self->device = g_object_ref (device);
+	self->endpoint = endpoint;
+	return self;
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+#include "fu-usb-device.h"
+
+#define FU_TYPE_USB_BULK_PIPELINE (fu_usb_bulk_pipeline_get_type ())
+
+G_DECLARE_FINAL_TYPE (FuUsbBulkPipeline, fu_usb_bulk_pipeline, FU, USB_BULK_PIPELINE, GObject)
+
+FuUsbBulkPipeline *fu_usb_bulk_pipeline_new		(FuUsbDevice		*device,
+							 guint8			 endpoint);
+void		 fu_usb_bulk_pipeline_set_depth		(FuUsbBulkPipeline	*self,
+							 guint			 depth);
+void		 fu_usb_bulk_pipeline_set_transfer_size	(FuUsbBulkPipeline	*self,
+							 gsize			 transfer_size);
+void		 fu_usb_bulk_pipeline_set_timeout	(FuUsbBulkPipeline	*self,
+							 guint			 timeout);
+gdouble		 fu_usb_bulk_pipeline_get_throughput	(FuUsbBulkPipeline	*self);
+gboolean	 fu_usb_bulk_pipeline_write		(FuUsbBulkPipeline	*self,
+							 GBytes			*blob,
+							 GFileProgressCallback	 progress_cb,
+							 gpointer		 progress_data,
+							 GCancellable		*cancellable,
+							 GError			**error)
+							 G_GNUC_WARN_UNUSED_RESULT;
@@ -9,3 +9,5 @@
 #include "fu-usb-device.h"
 
 const gchar	*fu_usb_device_get_platform_id		(FuUsbDevice	*self);
+gboolean	 fu_usb_device_prefetch			(FuUsbDevice	*self,
+							 GError		**error);
@@ -24,6 +24,7 @@ typedef struct
 {
 	GUsbDevice		*usb_device;
 	FuDeviceLocker		*usb_device_locker;
+	GPtrArray		*interfaces;	/* (nullable) of GUsbInterface */
 } FuUsbDevicePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (FuUsbDevice, fu_usb_device, FU_TYPE_DEVICE)
@@ -76,6 +77,8 @@ fu_usb_device_finalize (GObject *object)
 		g_object_unref (priv->usb_device_locker);
 	if (priv->usb_device != NULL)
 		g_object_unref (priv->usb_device);
+	if (priv->interfaces != NULL)
+		g_ptr_array_unref (priv->interfaces);
 
 	G_OBJECT_CLASS (fu_usb_device_parent_class)->finalize (object);
 }
@@ -126,14 +129,14 @@ fu_usb_device_query_hub (FuUsbDevice *self, GError **error)
 	/* longer descriptor for SuperSpeed */
 	if (fu_usb_device_get_spec (self) >= 0x0300)
 		value = 0x2a;
-	if (!g_usb_device_control_transfer (priv->usb_device,
-					    G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0x06, /* LIBUSB_REQUEST_GET_DESCRIPTOR */
-					    value << 8, 0x00,
-					    data, sizeof(data), &sz,
-					    1000, NULL, error)) {
+	if (!fu_usb_device_control_transfer (self,
+					     G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0x06, /* LIBUSB_REQUEST_GET_DESCRIPTOR */
+					     value << 8, 0x00,
+					     data, sizeof(data), &sz,
+					     1000, NULL, error)) {
 		g_prefix_error (error, "failed to get USB descriptor: ");
 		return FALSE;
 	}
@@ -344,9 +347,13 @@ fu_usb_device_probe (FuDevice *device, GError **error)
 					FU_DEVICE_INSTANCE_FLAG_ONLY_QUIRKS);
 
 	/* add the interface GUIDs */
-	intfs = g_usb_device_get_interfaces (priv->usb_device, error);
-	if (intfs == NULL)
-		return FALSE;
+	if (priv->interfaces != NULL) {
+		intfs = g_ptr_array_ref (priv->interfaces);
+	} else {
+		intfs = g_usb_device_get_interfaces (priv->usb_device, error);
+		if (intfs == NULL)
+			return FALSE;
+	}
 	for (guint i = 0; i < intfs->len; i++) {
 		GUsbInterface *intf = g_ptr_array_index (intfs, i);
 		g_autofree gchar *intid1 = NULL;
@@ -476,6 +483,239 @@ fu_usb_device_get_spec (FuUsbDevice *self)
 #endif
 }
 
+/**
+ * fu_usb_device_control_transfer:
+ * @self: A #FuUsbDevice
+ * @direction: the transfer direction
+ * @request_type: the request type classification
+ * @recipient: the recipient of this transfer
+ * @request: the request field for the setup packet
+ * @value: the value field for the setup packet
+ * @idx: the index field for the setup packet
+ * @data: (array length=length): a suitably-sized data buffer
+ * @length: the length field for the setup packet
+ * @actual_length: (out) (optional): the actual number of bytes sent, or %NULL
+ * @timeout: timeout timeout (in millseconds)
+ * @cancellable: (nullable): A #GCancellable
+ * @error: A #GError, or %NULL
+ *
+ * Performs a USB control transfer like g_usb_device_control_transfer(),
+ * recording the transfer in the device I/O statistics.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_usb_device_control_transfer (FuUsbDevice *self,
+				GUsbDeviceDirection direction,
+				GUsbDeviceRequestType request_type,
+				GUsbDeviceRecipient recipient,
+				guint8 request,
+				guint16 value,
+				guint16 idx,
+				guint8 *data,
+				gsize length,
+				gsize *actual_length,
+				guint timeout,
+				GCancellable *cancellable,
+				GError **error)
+{
+#ifdef HAVE_GUSB
+	FuUsbDevicePrivate *priv = GET_PRIVATE (self);
+	gboolean ret;
+	gint64 start;
+	gsize actual_length_tmp = 0;
+
+	g_return_val_if_fail (FU_IS_USB_DEVICE (self), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	start = g_get_monotonic_time ();
+	ret = g_usb_device_control_transfer (priv->usb_device,
+					     direction, request_type, recipient,
+					     request, value, idx,
+					     data, length, &actual_length_tmp,
+					     timeout, cancellable, error);
+	if (direction == G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST) {
+		fu_device_add_io_transfer (FU_DEVICE (self), actual_length_tmp, 0,
+					   g_get_monotonic_time () - start);
+	} else {
+		fu_device_add_io_transfer (FU_DEVICE (self), 0, actual_length_tmp,
+					   g_get_monotonic_time () - start);
+	}
+	if (actual_length != NULL)
+		*actual_length = actual_length_tmp;
+	return ret;
+#else
+	g_set_error_literal (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_SUPPORTED,
+			     "Not supported as <gusb.h> is unavailable");
+	return FALSE;
+#endif
+}
+
+#ifdef HAVE_GUSB
+typedef gboolean (*FuUsbDeviceTransferFunc)	(GUsbDevice	*device,
+						 guint8		 endpoint,
+						 guint8		*data,
+						 gsize		 length,
+						 gsize		*actual_length,
+						 guint		 timeout,
+						 GCancellable	*cancellable,
+						 GError		**error);
+
+static gboolean
+fu_usb_device_transfer (FuUsbDevice *self,
+			FuUsbDeviceTransferFunc func,
+			guint8 endpoint,
+			guint8 *data,
+			gsize length,
+			gsize *actual_length,
+			guint timeout,
+			GCancellable *cancellable,
+			GError **error)
+{
+	FuUsbDevicePrivate *priv = GET_PRIVATE (self);
+	gboolean ret;
+	gint64 start = g_get_monotonic_time ();
+	gsize actual_length_tmp = 0;
+
+	ret = func (priv->usb_device, endpoint, data, length,
+		    &actual_length_tmp, timeout, cancellable, error);
+	if (endpoint & 0x80) {
+		fu_device_add_io_transfer (FU_DEVICE (self), actual_length_tmp, 0,
+					   g_get_monotonic_time () - start);
+	} else {
+		fu_device_add_io_transfer (FU_DEVICE (self), 0, actual_length_tmp,
+					   g_get_monotonic_time () - start);
+	}
+	if (actual_length != NULL)
+		*actual_length = actual_length_tmp;
+	return ret;
+}
+#endif
+
+/**
+ * fu_usb_device_bulk_transfer:
+ * @self: A #FuUsbDevice
+ * @endpoint: the address of a valid endpoint to communicate with
+ * @data: (array length=length): a suitably-sized data buffer
+ * @length: the size of @data
+ * @actual_length: (out) (optional): the actual number of bytes sent, or %NULL
+ * @timeout: timeout timeout (in millseconds)
+ * @cancellable: (nullable): A #GCancellable
+ * @error: A #GError, or %NULL
+ *
+ * Performs a USB bulk transfer like g_usb_device_bulk_transfer(), recording
+ * the transfer in the device I/O statistics.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_usb_device_bulk_transfer (FuUsbDevice *self,
+			     guint8 endpoint,
+			     guint8 *data,
+			     gsize length,
+			     gsize *actual_length,
+			     guint timeout,
+			     GCancellable *cancellable,
+			     GError **error)
+{
+	g_return_val_if_fail (FU_IS_USB_DEVICE (self), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+#ifdef HAVE_GUSB
+	return fu_usb_device_transfer (self, g_usb_device_bulk_transfer,
+				       endpoint, data, length, actual_length,
+				       timeout, cancellable, error);
+#else
+	g_set_error_literal (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_SUPPORTED,
+			     "Not supported as <gusb.h> is unavailable");
+	return FALSE;
+#endif
+}
+
+/**
+ * fu_usb_device_interrupt_transfer:
+ * @self: A #FuUsbDevice
+ * @endpoint: the address of a valid endpoint to communicate with
+ * @data: (array length=length): a suitably-sized data buffer
+ * @length: the size of @data
+ * @actual_length: (out) (optional): the actual number of bytes sent, or %NULL
+ * @timeout: timeout timeout (in millseconds)
+ * @cancellable: (nullable): A #GCancellable
+ * @error: A #GError, or %NULL
+ *
+ * Performs a USB interrupt transfer like g_usb_device_interrupt_transfer(),
+ * recording the transfer in the device I/O statistics.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_usb_device_interrupt_transfer (FuUsbDevice *self,
+				  guint8 endpoint,
+				  guint8 *data,
+				  gsize length,
+				  gsize *actual_length,
+				  guint timeout,
+				  GCancellable *cancellable,
+				  GError **error)
+{
+	g_return_val_if_fail (FU_IS_USB_DEVICE (self), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+#ifdef HAVE_GUSB
+	return fu_usb_device_transfer (self, g_usb_device_interrupt_transfer,
+				       endpoint, data, length, actual_length,
+				       timeout, cancellable, error);
+#else
+	g_set_error_literal (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_SUPPORTED,
+			     "Not supported as <gusb.h> is unavailable");
+	return FALSE;
+#endif
+}
+
+/**
+ * fu_usb_device_prefetch:
+ * @self: A #FuUsbDevice
+ * @error: A #GError, or %NULL
+ *
+ * Reads the interface descriptors used by fu_device_probe(). This is safe to
+ * call from a worker thread as long as nothing else is using the device.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_usb_device_prefetch (FuUsbDevice *self, GError **error)
+{
+#ifdef HAVE_GUSB
+	FuUsbDevicePrivate *priv = GET_PRIVATE (self);
+	GPtrArray *intfs;
+
+	g_return_val_if_fail (FU_IS_USB_DEVICE (self), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	if (priv->usb_device == NULL)
+		return TRUE;
+	intfs = g_usb_device_get_interfaces (priv->usb_device, error);
+	if (intfs == NULL)
+		return FALSE;
+	if (priv->interfaces != NULL)
+		g_ptr_array_unref (priv->interfaces);
+	priv->interfaces = intfs;
+#endif
+	return TRUE;
+}
+
 /**
  * fu_usb_device_set_dev:
  * @device: A #FuUsbDevice
@@ -496,6 +736,8 @@ fu_usb_device_set_dev (FuUsbDevice *device, GUsbDevice *usb_device)
 	fu_device_probe_invalidate (FU_DEVICE (device));
 
 	/* allow replacement */
+	if (priv->usb_device != usb_device && priv->interfaces != NULL)
+		g_clear_pointer (&priv->interfaces, g_ptr_array_unref);
 	g_set_object (&priv->usb_device, usb_device);
 	if (usb_device == NULL) {
 		g_clear_object (&priv->usb_device_locker);
@@ -589,10 +831,15 @@ fu_usb_device_get_dev (FuUsbDevice *device)
 static void
 fu_usb_device_incorporate (FuDevice *self, FuDevice *donor)
 {
+	FuUsbDevicePrivate *priv = GET_PRIVATE (FU_USB_DEVICE (self));
+	FuUsbDevicePrivate *priv_donor = GET_PRIVATE (FU_USB_DEVICE (donor));
+
 	g_return_if_fail (FU_IS_USB_DEVICE (self));
 	g_return_if_fail (FU_IS_USB_DEVICE (donor));
 	fu_usb_device_set_dev (FU_USB_DEVICE (self),
 			       fu_usb_device_get_dev (FU_USB_DEVICE (donor)));
+	if (priv->interfaces == NULL && priv_donor->interfaces != NULL)
+		priv->interfaces = g_ptr_array_ref (priv_donor->interfaces);
 }
 
 static gboolean
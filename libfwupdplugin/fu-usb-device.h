@@ -12,6 +12,9 @@
 #else
 typedef GObject GUsbContext;
 typedef GObject GUsbDevice;
+typedef guint GUsbDeviceDirection;
+typedef guint GUsbDeviceRequestType;
+typedef guint GUsbDeviceRecipient;
 #define G_USB_CHECK_VERSION(a,c,b)	0
 #endif
 
@@ -44,3 +47,32 @@ gboolean	 fu_usb_device_is_open			(FuUsbDevice	*device);
 GUdevDevice	*fu_usb_device_find_udev_device		(FuUsbDevice	*device,
 							 GError		**error)
 							 G_GNUC_WARN_UNUSED_RESULT;
+gboolean	 fu_usb_device_control_transfer		(FuUsbDevice	*self,
+							 GUsbDeviceDirection direction,
+							 GUsbDeviceRequestType request_type,
+							 GUsbDeviceRecipient recipient,
+							 guint8		 request,
+							 guint16	 value,
+							 guint16	 idx,
+							 guint8		*data,
+							 gsize		 length,
+							 gsize		*actual_length,
+							 guint		 timeout,
+							 GCancellable	*cancellable,
+							 GError		**error);
+gboolean	 fu_usb_device_bulk_transfer		(FuUsbDevice	*self,
+							 guint8		 endpoint,
+							 guint8		*data,
+							 gsize		 length,
+							 gsize		*actual_length,
+							 guint		 timeout,
+							 GCancellable	*cancellable,
+							 GError		**error);
+gboolean	 fu_usb_device_interrupt_transfer	(FuUsbDevice	*self,
+							 guint8		 endpoint,
+							 guint8		*data,
+							 gsize		 length,
+							 gsize		*actual_length,
+							 guint		 timeout,
+							 GCancellable	*cancellable,
+							 GError		**error);
@@ -0,0 +1,396 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#define G_LOG_DOMAIN				"FuVerifyCache"
+
+#include "config.h"
+
+#include "fu-verify-cache.h"
+
+/**
+ * SECTION:fu-verify-cache
+ * @short_description: a cache of Jcat verification results
+ *
+ * Verifying a detached signature is expensive, and the same archive is often
+ * verified more than once, for instance when calling GetDetails and then
+ * Install on the same file.
+ *
+ * The results are keyed on the checksum of the payload, the checksum of the
+ * signatures, the verify flags and the keyring generation. The caller should
+ * use fu_verify_cache_invalidate() when the trusted keys change.
+ *
+ * Certificates are only valid for a time window, and so results also expire
+ * after a maximum age.
+ */
+
+struct _FuVerifyCache {
+	GObject			 parent_instance;
+	GHashTable		*items;		/* str:FuVerifyCacheItem */
+	guint			 max_items;
+	guint			 max_age;	/* s */
+	guint64			 generation;
+};
+
+typedef struct {
+	GPtrArray		*results;	/* of JcatResult, or %NULL */
+	GError			*error;
+	gint64			 ctime;
+	gint64			 atime;
+} FuVerifyCacheItem;
+
+G_DEFINE_TYPE (FuVerifyCache, fu_verify_cache, G_TYPE_OBJECT)
+
+#define FU_VERIFY_CACHE_MAX_ITEMS_DEFAULT	64
+#define FU_VERIFY_CACHE_MAX_AGE_DEFAULT		3600	/* s */
+
+static void
+fu_verify_cache_item_free (FuVerifyCacheItem *item)
+{
+	if (item->results != NULL)
+		g_ptr_array_unref (item->results);
+	if (item->error != NULL)
+		g_error_free (item->error);
+	g_free (item);
+}
+
+/**
+ * fu_verify_cache_set_max_items:
+ * @self: A #FuVerifyCache
+ * @max_items: number of results, or 0 to disable the cache
+ *
+ * Sets the maximum number of results to store. When the cache is full the
+ * least recently used result is removed.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_verify_cache_set_max_items (FuVerifyCache *self, guint max_items)
+{
+	g_return_if_fail (FU_IS_VERIFY_CACHE (self));
+	self->max_items = max_items;
+	if (max_items == 0)
+		g_hash_table_remove_all (self->items);
+}
+
+/**
+ * fu_verify_cache_set_max_age:
+ * @self: A #FuVerifyCache
+ * @max_age: age in seconds, or 0 to never reuse a result
+ *
+ * Sets the maximum age of a stored result, after which the signature is
+ * verified again so that certificates that have since expired or become
+ * valid are handled correctly.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_verify_cache_set_max_age (FuVerifyCache *self, guint max_age)
+{
+	g_return_if_fail (FU_IS_VERIFY_CACHE (self));
+	self->max_age = max_age;
+}
+
+/**
+ * fu_verify_cache_get_size:
+ * @self: A #FuVerifyCache
+ *
+ * Gets the number of results currently stored.
+ *
+ * Returns: integer
+ *
+ * Since: 1.5.8
+ **/
+guint
+fu_verify_cache_get_size (FuVerifyCache *self)
+{
+	g_return_val_if_fail (FU_IS_VERIFY_CACHE (self), 0);
+	return g_hash_table_size (self->items);
+}
+
+/**
+ * fu_verify_cache_invalidate:
+ * @self: A #FuVerifyCache
+ *
+ * Removes all the stored results, typically because the public keys or the
+ * keyring have been changed.
+ *
+ * Since: 1.5.8
+ **/
+void
+fu_verify_cache_invalidate (FuVerifyCache *self)
+{
+	g_return_if_fail (FU_IS_VERIFY_CACHE (self));
+	if (g_hash_table_size (self->items) > 0)
+		g_debug ("invalidating %u results", g_hash_table_size (self->items));
+	self->generation++;
+	g_hash_table_remove_all (self->items);
+}
+
+static void
+fu_verify_cache_checksum_blob (GChecksum *csum, JcatBlob *blob_signature)
+{
+	JcatBlobKind kind = jcat_blob_get_kind (blob_signature);
+	GBytes *data = jcat_blob_get_data (blob_signature);
+	g_checksum_update (csum, (const guchar *) &kind, sizeof(kind));
+	if (data != NULL) {
+		gsize bufsz = 0;
+		const guint8 *buf = g_bytes_get_data (data, &bufsz);
+		g_checksum_update (csum, buf, bufsz);
+	}
+}
+
+static gchar *
+fu_verify_cache_build_key (FuVerifyCache *self,
+			   const gchar *prefix,
+			   GBytes *blob,
+			   GChecksum *csum_signatures,
+			   JcatVerifyFlags flags)
+{
+	g_autofree gchar *csum_blob = NULL;
+	csum_blob = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, blob);
+	return g_strdup_printf ("%s:%s:%s:%x:%" G_GUINT64_FORMAT,
+				prefix,
+				csum_blob,
+				g_checksum_get_string (csum_signatures),
+				(guint) flags,
+				self->generation);
+}
+
+static GPtrArray *
+fu_verify_cache_copy_results (GPtrArray *results)
+{
+	GPtrArray *results_new = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	for (guint i = 0; i < results->len; i++)
+		g_ptr_array_add (results_new, g_object_ref (g_ptr_array_index (results, i)));
+	return results_new;
+}
+
+static GPtrArray *
+fu_verify_cache_lookup (FuVerifyCache *self, const gchar *key, gboolean *hit, GError **error)
+{
+	FuVerifyCacheItem *item = g_hash_table_lookup (self->items, key);
+	gint64 now = g_get_monotonic_time ();
+	if (item == NULL) {
+		*hit = FALSE;
+		return NULL;
+	}
+	if (now - item->ctime >= (gint64) self->max_age * G_USEC_PER_SEC) {
+		g_debug ("result for %s expired", key);
+		g_hash_table_remove (self->items, key);
+		*hit = FALSE;
+		return NULL;
+	}
+	*hit = TRUE;
+	item->atime = now;
+	if (item->error != NULL) {
+		g_propagate_error (error, g_error_copy (item->error));
+		return NULL;
+	}
+
+	/* the caller may sort the results in-place */
+	return fu_verify_cache_copy_results (item->results);
+}
+
+static void
+fu_verify_cache_remove_oldest (FuVerifyCache *self)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	const gchar *key_oldest = NULL;
+	gint64 atime_oldest = G_MAXINT64;
+
+	g_hash_table_iter_init (&iter, self->items);
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		FuVerifyCacheItem *item = value;
+		if (item->atime < atime_oldest) {
+			atime_oldest = item->atime;
+			key_oldest = key;
+		}
+	}
+	if (key_oldest != NULL)
+		g_hash_table_remove (self->items, key_oldest);
+}
+
+static void
+fu_verify_cache_insert (FuVerifyCache *self,
+			const gchar *key,
+			GPtrArray *results,
+			const GError *error)
+{
+	FuVerifyCacheItem *item;
+
+	/* disabled */
+	if (self->max_items == 0)
+		return;
+	while (g_hash_table_size (self->items) >= self->max_items)
+		fu_verify_cache_remove_oldest (self);
+
+	item = g_new0 (FuVerifyCacheItem, 1);
+	item->ctime = g_get_monotonic_time ();
+	item->atime = item->ctime;
+	if (results != NULL)
+		item->results = fu_verify_cache_copy_results (results);
+	if (error != NULL)
+		item->error = g_error_copy (error);
+	g_hash_table_insert (self->items, g_strdup (key), item);
+}
+
+/**
+ * fu_verify_cache_verify_item:
+ * @self: A #FuVerifyCache
+ * @context: A #JcatContext
+ * @blob: the payload data
+ * @item: the #JcatItem containing the checksums and signatures
+ * @flags: #JcatVerifyFlags, e.g. %JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE
+ * @error: A #GError, or %NULL
+ *
+ * Verifies the payload using all the signatures in the item, returning the
+ * previous result if this payload and signature have already been verified.
+ *
+ * Returns: (transfer container) (element-type JcatResult): results, or %NULL
+ *
+ * Since: 1.5.8
+ **/
+GPtrArray *
+fu_verify_cache_verify_item (FuVerifyCache *self,
+			     JcatContext *context,
+			     GBytes *blob,
+			     JcatItem *item,
+			     JcatVerifyFlags flags,
+			     GError **error)
+{
+	gboolean hit = FALSE;
+	g_autofree gchar *key = NULL;
+	g_autoptr(GChecksum) csum = g_checksum_new (G_CHECKSUM_SHA256);
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GPtrArray) blobs = NULL;
+	g_autoptr(GPtrArray) results = NULL;
+
+	g_return_val_if_fail (FU_IS_VERIFY_CACHE (self), NULL);
+	g_return_val_if_fail (JCAT_IS_CONTEXT (context), NULL);
+	g_return_val_if_fail (blob != NULL, NULL);
+	g_return_val_if_fail (JCAT_IS_ITEM (item), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* already verified */
+	blobs = jcat_item_get_blobs (item);
+	for (guint i = 0; i < blobs->len; i++)
+		fu_verify_cache_checksum_blob (csum, g_ptr_array_index (blobs, i));
+	key = fu_verify_cache_build_key (self, "item", blob, csum, flags);
+	results = fu_verify_cache_lookup (self, key, &hit, error);
+	if (hit)
+		return g_steal_pointer (&results);
+
+	/* do the expensive thing */
+	results = jcat_context_verify_item (context, blob, item, flags, &error_local);
+	fu_verify_cache_insert (self, key, results, error_local);
+	if (results == NULL) {
+		g_propagate_error (error, g_steal_pointer (&error_local));
+		return NULL;
+	}
+	return g_steal_pointer (&results);
+}
+
+/**
+ * fu_verify_cache_verify_blob:
+ * @self: A #FuVerifyCache
+ * @context: A #JcatContext
+ * @blob: the payload data
+ * @blob_signature: the detached signature
+ * @flags: #JcatVerifyFlags, e.g. %JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE
+ * @error: A #GError, or %NULL
+ *
+ * Verifies the payload using a single detached signature, returning the
+ * previous result if this payload and signature have already been verified.
+ *
+ * Returns: (transfer full): a #JcatResult, or %NULL
+ *
+ * Since: 1.5.8
+ **/
+JcatResult *
+fu_verify_cache_verify_blob (FuVerifyCache *self,
+			     JcatContext *context,
+			     GBytes *blob,
+			     JcatBlob *blob_signature,
+			     JcatVerifyFlags flags,
+			     GError **error)
+{
+	gboolean hit = FALSE;
+	g_autofree gchar *key = NULL;
+	g_autoptr(GChecksum) csum = g_checksum_new (G_CHECKSUM_SHA256);
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GPtrArray) results = NULL;
+	g_autoptr(JcatResult) result = NULL;
+
+	g_return_val_if_fail (FU_IS_VERIFY_CACHE (self), NULL);
+	g_return_val_if_fail (JCAT_IS_CONTEXT (context), NULL);
+	g_return_val_if_fail (blob != NULL, NULL);
+	g_return_val_if_fail (JCAT_IS_BLOB (blob_signature), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* already verified */
+	fu_verify_cache_checksum_blob (csum, blob_signature);
+	key = fu_verify_cache_build_key (self, "blob", blob, csum, flags);
+	results = fu_verify_cache_lookup (self, key, &hit, error);
+	if (hit) {
+		if (results == NULL || results->len == 0)
+			return NULL;
+		return g_object_ref (g_ptr_array_index (results, 0));
+	}
+
+	/* do the expensive thing */
+	result = jcat_context_verify_blob (context, blob, blob_signature, flags, &error_local);
+	if (result == NULL) {
+		fu_verify_cache_insert (self, key, NULL, error_local);
+		g_propagate_error (error, g_steal_pointer (&error_local));
+		return NULL;
+	}
+	results = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_ptr_array_add (results, g_object_ref (result));
+	fu_verify_cache_insert (self, key, results, NULL);
+	return g_steal_pointer (&result);
+}
+
+static void
+fu_verify_cache_finalize (GObject *obj)
+{
+	FuVerifyCache *self = FU_VERIFY_CACHE (obj);
+	g_hash_table_unref (self->items);
+	G_OBJECT_CLASS (fu_verify_cache_parent_class)->finalize (obj);
+}
+
+static void
+fu_verify_cache_class_init (FuVerifyCacheClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	object_class->finalize = fu_verify_cache_finalize;
+}
+
+static void
+fu_verify_cache_init (FuVerifyCache *self)
+{
+	self->max_items = FU_VERIFY_CACHE_MAX_ITEMS_DEFAULT;
+	self->max_age = FU_VERIFY_CACHE_MAX_AGE_DEFAULT;
+	self->items = g_hash_table_new_full (g_str_hash, g_str_equal,
+					     g_free,
+					     (GDestroyNotify) fu_verify_cache_item_free);
+}
+
+/**
+ * fu_verify_cache_new:
+ *
+ * Creates a new #FuVerifyCache.
+ *
+ * Returns: a #FuVerifyCache
+ *
+ * Since: 1.5.8
+ **/
+FuVerifyCache *
+fu_verify_cache_new (void)
+{
+	return g_object_new (FU_TYPE_VERIFY_CACHE, NULL);
+}
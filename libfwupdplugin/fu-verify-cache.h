@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#pragma once
+
+#include <glib-object.h>
+#include <jcat.h>
+
+#define FU_TYPE_VERIFY_CACHE (fu_verify_cache_get_type ())
+
+G_DECLARE_FINAL_TYPE (FuVerifyCache, fu_verify_cache, FU, VERIFY_CACHE, GObject)
+
+FuVerifyCache	*fu_verify_cache_new		(void);
+void		 fu_verify_cache_set_max_items	(FuVerifyCache		*self,
+						 guint			 max_items);
+void		 fu_verify_cache_set_max_age	(FuVerifyCache		*self,
+						 guint			 max_age);
+guint		 fu_verify_cache_get_size	(FuVerifyCache		*self);
+void		 fu_verify_cache_invalidate	(FuVerifyCache		*self);
+GPtrArray	*fu_verify_cache_verify_item	(FuVerifyCache		*self,
+						 JcatContext		*context,
+						 GBytes			*blob,
+						 JcatItem		*item,
+						 JcatVerifyFlags	 flags,
+						 GError			**error)
+						 G_GNUC_WARN_UNUSED_RESULT;
+JcatResult	*fu_verify_cache_verify_blob	(FuVerifyCache		*self,
+						 JcatContext		*context,
+						 GBytes			*blob,
+						 JcatBlob		*blob_signature,
+						 JcatVerifyFlags	 flags,
+						 GError			**error)
+						 G_GNUC_WARN_UNUSED_RESULT;
@@ -140,6 +140,10 @@ fu_altos_device_tty_open (FuAltosDevice *self, GError **error)
 	self->io_channel = fu_io_channel_new_file (self->tty, error);
 	if (self->io_channel == NULL)
 		return FALSE;
+	fu_io_channel_set_device (self->io_channel, FU_DEVICE (self));
+
+	/* coalesce the command and page data into one write */
+	fu_io_channel_set_buffer_size (self->io_channel, 0x1000);
 
 	/* get the old termios settings so we can restore later */
 	if (tcgetattr (fu_io_channel_unix_get_fd (self->io_channel), &termios) < 0) {
@@ -187,6 +191,8 @@ fu_altos_device_tty_open (FuAltosDevice *self, GError **error)
 static gboolean
 fu_altos_device_tty_close (FuAltosDevice *self, GError **error)
 {
+	if (!fu_io_channel_flush (self->io_channel, 500, error))
+		return FALSE;
 	tcsetattr (fu_io_channel_unix_get_fd (self->io_channel),
 		   TCSAFLUSH, &self->tty_termios);
 	if (!fu_io_channel_shutdown (self->io_channel, error))
@@ -195,17 +201,25 @@ fu_altos_device_tty_close (FuAltosDevice *self, GError **error)
 	return TRUE;
 }
 
-static GString *
-fu_altos_device_read_page (FuAltosDevice *self, guint address, GError **error)
+static gboolean
+fu_altos_device_read_page (FuAltosDevice *self,
+			   guint address,
+			   guint8 *buf,
+			   gsize bufsz,
+			   GError **error)
 {
-	g_autoptr(GString) str = NULL;
 	g_autofree gchar *cmd = g_strdup_printf ("R %x\n", address);
 	if (!fu_altos_device_tty_write (self, cmd, -1, error))
-		return NULL;
-	str = fu_altos_device_tty_read (self, 1500, 256, error);
-	if (str == NULL)
-		return NULL;
-	return g_steal_pointer (&str);
+		return FALSE;
+	if (!fu_io_channel_read_until (self->io_channel, buf, bufsz, NULL,
+				       NULL, 0, 1500, FU_IO_CHANNEL_FLAG_NONE,
+				       error)) {
+		g_prefix_error (error, "failed to read @%x: ", address);
+		return FALSE;
+	}
+	if (g_getenv ("FWUPD_ALTOS_VERBOSE") != NULL)
+		fu_common_dump_raw (G_LOG_DOMAIN, "read", buf, bufsz);
+	return TRUE;
 }
 
 static gboolean
@@ -318,7 +332,7 @@ fu_altos_device_write_firmware (FuDevice *device,
 		return FALSE;
 	fu_device_set_status (device, FWUPD_STATUS_DEVICE_WRITE);
 	for (guint i = 0; i < flash_len; i+= 0x100) {
-		g_autoptr(GString) str = NULL;
+		guint8 buf_dev[0x100];
 		guint8 buf_tmp[0x100];
 
 		/* copy remaining data into buf if required */
@@ -342,21 +356,13 @@ fu_altos_device_write_firmware (FuDevice *device,
 			return FALSE;
 
 		/* verify data written on device */
-		str = fu_altos_device_read_page (self,
-						 self->addr_base + i,
-						 error);
-		if (str == NULL)
-			return FALSE;
-		if (str->len != 0x100) {
-			g_set_error (error,
-					     FWUPD_ERROR,
-					     FWUPD_ERROR_WRITE,
-					     "failed to verify @%x, "
-					     "not enough data returned",
-					     (guint) (self->addr_base + i));
+		if (!fu_altos_device_read_page (self,
+						self->addr_base + i,
+						buf_dev,
+						sizeof(buf_dev),
+						error))
 			return FALSE;
-		}
-		if (memcmp (str->str, buf_tmp, 0x100) != 0) {
+		if (memcmp (buf_dev, buf_tmp, 0x100) != 0) {
 			g_set_error (error,
 					     FWUPD_ERROR,
 					     FWUPD_ERROR_WRITE,
@@ -367,7 +373,7 @@ fu_altos_device_write_firmware (FuDevice *device,
 
 		/* progress */
 		fu_device_set_progress_full (device, i, flash_len);
-		g_string_append_len (buf, str->str, str->len);
+		g_string_append_len (buf, (const gchar *) buf_dev, sizeof(buf_dev));
 	}
 
 	/* go to application mode */
@@ -425,18 +431,17 @@ fu_altos_device_dump_firmware (FuDevice *device, GError **error)
 	if (locker == NULL)
 		return NULL;
 	for (guint i = self->addr_base; i < self->addr_bound; i+= 0x100) {
-		g_autoptr(GString) str = NULL;
+		guint8 buf_dev[0x100];
 
 		/* request data from device */
-		str = fu_altos_device_read_page (self, i, error);
-		if (str == NULL)
+		if (!fu_altos_device_read_page (self, i, buf_dev, sizeof(buf_dev), error))
 			return NULL;
 
 		/* progress */
 		fu_device_set_progress_full (device,
 					     i - self->addr_base,
 					     self->addr_bound - self->addr_base);
-		g_string_append_len (buf, str->str, str->len);
+		g_string_append_len (buf, (const gchar *) buf_dev, sizeof(buf_dev));
 	}
 
 	/* success */
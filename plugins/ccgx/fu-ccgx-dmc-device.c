@@ -35,18 +35,18 @@ fu_ccgx_dmc_device_get_dock_id (FuCcgxDmcDevice *self,
 {
 	g_return_val_if_fail (dock_id != NULL, FALSE);
 
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    DMC_RQT_CODE_DOCK_IDENTITY, /* request */
-					    0, /* value */
-					    0, /* index */
-					    (guint8 *) dock_id, /* data */
-					    sizeof (DmcDockIdentity),  /* length */
-					    NULL, /* actual length */
-					    DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     DMC_RQT_CODE_DOCK_IDENTITY, /* request */
+					     0, /* value */
+					     0, /* index */
+					     (guint8 *) dock_id, /* data */
+					     sizeof (DmcDockIdentity),  /* length */
+					     NULL, /* actual length */
+					     DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "get_dock_id error: ");
 		return FALSE;
 	}
@@ -61,35 +61,35 @@ fu_ccgx_dmc_device_get_dock_status (FuCcgxDmcDevice *self,
 	g_return_val_if_fail (dock_status != NULL, FALSE);
 
 	/* read minimum status length */
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    DMC_RQT_CODE_DOCK_STATUS, /* request */
-					    0, /* value */
-					    0, /* index */
-					    (guint8 *) dock_status, /* data */
-					    DMC_GET_STATUS_MIN_LEN,  /* length */
-					    NULL, /* actual length */
-					    DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     DMC_RQT_CODE_DOCK_STATUS, /* request */
+					     0, /* value */
+					     0, /* index */
+					     (guint8 *) dock_status, /* data */
+					     DMC_GET_STATUS_MIN_LEN,  /* length */
+					     NULL, /* actual length */
+					     DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "get_dock_status min size error: ");
 		return FALSE;
 	}
 	if (dock_status->status_length <= sizeof(DmcDockStatus)) {
 		/* read full status length */
-		if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-						    G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-						    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-						    G_USB_DEVICE_RECIPIENT_DEVICE,
-						    DMC_RQT_CODE_DOCK_STATUS, /* request */
-						    0, /* value */
-						    0, /* index */
-						    (guint8 *) dock_status, /* data */
-						    sizeof(DmcDockStatus),  /* length */
-						    NULL, /* actual length */
-						    DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
-						    NULL, error)) {
+		if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+						     G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+						     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+						     G_USB_DEVICE_RECIPIENT_DEVICE,
+						     DMC_RQT_CODE_DOCK_STATUS, /* request */
+						     0, /* value */
+						     0, /* index */
+						     (guint8 *) dock_status, /* data */
+						     sizeof(DmcDockStatus),  /* length */
+						     NULL, /* actual length */
+						     DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
+						     NULL, error)) {
 			g_prefix_error (error, "get_dock_status actual size error: ");
 			return FALSE;
 		}
@@ -100,18 +100,18 @@ fu_ccgx_dmc_device_get_dock_status (FuCcgxDmcDevice *self,
 static gboolean
 fu_ccgx_dmc_device_send_reset_state_machine (FuCcgxDmcDevice *self, GError **error)
 {
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    DMC_RQT_CODE_RESET_STATE_MACHINE, /* request */
-					    0, /* value */
-					    0, /* index */
-					    0, /* data */
-					    0,  /* length */
-					    NULL, /* actual length */
-					    DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     DMC_RQT_CODE_RESET_STATE_MACHINE, /* request */
+					     0, /* value */
+					     0, /* index */
+					     0, /* data */
+					     0,  /* length */
+					     NULL, /* actual length */
+					     DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "send reset state machine error: ");
 		return FALSE;
 	}
@@ -123,18 +123,18 @@ fu_ccgx_dmc_device_send_sort_reset (FuCcgxDmcDevice *self,
 				    gboolean reset_later,
 				    GError **error)
 {
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    DMC_RQT_CODE_SOFT_RESET, /* request */
-					    reset_later, /* value */
-					    0, /* index */
-					    0, /* data */
-					    0,  /* length */
-					    NULL, /* actual length */
-					    DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     DMC_RQT_CODE_SOFT_RESET, /* request */
+					     reset_later, /* value */
+					     0, /* index */
+					     0, /* data */
+					     0,  /* length */
+					     NULL, /* actual length */
+					     DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "send reset error: ");
 		return FALSE;
 	}
@@ -159,18 +159,18 @@ fu_ccgx_dmc_device_send_start_upgrade (FuCcgxDmcDevice *self,
 			    "invalid metadata, buffer is NULL but size = %d",custom_meta_bufsz);
 			return FALSE;
 	}
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    DMC_RQT_CODE_UPGRADE_START, /* request */
-					    value, /* value */
-					    1, /* index, forced update for Adicora only, other dock will ignore it */
-					    (guint8 *)custom_meta_data, /* data */
-					    custom_meta_bufsz,  /* length */
-					    NULL, /* actual length */
-					    DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     DMC_RQT_CODE_UPGRADE_START, /* request */
+					     value, /* value */
+					     1, /* index, forced update for Adicora only, other dock will ignore it */
+					     (guint8 *)custom_meta_data, /* data */
+					     custom_meta_bufsz,  /* length */
+					     NULL, /* actual length */
+					     DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "send reset error: ");
 		return FALSE;
 	}
@@ -182,18 +182,18 @@ fu_ccgx_dmc_device_send_download_trigger (FuCcgxDmcDevice *self,
 					  DmcTriggerCode trigger,
 					  GError **error)
 {
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    DMC_RQT_CODE_TRIGGER, /* request */
-					    trigger, /* value */
-					    0, /* index */
-					    0, /* data */
-					    0,  /* length */
-					    NULL, /* actual length */
-					    DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     DMC_RQT_CODE_TRIGGER, /* request */
+					     trigger, /* value */
+					     0, /* index */
+					     0, /* data */
+					     0,  /* length */
+					     NULL, /* actual length */
+					     DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "send download trigger error: ");
 		return FALSE;
 	}
@@ -209,18 +209,18 @@ fu_ccgx_dmc_device_send_fwct (FuCcgxDmcDevice *self,
 {
 	g_return_val_if_fail (fwct_buf != NULL, FALSE);
 
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    DMC_RQT_CODE_FWCT_WRITE, /* request */
-					    0, /* value */
-					    0, /* index */
-					    (guint8 *) fwct_buf, /* data */
-					    fwct_sz,  /* length */
-					    NULL, /* actual length */
-					    DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     DMC_RQT_CODE_FWCT_WRITE, /* request */
+					     0, /* value */
+					     0, /* index */
+					     (guint8 *) fwct_buf, /* data */
+					     fwct_sz,  /* length */
+					     NULL, /* actual length */
+					     DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "send fwct error: ");
 		return FALSE;
 	}
@@ -234,13 +234,13 @@ fu_ccgx_dmc_device_read_intr_req (FuCcgxDmcDevice *self,
 {
 	g_return_val_if_fail (intr_rqt != NULL, FALSE);
 
-	if (!g_usb_device_interrupt_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					      self->ep_intr_in,
-					      (guint8 *) intr_rqt,
-					      sizeof(DmcIntRqt),
-					      NULL,
-					      DMC_GET_REQUEST_TIMEOUT,
-					      NULL, error)) {
+	if (!fu_usb_device_interrupt_transfer (FU_USB_DEVICE (self),
+					       self->ep_intr_in,
+					       (guint8 *) intr_rqt,
+					       sizeof(DmcIntRqt),
+					       NULL,
+					       DMC_GET_REQUEST_TIMEOUT,
+					       NULL, error)) {
 		g_prefix_error (error, "read intr rqt error: ");
 		return FALSE;
 	}
@@ -253,18 +253,18 @@ fu_ccgx_dmc_device_send_write_command (FuCcgxDmcDevice *self,
 				       guint16 num_of_row,
 				       GError **error)
 {
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    DMC_RQT_CODE_IMG_WRITE, /* request */
-					    start_row, /* value */
-					    num_of_row, /* index */
-					    0, /* data */
-					    0,  /* length */
-					    NULL, /* actual length */
-					    DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     DMC_RQT_CODE_IMG_WRITE, /* request */
+					     start_row, /* value */
+					     num_of_row, /* index */
+					     0, /* data */
+					     0,  /* length */
+					     NULL, /* actual length */
+					     DMC_CONTROL_TRANSFER_DEFAULT_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "send fwct error: ");
 		return FALSE;
 	}
@@ -279,11 +279,11 @@ fu_ccgx_dmc_device_send_row_data (FuCcgxDmcDevice *self,
 {
 	g_return_val_if_fail (row_buffer != NULL, FALSE);
 
-	if (!g_usb_device_bulk_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					 self->ep_bulk_out,
-					 (guint8 *)row_buffer, row_size, NULL,
-					 DMC_BULK_OUT_PIPE_TIMEOUT,
-					 NULL, error)) {
+	if (!fu_usb_device_bulk_transfer (FU_USB_DEVICE (self),
+					  self->ep_bulk_out,
+					  (guint8 *)row_buffer, row_size, NULL,
+					  DMC_BULK_OUT_PIPE_TIMEOUT,
+					  NULL, error)) {
 		g_prefix_error (error, "write row data error: ");
 		return FALSE;
 	}
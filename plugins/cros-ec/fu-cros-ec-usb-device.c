@@ -8,10 +8,10 @@
 
 #include <string.h>
 
-#include "fu-chunk.h"
 #include "fu-cros-ec-usb-device.h"
 #include "fu-cros-ec-common.h"
 #include "fu-cros-ec-firmware.h"
+#include "fu-usb-bulk-pipeline.h"
 
 #define USB_SUBCLASS_GOOGLE_UPDATE	0x53
 #define USB_PROTOCOL_GOOGLE_UPDATE	0xff
@@ -192,7 +192,6 @@ fu_cros_ec_usb_device_do_xfer (FuCrosEcUsbDevice * self, const guint8 *outbuf,
 			       gboolean allow_less, gsize *rxed_count,
 			       GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
 	gsize actual = 0;
 	g_autofree guint8 *outbuf_tmp = NULL;
 
@@ -203,10 +202,10 @@ fu_cros_ec_usb_device_do_xfer (FuCrosEcUsbDevice * self, const guint8 *outbuf,
 
 	/* send data out */
 	if (outbuf != NULL && outlen > 0) {
-		if (!g_usb_device_bulk_transfer (usb_device, self->ep_num,
-						 outbuf_tmp, outlen,
-						 &actual, BULK_SEND_TIMEOUT_MS,
-						 NULL, error)) {
+		if (!fu_usb_device_bulk_transfer (FU_USB_DEVICE (self), self->ep_num,
+						  outbuf_tmp, outlen,
+						  &actual, BULK_SEND_TIMEOUT_MS,
+						  NULL, error)) {
 			return FALSE;
 		}
 		if (actual != outlen) {
@@ -223,11 +222,11 @@ fu_cros_ec_usb_device_do_xfer (FuCrosEcUsbDevice * self, const guint8 *outbuf,
 	/* read reply back */
 	if (inbuf != NULL && inlen > 0) {
 		actual = 0;
-		if (!g_usb_device_bulk_transfer (usb_device,
-						 self->ep_num | 0x80,
-						 inbuf, inlen,
-						 &actual, BULK_RECV_TIMEOUT_MS,
-						 NULL, error)) {
+		if (!fu_usb_device_bulk_transfer (FU_USB_DEVICE (self),
+						  self->ep_num | 0x80,
+						  inbuf, inlen,
+						  &actual, BULK_RECV_TIMEOUT_MS,
+						  NULL, error)) {
 			return FALSE;
 		}
 		if (actual != inlen && !allow_less) {
@@ -251,14 +250,13 @@ static gboolean
 fu_cros_ec_usb_device_flush (FuDevice *device, gpointer user_data,
 			     GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (device));
 	FuCrosEcUsbDevice *self = FU_CROS_EC_USB_DEVICE (device);
 	gsize actual = 0;
 	g_autofree guint8 *inbuf = g_malloc0 (self->chunk_len);
 
-	if (g_usb_device_bulk_transfer (usb_device, self->ep_num | 0x80, inbuf,
-					self->chunk_len, &actual,
-					FLUSH_TIMEOUT_MS, NULL, NULL)) {
+	if (fu_usb_device_bulk_transfer (FU_USB_DEVICE (device), self->ep_num | 0x80, inbuf,
+					 self->chunk_len, &actual,
+					 FLUSH_TIMEOUT_MS, NULL, NULL)) {
 		g_debug ("flushing %" G_GSIZE_FORMAT " bytes", actual);
 		g_set_error (error,
 			     G_IO_ERROR,
@@ -468,7 +466,7 @@ fu_cros_ec_usb_device_transfer_block (FuDevice *device, gpointer user_data,
 	gsize transfer_size = 0;
 	guint32 reply = 0;
 	g_autoptr(GBytes) block_bytes = NULL;
-	g_autoptr(GPtrArray) chunks = NULL;
+	g_autoptr(FuUsbBulkPipeline) pipeline = NULL;
 
 	g_return_val_if_fail (block_info != NULL, FALSE);
 
@@ -491,10 +489,6 @@ fu_cros_ec_usb_device_transfer_block (FuDevice *device, gpointer user_data,
 						  error);
 	if (block_bytes == NULL)
 		return FALSE;
-	chunks = fu_chunk_array_new_from_bytes (block_bytes,
-						0x00,
-						0x00,
-						self->chunk_len);
 
 	/* first send the header */
 	if (!fu_cros_ec_usb_device_do_xfer (self, (const guint8 *)&block_info->ufh,
@@ -510,25 +504,21 @@ fu_cros_ec_usb_device_transfer_block (FuDevice *device, gpointer user_data,
 		return FALSE;
 	}
 
-	/* send the block, chunk by chunk */
-	for (guint i = 0; i < chunks->len; i++) {
-		FuChunk *chk = g_ptr_array_index (chunks, i);
-
-		if (!fu_cros_ec_usb_device_do_xfer (self,
-						    fu_chunk_get_data (chk),
-						    fu_chunk_get_data_sz (chk),
-						    NULL,
-						    0, FALSE,
-						    NULL, error)) {
-			g_prefix_error (error, "failed at sending chunk: ");
+	/* send the block, with several chunks in flight */
+	pipeline = fu_usb_bulk_pipeline_new (FU_USB_DEVICE (self), self->ep_num);
+	fu_usb_bulk_pipeline_set_transfer_size (pipeline, self->chunk_len);
+	fu_usb_bulk_pipeline_set_timeout (pipeline, BULK_SEND_TIMEOUT_MS);
+	if (!fu_usb_bulk_pipeline_write (pipeline, block_bytes, NULL, NULL, NULL, error)) {
+		g_prefix_error (error, "failed at sending chunk: ");
 
-			/* flush all data from endpoint to recover in case of error */
-			if (!fu_cros_ec_usb_device_recovery (device, NULL)) {
-				g_debug ("failed to flush to idle");
-			}
-			return FALSE;
+		/* flush all data from endpoint to recover in case of error */
+		if (!fu_cros_ec_usb_device_recovery (device, NULL)) {
+			g_debug ("failed to flush to idle");
 		}
+		return FALSE;
 	}
+	g_debug ("sent block 0x%x at %.1fKiB/s", (guint) block_info->offset,
+		 fu_usb_bulk_pipeline_get_throughput (pipeline) / 1024.f);
 
 	/* get the reply */
 	if (!fu_cros_ec_usb_device_do_xfer (self, NULL, 0,
@@ -46,6 +46,7 @@
  * * `absent-sector-size`:	In absence of sector size, assume byte
  * * `manifest-poll`:		Requires polling via GetStatus in dfuManifest state
  * * `no-bus-reset-attach`:	Do not require a bus reset to attach to normal
+ * * `adaptive-polltimeout`:	Poll sooner than the download timeout once the busy time is known
  *
  * Default value: `none`
  *
@@ -104,6 +105,9 @@ typedef struct {
 	guint16			 transfer_size;
 	guint8			 iface_number;
 	guint			 dnload_timeout;
+	guint			 dnload_busy;	/* ms, learned */
+	guint			 dnload_busy_min; /* ms, longest delay that was too short */
+	gboolean		 dnload_busy_disabled;
 	guint			 timeout_ms;
 } DfuDevicePrivate;
 
@@ -135,6 +139,10 @@ dfu_device_to_string (FuDevice *device, guint idt, GString *str)
 	fu_common_string_append_kx (str, idt, "TransferSize", priv->transfer_size);
 	fu_common_string_append_kx (str, idt, "IfaceNumber", priv->iface_number);
 	fu_common_string_append_kx (str, idt, "DnloadTimeout", priv->dnload_timeout);
+	if (priv->dnload_busy > 0)
+		fu_common_string_append_ku (str, idt, "DnloadBusy", priv->dnload_busy);
+	if (priv->dnload_busy_min > 0)
+		fu_common_string_append_ku (str, idt, "DnloadBusyMin", priv->dnload_busy_min);
 	fu_common_string_append_kx (str, idt, "TimeoutMs", priv->timeout_ms);
 	for (guint i = 0; i < priv->targets->len; i++) {
 		DfuTarget *target = g_ptr_array_index (priv->targets, i);
@@ -190,6 +198,89 @@ dfu_device_get_download_timeout (DfuDevice *device)
 	return priv->dnload_timeout;
 }
 
+/**
+ * dfu_device_set_download_timeout:
+ * @device: a #GUsbDevice
+ * @dnload_timeout: the bwPollTimeout in ms
+ *
+ * Sets the download timeout, which is normally returned by GetStatus.
+ **/
+void
+dfu_device_set_download_timeout (DfuDevice *device, guint dnload_timeout)
+{
+	DfuDevicePrivate *priv = GET_PRIVATE (device);
+	g_return_if_fail (DFU_IS_DEVICE (device));
+	priv->dnload_timeout = dnload_timeout;
+}
+
+/**
+ * dfu_device_get_download_poll_delay:
+ * @device: a #GUsbDevice
+ *
+ * Gets the time to wait before asking for the status after downloading a
+ * full-sized data block.
+ *
+ * DFU defines bwPollTimeout as the minimum time to wait, but many devices
+ * report a pessimistic value. For devices with the `adaptive-polltimeout`
+ * quirk the shorter learned busy time is used once it has been measured.
+ * Commands and any further polls while the device is busy always use
+ * bwPollTimeout.
+ *
+ * Return value: delay in ms
+ **/
+guint
+dfu_device_get_download_poll_delay (DfuDevice *device)
+{
+	DfuDevicePrivate *priv = GET_PRIVATE (device);
+	g_return_val_if_fail (DFU_IS_DEVICE (device), 0);
+	if (priv->dnload_busy == 0 || priv->dnload_busy_disabled ||
+	    !fu_device_has_custom_flag (FU_DEVICE (device), "adaptive-polltimeout"))
+		return priv->dnload_timeout;
+	return MIN (priv->dnload_busy, priv->dnload_timeout);
+}
+
+/**
+ * dfu_device_add_download_busy:
+ * @device: a #GUsbDevice
+ * @delay: time in ms waited before the first GetStatus
+ * @elapsed: time in ms from the download until the device was idle
+ * @polls: number of GetStatus requests needed after the first delay
+ *
+ * Learns how long the device is actually busy for each download.
+ *
+ * If the device was already idle at the first poll then it may have finished
+ * some time before, so a shorter delay is tried next time, but never one
+ * that has already been too short. Otherwise the delay is remembered as too
+ * short and the measured time is used directly.
+ **/
+void
+dfu_device_add_download_busy (DfuDevice *device, guint delay, guint elapsed, guint polls)
+{
+	DfuDevicePrivate *priv = GET_PRIVATE (device);
+	g_return_if_fail (DFU_IS_DEVICE (device));
+	if (polls <= 1) {
+		priv->dnload_busy = MAX ((elapsed * 3) / 4, priv->dnload_busy_min + 1);
+	} else {
+		priv->dnload_busy_min = MAX (priv->dnload_busy_min, delay);
+		priv->dnload_busy = MAX (elapsed, priv->dnload_busy_min + 1);
+	}
+}
+
+/**
+ * dfu_device_disable_download_busy:
+ * @device: a #GUsbDevice
+ *
+ * Stops using the learned busy time, e.g. as the device failed a GetStatus
+ * that was sent before bwPollTimeout.
+ **/
+void
+dfu_device_disable_download_busy (DfuDevice *device)
+{
+	DfuDevicePrivate *priv = GET_PRIVATE (device);
+	g_return_if_fail (DFU_IS_DEVICE (device));
+	priv->dnload_busy_disabled = TRUE;
+}
+
 /**
  * dfu_device_set_transfer_size:
  * @device: a #GUsbDevice
@@ -897,17 +988,17 @@ dfu_device_refresh (DfuDevice *device, GError **error)
 	    !(priv->attributes & DFU_DEVICE_ATTRIBUTE_MANIFEST_TOL))
 		return TRUE;
 
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_INTERFACE,
-					    DFU_REQUEST_GETSTATUS,
-					    0,
-					    priv->iface_number,
-					    buf, sizeof(buf), &actual_length,
-					    priv->timeout_ms,
-					    NULL, /* cancellable */
-					    &error_local)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (device),
+					     G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     DFU_REQUEST_GETSTATUS,
+					     0,
+					     priv->iface_number,
+					     buf, sizeof(buf), &actual_length,
+					     priv->timeout_ms,
+					     NULL, /* cancellable */
+					     &error_local)) {
 		g_set_error (error,
 			     FWUPD_ERROR,
 			     FWUPD_ERROR_NOT_SUPPORTED,
@@ -958,21 +1049,20 @@ static gboolean
 dfu_device_request_detach (DfuDevice *self, GError **error)
 {
 	DfuDevicePrivate *priv = GET_PRIVATE (self);
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
 	const guint16 timeout_reset_ms = 1000;
 	g_autoptr(GError) error_local = NULL;
 
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_INTERFACE,
-					    DFU_REQUEST_DETACH,
-					    timeout_reset_ms,
-					    priv->iface_number,
-					    NULL, 0, NULL,
-					    priv->timeout_ms,
-					    NULL, /* cancellable */
-					    &error_local)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     DFU_REQUEST_DETACH,
+					     timeout_reset_ms,
+					     priv->iface_number,
+					     NULL, 0, NULL,
+					     priv->timeout_ms,
+					     NULL, /* cancellable */
+					     &error_local)) {
 		/* some devices just reboot and stall the endpoint :/ */
 		if (g_error_matches (error_local,
 				     G_USB_DEVICE_ERROR,
@@ -1099,17 +1189,17 @@ dfu_device_abort (DfuDevice *device, GError **error)
 	if (!dfu_device_ensure_interface (device, error))
 		return FALSE;
 
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_INTERFACE,
-					    DFU_REQUEST_ABORT,
-					    0,
-					    priv->iface_number,
-					    NULL, 0, NULL,
-					    priv->timeout_ms,
-					    NULL, /* cancellable */
-					    &error_local)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (device),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     DFU_REQUEST_ABORT,
+					     0,
+					     priv->iface_number,
+					     NULL, 0, NULL,
+					     priv->timeout_ms,
+					     NULL, /* cancellable */
+					     &error_local)) {
 		/* refresh the error code */
 		dfu_device_error_fixup (device, &error_local);
 		g_set_error (error,
@@ -1166,17 +1256,17 @@ dfu_device_clear_status (DfuDevice *device, GError **error)
 	if (!dfu_device_ensure_interface (device, error))
 		return FALSE;
 
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_INTERFACE,
-					    DFU_REQUEST_CLRSTATUS,
-					    0,
-					    priv->iface_number,
-					    NULL, 0, NULL,
-					    priv->timeout_ms,
-					    NULL, /* cancellable */
-					    &error_local)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (device),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     DFU_REQUEST_CLRSTATUS,
+					     0,
+					     priv->iface_number,
+					     NULL, 0, NULL,
+					     priv->timeout_ms,
+					     NULL, /* cancellable */
+					     &error_local)) {
 		/* refresh the error code */
 		dfu_device_error_fixup (device, &error_local);
 		g_set_error (error,
@@ -95,6 +95,14 @@ void		 dfu_device_set_timeout			(DfuDevice	*device,
 void		 dfu_device_error_fixup			(DfuDevice	*device,
 							 GError		**error);
 guint		 dfu_device_get_download_timeout	(DfuDevice	*device);
+void		 dfu_device_set_download_timeout	(DfuDevice	*device,
+							 guint		 dnload_timeout);
+guint		 dfu_device_get_download_poll_delay	(DfuDevice	*device);
+void		 dfu_device_add_download_busy		(DfuDevice	*device,
+							 guint		 delay,
+							 guint		 elapsed,
+							 guint		 polls);
+void		 dfu_device_disable_download_busy	(DfuDevice	*device);
 gchar		*dfu_device_get_attributes_as_string	(DfuDevice	*device);
 gboolean	 dfu_device_ensure_interface		(DfuDevice	*device,
 							 GError		**error);
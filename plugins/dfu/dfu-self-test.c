@@ -23,6 +23,45 @@ dfu_enums_func (void)
 		g_assert_cmpstr (dfu_status_to_string (i), !=, NULL);
 }
 
+static void
+dfu_device_download_busy_func (void)
+{
+	g_autoptr(DfuDevice) device = dfu_device_new (NULL);
+
+	/* always bwPollTimeout unless the quirk is set */
+	dfu_device_set_download_timeout (device, 100);
+	dfu_device_add_download_busy (device, 100, 20, 1);
+	g_assert_cmpint (dfu_device_get_download_poll_delay (device), ==, 100);
+	fu_device_set_custom_flags (FU_DEVICE (device), "adaptive-polltimeout");
+
+	/* idle at the first poll, so try shorter */
+	g_assert_cmpint (dfu_device_get_download_poll_delay (device), ==, 15);
+	dfu_device_add_download_busy (device, 15, 16, 1);
+	g_assert_cmpint (dfu_device_get_download_poll_delay (device), ==, 12);
+
+	/* still busy at the first poll, so use the measured time */
+	dfu_device_add_download_busy (device, 12, 112, 2);
+	g_assert_cmpint (dfu_device_get_download_poll_delay (device), ==, 100);
+
+	/* shrinks again, but never below a delay that was too short */
+	dfu_device_add_download_busy (device, 100, 101, 1);
+	g_assert_cmpint (dfu_device_get_download_poll_delay (device), ==, 75);
+	for (guint i = 0; i < 20; i++) {
+		guint delay = dfu_device_get_download_poll_delay (device);
+		dfu_device_add_download_busy (device, delay, delay + 1, 1);
+	}
+	g_assert_cmpint (dfu_device_get_download_poll_delay (device), ==, 13);
+
+	/* never longer than bwPollTimeout */
+	dfu_device_set_download_timeout (device, 10);
+	g_assert_cmpint (dfu_device_get_download_poll_delay (device), ==, 10);
+	dfu_device_set_download_timeout (device, 100);
+
+	/* an early poll failed */
+	dfu_device_disable_download_busy (device);
+	g_assert_cmpint (dfu_device_get_download_poll_delay (device), ==, 100);
+}
+
 static gboolean
 fu_test_compare_lines (const gchar *txt1, const gchar *txt2, GError **error)
 {
@@ -159,6 +198,7 @@ main (int argc, char **argv)
 
 	/* tests go here */
 	g_test_add_func ("/dfu/enums", dfu_enums_func);
+	g_test_add_func ("/dfu/device{download-busy}", dfu_device_download_busy_func);
 	g_test_add_func ("/dfu/target(DfuSe}", dfu_target_dfuse_func);
 	return g_test_run ();
 }
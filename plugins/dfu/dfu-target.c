@@ -518,16 +518,23 @@ dfu_target_manifest_wait (DfuTarget *target, GError **error)
 	return TRUE;
 }
 
-gboolean
-dfu_target_check_status (DfuTarget *target, GError **error)
+static gboolean
+dfu_target_check_status_full (DfuTarget *target,
+			      gboolean refresh,
+			      guint *polls,
+			      GError **error)
 {
 	DfuTargetPrivate *priv = GET_PRIVATE (target);
 	DfuStatus status;
 	g_autoptr(GTimer) timer = g_timer_new ();
 
-	/* get the status */
-	if (!dfu_device_refresh (priv->device, error))
-		return FALSE;
+	/* get the status, unless the caller just did */
+	if (refresh) {
+		if (!dfu_device_refresh (priv->device, error))
+			return FALSE;
+		if (polls != NULL)
+			(*polls)++;
+	}
 
 	/* wait for dfuDNBUSY to not be set */
 	while (dfu_device_get_state (priv->device) == DFU_STATE_DFU_DNBUSY) {
@@ -535,6 +542,8 @@ dfu_target_check_status (DfuTarget *target, GError **error)
 		g_usleep (dfu_device_get_download_timeout (priv->device) * 1000);
 		if (!dfu_device_refresh (priv->device, error))
 			return FALSE;
+		if (polls != NULL)
+			(*polls)++;
 		/* this is a really long time to save fwupd in case
 		 * the device has got wedged */
 		if (g_timer_elapsed (timer, NULL) > 120.f) {
@@ -577,6 +586,12 @@ dfu_target_check_status (DfuTarget *target, GError **error)
 	return FALSE;
 }
 
+gboolean
+dfu_target_check_status (DfuTarget *target, GError **error)
+{
+	return dfu_target_check_status_full (target, TRUE, NULL, error);
+}
+
 /**
  * dfu_target_use_alt_setting:
  * @target: a #DfuTarget
@@ -780,27 +795,32 @@ gboolean
 dfu_target_download_chunk (DfuTarget *target, guint16 index, GBytes *bytes, GError **error)
 {
 	DfuTargetPrivate *priv = GET_PRIVATE (target);
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (priv->device));
+	gboolean is_data;
+	gboolean refresh = TRUE;
+	guint delay;
+	guint polls = 0;
 	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GError) error_poll = NULL;
+	g_autoptr(GTimer) timer = NULL;
 	gsize actual_length;
 
 	/* low level packet debugging */
 	if (g_getenv ("FWUPD_DFU_VERBOSE") != NULL)
 		fu_common_dump_bytes (G_LOG_DOMAIN, "Message", bytes);
 
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_INTERFACE,
-					    DFU_REQUEST_DNLOAD,
-					    index,
-					    dfu_device_get_interface (priv->device),
-					    (guint8 *) g_bytes_get_data (bytes, NULL),
-					    g_bytes_get_size (bytes),
-					    &actual_length,
-					    dfu_device_get_timeout (priv->device),
-					    NULL,
-					    &error_local)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (priv->device),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     DFU_REQUEST_DNLOAD,
+					     index,
+					     dfu_device_get_interface (priv->device),
+					     (guint8 *) g_bytes_get_data (bytes, NULL),
+					     g_bytes_get_size (bytes),
+					     &actual_length,
+					     dfu_device_get_timeout (priv->device),
+					     NULL,
+					     &error_local)) {
 		/* refresh the error code */
 		dfu_device_error_fixup (priv->device, &error_local);
 		g_set_error (error,
@@ -811,27 +831,59 @@ dfu_target_download_chunk (DfuTarget *target, guint16 index, GBytes *bytes, GErr
 		return FALSE;
 	}
 
+	timer = g_timer_new ();
+
 	/* for STM32 devices, the action only occurs when we do GetStatus */
 	if (dfu_device_get_version (priv->device) == DFU_VERSION_DFUSE) {
 		if (!dfu_device_refresh (priv->device, error))
 			return FALSE;
+
+		/* the trigger already returned the idle state, so there is
+		 * no need to sleep and then ask again */
+		if (dfu_device_get_state (priv->device) == DFU_STATE_DFU_DNLOAD_IDLE)
+			refresh = FALSE;
 	}
 
+	/* only full-sized data blocks are representative of the busy time,
+	 * and commands such as erase or set-address always use bwPollTimeout */
+	is_data = g_bytes_get_size (bytes) == dfu_device_get_transfer_size (priv->device);
+	if (dfu_device_get_version (priv->device) == DFU_VERSION_DFUSE && index < 2)
+		is_data = FALSE;
+
 	/* wait for the device to write contents to the EEPROM */
-	if (g_bytes_get_size (bytes) == 0 &&
-	    dfu_device_get_download_timeout (priv->device) > 0) {
+	delay = is_data ? dfu_device_get_download_poll_delay (priv->device) :
+			  dfu_device_get_download_timeout (priv->device);
+	if (refresh && g_bytes_get_size (bytes) == 0 && delay > 0) {
 		dfu_target_set_action (target, FWUPD_STATUS_IDLE);
 		dfu_target_set_action (target, FWUPD_STATUS_DEVICE_BUSY);
 	}
-	if (dfu_device_get_download_timeout (priv->device) > 0) {
-		g_debug ("sleeping for %ums…",
-			 dfu_device_get_download_timeout (priv->device));
-		g_usleep (dfu_device_get_download_timeout (priv->device) * 1000);
+	if (refresh && delay > 0) {
+		g_debug ("sleeping for %ums…", delay);
+		g_usleep (delay * 1000);
 	}
 
 	/* find out if the write was successful, waiting for BUSY to clear */
-	if (!dfu_target_check_status (target, error))
-		return FALSE;
+	if (!dfu_target_check_status_full (target, refresh, &polls, &error_poll)) {
+		if (!refresh || delay >= dfu_device_get_download_timeout (priv->device)) {
+			g_propagate_error (error, g_steal_pointer (&error_poll));
+			return FALSE;
+		}
+
+		/* the device did not like being polled early, so give it the
+		 * full bwPollTimeout and stop learning */
+		g_debug ("failed to get status after %ums, retrying: %s",
+			 delay, error_poll->message);
+		dfu_device_disable_download_busy (priv->device);
+		g_usleep (dfu_device_get_download_timeout (priv->device) * 1000);
+		if (!dfu_target_check_status_full (target, TRUE, NULL, error))
+			return FALSE;
+	} else if (refresh && is_data) {
+		/* learn how long the device was actually busy */
+		dfu_device_add_download_busy (priv->device,
+					      delay,
+					      (guint) (g_timer_elapsed (timer, NULL) * 1000),
+					      polls);
+	}
 
 	g_assert (actual_length == g_bytes_get_size (bytes));
 	return TRUE;
@@ -841,7 +893,6 @@ GBytes *
 dfu_target_upload_chunk (DfuTarget *target, guint16 index, gsize buf_sz, GError **error)
 {
 	DfuTargetPrivate *priv = GET_PRIVATE (target);
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (priv->device));
 	g_autoptr(GError) error_local = NULL;
 	guint8 *buf;
 	gsize actual_length;
@@ -851,18 +902,18 @@ dfu_target_upload_chunk (DfuTarget *target, guint16 index, gsize buf_sz, GError
 		buf_sz = (gsize) dfu_device_get_transfer_size (priv->device);
 
 	buf = g_new0 (guint8, buf_sz);
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_INTERFACE,
-					    DFU_REQUEST_UPLOAD,
-					    index,
-					    dfu_device_get_interface (priv->device),
-					    buf, buf_sz,
-					    &actual_length,
-					    dfu_device_get_timeout (priv->device),
-					    NULL,
-					    &error_local)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (priv->device),
+					     G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     DFU_REQUEST_UPLOAD,
+					     index,
+					     dfu_device_get_interface (priv->device),
+					     buf, buf_sz,
+					     &actual_length,
+					     dfu_device_get_timeout (priv->device),
+					     NULL,
+					     &error_local)) {
 		/* refresh the error code */
 		dfu_device_error_fixup (priv->device, &error_local);
 		g_set_error (error,
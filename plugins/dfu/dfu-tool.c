@@ -643,6 +643,8 @@ static gboolean
 dfu_tool_write_alt (DfuToolPrivate *priv, gchar **values, GError **error)
 {
 	DfuTargetTransferFlags flags = DFU_TARGET_TRANSFER_FLAG_VERIFY;
+	gdouble elapsed;
+	gsize total = 0;
 	g_autofree gchar *str_debug = NULL;
 	g_autoptr(DfuDevice) device = NULL;
 	g_autoptr(FuFirmware) firmware = NULL;
@@ -650,6 +652,8 @@ dfu_tool_write_alt (DfuToolPrivate *priv, gchar **values, GError **error)
 	g_autoptr(DfuTarget) target = NULL;
 	g_autoptr(FuDeviceLocker) locker  = NULL;
 	g_autoptr(GFile) file = NULL;
+	g_autoptr(GPtrArray) chunks = NULL;
+	g_autoptr(GTimer) timer = NULL;
 
 	/* check args */
 	if (g_strv_length (values) < 2) {
@@ -749,8 +753,17 @@ dfu_tool_write_alt (DfuToolPrivate *priv, gchar **values, GError **error)
 	}
 
 	/* transfer */
+	timer = g_timer_new ();
 	if (!dfu_target_download (target, image, flags, error))
 		return FALSE;
+	elapsed = g_timer_elapsed (timer, NULL);
+	chunks = fu_firmware_image_get_chunks (image, error);
+	if (chunks == NULL)
+		return FALSE;
+	for (guint i = 0; i < chunks->len; i++) {
+		FuChunk *chk = g_ptr_array_index (chunks, i);
+		total += fu_chunk_get_data_sz (chk);
+	}
 
 	/* do host reset */
 	if (!fu_device_attach (FU_DEVICE (device), error))
@@ -759,7 +772,9 @@ dfu_tool_write_alt (DfuToolPrivate *priv, gchar **values, GError **error)
 		return FALSE;
 
 	/* success */
-	g_print ("Successfully downloaded to device\n");
+	g_print ("%u bytes successfully downloaded to device in %.1fs (%.1f KiB/s)\n",
+		 (guint) total, elapsed,
+		 elapsed > 0.f ? total / (elapsed * 1024.f) : 0.f);
 	return TRUE;
 }
 
@@ -767,9 +782,11 @@ static gboolean
 dfu_tool_write (DfuToolPrivate *priv, gchar **values, GError **error)
 {
 	FwupdInstallFlags flags = FWUPD_INSTALL_FLAG_NONE;
+	gdouble elapsed;
 	g_autoptr(DfuDevice) device = NULL;
 	g_autoptr(GBytes) fw = NULL;
 	g_autoptr(FuDeviceLocker) locker  = NULL;
+	g_autoptr(GTimer) timer = NULL;
 
 	/* check args */
 	if (g_strv_length (values) < 1) {
@@ -816,8 +833,10 @@ dfu_tool_write (DfuToolPrivate *priv, gchar **values, GError **error)
 			  G_CALLBACK (fu_tool_action_changed_cb), priv);
 	g_signal_connect (device, "notify::progress",
 			  G_CALLBACK (fu_tool_action_changed_cb), priv);
+	timer = g_timer_new ();
 	if (!fu_device_write_firmware (FU_DEVICE (device), fw, flags, error))
 		return FALSE;
+	elapsed = g_timer_elapsed (timer, NULL);
 
 	/* do host reset */
 	if (!fu_device_attach (FU_DEVICE (device), error))
@@ -829,8 +848,9 @@ dfu_tool_write (DfuToolPrivate *priv, gchar **values, GError **error)
 	}
 
 	/* success */
-	g_print ("%u bytes successfully downloaded to device\n",
-		 (guint) g_bytes_get_size (fw));
+	g_print ("%u bytes successfully downloaded to device in %.1fs (%.1f KiB/s)\n",
+		 (guint) g_bytes_get_size (fw), elapsed,
+		 elapsed > 0.f ? g_bytes_get_size (fw) / (elapsed * 1024.f) : 0.f);
 	return TRUE;
 }
 
@@ -30,7 +30,6 @@ fu_ebitdo_device_send (FuEbitdoDevice *self,
 		       gsize in_len,
 		       GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
 	guint8 packet[FU_EBITDO_USB_EP_SIZE] = {0};
 	gsize actual_length;
 	guint8 ep_out = FU_EBITDO_USB_RUNTIME_EP_OUT;
@@ -77,14 +76,14 @@ fu_ebitdo_device_send (FuEbitdoDevice *self,
 	}
 
 	/* get data from device */
-	if (!g_usb_device_interrupt_transfer (usb_device,
-					      ep_out,
-					      packet,
-					      FU_EBITDO_USB_EP_SIZE,
-					      &actual_length,
-					      FU_EBITDO_USB_TIMEOUT,
-					      NULL, /* cancellable */
-					      &error_local)) {
+	if (!fu_usb_device_interrupt_transfer (FU_USB_DEVICE (self),
+					       ep_out,
+					       packet,
+					       FU_EBITDO_USB_EP_SIZE,
+					       &actual_length,
+					       FU_EBITDO_USB_TIMEOUT,
+					       NULL, /* cancellable */
+					       &error_local)) {
 		g_set_error (error,
 			     G_IO_ERROR,
 			     G_IO_ERROR_INVALID_DATA,
@@ -102,7 +101,6 @@ fu_ebitdo_device_receive (FuEbitdoDevice *self,
 		       gsize out_len,
 		       GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
 	guint8 packet[FU_EBITDO_USB_EP_SIZE] = {0};
 	gsize actual_length;
 	guint8 ep_in = FU_EBITDO_USB_RUNTIME_EP_IN;
@@ -114,14 +112,14 @@ fu_ebitdo_device_receive (FuEbitdoDevice *self,
 		ep_in = FU_EBITDO_USB_BOOTLOADER_EP_IN;
 
 	/* get data from device */
-	if (!g_usb_device_interrupt_transfer (usb_device,
-					      ep_in,
-					      packet,
-					      FU_EBITDO_USB_EP_SIZE,
-					      &actual_length,
-					      FU_EBITDO_USB_TIMEOUT,
-					      NULL, /* cancellable */
-					      &error_local)) {
+	if (!fu_usb_device_interrupt_transfer (FU_USB_DEVICE (self),
+					       ep_in,
+					       packet,
+					       FU_EBITDO_USB_EP_SIZE,
+					       &actual_length,
+					       FU_EBITDO_USB_TIMEOUT,
+					       NULL, /* cancellable */
+					       &error_local)) {
 		g_set_error (error,
 			     G_IO_ERROR,
 			     G_IO_ERROR_INVALID_DATA,
@@ -10,8 +10,8 @@
 #include <xmlb.h>
 
 #include "fu-archive.h"
-#include "fu-chunk.h"
 #include "fu-fastboot-device.h"
+#include "fu-usb-bulk-pipeline.h"
 
 #define FASTBOOT_REMOVE_DELAY_RE_ENUMERATE	60000 /* ms */
 #define FASTBOOT_TRANSACTION_TIMEOUT		1000 /* ms */
@@ -87,7 +87,6 @@ fu_fastboot_buffer_dump (const gchar *title, const guint8 *buf, gsize sz)
 static gboolean
 fu_fastboot_device_write (FuDevice *device, const guint8 *buf, gsize buflen, GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (device));
 	gboolean ret;
 	gsize actual_len = 0;
 	g_autofree guint8 *buf2 = NULL;
@@ -98,13 +97,13 @@ fu_fastboot_device_write (FuDevice *device, const guint8 *buf, gsize buflen, GEr
 		return FALSE;
 
 	fu_fastboot_buffer_dump ("writing", buf, buflen);
-	ret = g_usb_device_bulk_transfer (usb_device,
-					  FASTBOOT_EP_OUT,
-					  buf2,
-					  buflen,
-					  &actual_len,
-					  FASTBOOT_TRANSACTION_TIMEOUT,
-					  NULL, error);
+	ret = fu_usb_device_bulk_transfer (FU_USB_DEVICE (device),
+					   FASTBOOT_EP_OUT,
+					   buf2,
+					   buflen,
+					   &actual_len,
+					   FASTBOOT_TRANSACTION_TIMEOUT,
+					   NULL, error);
 	if (!ret) {
 		g_prefix_error (error, "failed to do bulk transfer: ");
 		return FALSE;
@@ -146,7 +145,6 @@ fu_fastboot_device_read (FuDevice *device,
 			 GError **error)
 {
 	FuFastbootDevice *self = FU_FASTBOOT_DEVICE (device);
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (device));
 	guint retries = 1;
 
 	/* these commands may return INFO or take some time to complete */
@@ -160,13 +158,13 @@ fu_fastboot_device_read (FuDevice *device,
 		g_autofree gchar *tmp = NULL;
 		g_autoptr(GError) error_local = NULL;
 
-		ret = g_usb_device_bulk_transfer (usb_device,
-						  FASTBOOT_EP_IN,
-						  buf,
-						  sizeof(buf),
-						  &actual_len,
-						  FASTBOOT_TRANSACTION_TIMEOUT,
-						  NULL, &error_local);
+		ret = fu_usb_device_bulk_transfer (FU_USB_DEVICE (device),
+						   FASTBOOT_EP_IN,
+						   buf,
+						   sizeof(buf),
+						   &actual_len,
+						   FASTBOOT_TRANSACTION_TIMEOUT,
+						   NULL, &error_local);
 		if (!ret) {
 			if (g_error_matches (error_local,
 					     G_USB_DEVICE_ERROR,
@@ -264,13 +262,20 @@ fu_fastboot_device_flash (FuDevice *device, const gchar *partition, GError **err
 				       error);
 }
 
+static void
+fu_fastboot_device_download_progress_cb (goffset current, goffset total, gpointer user_data)
+{
+	FuDevice *device = FU_DEVICE (user_data);
+	fu_device_set_progress_full (device, (gsize) current, (gsize) total * 2);
+}
+
 static gboolean
 fu_fastboot_device_download (FuDevice *device, GBytes *fw, GError **error)
 {
 	FuFastbootDevice *self = FU_FASTBOOT_DEVICE (device);
 	gsize sz = g_bytes_get_size (fw);
 	g_autofree gchar *tmp = g_strdup_printf ("download:%08x", (guint) sz);
-	g_autoptr(GPtrArray) chunks = NULL;
+	g_autoptr(FuUsbBulkPipeline) pipeline = NULL;
 
 	/* tell the client the size of data to expect */
 	if (!fu_fastboot_device_cmd (device, tmp,
@@ -278,21 +283,26 @@ fu_fastboot_device_download (FuDevice *device, GBytes *fw, GError **error)
 				     error))
 		return FALSE;
 
-	/* send the data in chunks */
+	/* the blocks are not written one at a time, so dump them all first */
+	if (g_getenv ("FWUPD_FASTBOOT_VERBOSE") != NULL) {
+		const guint8 *buf = g_bytes_get_data (fw, NULL);
+		for (gsize i = 0; i < sz; i += self->blocksz)
+			fu_fastboot_buffer_dump ("writing", buf + i, MIN (self->blocksz, sz - i));
+	}
+
+	/* send the data in blocks, with several in flight */
 	fu_device_set_status (device, FWUPD_STATUS_DEVICE_WRITE);
-	chunks = fu_chunk_array_new_from_bytes (fw,
-						0x00,	/* start addr */
-						0x00,	/* page_sz */
-						self->blocksz);
-	for (guint i = 0; i < chunks->len; i++) {
-		FuChunk *chk = g_ptr_array_index (chunks, i);
-		if (!fu_fastboot_device_write (device,
-					       fu_chunk_get_data (chk),
-					       fu_chunk_get_data_sz (chk),
-					       error))
-			return FALSE;
-		fu_device_set_progress_full (device, (gsize) i, (gsize) chunks->len * 2);
+	pipeline = fu_usb_bulk_pipeline_new (FU_USB_DEVICE (device), FASTBOOT_EP_OUT);
+	fu_usb_bulk_pipeline_set_transfer_size (pipeline, self->blocksz);
+	fu_usb_bulk_pipeline_set_timeout (pipeline, FASTBOOT_TRANSACTION_TIMEOUT);
+	if (!fu_usb_bulk_pipeline_write (pipeline, fw,
+					 fu_fastboot_device_download_progress_cb,
+					 device, NULL, error)) {
+		g_prefix_error (error, "failed to download: ");
+		return FALSE;
 	}
+	g_debug ("downloaded 0x%x bytes at %.1fKiB/s", (guint) sz,
+		 fu_usb_bulk_pipeline_get_throughput (pipeline) / 1024.f);
 	if (!fu_fastboot_device_read (device, NULL,
 				      FU_FASTBOOT_DEVICE_READ_FLAG_STATUS_POLL, error))
 		return FALSE;
@@ -35,7 +35,6 @@ goodixmoc_device_cmd_send (FuGoodixMocDevice *self,
 			   GByteArray *req,
 			   GError    **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
 	guint32 crc_all = 0;
 	guint32 crc_hdr = 0;
 	gsize actual_len = 0;
@@ -55,12 +54,12 @@ goodixmoc_device_cmd_send (FuGoodixMocDevice *self,
 	fu_byte_array_append_uint32 (buf, crc_all, G_LITTLE_ENDIAN);
 
 	/* send zero length package */
-	if (!g_usb_device_bulk_transfer (usb_device,
-					 GX_USB_BULK_EP_OUT,
-					 NULL,
-					 0,
-					 NULL,
-					 GX_USB_DATAOUT_TIMEOUT, NULL, error)) {
+	if (!fu_usb_device_bulk_transfer (FU_USB_DEVICE (self),
+					  GX_USB_BULK_EP_OUT,
+					  NULL,
+					  0,
+					  NULL,
+					  GX_USB_DATAOUT_TIMEOUT, NULL, error)) {
 		g_prefix_error (error, "failed to req: ");
 		return FALSE;
 	}
@@ -71,12 +70,12 @@ goodixmoc_device_cmd_send (FuGoodixMocDevice *self,
 	}
 
 	/* send data */
-	if (!g_usb_device_bulk_transfer (usb_device,
-					 GX_USB_BULK_EP_OUT,
-					 buf->data,
-					 buf->len,
-					 &actual_len,
-					 GX_USB_DATAOUT_TIMEOUT, NULL, error)) {
+	if (!fu_usb_device_bulk_transfer (FU_USB_DEVICE (self),
+					  GX_USB_BULK_EP_OUT,
+					  buf->data,
+					  buf->len,
+					  &actual_len,
+					  GX_USB_DATAOUT_TIMEOUT, NULL, error)) {
 		g_prefix_error (error, "failed to req: ");
 		return FALSE;
 	}
@@ -98,7 +97,6 @@ goodixmoc_device_cmd_recv (FuGoodixMocDevice *self,
 			   gboolean     data_reply,
 			   GError     **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
 	guint32 crc_actual = 0;
 	guint32 crc_calculated = 0;
 	gsize actual_len = 0;
@@ -115,13 +113,13 @@ goodixmoc_device_cmd_recv (FuGoodixMocDevice *self,
 		guint8 header_cmd0 = 0x0;
 		g_autoptr(GByteArray) reply = g_byte_array_new ();
 		fu_byte_array_set_size (reply, GX_FLASH_TRANSFER_BLOCK_SIZE);
-		if (!g_usb_device_bulk_transfer (usb_device,
-						 GX_USB_BULK_EP_IN,
-						 reply->data,
-						 reply->len,
-						 &actual_len, /* allowed to return short read */
-						 GX_USB_DATAIN_TIMEOUT,
-						 NULL, error)) {
+		if (!fu_usb_device_bulk_transfer (FU_USB_DEVICE (self),
+						  GX_USB_BULK_EP_IN,
+						  reply->data,
+						  reply->len,
+						  &actual_len, /* allowed to return short read */
+						  GX_USB_DATAIN_TIMEOUT,
+						  NULL, error)) {
 			g_prefix_error (error, "failed to reply: ");
 			return FALSE;
 		}
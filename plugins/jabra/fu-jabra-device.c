@@ -94,17 +94,17 @@ fu_jabra_device_prepare (FuDevice *device, FwupdInstallFlags flags, GError **err
 	}
 
 	/* send magic to device */
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_INTERFACE,
-					    0x09,
-					    0x0200 | rep,
-					    0x0003,
-					    buf, 33, NULL,
-					    FU_DEVICE_REMOVE_DELAY_RE_ENUMERATE,
-					    NULL, /* cancellable */
-					    &error_local)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (device),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     0x09,
+					     0x0200 | rep,
+					     0x0003,
+					     buf, 33, NULL,
+					     FU_DEVICE_REMOVE_DELAY_RE_ENUMERATE,
+					     NULL, /* cancellable */
+					     &error_local)) {
 		g_debug ("whilst sending magic: %s, ignoring",
 			 error_local->message);
 	}
@@ -370,14 +370,14 @@ fu_logitech_hidpp_bootloader_request (FuLogitechHidPpBootloader *self,
 	if (usb_device != NULL &&
 	    req->cmd == FU_UNIFYING_BOOTLOADER_CMD_REBOOT) {
 		g_autoptr(GError) error_ignore = NULL;
-		if (!g_usb_device_interrupt_transfer (usb_device,
-						      FU_UNIFYING_DEVICE_EP1,
-						      buf_response,
-						      sizeof (buf_response),
-						      &actual_length,
-						      FU_UNIFYING_DEVICE_TIMEOUT_MS,
-						      NULL,
-						      &error_ignore)) {
+		if (!fu_usb_device_interrupt_transfer (FU_USB_DEVICE (self),
+						       FU_UNIFYING_DEVICE_EP1,
+						       buf_response,
+						       sizeof (buf_response),
+						       &actual_length,
+						       FU_UNIFYING_DEVICE_TIMEOUT_MS,
+						       NULL,
+						       &error_ignore)) {
 			g_debug ("ignoring: %s", error_ignore->message);
 		} else {
 			if (g_getenv ("FWUPD_LOGITECH_HIDPP") != NULL) {
@@ -391,14 +391,14 @@ fu_logitech_hidpp_bootloader_request (FuLogitechHidPpBootloader *self,
 	/* get response */
 	memset (buf_response, 0x00, sizeof (buf_response));
 	if (usb_device != NULL) {
-		if (!g_usb_device_interrupt_transfer (usb_device,
-						      FU_UNIFYING_DEVICE_EP1,
-						      buf_response,
-						      sizeof (buf_response),
-						      &actual_length,
-						      FU_UNIFYING_DEVICE_TIMEOUT_MS,
-						      NULL,
-						      error)) {
+		if (!fu_usb_device_interrupt_transfer (FU_USB_DEVICE (self),
+						       FU_UNIFYING_DEVICE_EP1,
+						       buf_response,
+						       sizeof (buf_response),
+						       &actual_length,
+						       FU_UNIFYING_DEVICE_TIMEOUT_MS,
+						       NULL,
+						       error)) {
 			g_prefix_error (error, "failed to get data: ");
 			return FALSE;
 		}
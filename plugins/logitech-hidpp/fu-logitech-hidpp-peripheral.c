@@ -243,6 +243,7 @@ fu_logitech_hidpp_peripheral_open (FuDevice *device, GError **error)
 	self->io_channel = fu_io_channel_new_file (devpath, error);
 	if (self->io_channel == NULL)
 		return FALSE;
+	fu_io_channel_set_device (self->io_channel, FU_DEVICE (self));
 
 	return TRUE;
 }
@@ -119,6 +119,7 @@ fu_logitech_hidpp_runtime_open (FuDevice *device, GError **error)
 	self->io_channel = fu_io_channel_new_file (devpath, error);
 	if (self->io_channel == NULL)
 		return FALSE;
+	fu_io_channel_set_device (self->io_channel, FU_DEVICE (self));
 
 	/* poll for notifications */
 	fu_device_set_poll_interval (device, 5000);
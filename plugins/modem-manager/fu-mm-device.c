@@ -398,6 +398,7 @@ fu_mm_device_io_open (FuMmDevice *self, GError **error)
 	self->io_channel = fu_io_channel_new_file (self->port_at, error);
 	if (self->io_channel == NULL)
 		return FALSE;
+	fu_io_channel_set_device (self->io_channel, FU_DEVICE (self));
 
 	/* success */
 	return TRUE;
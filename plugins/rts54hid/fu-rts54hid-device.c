@@ -75,12 +75,11 @@ fu_rts54hid_device_reset_to_flash (FuRts54HidDevice *self, GError **error)
 	return TRUE;
 }
 
-static gboolean
-fu_rts54hid_device_write_flash (FuRts54HidDevice *self,
-				guint32 addr,
-				const guint8 *data,
-				guint16 data_sz,
-				GError **error)
+static GByteArray *
+fu_rts54hid_device_write_flash_report (guint32 addr,
+				       const guint8 *data,
+				       guint16 data_sz,
+				       GError **error)
 {
 	FuRts54HidCmdBuffer cmd_buffer = {
 		.cmd = FU_RTS54HID_CMD_WRITE_DATA,
@@ -89,25 +88,19 @@ fu_rts54hid_device_write_flash (FuRts54HidDevice *self,
 		.bufferlen = GUINT16_TO_LE (data_sz),
 		.parameters = 0,
 	};
-	guint8 buf[FU_RTS54FU_HID_REPORT_LENGTH] = { 0 };
+	g_autoptr(GByteArray) buf = g_byte_array_new ();
 
-	g_return_val_if_fail (data_sz <= 128, FALSE);
-	g_return_val_if_fail (data != NULL, FALSE);
-	g_return_val_if_fail (data_sz != 0, FALSE);
+	g_return_val_if_fail (data_sz <= 128, NULL);
+	g_return_val_if_fail (data != NULL, NULL);
+	g_return_val_if_fail (data_sz != 0, NULL);
 
-	memcpy (buf, &cmd_buffer, sizeof(cmd_buffer));
-	if (!fu_memcpy_safe (buf, sizeof(buf), FU_RTS54HID_CMD_BUFFER_OFFSET_DATA,	/* dst */
+	fu_byte_array_set_size (buf, FU_RTS54FU_HID_REPORT_LENGTH);
+	memcpy (buf->data, &cmd_buffer, sizeof(cmd_buffer));
+	if (!fu_memcpy_safe (buf->data, buf->len, FU_RTS54HID_CMD_BUFFER_OFFSET_DATA,	/* dst */
 			     data, data_sz, 0x0,					/* src */
 			     data_sz, error))
-		return FALSE;
-	if (!fu_hid_device_set_report (FU_HID_DEVICE (self), 0x0, buf, sizeof(buf),
-				       FU_RTS54HID_DEVICE_TIMEOUT * 2,
-				       FU_HID_DEVICE_FLAG_NONE,
-				       error)) {
-		g_prefix_error (error, "failed to write flash @%08x: ", (guint) addr);
-		return FALSE;
-	}
-	return TRUE;
+		return NULL;
+	return g_steal_pointer (&buf);
 }
 
 static gboolean
@@ -279,20 +272,35 @@ fu_rts54hid_device_write_firmware (FuDevice *device,
 						0x00,	/* page_sz */
 						FU_RTS54HID_TRANSFER_BLOCK_SIZE);
 
-	/* write each block */
+	/* write blocks in batches, which are pipelined if the device supports it */
 	fu_device_set_status (device, FWUPD_STATUS_DEVICE_WRITE);
-	for (guint i = 0; i < chunks->len; i++) {
-		FuChunk *chk = g_ptr_array_index (chunks, i);
-		/* write chunk */
-		if (!fu_rts54hid_device_write_flash (self,
-						     fu_chunk_get_address (chk),
-						     fu_chunk_get_data (chk),
-						     fu_chunk_get_data_sz (chk),
-						     error))
+	for (guint i = 0; i < chunks->len; i += FU_RTS54HID_DEVICE_WRITE_BATCH) {
+		guint n_acked = 0;
+		g_autoptr(GPtrArray) reports = g_ptr_array_new_with_free_func ((GDestroyNotify) g_byte_array_unref);
+		for (guint j = i; j < MIN (i + FU_RTS54HID_DEVICE_WRITE_BATCH, chunks->len); j++) {
+			FuChunk *chk = g_ptr_array_index (chunks, j);
+			GByteArray *report;
+			report = fu_rts54hid_device_write_flash_report (fu_chunk_get_address (chk),
+									fu_chunk_get_data (chk),
+									fu_chunk_get_data_sz (chk),
+									error);
+			if (report == NULL)
+				return FALSE;
+			g_ptr_array_add (reports, report);
+		}
+		if (!fu_hid_device_set_reports (FU_HID_DEVICE (self), 0x0, reports,
+						FU_RTS54HID_DEVICE_TIMEOUT * 2,
+						FU_HID_DEVICE_FLAG_NONE,
+						NULL, NULL, &n_acked, error)) {
+			FuChunk *chk = g_ptr_array_index (chunks, i + n_acked);
+			g_prefix_error (error, "failed to write flash @%08x: ",
+					(guint) fu_chunk_get_address (chk));
 			return FALSE;
+		}
 
 		/* update progress */
-		fu_device_set_progress_full (device, (gsize) i, (gsize) chunks->len * 2);
+		fu_device_set_progress_full (device, (gsize) i + reports->len,
+					     (gsize) chunks->len * 2);
 	}
 
 	/* get device to authenticate the firmware */
@@ -12,3 +12,4 @@
 G_DECLARE_FINAL_TYPE (FuRts54HidDevice, fu_rts54hid_device, FU, RTS54HID_DEVICE, FuHidDevice)
 
 #define FU_RTS54HID_DEVICE_TIMEOUT			1000 /* ms */
+#define FU_RTS54HID_DEVICE_WRITE_BATCH			32 /* reports */
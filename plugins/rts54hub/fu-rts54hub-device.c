@@ -46,18 +46,17 @@ fu_rts54hub_device_to_string (FuDevice *device, guint idt, GString *str)
 static gboolean
 fu_rts54hub_device_highclockmode (FuRts54HubDevice *self, guint16 value, GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0x06,		/* request */
-					    value,		/* value */
-					    0,			/* idx */
-					    NULL, 0,		/* data */
-					    NULL,		/* actual */
-					    FU_RTS54HUB_DEVICE_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0x06,		/* request */
+					     value,		/* value */
+					     0,			/* idx */
+					     NULL, 0,		/* data */
+					     NULL,		/* actual */
+					     FU_RTS54HUB_DEVICE_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "failed to set highclockmode: ");
 		return FALSE;
 	}
@@ -68,18 +67,17 @@ fu_rts54hub_device_highclockmode (FuRts54HubDevice *self, guint16 value, GError
 static gboolean
 fu_rts54hub_device_reset_flash (FuRts54HubDevice *self, GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xC0 + 0x29,	/* request */
-					    0x0,		/* value */
-					    0x0,		/* idx */
-					    NULL, 0,		/* data */
-					    NULL,		/* actual */
-					    FU_RTS54HUB_DEVICE_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xC0 + 0x29,	/* request */
+					     0x0,		/* value */
+					     0x0,		/* idx */
+					     NULL, 0,		/* data */
+					     NULL,		/* actual */
+					     FU_RTS54HUB_DEVICE_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "failed to reset flash: ");
 		return FALSE;
 	}
@@ -93,7 +91,6 @@ fu_rts54hub_device_write_flash (FuRts54HubDevice *self,
 				gsize datasz,
 				GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
 	gsize actual_len = 0;
 	g_autofree guint8 *datarw = NULL;
 
@@ -102,17 +99,17 @@ fu_rts54hub_device_write_flash (FuRts54HubDevice *self,
 	if (datarw == NULL)
 		return FALSE;
 
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xC0 + 0x08,	/* request */
-					    addr % (1 << 16),	/* value */
-					    addr / (1 << 16),	/* idx */
-					    datarw, datasz,	/* data */
-					    &actual_len,
-					    FU_RTS54HUB_DEVICE_TIMEOUT_RW,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xC0 + 0x08,	/* request */
+					     addr % (1 << 16),	/* value */
+					     addr / (1 << 16),	/* idx */
+					     datarw, datasz,	/* data */
+					     &actual_len,
+					     FU_RTS54HUB_DEVICE_TIMEOUT_RW,
+					     NULL, error)) {
 		g_prefix_error (error, "failed to write flash: ");
 		return FALSE;
 	}
@@ -132,19 +129,18 @@ fu_rts54hub_device_read_flash (FuRts54HubDevice *self,
 			       gsize datasz,
 			       GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
 	gsize actual_len = 0;
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xC0 + 0x18,	/* request */
-					    addr % (1 << 16),	/* value */
-					    addr / (1 << 16),	/* idx */
-					    data, datasz,	/* data */
-					    &actual_len,
-					    FU_RTS54HUB_DEVICE_TIMEOUT_RW,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xC0 + 0x18,	/* request */
+					     addr % (1 << 16),	/* value */
+					     addr / (1 << 16),	/* idx */
+					     data, datasz,	/* data */
+					     &actual_len,
+					     FU_RTS54HUB_DEVICE_TIMEOUT_RW,
+					     NULL, error)) {
 		g_prefix_error (error, "failed to read flash: ");
 		return FALSE;
 	}
@@ -160,18 +156,17 @@ fu_rts54hub_device_read_flash (FuRts54HubDevice *self,
 static gboolean
 fu_rts54hub_device_flash_authentication (FuRts54HubDevice *self, GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xC0 + 0x19,	/* request */
-					    0x01,		/* value */
-					    0x0,		/* idx */
-					    NULL, 0,		/* data */
-					    NULL,		/* actual */
-					    FU_RTS54HUB_DEVICE_TIMEOUT_AUTH,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xC0 + 0x19,	/* request */
+					     0x01,		/* value */
+					     0x0,		/* idx */
+					     NULL, 0,		/* data */
+					     NULL,		/* actual */
+					     FU_RTS54HUB_DEVICE_TIMEOUT_AUTH,
+					     NULL, error)) {
 		g_prefix_error (error, "failed to authenticate: ");
 		return FALSE;
 	}
@@ -183,18 +178,17 @@ fu_rts54hub_device_erase_flash (FuRts54HubDevice *self,
 				guint8 erase_type,
 				GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xC0 + 0x28,	/* request */
-					    erase_type * 256,	/* value */
-					    0x0,		/* idx */
-					    NULL, 0,		/* data */
-					    NULL,		/* actual */
-					    FU_RTS54HUB_DEVICE_TIMEOUT_ERASE,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xC0 + 0x28,	/* request */
+					     erase_type * 256,	/* value */
+					     0x0,		/* idx */
+					     NULL, 0,		/* data */
+					     NULL,		/* actual */
+					     FU_RTS54HUB_DEVICE_TIMEOUT_ERASE,
+					     NULL, error)) {
 		g_prefix_error (error, "failed to erase flash: ");
 		return FALSE;
 	}
@@ -204,24 +198,22 @@ fu_rts54hub_device_erase_flash (FuRts54HubDevice *self,
 static gboolean
 fu_rts54hub_device_vendor_cmd (FuRts54HubDevice *self, guint8 value, GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
-
 	/* don't set something that's already set */
 	if (self->vendor_cmd == value) {
 		g_debug ("skipping vendor command 0x%02x as already set", value);
 		return TRUE;
 	}
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0x02,		/* request */
-					    value,		/* value */
-					    0x0bda,		/* idx */
-					    NULL, 0,		/* data */
-					    NULL,		/* actual */
-					    FU_RTS54HUB_DEVICE_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0x02,		/* request */
+					     value,		/* value */
+					     0x0bda,		/* idx */
+					     NULL, 0,		/* data */
+					     NULL,		/* actual */
+					     FU_RTS54HUB_DEVICE_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "failed to issue vendor cmd 0x%02x: ", value);
 		return FALSE;
 	}
@@ -233,20 +225,19 @@ static gboolean
 fu_rts54hub_device_ensure_status (FuRts54HubDevice *self, GError **error)
 {
 	guint8 data[FU_RTS54HUB_DEVICE_STATUS_LEN] = { 0 };
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
 	gsize actual_len = 0;
 
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0x09,		/* request */
-					    0x0,		/* value */
-					    0x0,		/* idx */
-					    data, sizeof(data),
-					    &actual_len,	/* actual */
-					    FU_RTS54HUB_DEVICE_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0x09,		/* request */
+					     0x0,		/* value */
+					     0x0,		/* idx */
+					     data, sizeof(data),
+					     &actual_len,	/* actual */
+					     FU_RTS54HUB_DEVICE_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "failed to get status: ");
 		return FALSE;
 	}
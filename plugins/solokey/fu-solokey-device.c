@@ -145,7 +145,6 @@ fu_solokey_device_close (FuUsbDevice *device, GError **error)
 static gboolean
 fu_solokey_device_packet_tx (FuSolokeyDevice *self, GByteArray *req, GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
 	gsize actual_length = 0;
 
 	/* round up to the endpoint size */
@@ -162,14 +161,14 @@ fu_solokey_device_packet_tx (FuSolokeyDevice *self, GByteArray *req, GError **er
 	if (g_getenv ("FWUPD_SOLOKEY_EMULATE") != NULL)
 		return TRUE;
 
-	if (!g_usb_device_interrupt_transfer (usb_device,
-					      SOLO_USB_HID_EP_OUT,
-					      req->data,
-					      req->len,
-					      &actual_length,
-					      SOLO_USB_TIMEOUT,
-					      NULL, /* cancellable */
-					      error)) {
+	if (!fu_usb_device_interrupt_transfer (FU_USB_DEVICE (self),
+					       SOLO_USB_HID_EP_OUT,
+					       req->data,
+					       req->len,
+					       &actual_length,
+					       SOLO_USB_TIMEOUT,
+					       NULL, /* cancellable */
+					       error)) {
 		g_prefix_error (error, "failed to send request: ");
 		return FALSE;
 	}
@@ -189,7 +188,6 @@ fu_solokey_device_packet_tx (FuSolokeyDevice *self, GByteArray *req, GError **er
 static GByteArray *
 fu_solokey_device_packet_rx (FuSolokeyDevice *self, GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
 	gsize actual_length = 0;
 	g_autoptr(GByteArray) res = g_byte_array_new ();
 	guint8 buf[SOLO_USB_HID_EP_SIZE] = { 0x00 };
@@ -199,13 +197,13 @@ fu_solokey_device_packet_rx (FuSolokeyDevice *self, GError **error)
 		return g_steal_pointer (&res);
 
 	/* read reply */
-	if (!g_usb_device_interrupt_transfer (usb_device,
-					      SOLO_USB_HID_EP_IN,
-					      buf, sizeof(buf),
-					      &actual_length,
-					      SOLO_USB_TIMEOUT,
-					      NULL, /* cancellable */
-					      error)) {
+	if (!fu_usb_device_interrupt_transfer (FU_USB_DEVICE (self),
+					       SOLO_USB_HID_EP_IN,
+					       buf, sizeof(buf),
+					       &actual_length,
+					       SOLO_USB_TIMEOUT,
+					       NULL, /* cancellable */
+					       error)) {
 		g_prefix_error (error, "failed to get reply: ");
 		return NULL;
 	}
@@ -9,7 +9,10 @@
 #include "fu-superio-common.h"
 #include "fu-superio-device.h"
 
-#define FU_PLUGIN_SUPERIO_TIMEOUT	0.25 /* s */
+#define FU_PLUGIN_SUPERIO_TIMEOUT	250 /* ms */
+
+/* each byte needs a status wait and a data transfer */
+#define FU_PLUGIN_SUPERIO_EC_BATCH_SIZE	0x100
 
 typedef struct
 {
@@ -37,10 +40,14 @@ fu_superio_device_regval (FuSuperioDevice *self, guint8 addr,
 			  guint8 *data, GError **error)
 {
 	FuSuperioDevicePrivate *priv = GET_PRIVATE (self);
-	if (!fu_udev_device_pwrite (FU_UDEV_DEVICE (self), priv->port, addr, error))
-		return FALSE;
-	if (!fu_udev_device_pread (FU_UDEV_DEVICE (self), priv->port + 1, data, error))
+	FuUdevDevicePortIo ops[] = {
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WRITE,	priv->port,	addr },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_READ,	priv->port + 1,	0x0 },
+	};
+	if (!fu_udev_device_port_transfer (FU_UDEV_DEVICE (self), ops, G_N_ELEMENTS(ops),
+					   FU_PLUGIN_SUPERIO_TIMEOUT, error))
 		return FALSE;
+	*data = ops[1].value;
 	return TRUE;
 }
 
@@ -48,13 +55,17 @@ gboolean
 fu_superio_device_regval16 (FuSuperioDevice *self, guint8 addr,
 			    guint16 *data, GError **error)
 {
-	guint8 msb;
-	guint8 lsb;
-	if (!fu_superio_device_regval (self, addr, &msb, error))
-		return FALSE;
-	if (!fu_superio_device_regval (self, addr + 1, &lsb, error))
+	FuSuperioDevicePrivate *priv = GET_PRIVATE (self);
+	FuUdevDevicePortIo ops[] = {
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WRITE,	priv->port,	addr },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_READ,	priv->port + 1,	0x0 },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WRITE,	priv->port,	addr + 1 },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_READ,	priv->port + 1,	0x0 },
+	};
+	if (!fu_udev_device_port_transfer (FU_UDEV_DEVICE (self), ops, G_N_ELEMENTS(ops),
+					   FU_PLUGIN_SUPERIO_TIMEOUT, error))
 		return FALSE;
-	*data = ((guint16) msb << 8) | (guint16) lsb;
+	*data = ((guint16) ops[1].value << 8) | (guint16) ops[3].value;
 	return TRUE;
 }
 
@@ -63,11 +74,12 @@ fu_superio_device_regwrite (FuSuperioDevice *self, guint8 addr,
 			    guint8 data, GError **error)
 {
 	FuSuperioDevicePrivate *priv = GET_PRIVATE (self);
-	if (!fu_udev_device_pwrite (FU_UDEV_DEVICE (self), priv->port, addr, error))
-		return FALSE;
-	if (!fu_udev_device_pwrite (FU_UDEV_DEVICE (self), priv->port + 1, data, error))
-		return FALSE;
-	return TRUE;
+	FuUdevDevicePortIo ops[] = {
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WRITE,	priv->port,	addr },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WRITE,	priv->port + 1,	data },
+	};
+	return fu_udev_device_port_transfer (FU_UDEV_DEVICE (self), ops, G_N_ELEMENTS(ops),
+					     FU_PLUGIN_SUPERIO_TIMEOUT, error);
 }
 
 static gboolean
@@ -79,19 +91,30 @@ fu_superio_device_set_ldn (FuSuperioDevice *self, guint8 ldn, GError **error)
 static gboolean
 fu_superio_device_regdump (FuSuperioDevice *self, guint8 ldn, GError **error)
 {
+	FuSuperioDevicePrivate *priv = GET_PRIVATE (self);
 	const gchar *ldnstr = fu_superio_ldn_to_text (ldn);
 	guint8 buf[0xff] = { 0x00 };
 	guint16 iobad0 = 0x0;
 	guint16 iobad1 = 0x0;
+	FuUdevDevicePortIo ops[0xff * 2];
 	g_autoptr(GString) str = g_string_new (NULL);
 
 	/* set LDN */
 	if (!fu_superio_device_set_ldn (self, ldn, error))
 		return FALSE;
 	for (guint i = 0x00; i < 0xff; i++) {
-		if (!fu_superio_device_regval (self, i, &buf[i], error))
-			return FALSE;
+		ops[i * 2].kind = FU_UDEV_DEVICE_PORT_IO_KIND_WRITE;
+		ops[i * 2].port = priv->port;
+		ops[i * 2].value = i;
+		ops[i * 2 + 1].kind = FU_UDEV_DEVICE_PORT_IO_KIND_READ;
+		ops[i * 2 + 1].port = priv->port + 1;
+		ops[i * 2 + 1].value = 0x0;
 	}
+	if (!fu_udev_device_port_transfer (FU_UDEV_DEVICE (self), ops, G_N_ELEMENTS(ops),
+					   FU_PLUGIN_SUPERIO_TIMEOUT, error))
+		return FALSE;
+	for (guint i = 0x00; i < 0xff; i++)
+		buf[i] = ops[i * 2 + 1].value;
 
 	/* get the i/o base addresses */
 	if (!fu_superio_device_regval16 (self, SIO_LDNxx_IDX_IOBAD0, &iobad0, error))
@@ -143,54 +166,107 @@ fu_superio_device_check_id (FuSuperioDevice *self, GError **error)
 	return TRUE;
 }
 
-static gboolean
-fu_superio_device_wait_for (FuSuperioDevice *self, guint8 mask, gboolean set, GError **error)
+gboolean
+fu_superio_device_ec_read (FuSuperioDevice *self, guint8 *data, GError **error)
 {
 	FuSuperioDevicePrivate *priv = GET_PRIVATE (self);
-	g_autoptr(GTimer) timer = g_timer_new ();
-	do {
-		guint8 status = 0x00;
-		if (!fu_udev_device_pread (FU_UDEV_DEVICE (self), priv->pm1_iobad1, &status, error))
-			return FALSE;
-		if (g_timer_elapsed (timer, NULL) > FU_PLUGIN_SUPERIO_TIMEOUT)
-			break;
-		if (set && (status & mask) != 0)
-			return TRUE;
-		if (!set && (status & mask) == 0)
-			return TRUE;
-	} while (TRUE);
-	g_set_error (error,
-		     G_IO_ERROR,
-		     G_IO_ERROR_TIMED_OUT,
-		     "timed out whilst waiting for 0x%02x:%i", mask, set);
-	return FALSE;
+	FuUdevDevicePortIo ops[] = {
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_SET,	priv->pm1_iobad1, SIO_STATUS_EC_OBF },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_READ,	priv->pm1_iobad0, 0x0 },
+	};
+	if (!fu_udev_device_port_transfer (FU_UDEV_DEVICE (self), ops, G_N_ELEMENTS(ops),
+					   FU_PLUGIN_SUPERIO_TIMEOUT, error))
+		return FALSE;
+	*data = ops[1].value;
+	return TRUE;
 }
 
+/* sends @cmd and reads the result back for each byte of @buf */
 gboolean
-fu_superio_device_ec_read (FuSuperioDevice *self, guint8 *data, GError **error)
+fu_superio_device_ec_read_buf (FuSuperioDevice *self,
+			       guint8 cmd,
+			       guint8 *buf,
+			       gsize bufsz,
+			       GError **error)
 {
 	FuSuperioDevicePrivate *priv = GET_PRIVATE (self);
-	if (!fu_superio_device_wait_for (self, SIO_STATUS_EC_OBF, TRUE, error))
-		return FALSE;
-	return fu_udev_device_pread (FU_UDEV_DEVICE (self), priv->pm1_iobad0, data, error);
+	FuUdevDevicePortIo ops[FU_PLUGIN_SUPERIO_EC_BATCH_SIZE * 4];
+
+	for (gsize off = 0; off < bufsz; off += FU_PLUGIN_SUPERIO_EC_BATCH_SIZE) {
+		gsize n = MIN (bufsz - off, FU_PLUGIN_SUPERIO_EC_BATCH_SIZE);
+		for (gsize i = 0; i < n; i++) {
+			FuUdevDevicePortIo *op = &ops[i * 4];
+			op[0].kind = FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_CLEAR;
+			op[0].port = priv->pm1_iobad1;
+			op[0].value = SIO_STATUS_EC_IBF;
+			op[1].kind = FU_UDEV_DEVICE_PORT_IO_KIND_WRITE;
+			op[1].port = priv->pm1_iobad1;
+			op[1].value = cmd;
+			op[2].kind = FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_SET;
+			op[2].port = priv->pm1_iobad1;
+			op[2].value = SIO_STATUS_EC_OBF;
+			op[3].kind = FU_UDEV_DEVICE_PORT_IO_KIND_READ;
+			op[3].port = priv->pm1_iobad0;
+			op[3].value = 0x0;
+		}
+		if (!fu_udev_device_port_transfer (FU_UDEV_DEVICE (self), ops, n * 4,
+						   FU_PLUGIN_SUPERIO_TIMEOUT, error))
+			return FALSE;
+		for (gsize i = 0; i < n; i++)
+			buf[off + i] = ops[i * 4 + 3].value;
+	}
+	return TRUE;
 }
 
 gboolean
 fu_superio_device_ec_write0 (FuSuperioDevice *self, guint8 data, GError **error)
 {
 	FuSuperioDevicePrivate *priv = GET_PRIVATE (self);
-	if (!fu_superio_device_wait_for (self, SIO_STATUS_EC_IBF, FALSE, error))
-		return FALSE;
-	return fu_udev_device_pwrite (FU_UDEV_DEVICE (self), priv->pm1_iobad0, data, error);
+	FuUdevDevicePortIo ops[] = {
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_CLEAR, priv->pm1_iobad1, SIO_STATUS_EC_IBF },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WRITE,	  priv->pm1_iobad0, data },
+	};
+	return fu_udev_device_port_transfer (FU_UDEV_DEVICE (self), ops, G_N_ELEMENTS(ops),
+					     FU_PLUGIN_SUPERIO_TIMEOUT, error);
 }
 
 gboolean
 fu_superio_device_ec_write1 (FuSuperioDevice *self, guint8 data, GError **error)
 {
 	FuSuperioDevicePrivate *priv = GET_PRIVATE (self);
-	if (!fu_superio_device_wait_for (self, SIO_STATUS_EC_IBF, FALSE, error))
-		return FALSE;
-	return fu_udev_device_pwrite (FU_UDEV_DEVICE (self), priv->pm1_iobad1, data, error);
+	FuUdevDevicePortIo ops[] = {
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_CLEAR, priv->pm1_iobad1, SIO_STATUS_EC_IBF },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WRITE,	  priv->pm1_iobad1, data },
+	};
+	return fu_udev_device_port_transfer (FU_UDEV_DEVICE (self), ops, G_N_ELEMENTS(ops),
+					     FU_PLUGIN_SUPERIO_TIMEOUT, error);
+}
+
+/* writes each byte of @buf to the command port */
+gboolean
+fu_superio_device_ec_write1_buf (FuSuperioDevice *self,
+				 const guint8 *buf,
+				 gsize bufsz,
+				 GError **error)
+{
+	FuSuperioDevicePrivate *priv = GET_PRIVATE (self);
+	FuUdevDevicePortIo ops[FU_PLUGIN_SUPERIO_EC_BATCH_SIZE * 2];
+
+	for (gsize off = 0; off < bufsz; off += FU_PLUGIN_SUPERIO_EC_BATCH_SIZE) {
+		gsize n = MIN (bufsz - off, FU_PLUGIN_SUPERIO_EC_BATCH_SIZE);
+		for (gsize i = 0; i < n; i++) {
+			ops[i * 2].kind = FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_CLEAR;
+			ops[i * 2].port = priv->pm1_iobad1;
+			ops[i * 2].value = SIO_STATUS_EC_IBF;
+			ops[i * 2 + 1].kind = FU_UDEV_DEVICE_PORT_IO_KIND_WRITE;
+			ops[i * 2 + 1].port = priv->pm1_iobad1;
+			ops[i * 2 + 1].value = buf[off + i];
+		}
+		if (!fu_udev_device_port_transfer (FU_UDEV_DEVICE (self), ops, n * 2,
+						   FU_PLUGIN_SUPERIO_TIMEOUT, error))
+			return FALSE;
+	}
+	return TRUE;
 }
 
 static gboolean
@@ -198,7 +274,7 @@ fu_superio_device_ec_flush (FuSuperioDevice *self, GError **error)
 {
 	FuSuperioDevicePrivate *priv = GET_PRIVATE (self);
 	guint8 status = 0x00;
-	g_autoptr(GTimer) timer = g_timer_new ();
+	gint64 deadline = g_get_monotonic_time () + FU_PLUGIN_SUPERIO_TIMEOUT * 1000;
 	do {
 		guint8 unused = 0;
 		if (!fu_udev_device_pread (FU_UDEV_DEVICE (self), priv->pm1_iobad1, &status, error))
@@ -207,7 +283,7 @@ fu_superio_device_ec_flush (FuSuperioDevice *self, GError **error)
 			break;
 		if (!fu_udev_device_pread (FU_UDEV_DEVICE (self), priv->pm1_iobad0, &unused, error))
 			return FALSE;
-		if (g_timer_elapsed (timer, NULL) > FU_PLUGIN_SUPERIO_TIMEOUT) {
+		if (g_get_monotonic_time () > deadline) {
 			g_set_error_literal (error,
 					     G_IO_ERROR,
 					     G_IO_ERROR_TIMED_OUT,
@@ -221,11 +297,20 @@ fu_superio_device_ec_flush (FuSuperioDevice *self, GError **error)
 gboolean
 fu_superio_device_ec_get_param (FuSuperioDevice *self, guint8 param, guint8 *data, GError **error)
 {
-	if (!fu_superio_device_ec_write1 (self, SIO_CMD_EC_READ, error))
-		return FALSE;
-	if (!fu_superio_device_ec_write0 (self, param, error))
+	FuSuperioDevicePrivate *priv = GET_PRIVATE (self);
+	FuUdevDevicePortIo ops[] = {
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_CLEAR, priv->pm1_iobad1, SIO_STATUS_EC_IBF },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WRITE,	  priv->pm1_iobad1, SIO_CMD_EC_READ },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_CLEAR, priv->pm1_iobad1, SIO_STATUS_EC_IBF },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WRITE,	  priv->pm1_iobad0, param },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_WAIT_SET,	  priv->pm1_iobad1, SIO_STATUS_EC_OBF },
+		{ FU_UDEV_DEVICE_PORT_IO_KIND_READ,	  priv->pm1_iobad0, 0x0 },
+	};
+	if (!fu_udev_device_port_transfer (FU_UDEV_DEVICE (self), ops, G_N_ELEMENTS(ops),
+					   FU_PLUGIN_SUPERIO_TIMEOUT, error))
 		return FALSE;
-	return fu_superio_device_ec_read (self, data, error);
+	*data = ops[5].value;
+	return TRUE;
 }
 
 #if 0
@@ -21,12 +21,21 @@ struct _FuSuperioDeviceClass
 gboolean	 fu_superio_device_ec_read	(FuSuperioDevice	*self,
 						 guint8			*data,
 						 GError			**error);
+gboolean	 fu_superio_device_ec_read_buf	(FuSuperioDevice	*self,
+						 guint8			 cmd,
+						 guint8			*buf,
+						 gsize			 bufsz,
+						 GError			**error);
 gboolean	 fu_superio_device_ec_write0	(FuSuperioDevice	*self,
 						 guint8			 data,
 						 GError			**error);
 gboolean	 fu_superio_device_ec_write1	(FuSuperioDevice	*self,
 						 guint8			 data,
 						 GError			**error);
+gboolean	 fu_superio_device_ec_write1_buf (FuSuperioDevice	*self,
+						 const guint8		*buf,
+						 gsize			 bufsz,
+						 GError			**error);
 gboolean	 fu_superio_device_ec_get_param	(FuSuperioDevice	*self,
 						 guint8			 param,
 						 guint8			*data,
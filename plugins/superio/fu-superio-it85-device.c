@@ -19,18 +19,21 @@ G_DEFINE_TYPE (FuSuperioIt85Device, fu_superio_it85_device, FU_TYPE_SUPERIO_DEVI
 static gchar *
 fu_superio_it85_device_get_str (FuSuperioDevice *self, guint8 idx, GError **error)
 {
-	GString *str = g_string_new (NULL);
-	if (!fu_superio_device_ec_write1 (self, idx, error))
+	guint8 c = 0;
+	g_autoptr(GString) str = g_string_new (NULL);
+
+	/* the command and the first byte are sent in one transfer, but the
+	 * length is not known so the rest have to be read one at a time */
+	if (!fu_superio_device_ec_read_buf (self, idx, &c, 1, error))
 		return NULL;
-	for (guint i = 0; i < 0xff; i++) {
-		guint8 c = 0;
+	for (guint i = 1; c != '$'; i++) {
+		g_string_append_c (str, c);
+		if (i >= 0xff)
+			break;
 		if (!fu_superio_device_ec_read (self, &c, error))
 			return NULL;
-		if (c == '$')
-			break;
-		g_string_append_c (str, c);
 	}
-	return g_string_free (str, FALSE);
+	return g_string_free (g_steal_pointer (&str), FALSE);
 }
 
 static gboolean
@@ -16,6 +16,8 @@ struct _FuSuperioIt89Device {
 
 G_DEFINE_TYPE (FuSuperioIt89Device, fu_superio_it89_device, FU_TYPE_SUPERIO_DEVICE)
 
+#define FU_SUPERIO_IT89_DEVICE_READ_BLOCK_SIZE	0x1000
+
 static gboolean
 fu_superio_it89_device_read_ec_register (FuSuperioDevice *self,
 					 guint16 addr,
@@ -121,24 +123,27 @@ fu_superio_it89_device_setup (FuSuperioDevice *self, GError **error)
 	return TRUE;
 }
 
-static gboolean
-fu_superio_it89_device_ec_pm1do_sci (FuSuperioDevice *self, guint8 val, GError **error)
+/* queues a SPI command, or a byte of its payload */
+static void
+fu_superio_it89_device_append_sci (GByteArray *buf, guint8 val)
 {
-	if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DOSCI, error))
-		return FALSE;
-	if (!fu_superio_device_ec_write1 (self, val, error))
-		return FALSE;
-	return TRUE;
+	fu_byte_array_append_uint8 (buf, SIO_EC_PMC_PM1DOSCI);
+	fu_byte_array_append_uint8 (buf, val);
 }
 
+static void
+fu_superio_it89_device_append_smi (GByteArray *buf, guint8 val)
+{
+	fu_byte_array_append_uint8 (buf, SIO_EC_PMC_PM1DOCMI);
+	fu_byte_array_append_uint8 (buf, val);
+}
+
+/* sends PM1DO and the SPI command in one transfer */
 static gboolean
-fu_superio_it89_device_ec_pm1do_smi (FuSuperioDevice *self, guint8 val, GError **error)
+fu_superio_it89_device_ec_spi_cmd (FuSuperioDevice *self, guint8 cmd, GError **error)
 {
-	if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DOCMI, error))
-		return FALSE;
-	if (!fu_superio_device_ec_write1 (self, val, error))
-		return FALSE;
-	return TRUE;
+	const guint8 buf[] = { SIO_EC_PMC_PM1DO, SIO_EC_PMC_PM1DOSCI, cmd };
+	return fu_superio_device_ec_write1_buf (self, buf, sizeof(buf), error);
 }
 
 static gboolean
@@ -147,16 +152,12 @@ fu_superio_device_ec_read_status (FuSuperioDevice *self, GError **error)
 	guint8 tmp = 0x00;
 
 	/* read status register */
-	if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DO, error))
-		return FALSE;
-	if (!fu_superio_it89_device_ec_pm1do_sci (self, SIO_SPI_CMD_RDSR, error))
+	if (!fu_superio_it89_device_ec_spi_cmd (self, SIO_SPI_CMD_RDSR, error))
 		return FALSE;
 
 	/* wait for write */
 	do {
-		if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DI, error))
-			return FALSE;
-		if (!fu_superio_device_ec_read (self, &tmp, error))
+		if (!fu_superio_device_ec_read_buf (self, SIO_EC_PMC_PM1DI, &tmp, 1, error))
 			return FALSE;
 	} while ((tmp & SIO_STATUS_EC_OBF) != 0);
 
@@ -174,22 +175,16 @@ fu_superio_device_ec_write_disable (FuSuperioDevice *self, GError **error)
 		return FALSE;
 
 	/* write disable */
-	if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DO, error))
-		return FALSE;
-	if (!fu_superio_it89_device_ec_pm1do_sci (self, SIO_SPI_CMD_WRDI, error))
+	if (!fu_superio_it89_device_ec_spi_cmd (self, SIO_SPI_CMD_WRDI, error))
 		return FALSE;
 
 	/* read status register */
-	if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DO, error))
-		return FALSE;
-	if (!fu_superio_it89_device_ec_pm1do_sci (self, SIO_SPI_CMD_RDSR, error))
+	if (!fu_superio_it89_device_ec_spi_cmd (self, SIO_SPI_CMD_RDSR, error))
 		return FALSE;
 
 	/* wait for read */
 	do {
-		if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DI, error))
-			return FALSE;
-		if (!fu_superio_device_ec_read (self, &tmp, error))
+		if (!fu_superio_device_ec_read_buf (self, SIO_EC_PMC_PM1DI, &tmp, 1, error))
 			return FALSE;
 	} while ((tmp & SIO_STATUS_EC_IBF) != 0);
 
@@ -207,22 +202,16 @@ fu_superio_device_ec_write_enable (FuSuperioDevice *self, GError **error)
 		return FALSE;
 
 	/* write enable */
-	if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DO, error))
-		return FALSE;
-	if (!fu_superio_it89_device_ec_pm1do_sci (self, SIO_SPI_CMD_WREN, error))
+	if (!fu_superio_it89_device_ec_spi_cmd (self, SIO_SPI_CMD_WREN, error))
 		return FALSE;
 
 	/* read status register */
-	if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DO, error))
-		return FALSE;
-	if (!fu_superio_it89_device_ec_pm1do_sci (self, SIO_SPI_CMD_RDSR, error))
+	if (!fu_superio_it89_device_ec_spi_cmd (self, SIO_SPI_CMD_RDSR, error))
 		return FALSE;
 
 	/* wait for !BUSY */
 	do {
-		if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DI, error))
-			return FALSE;
-		if (!fu_superio_device_ec_read (self, &tmp, error))
+		if (!fu_superio_device_ec_read_buf (self, SIO_EC_PMC_PM1DI, &tmp, 1, error))
 			return FALSE;
 	} while ((tmp & 3) != SIO_STATUS_EC_IBF);
 
@@ -238,6 +227,7 @@ fu_superio_it89_device_read_addr (FuSuperioDevice *self,
 				  GError **error)
 {
 	g_autofree guint8 *buf = NULL;
+	g_autoptr(GByteArray) cmd = g_byte_array_new ();
 
 	/* check... */
 	if (!fu_superio_device_ec_write_disable (self, error))
@@ -245,35 +235,29 @@ fu_superio_it89_device_read_addr (FuSuperioDevice *self,
 	if (!fu_superio_device_ec_read_status (self, error))
 		return NULL;
 
-	/* high speed read */
-	if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DO, error))
-		return NULL;
-	if (!fu_superio_it89_device_ec_pm1do_sci (self, SIO_SPI_CMD_HS_READ, error))
-		return NULL;
-
-	/* set address, MSB, MID, LSB */
-	if (!fu_superio_it89_device_ec_pm1do_smi (self, addr >> 16, error))
-		return NULL;
-	if (!fu_superio_it89_device_ec_pm1do_smi (self, addr >> 8, error))
-		return NULL;
-	if (!fu_superio_it89_device_ec_pm1do_smi (self, addr & 0xff, error))
-		return NULL;
+	/* high speed read, setting address MSB, MID, LSB */
+	fu_byte_array_append_uint8 (cmd, SIO_EC_PMC_PM1DO);
+	fu_superio_it89_device_append_sci (cmd, SIO_SPI_CMD_HS_READ);
+	fu_superio_it89_device_append_smi (cmd, addr >> 16);
+	fu_superio_it89_device_append_smi (cmd, addr >> 8);
+	fu_superio_it89_device_append_smi (cmd, addr & 0xff);
 
 	/* padding for HS? */
-	if (!fu_superio_it89_device_ec_pm1do_smi (self, 0x0, error))
+	fu_superio_it89_device_append_smi (cmd, 0x0);
+	if (!fu_superio_device_ec_write1_buf (self, cmd->data, cmd->len, error))
 		return NULL;
 
-	/* read out data */
+	/* read out data in blocks */
 	buf = g_malloc0 (size);
-	for (guint i = 0; i < size; i++) {
-		if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DI, error))
-			return NULL;
-		if (!fu_superio_device_ec_read (self, &buf[i], error))
+	for (guint i = 0; i < size; i += FU_SUPERIO_IT89_DEVICE_READ_BLOCK_SIZE) {
+		guint n = MIN (size - i, FU_SUPERIO_IT89_DEVICE_READ_BLOCK_SIZE);
+		if (!fu_superio_device_ec_read_buf (self, SIO_EC_PMC_PM1DI,
+						    buf + i, n, error))
 			return NULL;
 
 		/* update progress */
 		if (progress_cb != NULL)
-			progress_cb ((goffset) i, (goffset) size, self);
+			progress_cb ((goffset) i + n, (goffset) size, self);
 	}
 
 	/* check again... */
@@ -296,6 +280,7 @@ fu_superio_it89_device_write_addr (FuSuperioDevice *self, guint addr, GBytes *fw
 {
 	gsize size = 0;
 	const guint8 *buf = g_bytes_get_data (fw, &size);
+	g_autoptr(GByteArray) cmd = g_byte_array_new ();
 
 	/* sanity check */
 	if ((addr & 0xff) != 0x00) {
@@ -317,35 +302,26 @@ fu_superio_it89_device_write_addr (FuSuperioDevice *self, guint addr, GBytes *fw
 	if (!fu_superio_device_ec_write_enable (self, error))
 		return FALSE;
 
-	/* write DWORDs */
-	if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DO, error))
-		return FALSE;
-	if (!fu_superio_it89_device_ec_pm1do_sci (self, SIO_SPI_CMD_WRITE_WORD, error))
-		return FALSE;
-
-	/* set address, MSB, MID, LSB */
-	if (!fu_superio_it89_device_ec_pm1do_smi (self, addr >> 16, error))
-		return FALSE;
-	if (!fu_superio_it89_device_ec_pm1do_smi (self, addr >> 8, error))
-		return FALSE;
-	if (!fu_superio_it89_device_ec_pm1do_smi (self, addr & 0xff, error))
-		return FALSE;
+	/* write DWORDs, setting address MSB, MID, LSB */
+	fu_byte_array_append_uint8 (cmd, SIO_EC_PMC_PM1DO);
+	fu_superio_it89_device_append_sci (cmd, SIO_SPI_CMD_WRITE_WORD);
+	fu_superio_it89_device_append_smi (cmd, addr >> 16);
+	fu_superio_it89_device_append_smi (cmd, addr >> 8);
+	fu_superio_it89_device_append_smi (cmd, addr & 0xff);
 
-	/* write data two bytes at a time */
+	/* write data two bytes at a time, where the status has to be polled
+	 * between each word so everything else for the word is one transfer */
 	for (guint i = 0; i < size; i += 2) {
 		if (i > 0) {
 			if (!fu_superio_device_ec_read_status (self, error))
 				return FALSE;
-			if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DO, error))
-				return FALSE;
-			if (!fu_superio_it89_device_ec_pm1do_sci (self,
-								  SIO_SPI_CMD_WRITE_WORD,
-								  error))
-				return FALSE;
+			g_byte_array_set_size (cmd, 0);
+			fu_byte_array_append_uint8 (cmd, SIO_EC_PMC_PM1DO);
+			fu_superio_it89_device_append_sci (cmd, SIO_SPI_CMD_WRITE_WORD);
 		}
-		if (!fu_superio_it89_device_ec_pm1do_smi (self, buf[i+0], error))
-			return FALSE;
-		if (!fu_superio_it89_device_ec_pm1do_smi (self, buf[i+1], error))
+		fu_superio_it89_device_append_smi (cmd, buf[i+0]);
+		fu_superio_it89_device_append_smi (cmd, buf[i+1]);
+		if (!fu_superio_device_ec_write1_buf (self, cmd->data, cmd->len, error))
 			return FALSE;
 	}
 
@@ -358,26 +334,22 @@ fu_superio_it89_device_write_addr (FuSuperioDevice *self, guint addr, GBytes *fw
 static gboolean
 fu_superio_it89_device_erase_addr (FuSuperioDevice *self, guint addr, GError **error)
 {
+	g_autoptr(GByteArray) cmd = g_byte_array_new ();
+
 	/* enable writes */
 	if (!fu_superio_device_ec_write_enable (self, error))
 		return FALSE;
 
-	/* sector erase */
-	if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DO, error))
-		return FALSE;
-	if (!fu_superio_it89_device_ec_pm1do_sci (self, SIO_SPI_CMD_4K_SECTOR_ERASE, error))
-		return FALSE;
-
-	/* set address, MSB, MID, LSB */
-	if (!fu_superio_it89_device_ec_pm1do_smi (self, addr >> 16, error))
-		return FALSE;
-	if (!fu_superio_it89_device_ec_pm1do_smi (self, addr >> 8, error))
-		return FALSE;
-	if (!fu_superio_it89_device_ec_pm1do_smi (self, addr & 0xff, error))
-		return FALSE;
+	/* sector erase, setting address MSB, MID, LSB */
+	fu_byte_array_append_uint8 (cmd, SIO_EC_PMC_PM1DO);
+	fu_superio_it89_device_append_sci (cmd, SIO_SPI_CMD_4K_SECTOR_ERASE);
+	fu_superio_it89_device_append_smi (cmd, addr >> 16);
+	fu_superio_it89_device_append_smi (cmd, addr >> 8);
+	fu_superio_it89_device_append_smi (cmd, addr & 0xff);
 
 	/* watch SCI events */
-	if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DISCI, error))
+	fu_byte_array_append_uint8 (cmd, SIO_EC_PMC_PM1DISCI);
+	if (!fu_superio_device_ec_write1_buf (self, cmd->data, cmd->len, error))
 		return FALSE;
 	return fu_superio_device_ec_read_status (self, error);
 }
@@ -599,18 +571,12 @@ fu_superio_it89_device_get_jedec_id (FuSuperioDevice *self, guint8 *id, GError *
 	/* read status register */
 	if (!fu_superio_device_ec_read_status (self, error))
 		return FALSE;
-	if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DO, error))
-		return FALSE;
-	if (!fu_superio_it89_device_ec_pm1do_sci (self, SIO_SPI_CMD_JEDEC_ID, error))
+	if (!fu_superio_it89_device_ec_spi_cmd (self, SIO_SPI_CMD_JEDEC_ID, error))
 		return FALSE;
 
 	/* wait for reads */
-	for (guint i = 0; i < 4; i++) {
-		if (!fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DI, error))
-			return FALSE;
-		if (!fu_superio_device_ec_read (self, &id[i], error))
-			return FALSE;
-	}
+	if (!fu_superio_device_ec_read_buf (self, SIO_EC_PMC_PM1DI, id, 4, error))
+		return FALSE;
 
 	/* watch SCI events */
 	return fu_superio_device_ec_write1 (self, SIO_EC_PMC_PM1DISCI, error);
@@ -82,7 +82,6 @@ fu_synaprom_device_cmd_send (FuSynapromDevice *device,
 			     guint timeout_ms,
 			     GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (device));
 	gboolean ret;
 	gsize actual_len = 0;
 
@@ -91,12 +90,12 @@ fu_synaprom_device_cmd_send (FuSynapromDevice *device,
 				     request->data, request->len, 16,
 				     FU_DUMP_FLAGS_SHOW_ADDRESSES);
 	}
-	ret = g_usb_device_bulk_transfer (usb_device,
-					  FU_SYNAPROM_USB_REQUEST_EP,
-					  request->data,
-					  request->len,
-					  &actual_len,
-					  timeout_ms, NULL, error);
+	ret = fu_usb_device_bulk_transfer (FU_USB_DEVICE (device),
+					   FU_SYNAPROM_USB_REQUEST_EP,
+					   request->data,
+					   request->len,
+					   &actual_len,
+					   timeout_ms, NULL, error);
 	if (!ret) {
 		g_prefix_error (error, "failed to request: ");
 		return FALSE;
@@ -110,12 +109,12 @@ fu_synaprom_device_cmd_send (FuSynapromDevice *device,
 		return FALSE;
 	}
 
-	ret = g_usb_device_bulk_transfer (usb_device,
-					  FU_SYNAPROM_USB_REPLY_EP,
-					  reply->data,
-					  reply->len,
-					  NULL, /* allowed to return short read */
-					  timeout_ms, NULL, error);
+	ret = fu_usb_device_bulk_transfer (FU_USB_DEVICE (device),
+					   FU_SYNAPROM_USB_REPLY_EP,
+					   reply->data,
+					   reply->len,
+					   NULL, /* allowed to return short read */
+					   timeout_ms, NULL, error);
 	if (!ret) {
 		g_prefix_error (error, "failed to reply: ");
 		return FALSE;
@@ -367,14 +366,14 @@ fu_synaprom_device_attach (FuDevice *device, GError **error)
 		return TRUE;
 	}
 
-	ret = g_usb_device_control_transfer (usb_device,
-					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					     G_USB_DEVICE_RECIPIENT_DEVICE,
-					     FU_SYNAPROM_USB_CTRLREQUEST_VENDOR_WRITEDFT,
-					     0x0000, 0x0000,
-					     data, sizeof(data), &actual_len,
-					     2000, NULL, error);
+	ret = fu_usb_device_control_transfer (FU_USB_DEVICE (device),
+					      G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					      G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					      G_USB_DEVICE_RECIPIENT_DEVICE,
+					      FU_SYNAPROM_USB_CTRLREQUEST_VENDOR_WRITEDFT,
+					      0x0000, 0x0000,
+					      data, sizeof(data), &actual_len,
+					      2000, NULL, error);
 	if (!ret)
 		return FALSE;
 	if (actual_len != sizeof(data)) {
@@ -408,14 +407,14 @@ fu_synaprom_device_detach (FuDevice *device, GError **error)
 		return TRUE;
 	}
 
-	ret = g_usb_device_control_transfer (usb_device,
-					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					     G_USB_DEVICE_RECIPIENT_DEVICE,
-					     FU_SYNAPROM_USB_CTRLREQUEST_VENDOR_WRITEDFT,
-					     0x0000, 0x0000,
-					     data, sizeof(data), &actual_len,
-					     2000, NULL, error);
+	ret = fu_usb_device_control_transfer (FU_USB_DEVICE (device),
+					      G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					      G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					      G_USB_DEVICE_RECIPIENT_DEVICE,
+					      FU_SYNAPROM_USB_CTRLREQUEST_VENDOR_WRITEDFT,
+					      0x0000, 0x0000,
+					      data, sizeof(data), &actual_len,
+					      2000, NULL, error);
 	if (!ret)
 		return FALSE;
 	if (actual_len != sizeof(data)) {
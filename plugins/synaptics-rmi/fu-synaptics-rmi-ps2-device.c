@@ -742,6 +742,7 @@ fu_synaptics_rmi_ps2_device_open (FuUdevDevice *device, GError **error)
 
 	/* create channel */
 	self->io_channel = fu_io_channel_unix_new (fu_udev_device_get_fd (device));
+	fu_io_channel_set_device (self->io_channel, FU_DEVICE (device));
 
 	/* in serio_raw mode */
 	if (fu_device_has_flag (FU_DEVICE (self), FWUPD_DEVICE_FLAG_IS_BOOTLOADER)) {
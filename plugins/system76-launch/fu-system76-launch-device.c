@@ -22,7 +22,6 @@ G_DEFINE_TYPE (FuSystem76LaunchDevice, fu_system76_launch_device, FU_TYPE_USB_DE
 static gboolean
 fu_system76_launch_device_setup (FuDevice *device, GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (device));
 	const guint8 ep_in = 0x82;
 	const guint8 ep_out = 0x03;
 	guint8 data[32] = { 0 };
@@ -31,14 +30,14 @@ fu_system76_launch_device_setup (FuDevice *device, GError **error)
 
 	/* send version command */
 	data[0] = SYSTEM76_LAUNCH_CMD_VERSION;
-	if (!g_usb_device_interrupt_transfer (usb_device,
-					      ep_out,
-					      data,
-					      sizeof(data),
-					      &actual_len,
-					      SYSTEM76_LAUNCH_TIMEOUT,
-					      NULL,
-					      error)) {
+	if (!fu_usb_device_interrupt_transfer (FU_USB_DEVICE (device),
+					       ep_out,
+					       data,
+					       sizeof(data),
+					       &actual_len,
+					       SYSTEM76_LAUNCH_TIMEOUT,
+					       NULL,
+					       error)) {
 		g_prefix_error (error, "failed to send version command: ");
 		return FALSE;
 	}
@@ -52,14 +51,14 @@ fu_system76_launch_device_setup (FuDevice *device, GError **error)
 	}
 
 	/* receive version response */
-	if (!g_usb_device_interrupt_transfer (usb_device,
-					      ep_in,
-					      data,
-					      sizeof(data),
-					      &actual_len,
-					      SYSTEM76_LAUNCH_TIMEOUT,
-					      NULL,
-					      error)) {
+	if (!fu_usb_device_interrupt_transfer (FU_USB_DEVICE (device),
+					       ep_in,
+					       data,
+					       sizeof(data),
+					       &actual_len,
+					       SYSTEM76_LAUNCH_TIMEOUT,
+					       NULL,
+					       error)) {
 		g_prefix_error (error, "failed to read version response: ");
 		return FALSE;
 	}
@@ -81,7 +80,6 @@ fu_system76_launch_device_setup (FuDevice *device, GError **error)
 static gboolean
 fu_system76_launch_device_detach (FuDevice *device, GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (device));
 	const guint8 ep_out = 0x03;
 	guint8 data[32] = { 0 };
 	gsize actual_len = 0;
@@ -90,14 +88,14 @@ fu_system76_launch_device_detach (FuDevice *device, GError **error)
 
 	/* send reset command, should result in bootloader device appearing */
 	data[0] = SYSTEM76_LAUNCH_CMD_RESET;
-	if (!g_usb_device_interrupt_transfer (usb_device,
-					      ep_out,
-					      data,
-					      sizeof(data),
-					      &actual_len,
-					      SYSTEM76_LAUNCH_TIMEOUT,
-					      NULL,
-					      error)) {
+	if (!fu_usb_device_interrupt_transfer (FU_USB_DEVICE (device),
+					       ep_out,
+					       data,
+					       sizeof(data),
+					       &actual_len,
+					       SYSTEM76_LAUNCH_TIMEOUT,
+					       NULL,
+					       error)) {
 		g_prefix_error (error, "failed to send reset command: ");
 		return FALSE;
 	}
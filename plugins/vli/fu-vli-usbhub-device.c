@@ -49,15 +49,14 @@ fu_vli_usbhub_device_to_string (FuVliDevice *device, guint idt, GString *str)
 static gboolean
 fu_vli_usbhub_device_vdr_unlock_813 (FuVliUsbhubDevice *self, GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0x85, 0x8786, 0x8988,
-					    NULL, 0x0, NULL,
-					    FU_VLI_DEVICE_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0x85, 0x8786, 0x8988,
+					     NULL, 0x0, NULL,
+					     FU_VLI_DEVICE_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "failed to UnLock_VL813: ");
 		return FALSE;
 	}
@@ -67,14 +66,14 @@ fu_vli_usbhub_device_vdr_unlock_813 (FuVliUsbhubDevice *self, GError **error)
 static gboolean
 fu_vli_usbhub_device_read_reg (FuVliUsbhubDevice *self, guint16 addr, guint8 *buf, GError **error)
 {
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    addr >> 8, addr & 0xff, 0x0,
-					    buf, 0x1, NULL,
-					    FU_VLI_DEVICE_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     addr >> 8, addr & 0xff, 0x0,
+					     buf, 0x1, NULL,
+					     FU_VLI_DEVICE_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "failed to read register 0x%x: ", addr);
 		return FALSE;
 	}
@@ -84,14 +83,14 @@ fu_vli_usbhub_device_read_reg (FuVliUsbhubDevice *self, guint16 addr, guint8 *bu
 static gboolean
 fu_vli_usbhub_device_write_reg (FuVliUsbhubDevice *self, guint16 addr, guint8 value, GError **error)
 {
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    addr >> 8, addr & 0xff, (guint16) value,
-					    NULL, 0x0, NULL,
-					    FU_VLI_DEVICE_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     addr >> 8, addr & 0xff, (guint16) value,
+					     NULL, 0x0, NULL,
+					     FU_VLI_DEVICE_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "failed to write register 0x%x: ", addr);
 		return FALSE;
 	}
@@ -105,14 +104,14 @@ fu_vli_usbhub_device_spi_read_status (FuVliDevice *self, guint8 *status, GError
 	if (!fu_vli_device_get_spi_cmd (self, FU_VLI_DEVICE_SPI_REQ_READ_STATUS,
 					&spi_cmd, error))
 		return FALSE;
-	return g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					      G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					      G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					      G_USB_DEVICE_RECIPIENT_DEVICE,
-					      0xc1, spi_cmd, 0x0000,
-					      status, 0x1, NULL,
-					      FU_VLI_DEVICE_TIMEOUT,
-					      NULL, error);
+	return fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					       G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					       G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					       G_USB_DEVICE_RECIPIENT_DEVICE,
+					       0xc1, spi_cmd, 0x0000,
+					       status, 0x1, NULL,
+					       FU_VLI_DEVICE_TIMEOUT,
+					       NULL, error);
 }
 
 static gboolean
@@ -126,14 +125,14 @@ fu_vli_usbhub_device_spi_read_data (FuVliDevice *self, guint32 addr, guint8 *buf
 		return FALSE;
 	value = ((addr >> 8) & 0xff00) | spi_cmd;
 	index = ((addr << 8) & 0xff00) | ((addr >> 8) & 0x00ff);
-	return g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					      G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					      G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					      G_USB_DEVICE_RECIPIENT_DEVICE,
-					      0xc4, value, index,
-					      buf, bufsz, NULL,
-					      FU_VLI_DEVICE_TIMEOUT,
-					      NULL, error);
+	return fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					       G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					       G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					       G_USB_DEVICE_RECIPIENT_DEVICE,
+					       0xc4, value, index,
+					       buf, bufsz, NULL,
+					       FU_VLI_DEVICE_TIMEOUT,
+					       NULL, error);
 }
 
 static gboolean
@@ -143,14 +142,14 @@ fu_vli_usbhub_device_spi_write_status (FuVliDevice *self, guint8 status, GError
 	if (!fu_vli_device_get_spi_cmd (self, FU_VLI_DEVICE_SPI_REQ_WRITE_STATUS,
 					&spi_cmd, error))
 		return FALSE;
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xd1, spi_cmd, 0x0000,
-					    &status, 0x1, NULL,
-					    FU_VLI_DEVICE_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xd1, spi_cmd, 0x0000,
+					     &status, 0x1, NULL,
+					     FU_VLI_DEVICE_TIMEOUT,
+					     NULL, error)) {
 		return FALSE;
 	}
 
@@ -166,14 +165,14 @@ fu_vli_usbhub_device_spi_write_enable (FuVliDevice *self, GError **error)
 	if (!fu_vli_device_get_spi_cmd (self, FU_VLI_DEVICE_SPI_REQ_WRITE_EN,
 					&spi_cmd, error))
 		return FALSE;
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xd1, spi_cmd, 0x0000,
-					    NULL, 0x0, NULL,
-					    FU_VLI_DEVICE_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xd1, spi_cmd, 0x0000,
+					     NULL, 0x0, NULL,
+					     FU_VLI_DEVICE_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "failed to write enable SPI: ");
 		return FALSE;
 	}
@@ -187,14 +186,14 @@ fu_vli_usbhub_device_spi_chip_erase (FuVliDevice *self, GError **error)
 	if (!fu_vli_device_get_spi_cmd (self, FU_VLI_DEVICE_SPI_REQ_CHIP_ERASE,
 					&spi_cmd, error))
 		return FALSE;
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xd1, spi_cmd, 0x0000,
-					    NULL, 0x0, NULL,
-					    FU_VLI_DEVICE_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xd1, spi_cmd, 0x0000,
+					     NULL, 0x0, NULL,
+					     FU_VLI_DEVICE_TIMEOUT,
+					     NULL, error)) {
 		return FALSE;
 	}
 	return TRUE;
@@ -211,14 +210,14 @@ fu_vli_usbhub_device_spi_sector_erase (FuVliDevice *self, guint32 addr, GError *
 		return FALSE;
 	value = ((addr >> 8) & 0xff00) | spi_cmd;
 	index = ((addr << 8) & 0xff00) | ((addr >> 8) & 0x00ff);
-	return g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					      G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					      G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					      G_USB_DEVICE_RECIPIENT_DEVICE,
-					      0xd4, value, index,
-					      NULL, 0x0, NULL,
-					      FU_VLI_DEVICE_TIMEOUT,
-					      NULL, error);
+	return fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					       G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					       G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					       G_USB_DEVICE_RECIPIENT_DEVICE,
+					       0xd4, value, index,
+					       NULL, 0x0, NULL,
+					       FU_VLI_DEVICE_TIMEOUT,
+					       NULL, error);
 }
 
 static gboolean
@@ -236,14 +235,14 @@ fu_vli_usbhub_device_spi_write_data (FuVliDevice *self,
 		return FALSE;
 	value = ((addr >> 8) & 0xff00) | spi_cmd;
 	index = ((addr << 8) & 0xff00) | ((addr >> 8) & 0x00ff);
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xd4, value, index,
-					    (guint8 *) buf, bufsz, NULL,
-					    FU_VLI_DEVICE_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xd4, value, index,
+					     (guint8 *) buf, bufsz, NULL,
+					     FU_VLI_DEVICE_TIMEOUT,
+					     NULL, error)) {
 		return FALSE;
 	}
 	return TRUE;
@@ -288,14 +287,14 @@ fu_vli_usbhub_device_attach_full (FuDevice *device, FuDevice *proxy, GError **er
 			return FALSE;
 	} else {
 		/* replug, and ignore the device going away */
-		if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (proxy)),
-						    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-						    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-						    G_USB_DEVICE_RECIPIENT_DEVICE,
-						    0xf6, 0x0040, 0x0002,
-						    NULL, 0x0, NULL,
-						    FU_VLI_DEVICE_TIMEOUT,
-						    NULL, &error_local)) {
+		if (!fu_usb_device_control_transfer (FU_USB_DEVICE (proxy),
+						     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+						     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+						     G_USB_DEVICE_RECIPIENT_DEVICE,
+						     0xf6, 0x0040, 0x0002,
+						     NULL, 0x0, NULL,
+						     FU_VLI_DEVICE_TIMEOUT,
+						     NULL, &error_local)) {
 			if (g_error_matches (error_local,
 					     G_USB_DEVICE_ERROR,
 					     G_USB_DEVICE_ERROR_NO_DEVICE) ||
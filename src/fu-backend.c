@@ -41,6 +41,99 @@ fu_backend_device_added (FuBackend *self, FuDevice *device)
 	g_signal_emit (self, signals[SIGNAL_ADDED], 0, device);
 }
 
+typedef struct {
+	FuBackend			*self;		/* no-ref */
+	FuDevice			*device;
+	GError				*error;
+} FuBackendPrefetchHelper;
+
+static void
+fu_backend_prefetch_helper_free (FuBackendPrefetchHelper *helper)
+{
+	g_object_unref (helper->device);
+	if (helper->error != NULL)
+		g_error_free (helper->error);
+	g_free (helper);
+}
+
+static void
+fu_backend_prefetch_helper_cb (gpointer data, gpointer user_data)
+{
+	FuBackendPrefetchHelper *helper = (FuBackendPrefetchHelper *) data;
+	FuBackendClass *klass = FU_BACKEND_GET_CLASS (helper->self);
+	if (!klass->prefetch (helper->self, helper->device, &helper->error))
+		return;
+}
+
+/* reading sysfs and descriptors is slow, so the backend can do this for all
+ * the devices in parallel; the probe, quirks and instance IDs are then done
+ * on the main context as each signal is emitted in the original order */
+void
+fu_backend_devices_added (FuBackend *self, GPtrArray *devices)
+{
+	FuBackendClass *klass = FU_BACKEND_GET_CLASS (self);
+	FuBackendPrivate *priv = GET_PRIVATE (self);
+	GThreadPool *pool = NULL;
+	gint64 start;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) helpers = NULL;
+
+	g_return_if_fail (FU_IS_BACKEND (self));
+	g_return_if_fail (devices != NULL);
+
+	/* nothing to do */
+	if (devices->len == 0)
+		return;
+
+	helpers = g_ptr_array_new_with_free_func ((GDestroyNotify) fu_backend_prefetch_helper_free);
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *device = g_ptr_array_index (devices, i);
+		FuBackendPrefetchHelper *helper = g_new0 (FuBackendPrefetchHelper, 1);
+		helper->self = self;
+		helper->device = g_object_ref (device);
+		g_ptr_array_add (helpers, helper);
+	}
+
+	/* not worth the thread overhead */
+	start = g_get_monotonic_time ();
+	if (klass->prefetch != NULL && devices->len > 1) {
+		pool = g_thread_pool_new (fu_backend_prefetch_helper_cb, NULL,
+					  MIN (g_get_num_processors (), devices->len),
+					  FALSE, &error);
+		if (pool == NULL)
+			g_warning ("failed to create thread pool: %s", error->message);
+	}
+	if (pool != NULL) {
+		for (guint i = 0; i < helpers->len; i++) {
+			FuBackendPrefetchHelper *helper = g_ptr_array_index (helpers, i);
+			g_autoptr(GError) error_local = NULL;
+			if (!g_thread_pool_push (pool, helper, &error_local)) {
+				g_warning ("failed to push: %s", error_local->message);
+				fu_backend_prefetch_helper_cb (helper, NULL);
+			}
+		}
+		g_thread_pool_free (pool, FALSE, TRUE);
+		g_debug ("prefetching %u %s devices took %.1fms",
+			 devices->len, priv->name,
+			 (gdouble) (g_get_monotonic_time () - start) / 1000.f);
+	}
+
+	/* back on the main context */
+	start = g_get_monotonic_time ();
+	for (guint i = 0; i < helpers->len; i++) {
+		FuBackendPrefetchHelper *helper = g_ptr_array_index (helpers, i);
+		if (helper->error != NULL) {
+			g_debug ("failed to prefetch device %s: %s",
+				 fu_device_get_physical_id (helper->device),
+				 helper->error->message);
+		}
+		fu_backend_device_added (self, helper->device);
+	}
+	g_debug ("adding %u %s devices took %.1fms",
+		 devices->len, priv->name,
+		 (gdouble) (g_get_monotonic_time () - start) / 1000.f);
+}
+
 void
 fu_backend_device_removed (FuBackend *self, FuDevice *device)
 {
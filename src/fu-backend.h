@@ -23,6 +23,11 @@ struct _FuBackendClass
 	gboolean		 (*recoldplug)		(FuBackend	*self,
 							 GError		**error)
 							 G_GNUC_WARN_UNUSED_RESULT;
+	/* called from a worker thread: raw reads only, no signals or quirks */
+	gboolean		 (*prefetch)		(FuBackend	*self,
+							 FuDevice	*device,
+							 GError		**error)
+							 G_GNUC_WARN_UNUSED_RESULT;
 };
 
 const gchar	*fu_backend_get_name			(FuBackend	*self);
@@ -40,6 +45,8 @@ gboolean	 fu_backend_recoldplug			(FuBackend	*self,
 							 G_GNUC_WARN_UNUSED_RESULT;
 void		 fu_backend_device_added		(FuBackend	*self,
 							 FuDevice	*device);
+void		 fu_backend_devices_added		(FuBackend	*self,
+							 GPtrArray	*devices);
 void		 fu_backend_device_removed		(FuBackend	*self,
 							 FuDevice	*device);
 void		 fu_backend_device_changed		(FuBackend	*self,
@@ -33,7 +33,12 @@ struct _FuConfig
 	GPtrArray		*blocked_firmware;	/* (element-type utf-8) */
 	GPtrArray		*uri_schemes;		/* (element-type utf-8) */
 	guint64			 archive_size_max;
+	guint64			 download_cache_size_max;
 	guint			 idle_timeout;
+	guint			 history_max_age;	/* days */
+	guint			 history_max_entries;
+	guint			 progress_rate_max;	/* per second */
+	guint			 progress_delta_min;	/* percent */
 	gchar			*config_file;
 	gboolean		 update_motd;
 	gboolean		 enumerate_all_devices;
@@ -52,6 +57,9 @@ static gboolean
 fu_config_reload (FuConfig *self, GError **error)
 {
 	guint64 archive_size_max;
+	guint64 download_cache_size_max;
+	guint64 progress_delta_min;
+	guint64 progress_rate_max;
 	guint idle_timeout;
 	g_auto(GStrv) approved_firmware = NULL;
 	g_auto(GStrv) blocked_firmware = NULL;
@@ -62,6 +70,9 @@ fu_config_reload (FuConfig *self, GError **error)
 	g_autoptr(GKeyFile) keyfile = g_key_file_new ();
 	g_autoptr(GError) error_update_motd = NULL;
 	g_autoptr(GError) error_enumerate_all = NULL;
+	g_autoptr(GError) error_progress_rate = NULL;
+	g_autoptr(GError) error_progress_delta = NULL;
+	g_autoptr(GError) error_download_cache = NULL;
 
 	g_debug ("loading config values from %s", self->config_file);
 	if (!g_key_file_load_from_file (keyfile, self->config_file,
@@ -165,6 +176,20 @@ fu_config_reload (FuConfig *self, GError **error)
 		}
 	}
 
+	/* get maximum size of the client download cache, where 0 is unlimited */
+	download_cache_size_max = g_key_file_get_uint64 (keyfile,
+							 "fwupd",
+							 "DownloadCacheSizeMax",
+							 &error_download_cache);
+	if (error_download_cache == NULL) {
+		if (download_cache_size_max > G_MAXUINT64 / 0x100000)
+			download_cache_size_max = G_MAXUINT64 / 0x100000;
+		self->download_cache_size_max = download_cache_size_max * 0x100000;
+	} else {
+		g_debug ("failed to read DownloadCacheSizeMax key: %s", error_download_cache->message);
+		self->download_cache_size_max = (guint64) FU_CONFIG_DOWNLOAD_CACHE_SIZE_MAX_DEFAULT * 0x100000;
+	}
+
 	/* get idle timeout */
 	idle_timeout = g_key_file_get_uint64 (keyfile,
 					      "fwupd",
@@ -173,6 +198,38 @@ fu_config_reload (FuConfig *self, GError **error)
 	if (idle_timeout > 0)
 		self->idle_timeout = idle_timeout;
 
+	/* get history retention, where 0 is forever */
+	self->history_max_age = g_key_file_get_uint64 (keyfile,
+						       "fwupd",
+						       "HistoryMaxAge",
+						       NULL);
+	self->history_max_entries = g_key_file_get_uint64 (keyfile,
+							   "fwupd",
+							   "HistoryMaxEntries",
+							   NULL);
+
+	/* limit how often the progress is sent to clients, where 0 is unlimited */
+	progress_rate_max = g_key_file_get_uint64 (keyfile,
+						   "fwupd",
+						   "ProgressRateMax",
+						   &error_progress_rate);
+	if (error_progress_rate == NULL) {
+		self->progress_rate_max = progress_rate_max;
+	} else {
+		g_debug ("failed to read ProgressRateMax key: %s", error_progress_rate->message);
+		self->progress_rate_max = FU_CONFIG_PROGRESS_RATE_MAX_DEFAULT;
+	}
+	progress_delta_min = g_key_file_get_uint64 (keyfile,
+						    "fwupd",
+						    "ProgressDeltaMin",
+						    &error_progress_delta);
+	if (error_progress_delta == NULL) {
+		self->progress_delta_min = progress_delta_min;
+	} else {
+		g_debug ("failed to read ProgressDeltaMin key: %s", error_progress_delta->message);
+		self->progress_delta_min = FU_CONFIG_PROGRESS_DELTA_MIN_DEFAULT;
+	}
+
 	/* get the domains to run in verbose */
 	domains = g_key_file_get_string (keyfile,
 					 "fwupd",
@@ -271,6 +328,20 @@ fu_config_get_idle_timeout (FuConfig *self)
 	return self->idle_timeout;
 }
 
+guint
+fu_config_get_history_max_age (FuConfig *self)
+{
+	g_return_val_if_fail (FU_IS_CONFIG (self), 0);
+	return self->history_max_age;
+}
+
+guint
+fu_config_get_history_max_entries (FuConfig *self)
+{
+	g_return_val_if_fail (FU_IS_CONFIG (self), 0);
+	return self->history_max_entries;
+}
+
 GPtrArray *
 fu_config_get_disabled_devices (FuConfig *self)
 {
@@ -310,6 +381,13 @@ fu_config_get_archive_size_max (FuConfig *self)
 	return self->archive_size_max;
 }
 
+guint64
+fu_config_get_download_cache_size_max (FuConfig *self)
+{
+	g_return_val_if_fail (FU_IS_CONFIG (self), 0);
+	return self->download_cache_size_max;
+}
+
 GPtrArray *
 fu_config_get_disabled_plugins (FuConfig *self)
 {
@@ -338,6 +416,20 @@ fu_config_get_enumerate_all_devices (FuConfig *self)
 	return self->enumerate_all_devices;
 }
 
+guint
+fu_config_get_progress_rate_max (FuConfig *self)
+{
+	g_return_val_if_fail (FU_IS_CONFIG (self), 0);
+	return self->progress_rate_max;
+}
+
+guint
+fu_config_get_progress_delta_min (FuConfig *self)
+{
+	g_return_val_if_fail (FU_IS_CONFIG (self), 0);
+	return self->progress_delta_min;
+}
+
 static void
 fu_config_class_init (FuConfigClass *klass)
 {
@@ -359,6 +451,9 @@ fu_config_init (FuConfig *self)
 	self->approved_firmware = g_ptr_array_new_with_free_func (g_free);
 	self->blocked_firmware = g_ptr_array_new_with_free_func (g_free);
 	self->uri_schemes = g_ptr_array_new_with_free_func (g_free);
+	self->progress_rate_max = FU_CONFIG_PROGRESS_RATE_MAX_DEFAULT;
+	self->progress_delta_min = FU_CONFIG_PROGRESS_DELTA_MIN_DEFAULT;
+	self->download_cache_size_max = (guint64) FU_CONFIG_DOWNLOAD_CACHE_SIZE_MAX_DEFAULT * 0x100000;
 }
 
 static void
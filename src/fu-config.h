@@ -13,6 +13,10 @@
 #define FU_TYPE_CONFIG (fu_config_get_type ())
 G_DECLARE_FINAL_TYPE (FuConfig, fu_config, FU, CONFIG, GObject)
 
+#define FU_CONFIG_PROGRESS_RATE_MAX_DEFAULT	10	/* per second */
+#define FU_CONFIG_PROGRESS_DELTA_MIN_DEFAULT	1	/* percent */
+#define FU_CONFIG_DOWNLOAD_CACHE_SIZE_MAX_DEFAULT 512	/* Mb */
+
 FuConfig	*fu_config_new				(void);
 gboolean	 fu_config_load				(FuConfig	*self,
 							 GError		**error);
@@ -22,7 +26,10 @@ gboolean	 fu_config_set_key_value		(FuConfig	*self,
 							 GError		**error);
 
 guint64		 fu_config_get_archive_size_max		(FuConfig	*self);
+guint64		 fu_config_get_download_cache_size_max	(FuConfig	*self);
 guint		 fu_config_get_idle_timeout		(FuConfig	*self);
+guint		 fu_config_get_history_max_age		(FuConfig	*self);
+guint		 fu_config_get_history_max_entries	(FuConfig	*self);
 GPtrArray	*fu_config_get_disabled_devices		(FuConfig	*self);
 GPtrArray	*fu_config_get_disabled_plugins		(FuConfig	*self);
 GPtrArray	*fu_config_get_approved_firmware	(FuConfig	*self);
@@ -31,3 +38,5 @@ guint		 fu_config_get_uri_scheme_prio		(FuConfig	*self,
 							 const gchar	*protocol);
 gboolean	 fu_config_get_update_motd		(FuConfig	*self);
 gboolean	 fu_config_get_enumerate_all_devices	(FuConfig	*self);
+guint		 fu_config_get_progress_rate_max	(FuConfig	*self);
+guint		 fu_config_get_progress_delta_min	(FuConfig	*self);
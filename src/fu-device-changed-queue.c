@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#define G_LOG_DOMAIN				"FuDeviceChangedQueue"
+
+#include "config.h"
+
+#include "fu-device-changed-queue.h"
+
+struct _FuDeviceChangedQueue
+{
+	GObject			 parent_instance;
+	GPtrArray		*devices;	/* (element-type FuDevice) */
+	guint			 interval;	/* ms */
+	guint			 timeout_id;
+	gint64			 flush_time;
+};
+
+enum {
+	SIGNAL_FLUSH,
+	SIGNAL_LAST
+};
+
+static guint signals[SIGNAL_LAST] = { 0 };
+
+G_DEFINE_TYPE (FuDeviceChangedQueue, fu_device_changed_queue, G_TYPE_OBJECT)
+
+static gboolean
+fu_device_changed_queue_remove_internal (FuDeviceChangedQueue *self, FuDevice *device)
+{
+	for (guint i = 0; i < self->devices->len; i++) {
+		FuDevice *device_tmp = g_ptr_array_index (self->devices, i);
+		if (device_tmp == device ||
+		    g_strcmp0 (fu_device_get_id (device_tmp),
+			       fu_device_get_id (device)) == 0) {
+			g_ptr_array_remove_index (self->devices, i);
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/**
+ * fu_device_changed_queue_flush:
+ * @self: A #FuDeviceChangedQueue
+ *
+ * Emits ::flush with all the pending devices straight away. This should be
+ * called before sending anything that a client may order against the
+ * device changes, e.g. another signal or a method reply.
+ **/
+void
+fu_device_changed_queue_flush (FuDeviceChangedQueue *self)
+{
+	g_autoptr(GPtrArray) devices = NULL;
+
+	g_return_if_fail (FU_IS_DEVICE_CHANGED_QUEUE (self));
+
+	if (self->timeout_id != 0) {
+		g_source_remove (self->timeout_id);
+		self->timeout_id = 0;
+	}
+	if (self->devices->len == 0)
+		return;
+	self->flush_time = g_get_monotonic_time ();
+
+	/* the handler may add more devices */
+	devices = g_steal_pointer (&self->devices);
+	self->devices = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_signal_emit (self, signals[SIGNAL_FLUSH], 0, devices);
+}
+
+static gboolean
+fu_device_changed_queue_timeout_cb (gpointer user_data)
+{
+	FuDeviceChangedQueue *self = FU_DEVICE_CHANGED_QUEUE (user_data);
+	self->timeout_id = 0;
+	fu_device_changed_queue_flush (self);
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * fu_device_changed_queue_add:
+ * @self: A #FuDeviceChangedQueue
+ * @device: A #FuDevice
+ *
+ * Adds a changed device. Only the final state of each device is sent, at
+ * most once per interval.
+ **/
+void
+fu_device_changed_queue_add (FuDeviceChangedQueue *self, FuDevice *device)
+{
+	gint64 elapsed;
+
+	g_return_if_fail (FU_IS_DEVICE_CHANGED_QUEUE (self));
+	g_return_if_fail (FU_IS_DEVICE (device));
+
+	fu_device_changed_queue_remove_internal (self, device);
+	g_ptr_array_add (self->devices, g_object_ref (device));
+
+	/* the main loop may be blocked for a long time during an update, so
+	 * flush from here if the interval has already passed */
+	elapsed = (g_get_monotonic_time () - self->flush_time) / 1000;
+	if (elapsed >= self->interval) {
+		fu_device_changed_queue_flush (self);
+		return;
+	}
+	if (self->timeout_id == 0) {
+		self->timeout_id = g_timeout_add (self->interval - elapsed,
+						  fu_device_changed_queue_timeout_cb,
+						  self);
+	}
+}
+
+/**
+ * fu_device_changed_queue_remove:
+ * @self: A #FuDeviceChangedQueue
+ * @device: A #FuDevice
+ *
+ * Drops any pending change for the device, e.g. as it has been removed.
+ **/
+void
+fu_device_changed_queue_remove (FuDeviceChangedQueue *self, FuDevice *device)
+{
+	g_return_if_fail (FU_IS_DEVICE_CHANGED_QUEUE (self));
+	g_return_if_fail (FU_IS_DEVICE (device));
+	fu_device_changed_queue_remove_internal (self, device);
+}
+
+static void
+fu_device_changed_queue_finalize (GObject *obj)
+{
+	FuDeviceChangedQueue *self = FU_DEVICE_CHANGED_QUEUE (obj);
+	if (self->timeout_id != 0)
+		g_source_remove (self->timeout_id);
+	g_ptr_array_unref (self->devices);
+	G_OBJECT_CLASS (fu_device_changed_queue_parent_class)->finalize (obj);
+}
+
+static void
+fu_device_changed_queue_class_init (FuDeviceChangedQueueClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	object_class->finalize = fu_device_changed_queue_finalize;
+
+	signals[SIGNAL_FLUSH] =
+		g_signal_new ("flush",
+			      G_TYPE_FROM_CLASS (object_class), G_SIGNAL_RUN_LAST,
+			      0, NULL, NULL, g_cclosure_marshal_VOID__BOXED,
+			      G_TYPE_NONE, 1, G_TYPE_PTR_ARRAY);
+}
+
+static void
+fu_device_changed_queue_init (FuDeviceChangedQueue *self)
+{
+	self->devices = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+}
+
+FuDeviceChangedQueue *
+fu_device_changed_queue_new (guint interval)
+{
+	FuDeviceChangedQueue *self = g_object_new (FU_TYPE_DEVICE_CHANGED_QUEUE, NULL);
+	self->interval = interval;
+	return FU_DEVICE_CHANGED_QUEUE (self);
+}
@@ -38,6 +38,8 @@ struct _FuDeviceList
 	GObject			 parent_instance;
 	GPtrArray		*devices;	/* of FuDeviceItem */
 	GRWLock			 devices_mutex;
+	GMainLoop		*replug_loop;	/* (nullable) */
+	FuDevice		*replug_device;	/* (nullable) */
 };
 
 enum {
@@ -58,6 +60,8 @@ typedef struct {
 
 G_DEFINE_TYPE (FuDeviceList, fu_device_list, G_TYPE_OBJECT)
 
+static void fu_device_list_replug_check (FuDeviceList *self);
+
 static void
 fu_device_list_emit_device_added (FuDeviceList *self, FuDevice *device)
 {
@@ -428,6 +432,7 @@ fu_device_list_device_delayed_remove_cb (gpointer user_data)
 	g_rw_lock_writer_lock (&self->devices_mutex);
 	g_ptr_array_remove (self->devices, item);
 	g_rw_lock_writer_unlock (&self->devices_mutex);
+	fu_device_list_replug_check (self);
 	return G_SOURCE_REMOVE;
 }
 
@@ -635,6 +640,9 @@ fu_device_list_replace (FuDeviceList *self, FuDeviceItem *item, FuDevice *device
 		fu_device_set_parent (device, parent);
 	}
 
+	/* keep the transfer statistics from the old mode */
+	fu_device_incorporate_io_stats (device, item->device);
+
 	/* assign the new device */
 	g_set_object (&item->device_old, item->device);
 	fu_device_list_item_set_device (item, device);
@@ -645,6 +653,7 @@ fu_device_list_replace (FuDeviceList *self, FuDeviceItem *item, FuDevice *device
 		g_debug ("device came back, clearing flag");
 		fu_device_remove_flag (item->device_old, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG);
 	}
+	fu_device_list_replug_check (self);
 }
 
 /**
@@ -814,34 +823,86 @@ fu_device_list_devices_wait_removed (FuDeviceList *self)
 	return cnt;
 }
 
+/* the device has come back, and no other devices are pending removal */
+static gboolean
+fu_device_list_replug_is_done (FuDeviceList *self)
+{
+	FuDeviceItem *item = fu_device_list_find_by_device (self, self->replug_device);
+	if (item == NULL)
+		return FALSE;
+	if (fu_device_has_flag (item->device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG))
+		return FALSE;
+	return fu_device_list_devices_wait_removed (self) == 0;
+}
+
+static void
+fu_device_list_replug_check (FuDeviceList *self)
+{
+	if (self->replug_loop == NULL)
+		return;
+	if (!fu_device_list_replug_is_done (self))
+		return;
+	g_main_loop_quit (self->replug_loop);
+}
+
+static void
+fu_device_list_replug_flags_notify_cb (FuDevice *device,
+				       GParamSpec *pspec,
+				       FuDeviceList *self)
+{
+	fu_device_list_replug_check (self);
+}
+
+static gboolean
+fu_device_list_replug_timeout_cb (gpointer user_data)
+{
+	FuDeviceList *self = FU_DEVICE_LIST (user_data);
+	g_main_loop_quit (self->replug_loop);
+	return G_SOURCE_REMOVE;
+}
+
 /**
- * fu_device_list_wait_for_replug:
+ * fu_device_list_wait_for_replug_full:
  * @self: A #FuDeviceList
  * @device: A #FuDevice
+ * @remove_delay: the maximum time to wait in ms, or 0 for the device default
+ * @latency: (out) (optional): the time waited in ms
  * @error: A #GError, or %NULL
  *
  * Waits for a specific device to replug if %FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG
- * is set.
+ * is set. The main context is iterated until the device is added back to the
+ * list, or until @remove_delay has elapsed.
+ *
+ * The @latency is also set if the device did not come back in time.
  *
  * If the device does not exist this function returns without an error.
  *
  * Returns: %TRUE for success
  *
- * Since: 1.1.2
+ * Since: 1.5.8
  **/
 gboolean
-fu_device_list_wait_for_replug (FuDeviceList *self, FuDevice *device, GError **error)
+fu_device_list_wait_for_replug_full (FuDeviceList *self,
+				     FuDevice *device,
+				     guint remove_delay,
+				     guint *latency,
+				     GError **error)
 {
 	FuDeviceItem *item;
-	guint remove_delay;
-	guint wait_removed;
-	guint wait_removed_old = 0;
+	gulong notify_id;
+	g_autoptr(GMainLoop) loop = NULL;
+	g_autoptr(GSource) source = NULL;
 	g_autoptr(GTimer) timer = g_timer_new ();
 
 	g_return_val_if_fail (FU_IS_DEVICE_LIST (self), FALSE);
 	g_return_val_if_fail (FU_IS_DEVICE (device), FALSE);
+	g_return_val_if_fail (self->replug_loop == NULL, FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
+	/* nothing waited for */
+	if (latency != NULL)
+		*latency = 0;
+
 	/* not found */
 	item = fu_device_list_find_by_device (self, device);
 	if (item == NULL)
@@ -866,7 +927,8 @@ fu_device_list_wait_for_replug (FuDeviceList *self, FuDevice *device, GError **e
 	}
 
 	/* plugin did not specify */
-	remove_delay = fu_device_get_remove_delay (device);
+	if (remove_delay == 0)
+		remove_delay = fu_device_get_remove_delay (device);
 	if (remove_delay == 0) {
 		remove_delay = FU_DEVICE_REMOVE_DELAY_RE_ENUMERATE;
 		g_warning ("plugin %s did not specify a remove delay for %s, "
@@ -878,23 +940,34 @@ fu_device_list_wait_for_replug (FuDeviceList *self, FuDevice *device, GError **e
 		g_debug ("waiting %ums for replug", remove_delay);
 	}
 
-	/* time to unplug and then re-plug */
-	do {
-		/* count how many devices are in the remove waiting state */
-		wait_removed = fu_device_list_devices_wait_removed (self);
-		if (wait_removed != wait_removed_old) {
-			g_debug ("devices in wait_removed: %u -> %u",
-				 wait_removed_old, wait_removed);
-			wait_removed_old = wait_removed;
-		}
-		g_usleep (1000);
-		g_main_context_iteration (NULL, FALSE);
-		if (!fu_device_has_flag (item->device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG) &&
-		    wait_removed == 0)
-			break;
-	} while (g_timer_elapsed (timer, NULL) * 1000.f < remove_delay);
+	/* time to unplug and then re-plug, or for the timeout */
+	loop = g_main_loop_new (NULL, FALSE);
+	self->replug_loop = loop;
+	self->replug_device = g_object_ref (item->device);
+	notify_id = g_signal_connect (self->replug_device, "notify::flags",
+				      G_CALLBACK (fu_device_list_replug_flags_notify_cb),
+				      self);
+	source = g_timeout_source_new (remove_delay);
+	g_source_set_callback (source, fu_device_list_replug_timeout_cb, self, NULL);
+	g_source_attach (source, NULL);
+	g_main_loop_run (loop);
+	g_source_destroy (source);
+	g_signal_handler_disconnect (self->replug_device, notify_id);
+	g_clear_object (&self->replug_device);
+	self->replug_loop = NULL;
+	if (latency != NULL)
+		*latency = (guint) (g_timer_elapsed (timer, NULL) * 1000.f);
 
 	/* device was not added back to the device list */
+	item = fu_device_list_find_by_device (self, device);
+	if (item == NULL) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_FOUND,
+			     "device %s was removed",
+			     fu_device_get_id (device));
+		return FALSE;
+	}
 	if (fu_device_has_flag (item->device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG)) {
 		g_set_error (error,
 			     FWUPD_ERROR,
@@ -916,10 +989,31 @@ fu_device_list_wait_for_replug (FuDeviceList *self, FuDevice *device, GError **e
 	}
 
 	/* the loop was quit without the timer */
-	g_debug ("waited for replug");
+	g_debug ("waited %.0fms for replug", g_timer_elapsed (timer, NULL) * 1000.f);
 	return TRUE;
 }
 
+/**
+ * fu_device_list_wait_for_replug:
+ * @self: A #FuDeviceList
+ * @device: A #FuDevice
+ * @error: A #GError, or %NULL
+ *
+ * Waits for a specific device to replug if %FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG
+ * is set, using the remove delay set on the device.
+ *
+ * If the device does not exist this function returns without an error.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.1.2
+ **/
+gboolean
+fu_device_list_wait_for_replug (FuDeviceList *self, FuDevice *device, GError **error)
+{
+	return fu_device_list_wait_for_replug_full (self, device, 0, NULL, error);
+}
+
 /**
  * fu_device_list_get_by_id:
  * @self: A #FuDeviceList
@@ -31,5 +31,10 @@ FuDevice	*fu_device_list_get_by_guid		(FuDeviceList	*self,
 gboolean	 fu_device_list_wait_for_replug		(FuDeviceList	*self,
 							 FuDevice	*device,
 							 GError		**error);
+gboolean	 fu_device_list_wait_for_replug_full	(FuDeviceList	*self,
+							 FuDevice	*device,
+							 guint		 remove_delay,
+							 guint		 *latency,
+							 GError		**error);
 void		 fu_device_list_depsolve_order		(FuDeviceList	*self,
 							 FuDevice	*device);
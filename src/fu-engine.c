@@ -13,6 +13,7 @@
 #include <gio/gunixinputstream.h>
 #endif
 #include <glib-object.h>
+#include <glib/gstdio.h>
 #include <string.h>
 #ifdef HAVE_UTSNAME_H
 #include <sys/utsname.h>
@@ -37,7 +38,7 @@
 #include "fu-engine.h"
 #include "fu-engine-helper.h"
 #include "fu-engine-request.h"
-#include "fu-hwids.h"
+#include "fu-hwids-private.h"
 #include "fu-idle.h"
 #include "fu-keyring-utils.h"
 #include "fu-hash.h"
@@ -73,8 +74,17 @@
 #include "fu-systemd.h"
 #endif
 
+/* the number of replugs required before the remove delay is shortened, the
+ * multiple of the slowest replug to wait for, and the minimum wait in ms */
+#define FU_ENGINE_REMOVED_GENERATIONS_MAX	256
+#define FU_ENGINE_SNAPSHOT_DELAY		500	/* ms */
+#define FU_ENGINE_REPLUG_LATENCY_SAMPLES_MIN	3
+#define FU_ENGINE_REPLUG_LATENCY_FACTOR		4
+#define FU_ENGINE_REPLUG_LATENCY_MIN		2000
+
 static void fu_engine_finalize	 (GObject *obj);
 static void fu_engine_ensure_security_attrs	(FuEngine *self);
+static gboolean fu_engine_snapshot_cb	(gpointer user_data);
 
 struct _FuEngine
 {
@@ -87,6 +97,9 @@ struct _FuEngine
 	FwupdStatus		 status;
 	gboolean		 tainted;
 	guint			 percentage;
+	guint			 percentage_emitted;
+	gint64			 percentage_emitted_time;
+	guint			 percentage_id;
 	FuHistory		*history;
 	FuIdle			*idle;
 	XbSilo			*silo;
@@ -106,11 +119,40 @@ struct _FuEngine
 	GHashTable		*firmware_gtypes;
 	gchar			*host_machine_id;
 	JcatContext		*jcat_context;
+	FuVerifyCache		*verify_cache;
+	GPtrArray		*keyring_monitors;	/* of GFileMonitor */
 	gboolean		 loaded;
 	gchar			*host_security_id;
 	FuSecurityAttrs		*host_security_attrs;
+	GHashTable		*security_items;	/* plugin-name:FuEngineSecurityItem */
+	GHashTable		*security_devices;	/* device-id:flags-and-version */
+	guint64			 generation;
+	GHashTable		*device_generations;	/* device-id:guint64 */
+	GHashTable		*removed_generations;	/* device-id:guint64 */
+	guint64			 removed_generation_min;
+	GHashTable		*releases_cache;	/* device-id:feature-flags:FuEngineReleasesItem */
+	GHashTable		*req_programs;		/* XbNode (no-ref):FuEngineReqProgram */
+	GMutex			 snapshot_mutex;
+	GPtrArray		*snapshot_devices;		/* (nullable) of GVariant */
+	GPtrArray		*snapshot_devices_trusted;	/* (nullable) of GVariant */
+	GPtrArray		*snapshot_remotes;		/* (nullable) of GVariant */
+	GPtrArray		*snapshot_security_attrs;	/* (nullable) of GVariant */
+	guint			 snapshot_id;
+	gboolean		 snapshot_delayed;
 };
 
+typedef struct {
+	gchar		*key;
+	GPtrArray	*releases;	/* (nullable) */
+	GError		*error;		/* (nullable) */
+} FuEngineReleasesItem;
+
+typedef struct {
+	FuPlugin	*plugin;	/* no-ref */
+	FuSecurityAttrs	*attrs;		/* (nullable) when stale */
+	gint64		 duration;	/* us, of the last evaluation */
+} FuEngineSecurityItem;
+
 enum {
 	SIGNAL_CHANGED,
 	SIGNAL_DEVICE_ADDED,
@@ -118,6 +160,7 @@ enum {
 	SIGNAL_DEVICE_CHANGED,
 	SIGNAL_STATUS_CHANGED,
 	SIGNAL_PERCENTAGE_CHANGED,
+	SIGNAL_CONFIG_CHANGED,
 	SIGNAL_LAST
 };
 
@@ -125,11 +168,130 @@ static guint signals[SIGNAL_LAST] = { 0 };
 
 G_DEFINE_TYPE (FuEngine, fu_engine, G_TYPE_OBJECT)
 
+static void
+fu_engine_releases_item_free (FuEngineReleasesItem *item)
+{
+	g_free (item->key);
+	if (item->releases != NULL)
+		g_ptr_array_unref (item->releases);
+	if (item->error != NULL)
+		g_error_free (item->error);
+	g_free (item);
+}
+
+static void
+fu_engine_releases_cache_invalidate (FuEngine *self)
+{
+	if (g_hash_table_size (self->releases_cache) == 0)
+		return;
+	g_debug ("invalidating release cache of %u items",
+		 g_hash_table_size (self->releases_cache));
+	g_hash_table_remove_all (self->releases_cache);
+}
+
+/* rebuild the snapshots when the daemon is next idle */
+static void
+fu_engine_snapshot_queue (FuEngine *self)
+{
+	if (self->snapshot_id != 0) {
+		if (!self->snapshot_delayed)
+			return;
+		g_source_remove (self->snapshot_id);
+	}
+	self->snapshot_delayed = FALSE;
+	self->snapshot_id = g_idle_add (fu_engine_snapshot_cb, self);
+}
+
+/* the progress and status change many times a second during an update, so
+ * the snapshot is rebuilt at most once per interval for these */
+static void
+fu_engine_snapshot_queue_delayed (FuEngine *self)
+{
+	if (self->snapshot_id != 0)
+		return;
+	self->snapshot_delayed = TRUE;
+	self->snapshot_id = g_timeout_add (FU_ENGINE_SNAPSHOT_DELAY,
+					   fu_engine_snapshot_cb, self);
+}
+
+/* the device list was changed, so the old snapshot must not be used */
+static void
+fu_engine_snapshot_invalidate_devices (FuEngine *self)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->snapshot_mutex);
+	g_clear_pointer (&self->snapshot_devices, g_ptr_array_unref);
+	g_clear_pointer (&self->snapshot_devices_trusted, g_ptr_array_unref);
+	fu_engine_snapshot_queue (self);
+}
+
+static void
+fu_engine_snapshot_invalidate_remotes (FuEngine *self)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->snapshot_mutex);
+	g_clear_pointer (&self->snapshot_remotes, g_ptr_array_unref);
+	fu_engine_snapshot_queue (self);
+}
+
+/* the attributes are only rebuilt when next requested */
+static void
+fu_engine_invalidate_host_security_id (FuEngine *self)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->snapshot_mutex);
+	g_clear_pointer (&self->snapshot_security_attrs, g_ptr_array_unref);
+	g_clear_pointer (&self->host_security_id, g_free);
+}
+
+static void
+fu_engine_security_item_free (FuEngineSecurityItem *item)
+{
+	if (item->attrs != NULL)
+		g_object_unref (item->attrs);
+	g_free (item);
+}
+
+/* only this plugin has to call add_security_attrs() again */
+static void
+fu_engine_invalidate_security_attrs_for_plugin (FuEngine *self, const gchar *plugin_name)
+{
+	FuEngineSecurityItem *item;
+
+	if (plugin_name == NULL)
+		return;
+	item = g_hash_table_lookup (self->security_items, plugin_name);
+	if (item == NULL || item->attrs == NULL)
+		return;
+	g_debug ("invalidating security attributes for %s", plugin_name);
+	g_clear_object (&item->attrs);
+	fu_engine_invalidate_host_security_id (self);
+}
+
+/* only the flags and version of a device can change what the owning plugin
+ * reports, so progress and status updates are ignored */
+static void
+fu_engine_invalidate_security_attrs_for_device (FuEngine *self, FuDevice *device)
+{
+	const gchar *device_id = fu_device_get_id (device);
+	g_autofree gchar *key = NULL;
+
+	if (device_id == NULL)
+		return;
+	key = g_strdup_printf ("%" G_GUINT64_FORMAT ":%s",
+			       fu_device_get_flags (device),
+			       fu_device_get_version (device));
+	if (g_strcmp0 (g_hash_table_lookup (self->security_devices, device_id), key) == 0)
+		return;
+	g_hash_table_insert (self->security_devices,
+			     g_strdup (device_id),
+			     g_steal_pointer (&key));
+	fu_engine_invalidate_security_attrs_for_plugin (self, fu_device_get_plugin (device));
+}
+
 static void
 fu_engine_emit_changed (FuEngine *self)
 {
 	g_signal_emit (self, signals[SIGNAL_CHANGED], 0);
 	fu_engine_idle_reset (self);
+	fu_engine_snapshot_invalidate_remotes (self);
 
 	/* update the motd */
 	if (self->loaded &&
@@ -141,11 +303,59 @@ fu_engine_emit_changed (FuEngine *self)
 	}
 }
 
+static void
+fu_engine_device_set_generation (FuEngine *self, FuDevice *device, GHashTable *generations)
+{
+	const gchar *device_id = fu_device_get_id (device);
+	guint64 *generation;
+
+	if (device_id == NULL)
+		return;
+	generation = g_new0 (guint64, 1);
+	*generation = ++self->generation;
+	g_hash_table_remove (self->device_generations, device_id);
+	g_hash_table_remove (self->removed_generations, device_id);
+	g_hash_table_insert (generations, g_strdup (device_id), generation);
+	fu_engine_snapshot_queue (self);
+
+	/* forget the oldest removal, so clients older than that must resync */
+	if (g_hash_table_size (self->removed_generations) > FU_ENGINE_REMOVED_GENERATIONS_MAX) {
+		GHashTableIter iter;
+		gpointer key;
+		gpointer value;
+		const gchar *device_id_oldest = NULL;
+		guint64 generation_oldest = G_MAXUINT64;
+
+		g_hash_table_iter_init (&iter, self->removed_generations);
+		while (g_hash_table_iter_next (&iter, &key, &value)) {
+			guint64 *generation_tmp = (guint64 *) value;
+			if (*generation_tmp < generation_oldest) {
+				generation_oldest = *generation_tmp;
+				device_id_oldest = key;
+			}
+		}
+		self->removed_generation_min = MAX (self->removed_generation_min,
+						    generation_oldest);
+		g_hash_table_remove (self->removed_generations, device_id_oldest);
+	}
+}
+
 static void
 fu_engine_emit_device_changed (FuEngine *self, FuDevice *device)
 {
+	fu_engine_device_set_generation (self, device, self->device_generations);
+
 	/* invalidate host security attributes */
-	g_clear_pointer (&self->host_security_id, g_free);
+	fu_engine_invalidate_security_attrs_for_device (self, device);
+	g_signal_emit (self, signals[SIGNAL_DEVICE_CHANGED], 0, device);
+}
+
+/* progress and status change constantly during an update and do not affect
+ * the releases, so only send the signal */
+static void
+fu_engine_emit_device_changed_transient (FuEngine *self, FuDevice *device)
+{
+	fu_engine_snapshot_queue_delayed (self);
 	g_signal_emit (self, signals[SIGNAL_DEVICE_CHANGED], 0, device);
 }
 
@@ -197,6 +407,28 @@ fu_engine_get_status (FuEngine *self)
 	return self->status;
 }
 
+static void
+fu_engine_emit_percentage (FuEngine *self)
+{
+	if (self->percentage_id != 0) {
+		g_source_remove (self->percentage_id);
+		self->percentage_id = 0;
+	}
+	self->percentage_emitted = self->percentage;
+	self->percentage_emitted_time = g_get_monotonic_time ();
+	g_signal_emit (self, signals[SIGNAL_PERCENTAGE_CHANGED], 0, self->percentage);
+}
+
+static gboolean
+fu_engine_percentage_timeout_cb (gpointer user_data)
+{
+	FuEngine *self = FU_ENGINE (user_data);
+	self->percentage_id = 0;
+	if (self->percentage != self->percentage_emitted)
+		fu_engine_emit_percentage (self);
+	return G_SOURCE_REMOVE;
+}
+
 static void
 fu_engine_set_status (FuEngine *self, FwupdStatus status)
 {
@@ -204,6 +436,10 @@ fu_engine_set_status (FuEngine *self, FwupdStatus status)
 		return;
 	self->status = status;
 
+	/* clients should not see the new status with an old percentage */
+	if (self->percentage != self->percentage_emitted)
+		fu_engine_emit_percentage (self);
+
 	/* emit changed */
 	g_debug ("Emitting PropertyChanged('Status'='%s')",
 		 fwupd_status_to_string (status));
@@ -213,12 +449,41 @@ fu_engine_set_status (FuEngine *self, FwupdStatus status)
 static void
 fu_engine_set_percentage (FuEngine *self, guint percentage)
 {
+	guint delta;
+	guint delta_min = fu_config_get_progress_delta_min (self->config);
+	guint rate_max = fu_config_get_progress_rate_max (self->config);
+	gint64 elapsed;
+	gint64 interval;
+
 	if (self->percentage == percentage)
 		return;
 	self->percentage = percentage;
 
-	/* emit changed */
-	g_signal_emit (self, signals[SIGNAL_PERCENTAGE_CHANGED], 0, percentage);
+	/* the start and end are always sent straight away */
+	if (percentage == 0 || percentage == 100 || rate_max == 0) {
+		fu_engine_emit_percentage (self);
+		return;
+	}
+
+	/* send now if the change is large enough and not too soon; this does
+	 * not need the main loop, which plugins often block while writing */
+	interval = G_USEC_PER_SEC / rate_max;
+	elapsed = g_get_monotonic_time () - self->percentage_emitted_time;
+	delta = percentage > self->percentage_emitted ?
+		percentage - self->percentage_emitted :
+		self->percentage_emitted - percentage;
+	if (elapsed >= interval && delta >= delta_min) {
+		fu_engine_emit_percentage (self);
+		return;
+	}
+
+	/* otherwise send the latest value when the interval has passed */
+	if (self->percentage_id == 0) {
+		gint64 timeout = elapsed < interval ? interval - elapsed : interval;
+		self->percentage_id = g_timeout_add (MAX (timeout / 1000, 1),
+						     fu_engine_percentage_timeout_cb,
+						     self);
+	}
 }
 
 static void
@@ -227,14 +492,23 @@ fu_engine_progress_notify_cb (FuDevice *device, GParamSpec *pspec, FuEngine *sel
 	if (fu_device_get_status (device) == FWUPD_STATUS_UNKNOWN)
 		return;
 	fu_engine_set_percentage (self, fu_device_get_progress (device));
-	fu_engine_emit_device_changed (self, device);
+	fu_engine_emit_device_changed_transient (self, device);
 }
 
 static void
 fu_engine_status_notify_cb (FuDevice *device, GParamSpec *pspec, FuEngine *self)
 {
 	fu_engine_set_status (self, fu_device_get_status (device));
-	fu_engine_emit_device_changed (self, device);
+	fu_engine_emit_device_changed_transient (self, device);
+}
+
+/* this includes setters that do not emit a notification, but not the
+ * transient status and progress */
+static void
+fu_engine_device_changed_cb (FuDevice *device, FuEngine *self)
+{
+	fu_engine_device_set_generation (self, device, self->device_generations);
+	fu_engine_snapshot_invalidate_devices (self);
 }
 
 static void
@@ -248,17 +522,26 @@ fu_engine_watch_device (FuEngine *self, FuDevice *device)
 		g_signal_handlers_disconnect_by_func (device_old,
 						      fu_engine_status_notify_cb,
 						      self);
+		g_signal_handlers_disconnect_by_func (device_old,
+						      fu_engine_device_changed_cb,
+						      self);
 	}
 	g_signal_connect (device, "notify::progress",
 			  G_CALLBACK (fu_engine_progress_notify_cb), self);
 	g_signal_connect (device, "notify::status",
 			  G_CALLBACK (fu_engine_status_notify_cb), self);
+	g_signal_connect (device, "changed",
+			  G_CALLBACK (fu_engine_device_changed_cb), self);
 }
 
 static void
 fu_engine_device_added_cb (FuDeviceList *device_list, FuDevice *device, FuEngine *self)
 {
 	fu_engine_watch_device (self, device);
+	fu_engine_device_set_generation (self, device, self->device_generations);
+	fu_engine_releases_cache_invalidate (self);
+	fu_engine_snapshot_invalidate_devices (self);
+	fu_engine_invalidate_security_attrs_for_device (self, device);
 	g_signal_emit (self, signals[SIGNAL_DEVICE_ADDED], 0, device);
 }
 
@@ -277,6 +560,12 @@ fu_engine_device_removed_cb (FuDeviceList *device_list, FuDevice *device, FuEngi
 {
 	fu_engine_device_runner_device_removed (self, device);
 	g_signal_handlers_disconnect_by_data (device, self);
+	fu_engine_device_set_generation (self, device, self->removed_generations);
+	fu_engine_releases_cache_invalidate (self);
+	fu_engine_snapshot_invalidate_devices (self);
+	if (fu_device_get_id (device) != NULL)
+		g_hash_table_remove (self->security_devices, fu_device_get_id (device));
+	fu_engine_invalidate_security_attrs_for_plugin (self, fu_device_get_plugin (device));
 	g_signal_emit (self, signals[SIGNAL_DEVICE_REMOVED], 0, device);
 }
 
@@ -641,6 +930,9 @@ fu_engine_modify_config (FuEngine *self, const gchar *key, const gchar *value, G
 		"VerboseDomains",
 		"UpdateMotd",
 		"EnumerateAllDevices",
+		"ProgressRateMax",
+		"ProgressDeltaMin",
+		"DownloadCacheSizeMax",
 		NULL };
 
 	g_return_val_if_fail (FU_IS_ENGINE (self), FALSE);
@@ -1158,45 +1450,273 @@ fu_engine_verify (FuEngine *self, const gchar *device_id, GError **error)
 	return TRUE;
 }
 
+typedef enum {
+	FU_ENGINE_REQ_KIND_UNKNOWN,
+	FU_ENGINE_REQ_KIND_ID,
+	FU_ENGINE_REQ_KIND_FIRMWARE_VERSION,
+	FU_ENGINE_REQ_KIND_FIRMWARE_BOOTLOADER,
+	FU_ENGINE_REQ_KIND_FIRMWARE_VENDOR_ID,
+	FU_ENGINE_REQ_KIND_FIRMWARE_NOT_CHILD,
+	FU_ENGINE_REQ_KIND_FIRMWARE_GUID,
+	FU_ENGINE_REQ_KIND_FIRMWARE_UNKNOWN,
+	FU_ENGINE_REQ_KIND_HARDWARE,
+	FU_ENGINE_REQ_KIND_CLIENT,
+} FuEngineReqKind;
+
+typedef enum {
+	FU_ENGINE_REQ_COMPARE_INVALID,
+	FU_ENGINE_REQ_COMPARE_EQ,
+	FU_ENGINE_REQ_COMPARE_NE,
+	FU_ENGINE_REQ_COMPARE_LT,
+	FU_ENGINE_REQ_COMPARE_GT,
+	FU_ENGINE_REQ_COMPARE_LE,
+	FU_ENGINE_REQ_COMPARE_GE,
+	FU_ENGINE_REQ_COMPARE_GLOB,
+	FU_ENGINE_REQ_COMPARE_REGEX,
+} FuEngineReqCompare;
+
+/* one <requires> child, with everything parsed ahead of time */
+typedef struct {
+	FuEngineReqKind		 kind;
+	FuEngineReqCompare	 compare;
+	gchar			*element;	/* (nullable) */
+	gchar			*text;		/* (nullable) */
+	gchar			*compare_str;	/* (nullable) */
+	gchar			*version;	/* (nullable) */
+	const gchar		*guid;		/* (nullable): interned */
+	guint64			 depth;
+	FuVersionKey		*key;
+	FuVersionKey		*key_hex;
+	FuVersionKey		*key_plain;
+	GRegex			*regex;		/* (nullable) */
+	GPtrArray		*hwids;		/* (nullable) (element-type utf8): interned */
+	FwupdFeatureFlags	 feature_flags;
+	gchar			*feature_unknown; /* (nullable) */
+} FuEngineReqOp;
+
+typedef GArray FuEngineReqProgram;
+
+static void
+fu_engine_req_op_clear (FuEngineReqOp *op)
+{
+	g_free (op->element);
+	g_free (op->text);
+	g_free (op->compare_str);
+	g_free (op->version);
+	fu_common_version_key_free (op->key);
+	fu_common_version_key_free (op->key_hex);
+	fu_common_version_key_free (op->key_plain);
+	if (op->regex != NULL)
+		g_regex_unref (op->regex);
+	if (op->hwids != NULL)
+		g_ptr_array_unref (op->hwids);
+	g_free (op->feature_unknown);
+}
+
+static FuEngineReqCompare
+fu_engine_req_compare_from_string (const gchar *compare)
+{
+	if (g_strcmp0 (compare, "eq") == 0)
+		return FU_ENGINE_REQ_COMPARE_EQ;
+	if (g_strcmp0 (compare, "ne") == 0)
+		return FU_ENGINE_REQ_COMPARE_NE;
+	if (g_strcmp0 (compare, "lt") == 0)
+		return FU_ENGINE_REQ_COMPARE_LT;
+	if (g_strcmp0 (compare, "gt") == 0)
+		return FU_ENGINE_REQ_COMPARE_GT;
+	if (g_strcmp0 (compare, "le") == 0)
+		return FU_ENGINE_REQ_COMPARE_LE;
+	if (g_strcmp0 (compare, "ge") == 0)
+		return FU_ENGINE_REQ_COMPARE_GE;
+	if (g_strcmp0 (compare, "glob") == 0)
+		return FU_ENGINE_REQ_COMPARE_GLOB;
+	if (g_strcmp0 (compare, "regex") == 0)
+		return FU_ENGINE_REQ_COMPARE_REGEX;
+	return FU_ENGINE_REQ_COMPARE_INVALID;
+}
+
+static void
+fu_engine_req_op_init (FuEngineReqOp *op, XbNode *req)
+{
+	op->element = g_strdup (xb_node_get_element (req));
+	op->text = g_strdup (xb_node_get_text (req));
+	op->compare_str = g_strdup (xb_node_get_attr (req, "compare"));
+	op->version = g_strdup (xb_node_get_attr (req, "version"));
+	op->depth = xb_node_get_attr_as_uint (req, "depth");
+	op->compare = fu_engine_req_compare_from_string (op->compare_str);
+	op->key = fu_common_version_key_new (op->version, FWUPD_VERSION_FORMAT_UNKNOWN);
+	op->key_hex = fu_common_version_key_new (op->version, FWUPD_VERSION_FORMAT_HEX);
+	op->key_plain = fu_common_version_key_new (op->version, FWUPD_VERSION_FORMAT_PLAIN);
+	if (op->compare == FU_ENGINE_REQ_COMPARE_REGEX && op->version != NULL)
+		op->regex = g_regex_new (op->version, 0, 0, NULL);
+
+	/* <id> */
+	if (g_strcmp0 (op->element, "id") == 0) {
+		op->kind = FU_ENGINE_REQ_KIND_ID;
+		return;
+	}
+
+	/* <firmware> */
+	if (g_strcmp0 (op->element, "firmware") == 0) {
+		if (op->text == NULL) {
+			op->kind = FU_ENGINE_REQ_KIND_FIRMWARE_VERSION;
+		} else if (g_strcmp0 (op->text, "bootloader") == 0) {
+			op->kind = FU_ENGINE_REQ_KIND_FIRMWARE_BOOTLOADER;
+		} else if (g_strcmp0 (op->text, "vendor-id") == 0) {
+			op->kind = FU_ENGINE_REQ_KIND_FIRMWARE_VENDOR_ID;
+			if (op->version != NULL && op->regex == NULL)
+				op->regex = g_regex_new (op->version, 0, 0, NULL);
+		} else if (g_strcmp0 (op->text, "not-child") == 0) {
+			op->kind = FU_ENGINE_REQ_KIND_FIRMWARE_NOT_CHILD;
+		} else if (fwupd_guid_is_valid (op->text)) {
+			op->kind = FU_ENGINE_REQ_KIND_FIRMWARE_GUID;
+			op->guid = g_intern_string (op->text);
+		} else {
+			op->kind = FU_ENGINE_REQ_KIND_FIRMWARE_UNKNOWN;
+		}
+		return;
+	}
+
+	/* <hardware>, split and treat as OR */
+	if (g_strcmp0 (op->element, "hardware") == 0) {
+		g_auto(GStrv) hwid_split = g_strsplit (op->text != NULL ? op->text : "", "|", -1);
+		op->kind = FU_ENGINE_REQ_KIND_HARDWARE;
+		op->hwids = g_ptr_array_new ();
+		for (guint i = 0; hwid_split[i] != NULL; i++)
+			g_ptr_array_add (op->hwids, (gpointer) g_intern_string (hwid_split[i]));
+		return;
+	}
+
+	/* <client>, split and treat as AND */
+	if (g_strcmp0 (op->element, "client") == 0) {
+		g_auto(GStrv) feature_split = g_strsplit (op->text != NULL ? op->text : "", "|", -1);
+		op->kind = FU_ENGINE_REQ_KIND_CLIENT;
+		for (guint i = 0; feature_split[i] != NULL; i++) {
+			FwupdFeatureFlags flag = fwupd_feature_flag_from_string (feature_split[i]);
+			if (flag == FWUPD_FEATURE_FLAG_LAST) {
+				op->feature_unknown = g_strdup (feature_split[i]);
+				break;
+			}
+			op->feature_flags |= flag;
+		}
+		return;
+	}
+
+	op->kind = FU_ENGINE_REQ_KIND_UNKNOWN;
+}
+
+/* compiles all the <requires> of a component, or returns %NULL if there are none */
+static FuEngineReqProgram *
+fu_engine_req_program_new (XbNode *component, GError **error)
+{
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GPtrArray) reqs = NULL;
+	FuEngineReqProgram *program;
+
+	program = g_array_new (FALSE, TRUE, sizeof(FuEngineReqOp));
+	g_array_set_clear_func (program, (GDestroyNotify) fu_engine_req_op_clear);
+	reqs = xb_node_query (component, "requires/*", 0, &error_local);
+	if (reqs == NULL) {
+		if (g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
+		    g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
+			return program;
+		g_array_unref (program);
+		g_propagate_error (error, g_steal_pointer (&error_local));
+		return NULL;
+	}
+	g_array_set_size (program, reqs->len);
+	for (guint i = 0; i < reqs->len; i++) {
+		XbNode *req = g_ptr_array_index (reqs, i);
+		fu_engine_req_op_init (&g_array_index (program, FuEngineReqOp, i), req);
+	}
+	return program;
+}
+
+static void
+fu_engine_req_program_component_finalized_cb (gpointer data, GObject *where_the_object_was)
+{
+	FuEngine *self = FU_ENGINE (data);
+	g_hash_table_remove (self->req_programs, where_the_object_was);
+}
+
+/* the program lives as long as the component, so it is compiled once per load */
+static FuEngineReqProgram *
+fu_engine_req_program_for_component (FuEngine *self, XbNode *component, GError **error)
+{
+	FuEngineReqProgram *program;
+
+	program = g_hash_table_lookup (self->req_programs, component);
+	if (program != NULL)
+		return program;
+	program = fu_engine_req_program_new (component, error);
+	if (program == NULL)
+		return NULL;
+	g_hash_table_insert (self->req_programs, component, program);
+	g_object_weak_ref (G_OBJECT (component),
+			   fu_engine_req_program_component_finalized_cb,
+			   self);
+	return program;
+}
+
+static gint
+fu_engine_req_op_vercmp_full (FuEngineReqOp *op, const gchar *version, FwupdVersionFormat fmt)
+{
+	const FuVersionKey *key = op->key;
+	gint rc;
+
+	if (fmt == FWUPD_VERSION_FORMAT_PLAIN)
+		key = op->key_plain;
+	else if (fmt == FWUPD_VERSION_FORMAT_HEX)
+		key = op->key_hex;
+
+	/* the key is the requirement, so swap the order back */
+	rc = fu_common_version_key_compare_version (key, version);
+	if (rc == G_MAXINT)
+		return rc;
+	return -rc;
+}
+
 static gboolean
-fu_engine_require_vercmp (XbNode *req,
-			  const gchar *version,
-			  FwupdVersionFormat fmt,
-			  GError **error)
+fu_engine_req_op_vercmp (FuEngineReqOp *op,
+			 const gchar *version,
+			 FwupdVersionFormat fmt,
+			 GError **error)
 {
 	gboolean ret = FALSE;
-	gint rc = 0;
-	const gchar *tmp = xb_node_get_attr (req, "compare");
-	const gchar *version_req = xb_node_get_attr (req, "version");
-
-	if (g_strcmp0 (tmp, "eq") == 0) {
-		rc = fu_common_vercmp_full (version, version_req, fmt);
-		ret = rc == 0;
-	} else if (g_strcmp0 (tmp, "ne") == 0) {
-		rc = fu_common_vercmp_full (version, version_req, fmt);
-		ret = rc != 0;
-	} else if (g_strcmp0 (tmp, "lt") == 0) {
-		rc = fu_common_vercmp_full (version, version_req, fmt);
-		ret = rc < 0;
-	} else if (g_strcmp0 (tmp, "gt") == 0) {
-		rc = fu_common_vercmp_full (version, version_req, fmt);
-		ret = rc > 0;
-	} else if (g_strcmp0 (tmp, "le") == 0) {
-		rc = fu_common_vercmp_full (version, version_req, fmt);
-		ret = rc <= 0;
-	} else if (g_strcmp0 (tmp, "ge") == 0) {
-		rc = fu_common_vercmp_full (version, version_req, fmt);
-		ret = rc >= 0;
-	} else if (g_strcmp0 (tmp, "glob") == 0) {
-		ret = fu_common_fnmatch (version_req, version);
-	} else if (g_strcmp0 (tmp, "regex") == 0) {
-		ret = g_regex_match_simple (version_req, version, 0, 0);
-	} else {
+
+	switch (op->compare) {
+	case FU_ENGINE_REQ_COMPARE_EQ:
+		ret = fu_engine_req_op_vercmp_full (op, version, fmt) == 0;
+		break;
+	case FU_ENGINE_REQ_COMPARE_NE:
+		ret = fu_engine_req_op_vercmp_full (op, version, fmt) != 0;
+		break;
+	case FU_ENGINE_REQ_COMPARE_LT:
+		ret = fu_engine_req_op_vercmp_full (op, version, fmt) < 0;
+		break;
+	case FU_ENGINE_REQ_COMPARE_GT:
+		ret = fu_engine_req_op_vercmp_full (op, version, fmt) > 0;
+		break;
+	case FU_ENGINE_REQ_COMPARE_LE:
+		ret = fu_engine_req_op_vercmp_full (op, version, fmt) <= 0;
+		break;
+	case FU_ENGINE_REQ_COMPARE_GE:
+		ret = fu_engine_req_op_vercmp_full (op, version, fmt) >= 0;
+		break;
+	case FU_ENGINE_REQ_COMPARE_GLOB:
+		ret = version != NULL && op->version != NULL &&
+		      fu_common_fnmatch (op->version, version);
+		break;
+	case FU_ENGINE_REQ_COMPARE_REGEX:
+		ret = version != NULL && op->regex != NULL &&
+		      g_regex_match (op->regex, version, 0, NULL);
+		break;
+	default:
 		g_set_error (error,
 			     FWUPD_ERROR,
 			     FWUPD_ERROR_NOT_SUPPORTED,
 			     "failed to compare [%s] and [%s]",
-			     version_req,
+			     op->version,
 			     version);
 		return FALSE;
 	}
@@ -1207,27 +1727,17 @@ fu_engine_require_vercmp (XbNode *req,
 			     FWUPD_ERROR,
 			     FWUPD_ERROR_INTERNAL,
 			     "failed predicate [%s %s %s]",
-			     version_req, tmp, version);
+			     op->version, op->compare_str, version);
 	}
 	return ret;
 }
 
 static gboolean
-fu_engine_check_requirement_not_child (FuEngine *self, XbNode *req,
+fu_engine_check_requirement_not_child (FuEngine *self, FuEngineReqOp *op,
 				       FuDevice *device, GError **error)
 {
 	GPtrArray *children = fu_device_get_children (device);
 
-	/* only <firmware> supported */
-	if (g_strcmp0 (xb_node_get_element (req), "firmware") != 0) {
-		g_set_error (error,
-			     FWUPD_ERROR,
-			     FWUPD_ERROR_NOT_SUPPORTED,
-			     "cannot handle not-child %s requirement",
-			     xb_node_get_element (req));
-		return FALSE;
-	}
-
 	/* check each child */
 	for (guint i = 0; i < children->len; i++) {
 		FuDevice *child = g_ptr_array_index (children, i);
@@ -1241,9 +1751,9 @@ fu_engine_check_requirement_not_child (FuEngine *self, XbNode *req,
 				     fu_device_get_name (device));
 			return FALSE;
 		}
-		if (fu_engine_require_vercmp (req, version,
-					      fu_device_get_version_format (child),
-					      NULL)) {
+		if (fu_engine_req_op_vercmp (op, version,
+					     fu_device_get_version_format (child),
+					     NULL)) {
 			g_set_error (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_NOT_SUPPORTED,
@@ -1256,11 +1766,10 @@ fu_engine_check_requirement_not_child (FuEngine *self, XbNode *req,
 }
 
 static gboolean
-fu_engine_check_requirement_vendor_id (FuEngine *self, XbNode *req,
+fu_engine_check_requirement_vendor_id (FuEngine *self, FuEngineReqOp *op,
 				       FuDevice *device, GError **error)
 {
 	GPtrArray *vendor_ids;
-	const gchar *vendor_ids_metadata;
 	g_autofree gchar *vendor_ids_device = NULL;
 
 	/* devices without vendor IDs should not exist! */
@@ -1275,8 +1784,7 @@ fu_engine_check_requirement_vendor_id (FuEngine *self, XbNode *req,
 	}
 
 	/* metadata with empty vendor IDs should not exist! */
-	vendor_ids_metadata = xb_node_get_attr (req, "version");
-	if (vendor_ids_metadata == NULL) {
+	if (op->version == NULL) {
 		g_set_error_literal (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_NOT_SUPPORTED,
@@ -1286,13 +1794,13 @@ fu_engine_check_requirement_vendor_id (FuEngine *self, XbNode *req,
 
 	/* it is always safe to use a regex, even for simple strings */
 	vendor_ids_device = fu_common_strjoin_array ("|", vendor_ids);
-	if (!g_regex_match_simple (vendor_ids_metadata, vendor_ids_device, 0, 0)) {
+	if (op->regex == NULL || !g_regex_match (op->regex, vendor_ids_device, 0, NULL)) {
 		g_set_error (error,
 			     FWUPD_ERROR,
 			     FWUPD_ERROR_INVALID_FILE,
 			     "Not compatible with vendor %s: got %s",
 			     vendor_ids_device,
-			     vendor_ids_metadata);
+			     op->version);
 		return FALSE;
 	}
 
@@ -1301,43 +1809,43 @@ fu_engine_check_requirement_vendor_id (FuEngine *self, XbNode *req,
 }
 
 static gboolean
-fu_engine_check_requirement_firmware (FuEngine *self, XbNode *req, FuDevice *device,
+fu_engine_check_requirement_firmware (FuEngine *self, FuEngineReqOp *op, FuDevice *device,
 				      FwupdInstallFlags flags, GError **error)
 {
-	guint64 depth;
 	g_autoptr(FuDevice) device_actual = g_object_ref (device);
 	g_autoptr(GError) error_local = NULL;
 
 	/* look at the parent device */
-	depth = xb_node_get_attr_as_uint (req, "depth");
-	if (depth != G_MAXUINT64) {
-		for (guint64 i = 0; i < depth; i++) {
+	if (op->depth != G_MAXUINT64) {
+		for (guint64 i = 0; i < op->depth; i++) {
 			FuDevice *device_tmp = fu_device_get_parent (device_actual);
-			if (device_actual == NULL) {
+			if (device_tmp == NULL) {
 				g_set_error (error,
 					     FWUPD_ERROR,
 					     FWUPD_ERROR_NOT_SUPPORTED,
 					     "No parent device for %s "
 					     "(%" G_GUINT64_FORMAT "/%" G_GUINT64_FORMAT ")",
-					     fu_device_get_name (device_actual), i, depth);
+					     fu_device_get_name (device_actual), i, op->depth);
 				return FALSE;
 			}
 			g_set_object (&device_actual, device_tmp);
 		}
 	}
 
+	switch (op->kind) {
 	/* old firmware version */
-	if (xb_node_get_text (req) == NULL) {
+	case FU_ENGINE_REQ_KIND_FIRMWARE_VERSION:
+	{
 		const gchar *version = fu_device_get_version (device_actual);
-		if (!fu_engine_require_vercmp (req, version,
-					       fu_device_get_version_format (device_actual),
-					       &error_local)) {
-			if (g_strcmp0 (xb_node_get_attr (req, "compare"), "ge") == 0) {
+		if (!fu_engine_req_op_vercmp (op, version,
+					      fu_device_get_version_format (device_actual),
+					      &error_local)) {
+			if (op->compare == FU_ENGINE_REQ_COMPARE_GE) {
 				g_set_error (error,
 					     FWUPD_ERROR,
 					     FWUPD_ERROR_INVALID_FILE,
 					     "Not compatible with firmware version %s, requires >= %s",
-					     version, xb_node_get_attr (req, "version"));
+					     version, op->version);
 			} else {
 				g_set_error (error,
 					     FWUPD_ERROR,
@@ -1351,17 +1859,18 @@ fu_engine_check_requirement_firmware (FuEngine *self, XbNode *req, FuDevice *dev
 	}
 
 	/* bootloader version */
-	if (g_strcmp0 (xb_node_get_text (req), "bootloader") == 0) {
+	case FU_ENGINE_REQ_KIND_FIRMWARE_BOOTLOADER:
+	{
 		const gchar *version = fu_device_get_version_bootloader (device_actual);
-		if (!fu_engine_require_vercmp (req, version,
-					       fu_device_get_version_format (device_actual),
-					       &error_local)) {
-			if (g_strcmp0 (xb_node_get_attr (req, "compare"), "ge") == 0) {
+		if (!fu_engine_req_op_vercmp (op, version,
+					      fu_device_get_version_format (device_actual),
+					      &error_local)) {
+			if (op->compare == FU_ENGINE_REQ_COMPARE_GE) {
 				g_set_error (error,
 					     FWUPD_ERROR,
 					     FWUPD_ERROR_NOT_SUPPORTED,
 					     "Not compatible with bootloader version %s, requires >= %s",
-                                             version, xb_node_get_attr (req, "version"));
+					     version, op->version);
 
 			} else {
 				g_debug ("Bootloader is not compatible: %s", error_local->message);
@@ -1376,37 +1885,36 @@ fu_engine_check_requirement_firmware (FuEngine *self, XbNode *req, FuDevice *dev
 	}
 
 	/* vendor ID */
-	if (g_strcmp0 (xb_node_get_text (req), "vendor-id") == 0) {
+	case FU_ENGINE_REQ_KIND_FIRMWARE_VENDOR_ID:
 		if (flags & FWUPD_INSTALL_FLAG_IGNORE_VID_PID)
 			return TRUE;
-		return fu_engine_check_requirement_vendor_id (self, req, device_actual, error);
-	}
+		return fu_engine_check_requirement_vendor_id (self, op, device_actual, error);
 
 	/* child version */
-	if (g_strcmp0 (xb_node_get_text (req), "not-child") == 0)
-		return fu_engine_check_requirement_not_child (self, req, device_actual, error);
+	case FU_ENGINE_REQ_KIND_FIRMWARE_NOT_CHILD:
+		return fu_engine_check_requirement_not_child (self, op, device_actual, error);
 
 	/* another device */
-	if (fwupd_guid_is_valid (xb_node_get_text (req))) {
-		const gchar *guid = xb_node_get_text (req);
+	case FU_ENGINE_REQ_KIND_FIRMWARE_GUID:
+	{
 		const gchar *version;
 
 		/* find if the other device exists */
-		if (depth == G_MAXUINT64) {
+		if (op->depth == G_MAXUINT64) {
 			g_autoptr(FuDevice) device_tmp = NULL;
-			device_tmp = fu_device_list_get_by_guid (self->device_list, guid, error);
+			device_tmp = fu_device_list_get_by_guid (self->device_list, op->guid, error);
 			if (device_tmp == NULL)
 				return FALSE;
 			g_set_object (&device_actual, device_tmp);
 
 		/* verify the parent device has the GUID */
 		} else {
-			if (!fu_device_has_guid (device_actual, guid)) {
+			if (!fu_device_has_guid (device_actual, op->guid)) {
 				g_set_error (error,
 					     FWUPD_ERROR,
 					     FWUPD_ERROR_NOT_SUPPORTED,
 					     "No GUID of %s on parent device %s",
-					     guid, fu_device_get_name (device_actual));
+					     op->guid, fu_device_get_name (device_actual));
 				return FALSE;
 			}
 		}
@@ -1414,18 +1922,18 @@ fu_engine_check_requirement_firmware (FuEngine *self, XbNode *req, FuDevice *dev
 		/* get the version of the other device */
 		version = fu_device_get_version (device_actual);
 		if (version != NULL &&
-		    xb_node_get_attr (req, "compare") != NULL &&
-		    !fu_engine_require_vercmp (req, version,
-					       fu_device_get_version_format (device_actual),
-					       &error_local)) {
-			if (g_strcmp0 (xb_node_get_attr (req, "compare"), "ge") == 0) {
+		    op->compare_str != NULL &&
+		    !fu_engine_req_op_vercmp (op, version,
+					      fu_device_get_version_format (device_actual),
+					      &error_local)) {
+			if (op->compare == FU_ENGINE_REQ_COMPARE_GE) {
 				g_set_error (error,
 					     FWUPD_ERROR,
 					     FWUPD_ERROR_INVALID_FILE,
 					     "Not compatible with %s version %s, requires >= %s",
 					     fu_device_get_name (device_actual),
 					     version,
-					     xb_node_get_attr (req, "version"));
+					     op->version);
 			} else {
 				g_set_error (error,
 					     FWUPD_ERROR,
@@ -1437,7 +1945,9 @@ fu_engine_check_requirement_firmware (FuEngine *self, XbNode *req, FuDevice *dev
 			return FALSE;
 		}
 		return TRUE;
-
+	}
+	default:
+		break;
 	}
 
 	/* not supported */
@@ -1445,59 +1955,55 @@ fu_engine_check_requirement_firmware (FuEngine *self, XbNode *req, FuDevice *dev
 		     FWUPD_ERROR,
 		     FWUPD_ERROR_NOT_SUPPORTED,
 		     "cannot handle firmware requirement '%s'",
-		     xb_node_get_text (req));
+		     op->text);
 	return FALSE;
 }
 
 static gboolean
-fu_engine_check_requirement_id (FuEngine *self, XbNode *req, GError **error)
+fu_engine_check_requirement_id (FuEngine *self, FuEngineReqOp *op, GError **error)
 {
 	g_autoptr(GError) error_local = NULL;
-	const gchar *version = g_hash_table_lookup (self->runtime_versions,
-						    xb_node_get_text (req));
+	const gchar *version = NULL;
+
+	if (op->text != NULL)
+		version = g_hash_table_lookup (self->runtime_versions, op->text);
 	if (version == NULL) {
 		g_set_error (error,
 			     FWUPD_ERROR,
 			     FWUPD_ERROR_NOT_FOUND,
 			     "no version available for %s",
-			     xb_node_get_text (req));
+			     op->text);
 		return FALSE;
 	}
-	if (!fu_engine_require_vercmp (req, version, FWUPD_VERSION_FORMAT_UNKNOWN, &error_local)) {
-		if (g_strcmp0 (xb_node_get_attr (req, "compare"), "ge") == 0) {
+	if (!fu_engine_req_op_vercmp (op, version, FWUPD_VERSION_FORMAT_UNKNOWN, &error_local)) {
+		if (op->compare == FU_ENGINE_REQ_COMPARE_GE) {
 			g_set_error (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_INVALID_FILE,
 				     "Not compatible with %s version %s, requires >= %s",
-				     xb_node_get_text (req), version,
-				     xb_node_get_attr (req, "version"));
+				     op->text, version, op->version);
 		} else {
 			g_set_error (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_INVALID_FILE,
 				     "Not compatible with %s version: %s",
-				     xb_node_get_text (req), error_local->message);
+				     op->text, error_local->message);
 		}
 		return FALSE;
 	}
 
 	g_debug ("requirement %s %s %s -> %s passed",
-		 xb_node_get_attr (req, "version"),
-		 xb_node_get_attr (req, "compare"),
-		 version, xb_node_get_text (req));
+		 op->version, op->compare_str, version, op->text);
 	return TRUE;
 }
 
 static gboolean
-fu_engine_check_requirement_hardware (FuEngine *self, XbNode *req, GError **error)
+fu_engine_check_requirement_hardware (FuEngine *self, FuEngineReqOp *op, GError **error)
 {
-	g_auto(GStrv) hwid_split = NULL;
-
-	/* split and treat as OR */
-	hwid_split = g_strsplit (xb_node_get_text (req), "|", -1);
-	for (guint i = 0; hwid_split[i] != NULL; i++) {
-		if (fu_hwids_has_guid (self->hwids, hwid_split[i])) {
-			g_debug ("HWID provided %s", hwid_split[i]);
+	for (guint i = 0; i < op->hwids->len; i++) {
+		const gchar *hwid = g_ptr_array_index (op->hwids, i);
+		if (fu_hwids_has_guid (self->hwids, hwid)) {
+			g_debug ("HWID provided %s", hwid);
 			return TRUE;
 		}
 	}
@@ -1507,42 +2013,41 @@ fu_engine_check_requirement_hardware (FuEngine *self, XbNode *req, GError **erro
 		     FWUPD_ERROR,
 		     FWUPD_ERROR_INVALID_FILE,
 		     "no HWIDs matched %s",
-		     xb_node_get_text (req));
+		     op->text);
 	return FALSE;
 }
 
 static gboolean
 fu_engine_check_requirement_client (FuEngine *self,
 				    FuEngineRequest *request,
-				    XbNode *req,
+				    FuEngineReqOp *op,
 				    GError **error)
 {
-	FwupdFeatureFlags flags;
-	g_auto(GStrv) feature_split = NULL;
-
-	/* split and treat as AND */
-	feature_split = g_strsplit (xb_node_get_text (req), "|", -1);
-	flags = fu_engine_request_get_feature_flags (request);
-	for (guint i = 0; feature_split[i] != NULL; i++) {
-		FwupdFeatureFlags flag = fwupd_feature_flag_from_string (feature_split[i]);
+	FwupdFeatureFlags flags = fu_engine_request_get_feature_flags (request);
+	FwupdFeatureFlags flags_missing;
 
-		/* not recognized */
-		if (flag == FWUPD_FEATURE_FLAG_LAST) {
-			g_set_error (error,
-				     FWUPD_ERROR,
-				     FWUPD_ERROR_NOT_FOUND,
-				     "client requirement %s unknown",
-				     feature_split[i]);
-			return FALSE;
-		}
+	/* not recognized */
+	if (op->feature_unknown != NULL) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_FOUND,
+			     "client requirement %s unknown",
+			     op->feature_unknown);
+		return FALSE;
+	}
 
-		/* not supported */
-		if ((flags & flag) == 0) {
+	/* not supported */
+	flags_missing = op->feature_flags & ~flags;
+	if (flags_missing != 0) {
+		for (guint i = 0; i < 64; i++) {
+			FwupdFeatureFlags flag = (guint64) 1 << i;
+			if ((flags_missing & flag) == 0)
+				continue;
 			g_set_error (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_NOT_SUPPORTED,
 				     "client requirement %s not supported",
-				     feature_split[i]);
+				     fwupd_feature_flag_to_string (flag));
 			return FALSE;
 		}
 	}
@@ -1554,37 +2059,45 @@ fu_engine_check_requirement_client (FuEngine *self,
 static gboolean
 fu_engine_check_requirement (FuEngine *self,
 			     FuEngineRequest *request,
-			     XbNode *req,
+			     FuEngineReqOp *op,
 			     FuDevice *device,
 			     FwupdInstallFlags flags,
 			     GError **error)
 {
+	switch (op->kind) {
 	/* ensure component requirement */
-	if (g_strcmp0 (xb_node_get_element (req), "id") == 0)
-		return fu_engine_check_requirement_id (self, req, error);
+	case FU_ENGINE_REQ_KIND_ID:
+		return fu_engine_check_requirement_id (self, op, error);
 
 	/* ensure firmware requirement */
-	if (g_strcmp0 (xb_node_get_element (req), "firmware") == 0) {
+	case FU_ENGINE_REQ_KIND_FIRMWARE_VERSION:
+	case FU_ENGINE_REQ_KIND_FIRMWARE_BOOTLOADER:
+	case FU_ENGINE_REQ_KIND_FIRMWARE_VENDOR_ID:
+	case FU_ENGINE_REQ_KIND_FIRMWARE_NOT_CHILD:
+	case FU_ENGINE_REQ_KIND_FIRMWARE_GUID:
+	case FU_ENGINE_REQ_KIND_FIRMWARE_UNKNOWN:
 		if (device == NULL)
 			return TRUE;
-		return fu_engine_check_requirement_firmware (self, req, device,
+		return fu_engine_check_requirement_firmware (self, op, device,
 							     flags, error);
-	}
 
 	/* ensure hardware requirement */
-	if (g_strcmp0 (xb_node_get_element (req), "hardware") == 0)
-		return fu_engine_check_requirement_hardware (self, req, error);
+	case FU_ENGINE_REQ_KIND_HARDWARE:
+		return fu_engine_check_requirement_hardware (self, op, error);
 
 	/* ensure client requirement */
-	if (g_strcmp0 (xb_node_get_element (req), "client") == 0)
-		return fu_engine_check_requirement_client (self, request, req, error);
+	case FU_ENGINE_REQ_KIND_CLIENT:
+		return fu_engine_check_requirement_client (self, request, op, error);
+	default:
+		break;
+	}
 
 	/* not supported */
 	g_set_error (error,
 		     FWUPD_ERROR,
 		     FWUPD_ERROR_NOT_SUPPORTED,
 		     "cannot handle requirement type %s",
-		     xb_node_get_element (req));
+		     op->element);
 	return FALSE;
 }
 
@@ -1611,8 +2124,7 @@ fu_engine_check_requirements (FuEngine *self,
 			      GError **error)
 {
 	FuDevice *device = fu_install_task_get_device (task);
-	g_autoptr(GError) error_local = NULL;
-	g_autoptr(GPtrArray) reqs = NULL;
+	FuEngineReqProgram *program;
 
 	/* all install task checks require a device */
 	if (device != NULL) {
@@ -1621,19 +2133,16 @@ fu_engine_check_requirements (FuEngine *self,
 	}
 
 	/* do engine checks */
-	reqs = xb_node_query (fu_install_task_get_component (task),
-			      "requires/*", 0, &error_local);
-	if (reqs != NULL) {
-		for (guint i = 0; i < reqs->len; i++) {
-			XbNode *req = g_ptr_array_index (reqs, i);
-			if (!fu_engine_check_requirement (self, request,
-							  req, device,
-							  flags, error))
-				return FALSE;
-		}
-	} else if (!g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) &&
-		   !g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT)) {
-			g_propagate_error (error, g_steal_pointer (&error_local));
+	program = fu_engine_req_program_for_component (self,
+						       fu_install_task_get_component (task),
+						       error);
+	if (program == NULL)
+		return FALSE;
+	for (guint i = 0; i < program->len; i++) {
+		FuEngineReqOp *op = &g_array_index (program, FuEngineReqOp, i);
+		if (!fu_engine_check_requirement (self, request,
+						  op, device,
+						  flags, error))
 			return FALSE;
 	}
 
@@ -2203,6 +2712,28 @@ fu_engine_schedule_update (FuEngine *self,
 	return fu_engine_offline_setup (error);
 }
 
+/* the device may have been replaced by a runtime or bootloader object */
+static void
+fu_engine_save_io_stats (FuEngine *self, const gchar *device_id, FwupdRelease *release)
+{
+	g_autoptr(FuDevice) device = NULL;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GHashTable) metadata = NULL;
+
+	device = fu_device_list_get_by_id (self->device_list, device_id, NULL);
+	if (device == NULL)
+		return;
+	metadata = fu_device_report_io_stats (device);
+	if (g_hash_table_size (metadata) == 0)
+		return;
+	fwupd_release_add_metadata (release, metadata);
+	if (!fu_history_set_device_metadata (self->history,
+					     device_id,
+					     fwupd_release_get_metadata (release),
+					     &error_local))
+		g_warning ("failed to save I/O statistics: %s", error_local->message);
+}
+
 static gboolean
 fu_engine_install_release (FuEngine *self,
 			   FuDevice *device_orig,
@@ -2219,6 +2750,7 @@ fu_engine_install_release (FuEngine *self,
 	g_autofree gchar *version_rel = NULL;
 	g_autoptr(FuDevice) device_tmp = NULL;
 	g_autoptr(FuDevice) device = g_object_ref (device_orig);
+	g_autoptr(FwupdRelease) release_tmp = NULL;
 	g_autoptr(GBytes) blob_fw2 = NULL;
 	g_autoptr(GError) error_local = NULL;
 
@@ -2262,7 +2794,6 @@ fu_engine_install_release (FuEngine *self,
 
 	/* add device to database */
 	if ((flags & FWUPD_INSTALL_FLAG_NO_HISTORY) == 0) {
-		g_autoptr(FwupdRelease) release_tmp = NULL;
 		release_tmp = fu_engine_create_release_metadata (self, device, plugin, error);
 		if (release_tmp == NULL)
 			return FALSE;
@@ -2279,8 +2810,11 @@ fu_engine_install_release (FuEngine *self,
 
 	/* install firmware blob */
 	version_orig = g_strdup (fu_device_get_version (device));
+	fu_device_reset_io_stats (device);
 	if (!fu_engine_install_blob (self, device, blob_fw2, flags, &error_local)) {
 		fu_device_set_status (device, FWUPD_STATUS_IDLE);
+		if (release_tmp != NULL)
+			fu_engine_save_io_stats (self, fu_device_get_id (device), release_tmp);
 		if (g_error_matches (error_local,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_AC_POWER_REQUIRED) ||
@@ -2315,6 +2849,8 @@ fu_engine_install_release (FuEngine *self,
 		return FALSE;
 	}
 	g_set_object (&device, device_tmp);
+	if (release_tmp != NULL)
+		fu_engine_save_io_stats (self, fu_device_get_id (device), release_tmp);
 
 	/* update database */
 	if (fu_device_has_flag (device, FWUPD_DEVICE_FLAG_NEEDS_REBOOT) ||
@@ -2352,50 +2888,56 @@ fu_engine_install_release (FuEngine *self,
 }
 
 typedef struct {
-	gboolean	 ret;
-	GError		**error;
-	FuEngine	*self;
-	FuDevice	*device;
-} FuEngineSortHelper;
+	gpointer	 data;
+	FuVersionKey	*key;
+} FuEngineSortItem;
 
-static gint
-fu_engine_sort_release_versions_cb (gconstpointer a, gconstpointer b, gpointer user_data)
+typedef GArray FuEngineSortItems;
+
+static void
+fu_engine_sort_items_free (FuEngineSortItems *items)
 {
-	FuEngineSortHelper *helper = (FuEngineSortHelper *) user_data;
-	XbNode *na = *((XbNode **) a);
-	XbNode *nb = *((XbNode **) b);
-	g_autofree gchar *va = NULL;
-	g_autofree gchar *vb = NULL;
+	for (guint i = 0; i < items->len; i++) {
+		FuEngineSortItem *item = &g_array_index (items, FuEngineSortItem, i);
+		fu_common_version_key_free (item->key);
+	}
+	g_array_unref (items);
+}
 
-	/* already failed */
-	if (!helper->ret)
-		return 0;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuEngineSortItems, fu_engine_sort_items_free)
 
-	/* get the semver from the release */
-	va = fu_engine_get_release_version (helper->self, helper->device, na, helper->error);
-	if (va == NULL) {
-		g_prefix_error (helper->error, "failed to get release version: ");
-		return 0;
-	}
-	vb = fu_engine_get_release_version (helper->self, helper->device, nb, helper->error);
-	if (vb == NULL) {
-		g_prefix_error (helper->error, "failed to get release version: ");
-		return 0;
-	}
-	return fu_common_vercmp_full (va, vb, fu_device_get_version_format (helper->device));
+static gint
+fu_engine_sort_release_versions_cb (gconstpointer a, gconstpointer b)
+{
+	const FuEngineSortItem *item_a = (const FuEngineSortItem *) a;
+	const FuEngineSortItem *item_b = (const FuEngineSortItem *) b;
+	return fu_common_version_key_compare (item_a->key, item_b->key);
 }
 
 static gboolean
 fu_engine_sort_releases (FuEngine *self, FuDevice *device, GPtrArray *rels, GError **error)
 {
-	FuEngineSortHelper helper = {
-		.ret = TRUE,
-		.self = self,
-		.device = device,
-		.error = error,
-	};
-	g_ptr_array_sort_with_data (rels, fu_engine_sort_release_versions_cb, &helper);
-	return helper.ret;
+	FwupdVersionFormat fmt = fu_device_get_version_format (device);
+	g_autoptr(FuEngineSortItems) items = NULL;
+
+	/* get the semver from each release only once */
+	items = g_array_sized_new (FALSE, FALSE, sizeof(FuEngineSortItem), rels->len);
+	for (guint i = 0; i < rels->len; i++) {
+		XbNode *rel = g_ptr_array_index (rels, i);
+		FuEngineSortItem item = { .data = rel };
+		g_autofree gchar *version = NULL;
+		version = fu_engine_get_release_version (self, device, rel, error);
+		if (version == NULL) {
+			g_prefix_error (error, "failed to get release version: ");
+			return FALSE;
+		}
+		item.key = fu_common_version_key_new (version, fmt);
+		g_array_append_val (items, item);
+	}
+	g_array_sort (items, fu_engine_sort_release_versions_cb);
+	for (guint i = 0; i < items->len; i++)
+		rels->pdata[i] = g_array_index (items, FuEngineSortItem, i).data;
+	return TRUE;
 }
 
 /**
@@ -2556,6 +3098,61 @@ fu_engine_get_plugins (FuEngine *self)
 	return fu_plugin_list_get_all (self->plugin_list);
 }
 
+/* devices that reliably come back in a fraction of their remove delay should
+ * not take much longer than the slowest replug seen, so warn if they do */
+static void
+fu_engine_add_replug_latency (FuEngine *self, const gchar *device_id, guint latency)
+{
+	g_autoptr(GError) error_local = NULL;
+	if (latency == 0)
+		return;
+	if (!fu_history_add_replug_latency (self->history, device_id,
+					    latency, &error_local)) {
+		g_warning ("failed to record replug latency: %s", error_local->message);
+	}
+}
+
+static gboolean
+fu_engine_wait_for_replug (FuEngine *self, FuDevice *device, GError **error)
+{
+	guint latency = 0;
+	guint latency_max = 0;
+	guint remove_delay = fu_device_get_remove_delay (device);
+	guint remove_delay_learned = 0;
+	guint samples = 0;
+	g_autofree gchar *device_id = g_strdup (fu_device_get_id (device));
+	g_autoptr(GError) error_local = NULL;
+
+	if (!fu_history_get_replug_latency (self->history, device_id,
+					    &samples, &latency_max, &error_local)) {
+		if (!g_error_matches (error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND))
+			g_warning ("failed to get replug latency: %s", error_local->message);
+	} else if (samples >= FU_ENGINE_REPLUG_LATENCY_SAMPLES_MIN) {
+		remove_delay_learned = MAX (latency_max * FU_ENGINE_REPLUG_LATENCY_FACTOR,
+					    FU_ENGINE_REPLUG_LATENCY_MIN);
+	}
+
+	/* always wait for the full remove delay; a timeout is not a sample as
+	 * the latency_max would then be the remove delay forever */
+	if (!fu_device_list_wait_for_replug_full (self->device_list, device,
+						  remove_delay, &latency, error)) {
+		g_debug ("%s did not replug after %ums, not recording",
+			 device_id, latency);
+		return FALSE;
+	}
+	if (latency == 0)
+		return TRUE;
+	if (remove_delay_learned > 0 && latency > remove_delay_learned) {
+		g_warning ("%s replugged %u times in at most %ums, but took %ums",
+			   device_id, samples, latency_max, latency);
+	} else if (latency * FU_ENGINE_REPLUG_LATENCY_FACTOR < remove_delay) {
+		g_debug ("%s replugged in %ums but has a remove delay of %ums",
+			 device_id, latency, remove_delay);
+	}
+	fu_engine_add_replug_latency (self, device_id, latency);
+	return TRUE;
+}
+
 /**
  * fu_engine_get_device:
  * @self: A #FuEngine
@@ -2581,12 +3178,12 @@ fu_engine_get_device (FuEngine *self, const gchar *device_id, GError **error)
 	/* wait for device to disconnect and reconnect */
 	root = fu_device_get_root (device1);
 	if (fu_device_has_flag (device1, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG)) {
-		if (!fu_device_list_wait_for_replug (self->device_list, device1, error)) {
+		if (!fu_engine_wait_for_replug (self, device1, error)) {
 			g_prefix_error (error, "failed to wait for detach replug: ");
 			return NULL;
 		}
 	} else if (fu_device_has_flag (root, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG)) {
-		if (!fu_device_list_wait_for_replug (self->device_list, root, error)) {
+		if (!fu_engine_wait_for_replug (self, root, error)) {
 			g_prefix_error (error, "failed to wait for detach replug: ");
 			return NULL;
 		}
@@ -2673,7 +3270,7 @@ fu_engine_update_prepare (FuEngine *self,
 
 	/* wait for device to disconnect and reconnect */
 	if (fu_device_has_flag (device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG)) {
-		if (!fu_device_list_wait_for_replug (self->device_list, device, error)) {
+		if (!fu_engine_wait_for_replug (self, device, error)) {
 			g_prefix_error (error, "failed to wait for prepare replug: ");
 			return FALSE;
 		}
@@ -2707,7 +3304,7 @@ fu_engine_update_cleanup (FuEngine *self,
 
 	/* wait for device to disconnect and reconnect */
 	if (fu_device_has_flag (device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG)) {
-		if (!fu_device_list_wait_for_replug (self->device_list, device, error)) {
+		if (!fu_engine_wait_for_replug (self, device, error)) {
 			g_prefix_error (error, "failed to wait for cleanup replug: ");
 			return FALSE;
 		}
@@ -2925,13 +3522,29 @@ fu_engine_firmware_dump (FuEngine *self,
 	return fu_device_dump_firmware (device, error);
 }
 
-gboolean
-fu_engine_install_blob (FuEngine *self,
-			FuDevice *device,
-			GBytes *blob_fw,
-			FwupdInstallFlags flags,
-			GError **error)
+static void
+fu_engine_add_phase_duration (FuEngine *self,
+			      const gchar *device_id,
+			      const gchar *phase,
+			      gint64 start)
+{
+	g_autoptr(FuDevice) device = NULL;
+	device = fu_device_list_get_by_id (self->device_list, device_id, NULL);
+	if (device == NULL)
+		return;
+	fu_device_add_phase_duration (device, phase,
+				      (g_get_monotonic_time () - start) / 1000);
+}
+
+gboolean
+fu_engine_install_blob (FuEngine *self,
+			FuDevice *device,
+			GBytes *blob_fw,
+			FwupdInstallFlags flags,
+			GError **error)
 {
+	gboolean ret;
+	gint64 start;
 	guint retries = 0;
 	g_autofree gchar *device_id = NULL;
 	g_autoptr(GTimer) timer = g_timer_new ();
@@ -2968,15 +3581,24 @@ fu_engine_install_blob (FuEngine *self,
 			return FALSE;
 
 		/* detach to bootloader mode */
-		if (!fu_engine_update_detach (self, device_id, error))
+		start = g_get_monotonic_time ();
+		ret = fu_engine_update_detach (self, device_id, error);
+		fu_engine_add_phase_duration (self, device_id, "Detach", start);
+		if (!ret)
 			return FALSE;
 
 		/* install */
-		if (!fu_engine_update (self, device_id, blob_fw, flags, error))
+		start = g_get_monotonic_time ();
+		ret = fu_engine_update (self, device_id, blob_fw, flags, error);
+		fu_engine_add_phase_duration (self, device_id, "Write", start);
+		if (!ret)
 			return FALSE;
 
 		/* attach into runtime mode */
-		if (!fu_engine_update_attach (self, device_id, error))
+		start = g_get_monotonic_time ();
+		ret = fu_engine_update_attach (self, device_id, error);
+		fu_engine_add_phase_duration (self, device_id, "Attach", start);
+		if (!ret)
 			return FALSE;
 
 		/* the device and plugin both may have changed */
@@ -2989,7 +3611,10 @@ fu_engine_install_blob (FuEngine *self,
 	} while (TRUE);
 
 	/* get the new version number */
-	if (!fu_engine_update_reload (self, device_id, error))
+	start = g_get_monotonic_time ();
+	ret = fu_engine_update_reload (self, device_id, error);
+	fu_engine_add_phase_duration (self, device_id, "Reload", start);
+	if (!ret)
 		return FALSE;
 
 	/* signal to all the plugins the update has happened */
@@ -3065,6 +3690,7 @@ fu_engine_set_silo (FuEngine *self, XbSilo *silo)
 	g_return_if_fail (FU_IS_ENGINE (self));
 	g_return_if_fail (XB_IS_SILO (silo));
 	g_set_object (&self->silo, silo);
+	fu_engine_releases_cache_invalidate (self);
 }
 
 static gboolean
@@ -3078,41 +3704,136 @@ fu_engine_appstream_upgrade_cb (XbBuilderFixup *self,
 	return TRUE;
 }
 
-static XbBuilderSource *
-fu_engine_create_metadata_builder_source (FuEngine *self,
-					  const gchar *fn,
-					  GError **error)
+static gchar *
+fu_engine_create_metadata_xml (FuEngine *self, const gchar *fn, GError **error)
 {
 	g_autoptr(GBytes) blob = NULL;
 	g_autoptr(XbSilo) silo = NULL;
-	g_autoptr(XbBuilderSource) source = xb_builder_source_new ();
-	g_autofree gchar *xml = NULL;
 
 	g_debug ("building metadata for %s", fn);
 	blob = fu_common_get_contents_bytes (fn, error);
 	if (blob == NULL)
 		return NULL;
 
-	/* convert the silo for the CAB into a XbBuilderSource */
+	/* convert the silo for the CAB into XML */
 	silo = fu_engine_get_silo_from_blob (self, blob, error);
 	if (silo == NULL)
 		return NULL;
-	xml = xb_silo_export (silo, XB_NODE_EXPORT_FLAG_NONE, error);
+	return xb_silo_export (silo, XB_NODE_EXPORT_FLAG_NONE, error);
+}
+
+/* anything that changes when the archive is replaced */
+static gchar *
+fu_engine_create_metadata_cache_key (const gchar *fn, GError **error)
+{
+	g_autoptr(GFile) file = g_file_new_for_path (fn);
+	g_autoptr(GFileInfo) info = NULL;
+
+	info = g_file_query_info (file,
+				  G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+				  G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+				  G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC ","
+				  G_FILE_ATTRIBUTE_UNIX_INODE,
+				  G_FILE_QUERY_INFO_NONE,
+				  NULL, error);
+	if (info == NULL)
+		return NULL;
+	return g_strdup_printf ("%s:%" G_GUINT64_FORMAT ":%" G_GUINT64_FORMAT ".%u:%" G_GUINT64_FORMAT,
+				fn,
+				(guint64) g_file_info_get_size (info),
+				g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED),
+				g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC),
+				g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_UNIX_INODE));
+}
+
+static XbBuilderSource *
+fu_engine_create_metadata_builder_source (FuEngine *self,
+					  const gchar *fn,
+					  const gchar *cachedir,
+					  GHashTable *cache_fns,
+					  GError **error)
+{
+	g_autofree gchar *cache_fn = NULL;
+	g_autofree gchar *cache_id = NULL;
+	g_autofree gchar *key = NULL;
+	g_autofree gchar *xml = NULL;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GFile) file = NULL;
+	g_autoptr(XbBuilderSource) source = xb_builder_source_new ();
+
+	/* the metainfo is only extracted when the archive changes */
+	key = fu_engine_create_metadata_cache_key (fn, error);
+	if (key == NULL)
+		return NULL;
+	cache_id = g_compute_checksum_for_string (G_CHECKSUM_SHA1, key, -1);
+	cache_fn = g_strdup_printf ("%s/%s.xml", cachedir, cache_id);
+	g_hash_table_add (cache_fns, g_strdup (cache_fn));
+	file = g_file_new_for_path (cache_fn);
+	if (g_file_test (cache_fn, G_FILE_TEST_EXISTS)) {
+		g_debug ("using cached metadata for %s", fn);
+		if (xb_builder_source_load_file (source, file,
+						 XB_BUILDER_SOURCE_FLAG_NONE,
+						 NULL, &error_local))
+			return g_steal_pointer (&source);
+
+		/* regenerate it rather than skipping the archive every time */
+		g_warning ("failed to load %s, regenerating: %s",
+			   cache_fn, error_local->message);
+		g_clear_error (&error_local);
+		if (g_unlink (cache_fn) != 0)
+			g_warning ("failed to delete %s", cache_fn);
+		g_object_unref (source);
+		source = xb_builder_source_new ();
+	}
+	xml = fu_engine_create_metadata_xml (self, fn, error);
 	if (xml == NULL)
 		return NULL;
-	if (!xb_builder_source_load_xml (source, xml,
-					 XB_BUILDER_SOURCE_FLAG_NONE,
-					 error))
+	if (!fu_common_mkdir_parent (cache_fn, &error_local) ||
+	    !g_file_set_contents (cache_fn, xml, -1, &error_local)) {
+		g_warning ("failed to save %s: %s", cache_fn, error_local->message);
+		if (!xb_builder_source_load_xml (source, xml,
+						 XB_BUILDER_SOURCE_FLAG_NONE,
+						 error))
+			return NULL;
+		return g_steal_pointer (&source);
+	}
+
+	/* the builder only reads this if the silo has to be recompiled, and
+	 * the filename and mtime are already part of the silo GUID */
+	if (!xb_builder_source_load_file (source, file,
+					  XB_BUILDER_SOURCE_FLAG_NONE,
+					  NULL, error))
 		return NULL;
 	return g_steal_pointer (&source);
 }
 
+/* remove the metainfo of archives that no longer exist */
+static void
+fu_engine_create_metadata_prune (const gchar *cachedir, GHashTable *cache_fns)
+{
+	const gchar *fn;
+	g_autoptr(GDir) dir = g_dir_open (cachedir, 0, NULL);
+	if (dir == NULL)
+		return;
+	while ((fn = g_dir_read_name (dir)) != NULL) {
+		g_autofree gchar *cache_fn = g_build_filename (cachedir, fn, NULL);
+		if (g_hash_table_contains (cache_fns, cache_fn))
+			continue;
+		g_debug ("removing stale %s", cache_fn);
+		if (g_unlink (cache_fn) != 0)
+			g_warning ("failed to delete %s", cache_fn);
+	}
+}
+
 static gboolean
 fu_engine_create_metadata (FuEngine *self, XbBuilder *builder,
 			   FwupdRemote *remote, GError **error)
 {
 	g_autoptr(GPtrArray) files = NULL;
 	const gchar *path;
+	g_autofree gchar *cachedir = NULL;
+	g_autofree gchar *cachedirpkg = NULL;
+	g_autoptr(GHashTable) cache_fns = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
 	/* find all files in directory */
 	path = fwupd_remote_get_filename_cache (remote);
@@ -3120,6 +3841,11 @@ fu_engine_create_metadata (FuEngine *self, XbBuilder *builder,
 	if (files == NULL)
 		return FALSE;
 
+	/* the extracted metainfo for each archive */
+	cachedirpkg = fu_common_get_path (FU_PATH_KIND_CACHEDIR_PKG);
+	cachedir = g_build_filename (cachedirpkg, "metainfo",
+				     fwupd_remote_get_id (remote), NULL);
+
 	/* add each source */
 	for (guint i = 0; i < files->len; i++) {
 		g_autoptr(XbBuilderNode) custom = NULL;
@@ -3135,7 +3861,10 @@ fu_engine_create_metadata (FuEngine *self, XbBuilder *builder,
 		}
 
 		/* build source for file */
-		source = fu_engine_create_metadata_builder_source (self, fn, &error_local);
+		source = fu_engine_create_metadata_builder_source (self, fn,
+								   cachedir,
+								   cache_fns,
+								   &error_local);
 		if (source == NULL) {
 			g_warning ("failed to create builder source: %s",
 				   error_local->message);
@@ -3155,6 +3884,7 @@ fu_engine_create_metadata (FuEngine *self, XbBuilder *builder,
 		xb_builder_source_set_info (source, custom);
 		xb_builder_import_source (builder, source);
 	}
+	fu_engine_create_metadata_prune (cachedir, cache_fns);
 	return TRUE;
 }
 
@@ -3468,6 +4198,7 @@ fu_engine_load_metadata_store (FuEngine *self, FuEngineLoadFlags flags, GError *
 	cachedirpkg = fu_common_get_path (FU_PATH_KIND_CACHEDIR_PKG);
 	xmlbfn = g_build_filename (cachedirpkg, "metadata.xmlb", NULL);
 	xmlb = g_file_new_for_path (xmlbfn);
+	fu_engine_releases_cache_invalidate (self);
 	self->silo = xb_builder_ensure (builder, xmlb, compile_flags, NULL, error);
 	if (self->silo == NULL)
 		return FALSE;
@@ -3497,10 +4228,97 @@ fu_engine_load_metadata_store (FuEngine *self, FuEngineLoadFlags flags, GError *
 	return TRUE;
 }
 
+static void
+fu_engine_history_prune (FuEngine *self)
+{
+	guint64 max_age = (guint64) fu_config_get_history_max_age (self->config) * 24 * 60 * 60;
+	g_autoptr(GError) error_local = NULL;
+	if (!fu_history_prune (self->history,
+			       max_age,
+			       fu_config_get_history_max_entries (self->config),
+			       &error_local))
+		g_warning ("failed to prune history: %s", error_local->message);
+}
+
 static void
 fu_engine_config_changed_cb (FuConfig *config, FuEngine *self)
 {
 	fu_idle_set_timeout (self->idle, fu_config_get_idle_timeout (config));
+	fu_engine_history_prune (self);
+
+	/* the disabled plugins are included in the HSI */
+	fu_engine_invalidate_host_security_id (self);
+
+	/* some values are exported as daemon properties */
+	g_signal_emit (self, signals[SIGNAL_CONFIG_CHANGED], 0);
+}
+
+static void
+fu_engine_keyring_monitor_changed_cb (GFileMonitor *monitor,
+				      GFile *file,
+				      GFile *other_file,
+				      GFileMonitorEvent event_type,
+				      gpointer user_data);
+
+/* any change to the trusted keys means the cached results are invalid */
+static void
+fu_engine_keyring_monitor_add (FuEngine *self, const gchar *path)
+{
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GFile) file = g_file_new_for_path (path);
+	g_autoptr(GFileMonitor) monitor = NULL;
+
+	monitor = g_file_monitor_directory (file, G_FILE_MONITOR_NONE, NULL, &error_local);
+	if (monitor == NULL) {
+		g_debug ("failed to monitor %s: %s", path, error_local->message);
+		return;
+	}
+	g_signal_connect (monitor, "changed",
+			  G_CALLBACK (fu_engine_keyring_monitor_changed_cb), self);
+	g_ptr_array_add (self->keyring_monitors, g_steal_pointer (&monitor));
+}
+
+/* the Jcat engines load the keys when first used, so a new context is
+ * required to see any keys that were added or removed */
+static void
+fu_engine_load_jcat_context (FuEngine *self)
+{
+	g_autofree gchar *keyring_path = NULL;
+	g_autofree gchar *pkidir_fw = NULL;
+	g_autofree gchar *pkidir_md = NULL;
+	g_autofree gchar *sysconfdir = NULL;
+
+	if (self->jcat_context != NULL)
+		g_object_unref (self->jcat_context);
+	self->jcat_context = jcat_context_new ();
+	keyring_path = fu_common_get_path (FU_PATH_KIND_LOCALSTATEDIR_PKG);
+	jcat_context_set_keyring_path (self->jcat_context, keyring_path);
+	sysconfdir = fu_common_get_path (FU_PATH_KIND_SYSCONFDIR);
+	pkidir_fw = g_build_filename (sysconfdir, "pki", "fwupd", NULL);
+	jcat_context_add_public_keys (self->jcat_context, pkidir_fw);
+	pkidir_md = g_build_filename (sysconfdir, "pki", "fwupd-metadata", NULL);
+	jcat_context_add_public_keys (self->jcat_context, pkidir_md);
+
+	/* only the key sources are watched, as gpg writes to the keyring in
+	 * localstatedir every time it verifies a signature */
+	if (self->keyring_monitors->len == 0) {
+		fu_engine_keyring_monitor_add (self, pkidir_fw);
+		fu_engine_keyring_monitor_add (self, pkidir_md);
+	}
+}
+
+static void
+fu_engine_keyring_monitor_changed_cb (GFileMonitor *monitor,
+				      GFile *file,
+				      GFile *other_file,
+				      GFileMonitorEvent event_type,
+				      gpointer user_data)
+{
+	FuEngine *self = FU_ENGINE (user_data);
+	g_autofree gchar *fn = g_file_get_path (file);
+	g_debug ("%s changed, reloading keys and invalidating signature results", fn);
+	fu_engine_load_jcat_context (self);
+	fu_verify_cache_invalidate (self->verify_cache);
 }
 
 static void
@@ -3515,9 +4333,6 @@ fu_engine_remote_list_changed_cb (FuRemoteList *remote_list, FuEngine *self)
 	/* set device properties from the metadata */
 	fu_engine_md_refresh_devices (self);
 
-	/* invalidate host security attributes */
-	g_clear_pointer (&self->host_security_id, g_free);
-
 	/* make the UI update */
 	fu_engine_emit_changed (self);
 }
@@ -3588,11 +4403,12 @@ fu_engine_get_system_jcat_result (FuEngine *self, FwupdRemote *remote, GError **
 	jcat_item = jcat_file_get_item_default (jcat_file, error);
 	if (jcat_item == NULL)
 		return NULL;
-	results = jcat_context_verify_item (self->jcat_context,
-					    blob, jcat_item,
-					    JCAT_VERIFY_FLAG_REQUIRE_CHECKSUM |
-					    JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE,
-					    error);
+	results = fu_verify_cache_verify_item (self->verify_cache,
+					       self->jcat_context,
+					       blob, jcat_item,
+					       JCAT_VERIFY_FLAG_REQUIRE_CHECKSUM |
+					       JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE,
+					       error);
 	if (results == NULL)
 		return NULL;
 
@@ -3715,9 +4531,10 @@ fu_engine_update_metadata_bytes (FuEngine *self, const gchar *remote_id,
 		jcat_item = jcat_file_get_item_default (jcat_file, error);
 		if (jcat_item == NULL)
 			return FALSE;
-		results = jcat_context_verify_item (self->jcat_context,
-						    bytes_raw, jcat_item,
-						    jcat_flags, error);
+		results = fu_verify_cache_verify_item (self->verify_cache,
+						       self->jcat_context,
+						       bytes_raw, jcat_item,
+						       jcat_flags, error);
 		if (results == NULL)
 			return FALSE;
 
@@ -3762,9 +4579,6 @@ fu_engine_update_metadata_bytes (FuEngine *self, const gchar *remote_id,
 	/* refresh SUPPORTED flag on devices */
 	fu_engine_md_refresh_devices (self);
 
-	/* invalidate host security attributes */
-	g_clear_pointer (&self->host_security_id, g_free);
-
 	/* make the UI update */
 	fu_engine_emit_changed (self);
 	return TRUE;
@@ -3851,6 +4665,7 @@ fu_engine_get_silo_from_blob (FuEngine *self, GBytes *blob_cab, GError **error)
 	fu_engine_set_status (self, FWUPD_STATUS_DECOMPRESSING);
 	fu_cabinet_set_size_max (cabinet, fu_engine_get_archive_size_max (self));
 	fu_cabinet_set_jcat_context (cabinet, self->jcat_context);
+	fu_cabinet_set_verify_cache (cabinet, self->verify_cache);
 	if (!fu_cabinet_parse (cabinet, blob_cab, FU_CABINET_PARSE_FLAG_NONE, error))
 		return NULL;
 	silo = fu_cabinet_get_silo (cabinet);
@@ -4152,6 +4967,212 @@ fu_engine_get_devices (FuEngine *self, GError **error)
 	return g_steal_pointer (&devices);
 }
 
+static GPtrArray *
+fu_engine_snapshot_devices_new (GPtrArray *devices, FwupdDeviceFlags flags)
+{
+	GPtrArray *snapshot = g_ptr_array_new_with_free_func ((GDestroyNotify) g_variant_unref);
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *device = g_ptr_array_index (devices, i);
+		GVariant *val = fwupd_device_to_variant_full (FWUPD_DEVICE (device), flags);
+		g_ptr_array_add (snapshot, g_variant_ref_sink (val));
+	}
+	return snapshot;
+}
+
+static gboolean
+fu_engine_snapshot_cb (gpointer user_data)
+{
+	FuEngine *self = FU_ENGINE (user_data);
+	GPtrArray *remotes = fu_remote_list_get_all (self->remote_list);
+	g_autoptr(GMutexLocker) locker = NULL;
+	g_autoptr(GPtrArray) devices = fu_device_list_get_active (self->device_list);
+	g_autoptr(GPtrArray) snapshot_devices = NULL;
+	g_autoptr(GPtrArray) snapshot_devices_trusted = NULL;
+	g_autoptr(GPtrArray) snapshot_remotes = NULL;
+
+	/* build the new snapshots without holding the lock */
+	g_ptr_array_sort (devices, fu_engine_sort_devices_by_priority_name);
+	snapshot_devices = fu_engine_snapshot_devices_new (devices, FWUPD_DEVICE_FLAG_NONE);
+	snapshot_devices_trusted = fu_engine_snapshot_devices_new (devices, FWUPD_DEVICE_FLAG_TRUSTED);
+	snapshot_remotes = g_ptr_array_new_with_free_func ((GDestroyNotify) g_variant_unref);
+	for (guint i = 0; i < remotes->len; i++) {
+		FwupdRemote *remote = g_ptr_array_index (remotes, i);
+		GVariant *val = fwupd_remote_to_variant (remote);
+		g_ptr_array_add (snapshot_remotes, g_variant_ref_sink (val));
+	}
+
+	/* publish */
+	locker = g_mutex_locker_new (&self->snapshot_mutex);
+	g_clear_pointer (&self->snapshot_devices, g_ptr_array_unref);
+	g_clear_pointer (&self->snapshot_devices_trusted, g_ptr_array_unref);
+	g_clear_pointer (&self->snapshot_remotes, g_ptr_array_unref);
+	self->snapshot_devices = g_steal_pointer (&snapshot_devices);
+	self->snapshot_devices_trusted = g_steal_pointer (&snapshot_devices_trusted);
+	self->snapshot_remotes = g_steal_pointer (&snapshot_remotes);
+	self->snapshot_id = 0;
+	self->snapshot_delayed = FALSE;
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * fu_engine_get_devices_snapshot:
+ * @self: A #FuEngine
+ * @flags: #FwupdDeviceFlags, e.g. %FWUPD_DEVICE_FLAG_TRUSTED
+ *
+ * Gets the serialized active devices, in the same order as
+ * fu_engine_get_devices(). The array is never modified once published and
+ * so this can be called from any thread.
+ *
+ * Returns: (transfer full) (element-type GVariant): devices, or %NULL if
+ * the device list has changed and the snapshot has not been rebuilt
+ **/
+GPtrArray *
+fu_engine_get_devices_snapshot (FuEngine *self, FwupdDeviceFlags flags)
+{
+	GPtrArray *snapshot;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->snapshot_mutex);
+	snapshot = (flags & FWUPD_DEVICE_FLAG_TRUSTED) > 0 ?
+			self->snapshot_devices_trusted : self->snapshot_devices;
+	if (snapshot == NULL)
+		return NULL;
+	return g_ptr_array_ref (snapshot);
+}
+
+/**
+ * fu_engine_get_remotes_snapshot:
+ * @self: A #FuEngine
+ *
+ * Gets the serialized remotes. This can be called from any thread.
+ *
+ * Returns: (transfer full) (element-type GVariant): remotes, or %NULL
+ **/
+GPtrArray *
+fu_engine_get_remotes_snapshot (FuEngine *self)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->snapshot_mutex);
+	if (self->snapshot_remotes == NULL)
+		return NULL;
+	return g_ptr_array_ref (self->snapshot_remotes);
+}
+
+/**
+ * fu_engine_get_host_security_attrs_snapshot:
+ * @self: A #FuEngine
+ *
+ * Gets the serialized host security attributes. This can be called from any
+ * thread.
+ *
+ * Returns: (transfer full) (element-type GVariant): attributes, or %NULL if
+ * they have not been calculated since they were last invalidated
+ **/
+GPtrArray *
+fu_engine_get_host_security_attrs_snapshot (FuEngine *self)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->snapshot_mutex);
+	if (self->snapshot_security_attrs == NULL)
+		return NULL;
+	return g_ptr_array_ref (self->snapshot_security_attrs);
+}
+
+/**
+ * fu_engine_get_generation:
+ * @self: A #FuEngine
+ *
+ * Gets the current device generation, which is incremented every time a
+ * device is added, removed or changed, ignoring the status and progress.
+ *
+ * The counter is seeded from the wall clock when the engine is created so
+ * that values from a previous daemon instance are always lower.
+ *
+ * Returns: integer
+ **/
+guint64
+fu_engine_get_generation (FuEngine *self)
+{
+	g_return_val_if_fail (FU_IS_ENGINE (self), 0);
+	return self->generation;
+}
+
+/**
+ * fu_engine_get_devices_since:
+ * @self: A #FuEngine
+ * @generation: A generation returned by fu_engine_get_generation(), or 0
+ * @removed_ids: (out) (transfer container) (element-type utf8): removed device IDs
+ * @error: A #GError, or %NULL
+ *
+ * Gets the devices that have been added or changed since @generation, and
+ * the IDs of the devices that have been removed since then.
+ *
+ * If @generation is 0 or is from the future, e.g. from a previous daemon
+ * instance, then all the active devices are returned.
+ *
+ * Changes to the transient status and progress are only sent using
+ * signals. Only a limited number of removals is remembered, and none from
+ * a previous daemon instance, and so if @generation is older than the
+ * oldest one an error is returned and the caller should use 0.
+ *
+ * Returns: (transfer container) (element-type FuDevice): devices, which may be empty
+ **/
+GPtrArray *
+fu_engine_get_devices_since (FuEngine *self,
+			     guint64 generation,
+			     GPtrArray **removed_ids,
+			     GError **error)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GPtrArray) devices_tmp = NULL;
+	g_autoptr(GPtrArray) removed = g_ptr_array_new_with_free_func (g_free);
+
+	g_return_val_if_fail (FU_IS_ENGINE (self), NULL);
+	g_return_val_if_fail (removed_ids != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* full resync */
+	if (generation > self->generation)
+		generation = 0;
+
+	/* we no longer know what was removed */
+	if (generation > 0 && generation < self->removed_generation_min) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_FOUND,
+			     "generation %" G_GUINT64_FORMAT " is too old, use 0",
+			     generation);
+		return NULL;
+	}
+
+	/* added or changed */
+	devices_tmp = fu_device_list_get_active (self->device_list);
+	devices = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	for (guint i = 0; i < devices_tmp->len; i++) {
+		FuDevice *device = g_ptr_array_index (devices_tmp, i);
+		guint64 *generation_tmp;
+		generation_tmp = g_hash_table_lookup (self->device_generations,
+						      fu_device_get_id (device));
+		if (generation_tmp != NULL && *generation_tmp <= generation)
+			continue;
+		g_ptr_array_add (devices, g_object_ref (device));
+	}
+	g_ptr_array_sort (devices, fu_engine_sort_devices_by_priority_name);
+
+	/* removed */
+	if (generation > 0) {
+		g_hash_table_iter_init (&iter, self->removed_generations);
+		while (g_hash_table_iter_next (&iter, &key, &value)) {
+			guint64 *generation_tmp = (guint64 *) value;
+			if (*generation_tmp > generation)
+				g_ptr_array_add (removed, g_strdup (key));
+		}
+	}
+
+	/* success */
+	*removed_ids = g_steal_pointer (&removed);
+	return g_steal_pointer (&devices);
+}
+
 /**
  * fu_engine_get_devices_by_guid:
  * @self: A #FuEngine
@@ -4212,32 +5233,46 @@ fu_engine_get_history_set_hsi_attrs (FuEngine *self, FuDevice *device)
 }
 
 /**
- * fu_engine_get_history:
+ * fu_engine_get_history_full:
  * @self: A #FuEngine
+ * @device_id: (nullable): A device ID to match, or %NULL for any
+ * @update_state: A #FwupdUpdateState to match, or %FWUPD_UPDATE_STATE_UNKNOWN for any
+ * @modified_min: The earliest modification time to include, or 0
+ * @modified_max: The latest modification time to include, or 0
+ * @offset: The number of matching entries to skip
+ * @limit: The maximum number of entries to return, or 0 for no limit
  * @error: A #GError, or %NULL
  *
- * Gets the list of history.
+ * Gets a filtered page of the history. Unlike fu_engine_get_history() an
+ * empty page is not considered an error.
  *
  * Returns: (transfer container) (element-type FwupdDevice): results
  **/
 GPtrArray *
-fu_engine_get_history (FuEngine *self, GError **error)
+fu_engine_get_history_full (FuEngine *self,
+			    const gchar *device_id,
+			    FwupdUpdateState update_state,
+			    guint64 modified_min,
+			    guint64 modified_max,
+			    guint offset,
+			    guint limit,
+			    GError **error)
 {
 	g_autoptr(GPtrArray) devices = NULL;
 
 	g_return_val_if_fail (FU_IS_ENGINE (self), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	devices = fu_history_get_devices (self->history, error);
+	devices = fu_history_get_devices_full (self->history,
+					       device_id,
+					       update_state,
+					       modified_min,
+					       modified_max,
+					       offset,
+					       limit,
+					       error);
 	if (devices == NULL)
 		return NULL;
-	if (devices->len == 0) {
-		g_set_error_literal (error,
-				     FWUPD_ERROR,
-				     FWUPD_ERROR_NOTHING_TO_DO,
-				     "No history");
-		return NULL;
-	}
 
 	/* if this is the system firmware device, add the HSI attrs */
 	for (guint i = 0; i < devices->len; i++) {
@@ -4273,6 +5308,38 @@ fu_engine_get_history (FuEngine *self, GError **error)
 	return g_steal_pointer (&devices);
 }
 
+/**
+ * fu_engine_get_history:
+ * @self: A #FuEngine
+ * @error: A #GError, or %NULL
+ *
+ * Gets the list of history.
+ *
+ * Returns: (transfer container) (element-type FwupdDevice): results
+ **/
+GPtrArray *
+fu_engine_get_history (FuEngine *self, GError **error)
+{
+	g_autoptr(GPtrArray) devices = NULL;
+
+	g_return_val_if_fail (FU_IS_ENGINE (self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	devices = fu_engine_get_history_full (self, NULL,
+					      FWUPD_UPDATE_STATE_UNKNOWN,
+					      0, 0, 0, 0, error);
+	if (devices == NULL)
+		return NULL;
+	if (devices->len == 0) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_NOTHING_TO_DO,
+				     "No history");
+		return NULL;
+	}
+	return g_steal_pointer (&devices);
+}
+
 #if !GLIB_CHECK_VERSION(2,62,0)
 static GPtrArray *
 g_ptr_array_copy (GPtrArray *array, GCopyFunc func, gpointer user_data)
@@ -4349,22 +5416,41 @@ fu_engine_get_remote_by_id (FuEngine *self, const gchar *remote_id, GError **err
 
 
 static gint
-fu_engine_sort_releases_cb (gconstpointer a, gconstpointer b, gpointer user_data)
+fu_engine_sort_releases_cb (gconstpointer a, gconstpointer b)
 {
-	FuDevice *device = FU_DEVICE (user_data);
-	FwupdRelease *rel_a = FWUPD_RELEASE (*((FwupdRelease **) a));
-	FwupdRelease *rel_b = FWUPD_RELEASE (*((FwupdRelease **) b));
+	const FuEngineSortItem *item_a = (const FuEngineSortItem *) a;
+	const FuEngineSortItem *item_b = (const FuEngineSortItem *) b;
 	gint rc;
 
 	/* first by branch */
-	rc = g_strcmp0 (fwupd_release_get_branch (rel_b), fwupd_release_get_branch (rel_a));
+	rc = g_strcmp0 (fwupd_release_get_branch (FWUPD_RELEASE (item_b->data)),
+			fwupd_release_get_branch (FWUPD_RELEASE (item_a->data)));
 	if (rc != 0)
 		return rc;
 
 	/* then by version */
-	return fu_common_vercmp_full (fwupd_release_get_version (rel_b),
-				      fwupd_release_get_version (rel_a),
-				      fu_device_get_version_format (device));
+	return fu_common_version_key_compare (item_b->key, item_a->key);
+}
+
+/* parse each version once rather than for every comparison */
+static void
+fu_engine_sort_releases_for_device (FuDevice *device, GPtrArray *releases)
+{
+	FwupdVersionFormat fmt = fu_device_get_version_format (device);
+	g_autoptr(FuEngineSortItems) items = NULL;
+
+	items = g_array_sized_new (FALSE, FALSE, sizeof(FuEngineSortItem), releases->len);
+	for (guint i = 0; i < releases->len; i++) {
+		FwupdRelease *rel = g_ptr_array_index (releases, i);
+		FuEngineSortItem item = {
+			.data = rel,
+			.key = fu_common_version_key_new (fwupd_release_get_version (rel), fmt),
+		};
+		g_array_append_val (items, item);
+	}
+	g_array_sort (items, fu_engine_sort_releases_cb);
+	for (guint i = 0; i < items->len; i++)
+		releases->pdata[i] = g_array_index (items, FuEngineSortItem, i).data;
 }
 
 static gboolean
@@ -4406,6 +5492,8 @@ fu_engine_add_releases_for_device_component (FuEngine *self,
 {
 	FwupdFeatureFlags feature_flags;
 	FwupdVersionFormat fmt = fu_device_get_version_format (device);
+	g_autoptr(FuVersionKey) key_device = NULL;
+	g_autoptr(FuVersionKey) key_lowest = NULL;
 	g_autoptr(GError) error_local = NULL;
 	g_autoptr(FuInstallTask) task = fu_install_task_new (device, component);
 	g_autoptr(GPtrArray) releases_tmp = NULL;
@@ -4430,6 +5518,9 @@ fu_engine_add_releases_for_device_component (FuEngine *self,
 		return FALSE;
 	}
 	feature_flags = fu_engine_request_get_feature_flags (request);
+	key_device = fu_common_version_key_new (fu_device_get_version (device), fmt);
+	if (fu_device_get_version_lowest (device) != NULL)
+		key_lowest = fu_common_version_key_new (fu_device_get_version_lowest (device), fmt);
 	for (guint i = 0; i < releases_tmp->len; i++) {
 		XbNode *release = g_ptr_array_index (releases_tmp, i);
 		const gchar *remote_id;
@@ -4438,6 +5529,7 @@ fu_engine_add_releases_for_device_component (FuEngine *self,
 		gint vercmp;
 		GPtrArray *checksums;
 		GPtrArray *locations;
+		g_autoptr(FuVersionKey) key_rel = NULL;
 		g_autoptr(FwupdRelease) rel = fwupd_release_new ();
 		g_autoptr(GError) error_loop = NULL;
 
@@ -4478,19 +5570,16 @@ fu_engine_add_releases_for_device_component (FuEngine *self,
 		}
 
 		/* test for upgrade or downgrade */
-		vercmp = fu_common_vercmp_full (fwupd_release_get_version (rel),
-						fu_device_get_version (device),
-						fmt);
+		key_rel = fu_common_version_key_new (fwupd_release_get_version (rel), fmt);
+		vercmp = fu_common_version_key_compare (key_rel, key_device);
 		if (vercmp > 0)
 			fwupd_release_add_flag (rel, FWUPD_RELEASE_FLAG_IS_UPGRADE);
 		else if (vercmp < 0)
 			fwupd_release_add_flag (rel, FWUPD_RELEASE_FLAG_IS_DOWNGRADE);
 
 		/* lower than allowed to downgrade to */
-		if (fu_device_get_version_lowest (device) != NULL &&
-		    fu_common_vercmp_full (fwupd_release_get_version (rel),
-					   fu_device_get_version_lowest (device),
-					   fmt) < 0) {
+		if (key_lowest != NULL &&
+		    fu_common_version_key_compare (key_rel, key_lowest) < 0) {
 			fwupd_release_add_flag (rel, FWUPD_RELEASE_FLAG_BLOCKED_VERSION);
 		}
 
@@ -4509,47 +5598,150 @@ fu_engine_add_releases_for_device_component (FuEngine *self,
 			}
 		}
 
-		/* add update message if exists but device doesn't already have one */
-		update_message = fwupd_release_get_update_message (rel);
-		if (fwupd_device_get_update_message (FWUPD_DEVICE (device)) == NULL &&
-		    update_message != NULL) {
-			fwupd_device_set_update_message (FWUPD_DEVICE (device), update_message);
+		/* add update message if exists but device doesn't already have one */
+		update_message = fwupd_release_get_update_message (rel);
+		if (fwupd_device_get_update_message (FWUPD_DEVICE (device)) == NULL &&
+		    update_message != NULL) {
+			fwupd_device_set_update_message (FWUPD_DEVICE (device), update_message);
+		}
+		update_image = fwupd_release_get_update_image (rel);
+		if (fwupd_device_get_update_image (FWUPD_DEVICE (device)) == NULL &&
+		    update_image != NULL) {
+			fwupd_device_set_update_image (FWUPD_DEVICE (device), update_image);
+		}
+		/* success */
+		g_ptr_array_add (releases, g_steal_pointer (&rel));
+	}
+
+	/* success */
+	return TRUE;
+}
+
+static const gchar *
+fu_engine_get_branch_fallback (const gchar *nullable_branch)
+{
+	if (nullable_branch == NULL)
+		return "default";
+	return nullable_branch;
+}
+
+/* returns a hash of flashed GUID:GPtrArray of XbNode components */
+static GHashTable *
+fu_engine_get_components_by_guid (FuEngine *self, GError **error)
+{
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GHashTable) hash = NULL;
+	g_autoptr(GPtrArray) components = NULL;
+
+	hash = g_hash_table_new_full (g_str_hash, g_str_equal,
+				      g_free, (GDestroyNotify) g_ptr_array_unref);
+	components = xb_silo_query (self->silo,
+				    "components/component[@type='firmware']",
+				    0, &error_local);
+	if (components == NULL) {
+		if (g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
+		    g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
+			return g_steal_pointer (&hash);
+		g_propagate_error (error, g_steal_pointer (&error_local));
+		return NULL;
+	}
+	for (guint i = 0; i < components->len; i++) {
+		XbNode *component = g_ptr_array_index (components, i);
+		g_autoptr(GPtrArray) provides = NULL;
+		provides = xb_node_query (component,
+					  "provides/firmware[@type=$'flashed']",
+					  0, NULL);
+		if (provides == NULL)
+			continue;
+		for (guint j = 0; j < provides->len; j++) {
+			XbNode *provide = g_ptr_array_index (provides, j);
+			const gchar *guid = xb_node_get_text (provide);
+			GPtrArray *components_tmp;
+			if (guid == NULL)
+				continue;
+			components_tmp = g_hash_table_lookup (hash, guid);
+			if (components_tmp == NULL) {
+				components_tmp = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+				g_hash_table_insert (hash, g_strdup (guid), components_tmp);
+			}
+			if (!g_ptr_array_find (components_tmp, component, NULL))
+				g_ptr_array_add (components_tmp, g_object_ref (component));
+		}
+	}
+	return g_steal_pointer (&hash);
+}
+
+static GPtrArray *
+fu_engine_get_components_for_device (FuEngine *self,
+				     FuDevice *device,
+				     GHashTable *components_by_guid,
+				     GError **error)
+{
+	GPtrArray *device_guids = fu_device_get_guids (device);
+	g_autoptr(GPtrArray) components = NULL;
+
+	/* use the prebuilt index */
+	if (components_by_guid != NULL) {
+		components = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+		for (guint i = 0; i < device_guids->len; i++) {
+			const gchar *guid = g_ptr_array_index (device_guids, i);
+			GPtrArray *components_tmp = g_hash_table_lookup (components_by_guid, guid);
+			if (components_tmp == NULL)
+				continue;
+			for (guint j = 0; j < components_tmp->len; j++) {
+				XbNode *component = g_ptr_array_index (components_tmp, j);
+				if (!g_ptr_array_find (components, component, NULL))
+					g_ptr_array_add (components, g_object_ref (component));
+			}
+		}
+		if (components->len == 0) {
+			g_set_error_literal (error,
+					     FWUPD_ERROR,
+					     FWUPD_ERROR_NOTHING_TO_DO,
+					     "No releases found");
+			return NULL;
+		}
+	} else {
+		g_autoptr(GError) error_local = NULL;
+		g_autoptr(GString) xpath = g_string_new (NULL);
+
+		/* get all the components that provide any of these GUIDs */
+		for (guint i = 0; i < device_guids->len; i++) {
+			const gchar *guid = g_ptr_array_index (device_guids, i);
+			xb_string_append_union (xpath,
+						"components/component[@type='firmware']/"
+						"provides/firmware[@type=$'flashed'][text()=$'%s']/"
+						"../..", guid);
 		}
-		update_image = fwupd_release_get_update_image (rel);
-		if (fwupd_device_get_update_image (FWUPD_DEVICE (device)) == NULL &&
-		    update_image != NULL) {
-			fwupd_device_set_update_image (FWUPD_DEVICE (device), update_image);
+		components = xb_silo_query (self->silo, xpath->str, 0, &error_local);
+		if (components == NULL) {
+			if (g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
+			    g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT)) {
+				g_set_error_literal (error,
+						     FWUPD_ERROR,
+						     FWUPD_ERROR_NOTHING_TO_DO,
+						     "No releases found");
+				return NULL;
+			}
+			g_propagate_error (error, g_steal_pointer (&error_local));
+			return NULL;
 		}
-		/* success */
-		g_ptr_array_add (releases, g_steal_pointer (&rel));
 	}
-
-	/* success */
-	return TRUE;
-}
-
-static const gchar *
-fu_engine_get_branch_fallback (const gchar *nullable_branch)
-{
-	if (nullable_branch == NULL)
-		return "default";
-	return nullable_branch;
+	return g_steal_pointer (&components);
 }
 
-GPtrArray *
-fu_engine_get_releases_for_device (FuEngine *self,
-				   FuEngineRequest *request,
-				   FuDevice *device,
-				   GError **error)
+static GPtrArray *
+fu_engine_get_releases_for_device_full (FuEngine *self,
+					FuEngineRequest *request,
+					FuDevice *device,
+					GHashTable *components_by_guid,
+					GError **error)
 {
-	GPtrArray *device_guids;
 	GPtrArray *releases;
 	const gchar *version;
 	g_autoptr(GError) error_all = NULL;
-	g_autoptr(GError) error_local = NULL;
 	g_autoptr(GPtrArray) branches = NULL;
 	g_autoptr(GPtrArray) components = NULL;
-	g_autoptr(GString) xpath = g_string_new (NULL);
 
 	/* get device version */
 	version = fu_device_get_version (device);
@@ -4571,27 +5763,11 @@ fu_engine_get_releases_for_device (FuEngine *self,
 	}
 
 	/* get all the components that provide any of these GUIDs */
-	device_guids = fu_device_get_guids (device);
-	for (guint i = 0; i < device_guids->len; i++) {
-		const gchar *guid = g_ptr_array_index (device_guids, i);
-		xb_string_append_union (xpath,
-					"components/component[@type='firmware']/"
-					"provides/firmware[@type=$'flashed'][text()=$'%s']/"
-					"../..", guid);
-	}
-	components = xb_silo_query (self->silo, xpath->str, 0, &error_local);
-	if (components == NULL) {
-		if (g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
-		    g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT)) {
-			g_set_error_literal (error,
-					     FWUPD_ERROR,
-					     FWUPD_ERROR_NOTHING_TO_DO,
-					     "No releases found");
-			return NULL;
-		}
-		g_propagate_error (error, g_steal_pointer (&error_local));
+	components = fu_engine_get_components_for_device (self, device,
+							  components_by_guid,
+							  error);
+	if (components == NULL)
 		return NULL;
-	}
 
 	/* find all the releases that pass all the requirements */
 	releases = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
@@ -4647,6 +5823,106 @@ fu_engine_get_releases_for_device (FuEngine *self,
 	return releases;
 }
 
+/* requirements can refer to other devices, so any device change invalidates */
+static guint64
+fu_engine_device_get_generation (FuEngine *self, FuDevice *device)
+{
+	guint64 *generation;
+	if (fu_device_get_id (device) == NULL)
+		return 0;
+	generation = g_hash_table_lookup (self->device_generations, fu_device_get_id (device));
+	return generation != NULL ? *generation : 0;
+}
+
+/* the requirements can also use the parents and children; devices matched
+ * by GUID only change the result when added or removed, which invalidates
+ * the entire cache */
+static gchar *
+fu_engine_releases_cache_key (FuEngine *self, FuDevice *device)
+{
+	GPtrArray *children = fu_device_get_children (device);
+	GString *str = g_string_new (NULL);
+
+	for (FuDevice *device_tmp = device;
+	     device_tmp != NULL;
+	     device_tmp = fu_device_get_parent (device_tmp)) {
+		g_string_append_printf (str, "%" G_GUINT64_FORMAT ":",
+					fu_engine_device_get_generation (self, device_tmp));
+	}
+	for (guint i = 0; i < children->len; i++) {
+		FuDevice *child = g_ptr_array_index (children, i);
+		g_string_append_printf (str, "%" G_GUINT64_FORMAT ":",
+					fu_engine_device_get_generation (self, child));
+	}
+	return g_string_free (str, FALSE);
+}
+
+/* callers modify the releases, so never hand out the cached objects */
+static GPtrArray *
+fu_engine_releases_copy (GPtrArray *releases)
+{
+	GPtrArray *releases_copy = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	for (guint i = 0; i < releases->len; i++) {
+		FwupdRelease *rel = g_ptr_array_index (releases, i);
+		FwupdRelease *rel_copy = fwupd_release_new ();
+		fwupd_release_incorporate (rel_copy, rel);
+		g_ptr_array_add (releases_copy, rel_copy);
+	}
+	return releases_copy;
+}
+
+static GPtrArray *
+fu_engine_get_releases_for_device_cached (FuEngine *self,
+					  FuEngineRequest *request,
+					  FuDevice *device,
+					  GHashTable *components_by_guid,
+					  GError **error)
+{
+	FuEngineReleasesItem *item;
+	GPtrArray *releases;
+	g_autofree gchar *key = fu_engine_releases_cache_key (self, device);
+	g_autofree gchar *id = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	/* already computed with the same inputs */
+	id = g_strdup_printf ("%s:%" G_GUINT64_FORMAT,
+			      fu_device_get_id (device),
+			      fu_engine_request_get_feature_flags (request));
+	item = g_hash_table_lookup (self->releases_cache, id);
+	if (item != NULL && g_strcmp0 (item->key, key) == 0) {
+		if (item->releases == NULL) {
+			g_propagate_error (error, g_error_copy (item->error));
+			return NULL;
+		}
+		return fu_engine_releases_copy (item->releases);
+	}
+
+	/* compute and save both success and failure */
+	item = g_new0 (FuEngineReleasesItem, 1);
+	item->key = g_steal_pointer (&key);
+	releases = fu_engine_get_releases_for_device_full (self, request, device,
+							   components_by_guid,
+							   &error_local);
+	if (releases == NULL) {
+		item->error = g_error_copy (error_local);
+		g_hash_table_insert (self->releases_cache, g_steal_pointer (&id), item);
+		g_propagate_error (error, g_steal_pointer (&error_local));
+		return NULL;
+	}
+	item->releases = fu_engine_releases_copy (releases);
+	g_hash_table_insert (self->releases_cache, g_steal_pointer (&id), item);
+	return releases;
+}
+
+GPtrArray *
+fu_engine_get_releases_for_device (FuEngine *self,
+				   FuEngineRequest *request,
+				   FuDevice *device,
+				   GError **error)
+{
+	return fu_engine_get_releases_for_device_cached (self, request, device, NULL, error);
+}
+
 /**
  * fu_engine_get_releases:
  * @self: A #FuEngine
@@ -4687,7 +5963,7 @@ fu_engine_get_releases (FuEngine *self,
 				     "No releases for device");
 		return NULL;
 	}
-	g_ptr_array_sort_with_data (releases, fu_engine_sort_releases_cb, device);
+	fu_engine_sort_releases_for_device (device, releases);
 	return g_steal_pointer (&releases);
 }
 
@@ -4791,7 +6067,7 @@ fu_engine_get_downgrades (FuEngine *self,
 		}
 		return NULL;
 	}
-	g_ptr_array_sort_with_data (releases, fu_engine_sort_releases_cb, device);
+	fu_engine_sort_releases_for_device (device, releases);
 	return g_steal_pointer (&releases);
 }
 
@@ -4819,6 +6095,7 @@ fu_engine_add_approved_firmware (FuEngine *self, const gchar *checksum)
 								 NULL);
 	}
 	g_hash_table_add (self->approved_firmware, g_strdup (checksum));
+	fu_engine_releases_cache_invalidate (self);
 }
 
 GPtrArray *
@@ -4845,6 +6122,7 @@ fu_engine_add_blocked_firmware (FuEngine *self, const gchar *checksum)
 								NULL);
 	}
 	g_hash_table_add (self->blocked_firmware, g_strdup (checksum));
+	fu_engine_releases_cache_invalidate (self);
 }
 
 gboolean
@@ -4855,6 +6133,7 @@ fu_engine_set_blocked_firmware (FuEngine *self, GPtrArray *checksums, GError **e
 		g_hash_table_unref (self->blocked_firmware);
 		self->blocked_firmware = NULL;
 	}
+	fu_engine_releases_cache_invalidate (self);
 	for (guint i = 0; i < checksums->len; i++) {
 		const gchar *csum = g_ptr_array_index (checksums, i);
 		fu_engine_add_blocked_firmware (self, csum);
@@ -4900,37 +6179,17 @@ fu_engine_self_sign (FuEngine *self,
 	return jcat_blob_get_data_as_string (jcat_signature);
 }
 
-/**
- * fu_engine_get_upgrades:
- * @self: A #FuEngine
- * @request: A #FuEngineRequest
- * @device_id: A device ID
- * @error: A #GError, or %NULL
- *
- * Gets the upgrades available for a specific device.
- *
- * Returns: (transfer container) (element-type FwupdDevice): results
- **/
-GPtrArray *
-fu_engine_get_upgrades (FuEngine *self,
-			FuEngineRequest *request,
-			const gchar *device_id,
-			GError **error)
+static GPtrArray *
+fu_engine_get_upgrades_for_device (FuEngine *self,
+				   FuEngineRequest *request,
+				   FuDevice *device,
+				   GHashTable *components_by_guid,
+				   GError **error)
 {
-	g_autoptr(FuDevice) device = NULL;
 	g_autoptr(GPtrArray) releases = NULL;
 	g_autoptr(GPtrArray) releases_tmp = NULL;
 	g_autoptr(GString) error_str = g_string_new (NULL);
 
-	g_return_val_if_fail (FU_IS_ENGINE (self), NULL);
-	g_return_val_if_fail (device_id != NULL, NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
-
-	/* find the device */
-	device = fu_device_list_get_by_id (self->device_list, device_id, error);
-	if (device == NULL)
-		return NULL;
-
 	/* don't show upgrades again until we reboot */
 	if (fu_device_get_update_state (device) == FWUPD_UPDATE_STATE_NEEDS_REBOOT) {
 		g_set_error_literal (error,
@@ -4941,7 +6200,9 @@ fu_engine_get_upgrades (FuEngine *self,
 	}
 
 	/* get all the releases for the device */
-	releases_tmp = fu_engine_get_releases_for_device (self, request, device, error);
+	releases_tmp = fu_engine_get_releases_for_device_cached (self, request, device,
+								 components_by_guid,
+								 error);
 	if (releases_tmp == NULL)
 		return NULL;
 	releases = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
@@ -5009,10 +6270,108 @@ fu_engine_get_upgrades (FuEngine *self,
 		}
 		return NULL;
 	}
-	g_ptr_array_sort_with_data (releases, fu_engine_sort_releases_cb, device);
+	fu_engine_sort_releases_for_device (device, releases);
 	return g_steal_pointer (&releases);
 }
 
+/**
+ * fu_engine_get_upgrades:
+ * @self: A #FuEngine
+ * @request: A #FuEngineRequest
+ * @device_id: A device ID
+ * @error: A #GError, or %NULL
+ *
+ * Gets the upgrades available for a specific device.
+ *
+ * Returns: (transfer container) (element-type FwupdDevice): results
+ **/
+GPtrArray *
+fu_engine_get_upgrades (FuEngine *self,
+			FuEngineRequest *request,
+			const gchar *device_id,
+			GError **error)
+{
+	g_autoptr(FuDevice) device = NULL;
+
+	g_return_val_if_fail (FU_IS_ENGINE (self), NULL);
+	g_return_val_if_fail (device_id != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* find the device */
+	device = fu_device_list_get_by_id (self->device_list, device_id, error);
+	if (device == NULL)
+		return NULL;
+	return fu_engine_get_upgrades_for_device (self, request, device, NULL, error);
+}
+
+/**
+ * fu_engine_get_upgrades_all:
+ * @self: A #FuEngine
+ * @request: A #FuEngineRequest
+ * @errors: (out) (optional) (transfer container) (element-type utf8 GError): device ID:error
+ * @error: A #GError, or %NULL
+ *
+ * Gets the upgrades available for all the active devices in one pass,
+ * only querying the silo once for all the firmware components.
+ *
+ * Devices that have no upgrades available are not included in the results,
+ * and the reason is instead returned in @errors. Requirements are still
+ * checked for each device as they depend on the device state.
+ *
+ * Returns: (transfer container) (element-type utf8 GPtrArray): device ID:releases
+ **/
+GHashTable *
+fu_engine_get_upgrades_all (FuEngine *self,
+			    FuEngineRequest *request,
+			    GHashTable **errors,
+			    GError **error)
+{
+	g_autoptr(GHashTable) components_by_guid = NULL;
+	g_autoptr(GHashTable) errors_tmp = NULL;
+	g_autoptr(GHashTable) results = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+
+	g_return_val_if_fail (FU_IS_ENGINE (self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* build the GUID index once for every device */
+	components_by_guid = fu_engine_get_components_by_guid (self, error);
+	if (components_by_guid == NULL)
+		return NULL;
+
+	results = g_hash_table_new_full (g_str_hash, g_str_equal,
+					 g_free, (GDestroyNotify) g_ptr_array_unref);
+	errors_tmp = g_hash_table_new_full (g_str_hash, g_str_equal,
+					    g_free, (GDestroyNotify) g_error_free);
+	devices = fu_device_list_get_active (self->device_list);
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *device = g_ptr_array_index (devices, i);
+		g_autoptr(GError) error_local = NULL;
+		g_autoptr(GPtrArray) releases = NULL;
+
+		if (!fu_device_has_flag (device, FWUPD_DEVICE_FLAG_UPDATABLE))
+			continue;
+		releases = fu_engine_get_upgrades_for_device (self, request, device,
+							      components_by_guid,
+							      &error_local);
+		if (releases == NULL) {
+			g_debug ("no upgrades for %s: %s",
+				 fu_device_get_id (device),
+				 error_local->message);
+			g_hash_table_insert (errors_tmp,
+					     g_strdup (fu_device_get_id (device)),
+					     g_steal_pointer (&error_local));
+			continue;
+		}
+		g_hash_table_insert (results,
+				     g_strdup (fu_device_get_id (device)),
+				     g_steal_pointer (&releases));
+	}
+	if (errors != NULL)
+		*errors = g_steal_pointer (&errors_tmp);
+	return g_steal_pointer (&results);
+}
+
 /**
  * fu_engine_clear_results:
  * @self: A #FuEngine
@@ -5507,7 +6866,7 @@ fu_engine_plugin_security_changed_cb (FuPlugin *plugin, gpointer user_data)
 	FuEngine *self = FU_ENGINE (user_data);
 
 	/* invalidate host security attributes */
-	g_clear_pointer (&self->host_security_id, g_free);
+	fu_engine_invalidate_security_attrs_for_plugin (self, fu_plugin_get_name (plugin));
 
 	/* make UI refresh */
 	fu_engine_emit_changed (self);
@@ -5779,11 +7138,71 @@ fu_engine_attrs_calculate_hsi_for_chassis (FuEngine *self)
 }
 
 
+static void
+fu_engine_security_item_run (FuEngineSecurityItem *item)
+{
+	g_autoptr(FuSecurityAttrs) attrs = fu_security_attrs_new ();
+	gint64 start = g_get_monotonic_time ();
+
+	fu_plugin_runner_add_security_attrs (item->plugin, attrs);
+	item->duration = g_get_monotonic_time () - start;
+	item->attrs = g_steal_pointer (&attrs);
+	g_debug ("security attributes for %s took %.1fms",
+		 fu_plugin_get_name (item->plugin),
+		 (gdouble) item->duration / 1000.f);
+}
+
+/* plugins are not thread-safe, so only evaluate the plugins with no cached
+ * attributes, one at a time */
+static void
+fu_engine_ensure_security_items (FuEngine *self)
+{
+	GPtrArray *plugins = fu_plugin_list_get_all (self->plugin_list);
+	gint64 start = g_get_monotonic_time ();
+	guint stale = 0;
+
+	for (guint i = 0; i < plugins->len; i++) {
+		FuPlugin *plugin_tmp = g_ptr_array_index (plugins, i);
+		FuEngineSecurityItem *item;
+
+		item = g_hash_table_lookup (self->security_items, fu_plugin_get_name (plugin_tmp));
+		if (item == NULL) {
+			item = g_new0 (FuEngineSecurityItem, 1);
+			g_hash_table_insert (self->security_items,
+					     g_strdup (fu_plugin_get_name (plugin_tmp)),
+					     item);
+		}
+		item->plugin = plugin_tmp;
+		if (item->attrs != NULL)
+			continue;
+		fu_engine_security_item_run (item);
+		stale++;
+	}
+	if (stale == 0)
+		return;
+	g_debug ("security attributes for %u plugins took %.1fms",
+		 stale, (gdouble) (g_get_monotonic_time () - start) / 1000.f);
+}
+
+/* the cached attributes are modified by the depsolve */
+static FwupdSecurityAttr *
+fu_engine_security_attr_copy (FwupdSecurityAttr *attr)
+{
+	FwupdSecurityAttr *attr_copy;
+	g_autoptr(GVariant) val = g_variant_ref_sink (fwupd_security_attr_to_variant (attr));
+	attr_copy = fwupd_security_attr_from_variant (val);
+	fwupd_security_attr_set_plugin (attr_copy, fwupd_security_attr_get_plugin (attr));
+	return attr_copy;
+}
+
 static void
 fu_engine_ensure_security_attrs (FuEngine *self)
 {
 	GPtrArray *plugins = fu_plugin_list_get_all (self->plugin_list);
+	g_autoptr(GMutexLocker) locker = NULL;
 	g_autoptr(GPtrArray) items = NULL;
+	g_autoptr(GPtrArray) items_sorted = NULL;
+	g_autoptr(GPtrArray) snapshot = NULL;
 
 	/* already valid */
 	if (self->host_security_id != NULL)
@@ -5795,10 +7214,26 @@ fu_engine_ensure_security_attrs (FuEngine *self)
 	/* built in */
 	fu_engine_ensure_security_attrs_tainted (self);
 
-	/* call into plugins */
+	/* call into plugins, only where required */
+	fu_engine_ensure_security_items (self);
+
+	/* the depsolve is done again as other plugins may have changed */
 	for (guint j = 0; j < plugins->len; j++) {
 		FuPlugin *plugin_tmp = g_ptr_array_index (plugins, j);
-		fu_plugin_runner_add_security_attrs (plugin_tmp, self->host_security_attrs);
+		FuEngineSecurityItem *item;
+		g_autoptr(GPtrArray) attrs_plugin = NULL;
+
+		item = g_hash_table_lookup (self->security_items, fu_plugin_get_name (plugin_tmp));
+		if (item == NULL || item->attrs == NULL)
+			continue;
+		attrs_plugin = fu_security_attrs_get_all (item->attrs);
+		for (guint i = 0; i < attrs_plugin->len; i++) {
+			FwupdSecurityAttr *attr = g_ptr_array_index (attrs_plugin, i);
+			g_autoptr(FwupdSecurityAttr) attr_copy = fu_engine_security_attr_copy (attr);
+			FwupdSecurityAttrFlags flags = fwupd_security_attr_get_flags (attr_copy);
+			fwupd_security_attr_set_flags (attr_copy, flags & ~FWUPD_SECURITY_ATTR_FLAG_OBSOLETED);
+			fu_security_attrs_append (self->host_security_attrs, attr_copy);
+		}
 	}
 
 	/* set the fallback names for clients without native translations */
@@ -5822,6 +7257,18 @@ fu_engine_ensure_security_attrs (FuEngine *self)
 	/* distil into one simple string */
 	g_free (self->host_security_id);
 	self->host_security_id = fu_engine_attrs_calculate_hsi_for_chassis (self);
+
+	/* publish for the worker threads, in the depsolved order */
+	items_sorted = fu_security_attrs_get_all (self->host_security_attrs);
+	snapshot = g_ptr_array_new_with_free_func ((GDestroyNotify) g_variant_unref);
+	for (guint i = 0; i < items_sorted->len; i++) {
+		FwupdSecurityAttr *attr = g_ptr_array_index (items_sorted, i);
+		GVariant *val = fwupd_security_attr_to_variant (attr);
+		g_ptr_array_add (snapshot, g_variant_ref_sink (val));
+	}
+	locker = g_mutex_locker_new (&self->snapshot_mutex);
+	g_clear_pointer (&self->snapshot_security_attrs, g_ptr_array_unref);
+	self->snapshot_security_attrs = g_steal_pointer (&snapshot);
 }
 
 const gchar *
@@ -5840,6 +7287,19 @@ fu_engine_get_host_security_attrs (FuEngine *self)
 	return g_object_ref (self->host_security_attrs);
 }
 
+/* in microseconds, or 0 if the plugin has not been evaluated */
+guint64
+fu_engine_get_host_security_attrs_duration (FuEngine *self, const gchar *plugin_name)
+{
+	FuEngineSecurityItem *item;
+	g_return_val_if_fail (FU_IS_ENGINE (self), 0);
+	g_return_val_if_fail (plugin_name != NULL, 0);
+	item = g_hash_table_lookup (self->security_items, plugin_name);
+	if (item == NULL)
+		return 0;
+	return (guint64) item->duration;
+}
+
 gboolean
 fu_engine_load_plugins (FuEngine *self, GError **error)
 {
@@ -5979,6 +7439,12 @@ fu_engine_get_archive_size_max (FuEngine *self)
 	return fu_config_get_archive_size_max (self->config);
 }
 
+guint64
+fu_engine_get_download_cache_size_max (FuEngine *self)
+{
+	return fu_config_get_download_cache_size_max (self->config);
+}
+
 static void
 fu_engine_backend_device_removed_cb (FuBackend *backend, FuDevice *device, FuEngine *self)
 {
@@ -6103,19 +7569,40 @@ fu_engine_load_quirks (FuEngine *self, FuQuirksLoadFlags quirks_flags)
 		g_warning ("Failed to load quirks: %s", error->message);
 }
 
+/* the parsed tables only change when the system firmware is updated */
 static void
-fu_engine_load_smbios (FuEngine *self)
+fu_engine_load_smbios (FuEngine *self, FuEngineLoadFlags flags)
 {
+	g_autofree gchar *cachedir = NULL;
+	g_autofree gchar *fn = NULL;
 	g_autoptr(GError) error = NULL;
-	if (!fu_smbios_setup (self->smbios, &error))
+
+	if (flags & FU_ENGINE_LOAD_FLAG_READONLY) {
+		if (!fu_smbios_setup (self->smbios, &error))
+			g_warning ("Failed to load SMBIOS: %s", error->message);
+		return;
+	}
+	cachedir = fu_common_get_path (FU_PATH_KIND_CACHEDIR_PKG);
+	fn = g_build_filename (cachedir, "smbios.cache", NULL);
+	if (!fu_smbios_setup_with_cache (self->smbios, fn, &error))
 		g_warning ("Failed to load SMBIOS: %s", error->message);
 }
 
 static void
-fu_engine_load_hwids (FuEngine *self)
+fu_engine_load_hwids (FuEngine *self, FuEngineLoadFlags flags)
 {
+	g_autofree gchar *cachedir = NULL;
+	g_autofree gchar *fn = NULL;
 	g_autoptr(GError) error = NULL;
-	if (!fu_hwids_setup (self->hwids, self->smbios, &error))
+
+	if (flags & FU_ENGINE_LOAD_FLAG_READONLY) {
+		if (!fu_hwids_setup (self->hwids, self->smbios, &error))
+			g_warning ("Failed to load HWIDs: %s", error->message);
+		return;
+	}
+	cachedir = fu_common_get_path (FU_PATH_KIND_CACHEDIR_PKG);
+	fn = g_build_filename (cachedir, "hwids.cache", NULL);
+	if (!fu_hwids_setup_with_cache (self->hwids, self->smbios, fn, &error))
 		g_warning ("Failed to load HWIDs: %s", error->message);
 }
 
@@ -6356,14 +7843,23 @@ fu_engine_load (FuEngine *self, FuEngineLoadFlags flags, GError **error)
 		fu_engine_add_blocked_firmware (self, csum);
 	}
 
+	/* drop any history entries older than the configured retention, and
+	 * compact the database now rather than when the config is changed */
+	if ((flags & FU_ENGINE_LOAD_FLAG_READONLY) == 0) {
+		g_autoptr(GError) error_local = NULL;
+		fu_engine_history_prune (self);
+		if (!fu_history_vacuum (self->history, &error_local))
+			g_warning ("failed to compact history: %s", error_local->message);
+	}
+
 	/* set up idle exit */
 	if ((self->app_flags & FU_APP_FLAGS_NO_IDLE_SOURCES) == 0)
 		fu_idle_set_timeout (self->idle, fu_config_get_idle_timeout (self->config));
 
 	/* load quirks, SMBIOS and the hwids */
 	if (flags & FU_ENGINE_LOAD_FLAG_HWINFO) {
-		fu_engine_load_smbios (self);
-		fu_engine_load_hwids (self);
+		fu_engine_load_smbios (self, flags);
+		fu_engine_load_hwids (self, flags);
 	}
 	/* on a read-only filesystem don't care about the cache GUID */
 	if (flags & FU_ENGINE_LOAD_FLAG_READONLY)
@@ -6512,6 +8008,11 @@ fu_engine_class_init (FuEngineClass *klass)
 			      G_TYPE_FROM_CLASS (object_class), G_SIGNAL_RUN_LAST,
 			      0, NULL, NULL, g_cclosure_marshal_VOID__UINT,
 			      G_TYPE_NONE, 1, G_TYPE_UINT);
+	signals[SIGNAL_CONFIG_CHANGED] =
+		g_signal_new ("config-changed",
+			      G_TYPE_FROM_CLASS (object_class), G_SIGNAL_RUN_LAST,
+			      0, NULL, NULL, g_cclosure_marshal_VOID__VOID,
+			      G_TYPE_NONE, 0);
 }
 
 void
@@ -6545,10 +8046,6 @@ fu_engine_init (FuEngine *self)
 #ifdef HAVE_UTSNAME_H
 	struct utsname uname_tmp;
 #endif
-	g_autofree gchar *keyring_path = NULL;
-	g_autofree gchar *pkidir_fw = NULL;
-	g_autofree gchar *pkidir_md = NULL;
-	g_autofree gchar *sysconfdir = NULL;
 	self->percentage = 0;
 	self->status = FWUPD_STATUS_IDLE;
 	self->config = fu_config_new ();
@@ -6562,11 +8059,23 @@ fu_engine_init (FuEngine *self)
 	self->plugin_list = fu_plugin_list_new ();
 	self->plugin_filter = g_ptr_array_new_with_free_func (g_free);
 	self->host_security_attrs = fu_security_attrs_new ();
+	self->security_items = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+						      (GDestroyNotify) fu_engine_security_item_free);
+	self->security_devices = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 	self->udev_subsystems = g_ptr_array_new_with_free_func (g_free);
 	self->backends = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
 	self->runtime_versions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 	self->compile_versions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 	self->firmware_gtypes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	self->device_generations = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	self->releases_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+						      (GDestroyNotify) fu_engine_releases_item_free);
+	self->req_programs = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+						    (GDestroyNotify) g_array_unref);
+	self->removed_generations = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	self->generation = g_get_real_time ();
+	self->removed_generation_min = self->generation;
+	g_mutex_init (&self->snapshot_mutex);
 
 	g_signal_connect (self->config, "changed",
 			  G_CALLBACK (fu_engine_config_changed_cb),
@@ -6586,15 +8095,11 @@ fu_engine_init (FuEngine *self)
 	g_ptr_array_add (self->backends, fu_udev_backend_new (self->udev_subsystems));
 #endif
 
-	/* setup Jcat context */
-	self->jcat_context = jcat_context_new ();
-	keyring_path = fu_common_get_path (FU_PATH_KIND_LOCALSTATEDIR_PKG);
-	jcat_context_set_keyring_path (self->jcat_context, keyring_path);
-	sysconfdir = fu_common_get_path (FU_PATH_KIND_SYSCONFDIR);
-	pkidir_fw = g_build_filename (sysconfdir, "pki", "fwupd", NULL);
-	jcat_context_add_public_keys (self->jcat_context, pkidir_fw);
-	pkidir_md = g_build_filename (sysconfdir, "pki", "fwupd-metadata", NULL);
-	jcat_context_add_public_keys (self->jcat_context, pkidir_md);
+	/* setup Jcat context; verification results are valid until the
+	 * trusted keys change */
+	self->verify_cache = fu_verify_cache_new ();
+	self->keyring_monitors = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	fu_engine_load_jcat_context (self);
 
 	/* add some runtime versions of things the daemon depends on */
 	fu_engine_add_runtime_version (self, "org.freedesktop.fwupd", VERSION);
@@ -6631,11 +8136,20 @@ static void
 fu_engine_finalize (GObject *obj)
 {
 	FuEngine *self = FU_ENGINE (obj);
+	g_autoptr(GList) components = NULL;
 
 	if (self->silo != NULL)
 		g_object_unref (self->silo);
 	if (self->coldplug_id != 0)
 		g_source_remove (self->coldplug_id);
+	if (self->snapshot_id != 0) {
+		g_source_remove (self->snapshot_id);
+		self->snapshot_id = 0;
+	}
+	if (self->percentage_id != 0) {
+		g_source_remove (self->percentage_id);
+		self->percentage_id = 0;
+	}
 	if (self->approved_firmware != NULL)
 		g_hash_table_unref (self->approved_firmware);
 	if (self->blocked_firmware != NULL)
@@ -6644,6 +8158,8 @@ fu_engine_finalize (GObject *obj)
 	g_free (self->host_machine_id);
 	g_free (self->host_security_id);
 	g_object_unref (self->host_security_attrs);
+	g_hash_table_unref (self->security_items);
+	g_hash_table_unref (self->security_devices);
 	g_object_unref (self->idle);
 	g_object_unref (self->config);
 	g_object_unref (self->remote_list);
@@ -6652,6 +8168,13 @@ fu_engine_finalize (GObject *obj)
 	g_object_unref (self->hwids);
 	g_object_unref (self->history);
 	g_object_unref (self->device_list);
+	for (guint i = 0; i < self->keyring_monitors->len; i++) {
+		GFileMonitor *monitor = g_ptr_array_index (self->keyring_monitors, i);
+		g_signal_handlers_disconnect_by_data (monitor, self);
+		g_file_monitor_cancel (monitor);
+	}
+	g_ptr_array_unref (self->keyring_monitors);
+	g_object_unref (self->verify_cache);
 	g_object_unref (self->jcat_context);
 	g_ptr_array_unref (self->plugin_filter);
 	g_ptr_array_unref (self->udev_subsystems);
@@ -6659,6 +8182,21 @@ fu_engine_finalize (GObject *obj)
 	g_hash_table_unref (self->runtime_versions);
 	g_hash_table_unref (self->compile_versions);
 	g_hash_table_unref (self->firmware_gtypes);
+	g_hash_table_unref (self->device_generations);
+	g_hash_table_unref (self->releases_cache);
+	g_hash_table_unref (self->removed_generations);
+	components = g_hash_table_get_keys (self->req_programs);
+	for (GList *l = components; l != NULL; l = l->next) {
+		g_object_weak_unref (G_OBJECT (l->data),
+				     fu_engine_req_program_component_finalized_cb,
+				     self);
+	}
+	g_hash_table_unref (self->req_programs);
+	g_clear_pointer (&self->snapshot_devices, g_ptr_array_unref);
+	g_clear_pointer (&self->snapshot_devices_trusted, g_ptr_array_unref);
+	g_clear_pointer (&self->snapshot_remotes, g_ptr_array_unref);
+	g_clear_pointer (&self->snapshot_security_attrs, g_ptr_array_unref);
+	g_mutex_clear (&self->snapshot_mutex);
 	g_object_unref (self->plugin_list);
 
 	G_OBJECT_CLASS (fu_engine_parent_class)->finalize (obj);
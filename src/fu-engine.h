@@ -62,9 +62,15 @@ XbSilo		*fu_engine_get_silo_from_blob		(FuEngine	*self,
 							 GBytes		*blob_cab,
 							 GError		**error);
 guint64		 fu_engine_get_archive_size_max		(FuEngine	*self);
+guint64		 fu_engine_get_download_cache_size_max	(FuEngine	*self);
 GPtrArray	*fu_engine_get_plugins			(FuEngine	*self);
 GPtrArray	*fu_engine_get_devices			(FuEngine	*self,
 							 GError		**error);
+guint64		 fu_engine_get_generation		(FuEngine	*self);
+GPtrArray	*fu_engine_get_devices_since		(FuEngine	*self,
+							 guint64	 generation,
+							 GPtrArray	**removed_ids,
+							 GError		**error);
 FuDevice	*fu_engine_get_device			(FuEngine	*self,
 							 const gchar	*device_id,
 							 GError		**error);
@@ -73,6 +79,14 @@ GPtrArray	*fu_engine_get_devices_by_guid		(FuEngine	*self,
 							 GError		**error);
 GPtrArray	*fu_engine_get_history			(FuEngine	*self,
 							 GError		**error);
+GPtrArray	*fu_engine_get_history_full		(FuEngine	*self,
+							 const gchar	*device_id,
+							 FwupdUpdateState update_state,
+							 guint64	 modified_min,
+							 guint64	 modified_max,
+							 guint		 offset,
+							 guint		 limit,
+							 GError		**error);
 FwupdRemote 	*fu_engine_get_remote_by_id		(FuEngine	*self,
 							 const gchar	*remote_id,
 							 GError		**error);
@@ -90,10 +104,20 @@ GPtrArray	*fu_engine_get_upgrades			(FuEngine	*self,
 							 FuEngineRequest *request,
 							 const gchar	*device_id,
 							 GError		**error);
+GHashTable	*fu_engine_get_upgrades_all		(FuEngine	*self,
+							 FuEngineRequest *request,
+							 GHashTable	**errors,
+							 GError		**error);
 FwupdDevice	*fu_engine_get_results			(FuEngine	*self,
 							 const gchar	*device_id,
 							 GError		**error);
 FuSecurityAttrs	*fu_engine_get_host_security_attrs	(FuEngine	*self);
+guint64		 fu_engine_get_host_security_attrs_duration (FuEngine	*self,
+							 const gchar	*plugin_name);
+GPtrArray	*fu_engine_get_devices_snapshot		(FuEngine	*self,
+							 FwupdDeviceFlags flags);
+GPtrArray	*fu_engine_get_remotes_snapshot		(FuEngine	*self);
+GPtrArray	*fu_engine_get_host_security_attrs_snapshot (FuEngine	*self);
 GHashTable	*fu_engine_get_report_metadata		(FuEngine	*self,
 							 GError		**error);
 gboolean	 fu_engine_clear_results		(FuEngine	*self,
@@ -20,7 +20,7 @@
 #include "fu-history.h"
 #include "fu-mutex.h"
 
-#define FU_HISTORY_CURRENT_SCHEMA_VERSION	6
+#define FU_HISTORY_CURRENT_SCHEMA_VERSION	8
 
 static void fu_history_finalize			 (GObject *object);
 
@@ -179,10 +179,16 @@ fu_history_create_database (FuHistory *self, GError **error)
 			 "version_new TEXT,"
 			 "checksum_device TEXT DEFAULT NULL,"
 			 "protocol TEXT DEFAULT NULL);"
+			 "CREATE INDEX IF NOT EXISTS history_device_modified "
+			 "ON history (device_modified);"
 			 "CREATE TABLE IF NOT EXISTS approved_firmware ("
 			 "checksum TEXT);"
 			 "CREATE TABLE IF NOT EXISTS blocked_firmware ("
 			 "checksum TEXT);"
+			 "CREATE TABLE IF NOT EXISTS replug_latency ("
+			 "device_id TEXT PRIMARY KEY,"
+			 "samples INTEGER DEFAULT 0,"
+			 "latency_max INTEGER DEFAULT 0);"
 			 "COMMIT;", NULL, NULL, NULL);
 	if (rc != SQLITE_OK) {
 		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
@@ -288,6 +294,42 @@ fu_history_migrate_database_v5 (FuHistory *self, GError **error)
 	return TRUE;
 }
 
+static gboolean
+fu_history_migrate_database_v6 (FuHistory *self, GError **error)
+{
+	gint rc;
+	rc = sqlite3_exec (self->db,
+			   "CREATE INDEX IF NOT EXISTS history_device_modified "
+			   "ON history (device_modified);",
+			   NULL, NULL, NULL);
+	if (rc != SQLITE_OK) {
+		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
+			     "Failed to create index: %s",
+			     sqlite3_errmsg (self->db));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+fu_history_migrate_database_v7 (FuHistory *self, GError **error)
+{
+	gint rc;
+	rc = sqlite3_exec (self->db,
+			   "CREATE TABLE IF NOT EXISTS replug_latency ("
+			   "device_id TEXT PRIMARY KEY,"
+			   "samples INTEGER DEFAULT 0,"
+			   "latency_max INTEGER DEFAULT 0);",
+			   NULL, NULL, NULL);
+	if (rc != SQLITE_OK) {
+		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
+			     "Failed to create table: %s",
+			     sqlite3_errmsg (self->db));
+		return FALSE;
+	}
+	return TRUE;
+}
+
 /* returns 0 if database is not initialized */
 static guint
 fu_history_get_schema_version (FuHistory *self)
@@ -347,6 +389,14 @@ fu_history_create_or_migrate (FuHistory *self, guint schema_ver, GError **error)
 	case 5:
 		if (!fu_history_migrate_database_v5 (self, error))
 			return FALSE;
+	/* fall through */
+	case 6:
+		if (!fu_history_migrate_database_v6 (self, error))
+			return FALSE;
+	/* fall through */
+	case 7:
+		if (!fu_history_migrate_database_v7 (self, error))
+			return FALSE;
 		break;
 	default:
 		/* this is probably okay, but return an error if we ever delete
@@ -891,23 +941,37 @@ fu_history_get_device_by_id (FuHistory *self, const gchar *device_id, GError **e
 	return g_object_ref (g_ptr_array_index (array_tmp, 0));
 }
 /**
- * fu_history_get_devices:
+ * fu_history_get_devices_full:
  * @self: A #FuHistory
+ * @device_id: (nullable): A device ID to match, or %NULL for any
+ * @update_state: A #FwupdUpdateState to match, or %FWUPD_UPDATE_STATE_UNKNOWN for any
+ * @modified_min: The earliest modification time to include, or 0
+ * @modified_max: The latest modification time to include, or 0
+ * @offset: The number of matching entries to skip
+ * @limit: The maximum number of entries to return, or 0 for no limit
  * @error: A #GError or NULL
  *
- * Gets the devices in the history database.
+ * Gets a filtered subset of the devices in the history database. The
+ * filtering and paging is done by the database itself, so only the
+ * requested rows are converted into #FuDevice objects.
  *
  * Returns: (element-type #FuDevice) (transfer container): devices
  *
- * Since: 1.0.4
+ * Since: 1.5.8
  **/
 GPtrArray *
-fu_history_get_devices (FuHistory *self, GError **error)
+fu_history_get_devices_full (FuHistory *self,
+			     const gchar *device_id,
+			     FwupdUpdateState update_state,
+			     guint64 modified_min,
+			     guint64 modified_max,
+			     guint offset,
+			     guint limit,
+			     GError **error)
 {
-	GPtrArray *array = NULL;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
 	gint rc;
 	g_autoptr(GPtrArray) array_tmp = NULL;
+	g_autoptr(sqlite3_stmt) stmt = NULL;
 	g_autoptr(GRWLockReaderLocker) locker = NULL;
 
 	g_return_val_if_fail (FU_IS_HISTORY (self), NULL);
@@ -918,7 +982,7 @@ fu_history_get_devices (FuHistory *self, GError **error)
 			return NULL;
 	}
 
-	/* get all the devices */
+	/* get the matching devices */
 	locker = g_rw_lock_reader_locker_new (&self->db_mutex);
 	g_return_val_if_fail (locker != NULL, NULL);
 	rc = sqlite3_prepare_v2 (self->db,
@@ -937,8 +1001,13 @@ fu_history_get_devices (FuHistory *self, GError **error)
 					"version_new, "
 					"version_old, "
 					"checksum_device, "
-					"protocol FROM history "
-					"ORDER BY device_modified ASC;",
+					"protocol FROM history WHERE "
+					"(?1 IS NULL OR device_id = ?1) AND "
+					"(?2 = 0 OR update_state = ?2) AND "
+					"(?3 = 0 OR device_modified >= ?3) AND "
+					"(?4 = 0 OR device_modified <= ?4) "
+					"ORDER BY device_modified ASC "
+					"LIMIT ?5 OFFSET ?6;",
 					-1, &stmt, NULL);
 	if (rc != SQLITE_OK) {
 		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
@@ -946,11 +1015,185 @@ fu_history_get_devices (FuHistory *self, GError **error)
 			     sqlite3_errmsg (self->db));
 		return NULL;
 	}
+	sqlite3_bind_text (stmt, 1, device_id, -1, SQLITE_STATIC);
+	sqlite3_bind_int (stmt, 2, update_state);
+	sqlite3_bind_int64 (stmt, 3, modified_min);
+	sqlite3_bind_int64 (stmt, 4, modified_max);
+	sqlite3_bind_int64 (stmt, 5, limit > 0 ? (gint64) limit : -1);
+	sqlite3_bind_int64 (stmt, 6, offset);
 	array_tmp = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
 	if (!fu_history_stmt_exec (self, stmt, array_tmp, error))
 		return NULL;
-	array = g_ptr_array_ref (array_tmp);
-	return array;
+	return g_steal_pointer (&array_tmp);
+}
+
+/**
+ * fu_history_get_devices:
+ * @self: A #FuHistory
+ * @error: A #GError or NULL
+ *
+ * Gets the devices in the history database.
+ *
+ * Returns: (element-type #FuDevice) (transfer container): devices
+ *
+ * Since: 1.0.4
+ **/
+GPtrArray *
+fu_history_get_devices (FuHistory *self, GError **error)
+{
+	return fu_history_get_devices_full (self, NULL,
+					    FWUPD_UPDATE_STATE_UNKNOWN,
+					    0, 0, 0, 0, error);
+}
+
+/**
+ * fu_history_prune:
+ * @self: A #FuHistory
+ * @max_age: The maximum age of entries to keep in seconds, or 0
+ * @max_entries: The maximum number of entries to keep, or 0
+ * @error: A #GError or NULL
+ *
+ * Removes old entries from the history database. Entries that are still
+ * pending or waiting for a reboot are never removed as they are required
+ * to finish the update.
+ *
+ * The database file is not compacted, see fu_history_vacuum().
+ *
+ * Returns: @TRUE if successful, @FALSE for failure
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_history_prune (FuHistory *self, guint64 max_age, guint max_entries, GError **error)
+{
+	gint rc;
+	gint changes = 0;
+	g_autoptr(GRWLockWriterLocker) locker = NULL;
+
+	g_return_val_if_fail (FU_IS_HISTORY (self), FALSE);
+
+	/* nothing to do */
+	if (max_age == 0 && max_entries == 0)
+		return TRUE;
+
+	/* lazy load */
+	if (!fu_history_load (self, error))
+		return FALSE;
+
+	locker = g_rw_lock_writer_locker_new (&self->db_mutex);
+	g_return_val_if_fail (locker != NULL, FALSE);
+
+	/* remove entries that are too old */
+	if (max_age > 0) {
+		g_autoptr(sqlite3_stmt) stmt = NULL;
+		gint64 now = g_get_real_time () / G_USEC_PER_SEC;
+		rc = sqlite3_prepare_v2 (self->db,
+					 "DELETE FROM history WHERE "
+					 "device_modified < ?1 AND "
+					 "update_state NOT IN (?2, ?3);",
+					 -1, &stmt, NULL);
+		if (rc != SQLITE_OK) {
+			g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
+				     "Failed to prepare SQL to prune history: %s",
+				     sqlite3_errmsg (self->db));
+			return FALSE;
+		}
+		sqlite3_bind_int64 (stmt, 1, now - (gint64) max_age);
+		sqlite3_bind_int (stmt, 2, FWUPD_UPDATE_STATE_PENDING);
+		sqlite3_bind_int (stmt, 3, FWUPD_UPDATE_STATE_NEEDS_REBOOT);
+		if (!fu_history_stmt_exec (self, stmt, NULL, error))
+			return FALSE;
+		changes += sqlite3_changes (self->db);
+	}
+
+	/* only keep the newest entries */
+	if (max_entries > 0) {
+		g_autoptr(sqlite3_stmt) stmt = NULL;
+		rc = sqlite3_prepare_v2 (self->db,
+					 "DELETE FROM history WHERE "
+					 "update_state NOT IN (?2, ?3) AND "
+					 "rowid NOT IN (SELECT rowid FROM history "
+					 "ORDER BY device_modified DESC LIMIT ?1);",
+					 -1, &stmt, NULL);
+		if (rc != SQLITE_OK) {
+			g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
+				     "Failed to prepare SQL to prune history: %s",
+				     sqlite3_errmsg (self->db));
+			return FALSE;
+		}
+		sqlite3_bind_int64 (stmt, 1, max_entries);
+		sqlite3_bind_int (stmt, 2, FWUPD_UPDATE_STATE_PENDING);
+		sqlite3_bind_int (stmt, 3, FWUPD_UPDATE_STATE_NEEDS_REBOOT);
+		if (!fu_history_stmt_exec (self, stmt, NULL, error))
+			return FALSE;
+		changes += sqlite3_changes (self->db);
+	}
+
+	if (changes > 0)
+		g_debug ("pruned %i history entries", changes);
+	return TRUE;
+}
+
+/**
+ * fu_history_vacuum:
+ * @self: A #FuHistory
+ * @error: A #GError or NULL
+ *
+ * Compacts the database file if any entries have been removed. This
+ * rewrites the entire file, so it should only be called at startup.
+ *
+ * Returns: @TRUE if successful, @FALSE for failure
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_history_vacuum (FuHistory *self, GError **error)
+{
+	gint rc;
+	gint freelist_count;
+	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(GRWLockWriterLocker) locker = NULL;
+
+	g_return_val_if_fail (FU_IS_HISTORY (self), FALSE);
+
+	/* lazy load */
+	if (!fu_history_load (self, error))
+		return FALSE;
+
+	locker = g_rw_lock_writer_locker_new (&self->db_mutex);
+	g_return_val_if_fail (locker != NULL, FALSE);
+
+	/* nothing to reclaim */
+	rc = sqlite3_prepare_v2 (self->db,
+				 "PRAGMA freelist_count;",
+				 -1, &stmt, NULL);
+	if (rc != SQLITE_OK) {
+		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
+			     "Failed to prepare SQL to get free pages: %s",
+			     sqlite3_errmsg (self->db));
+		return FALSE;
+	}
+	rc = sqlite3_step (stmt);
+	if (rc != SQLITE_ROW) {
+		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
+			     "Failed to get free pages: %s",
+			     sqlite3_errmsg (self->db));
+		return FALSE;
+	}
+	freelist_count = sqlite3_column_int (stmt, 0);
+	if (freelist_count == 0)
+		return TRUE;
+
+	/* reclaim the free pages */
+	g_debug ("compacting database with %i free pages", freelist_count);
+	rc = sqlite3_exec (self->db, "VACUUM;", NULL, NULL, NULL);
+	if (rc != SQLITE_OK) {
+		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_WRITE,
+			     "Failed to compact database: %s",
+			     sqlite3_errmsg (self->db));
+		return FALSE;
+	}
+	return TRUE;
 }
 
 /**
@@ -1222,6 +1465,124 @@ fu_history_add_blocked_firmware (FuHistory *self, const gchar *checksum, GError
 	return fu_history_stmt_exec (self, stmt, NULL, error);
 }
 
+/**
+ * fu_history_add_replug_latency:
+ * @self: A #FuHistory
+ * @device_id: A device ID
+ * @latency: The time the device took to replug in ms
+ * @error: A #GError or NULL
+ *
+ * Records how long a device took to come back after a detach or attach.
+ *
+ * Returns: #TRUE for success, #FALSE for failure
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_history_add_replug_latency (FuHistory *self,
+			       const gchar *device_id,
+			       guint latency,
+			       GError **error)
+{
+	gint rc;
+	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(GRWLockWriterLocker) locker = NULL;
+
+	g_return_val_if_fail (FU_IS_HISTORY (self), FALSE);
+	g_return_val_if_fail (device_id != NULL, FALSE);
+
+	/* lazy load */
+	if (!fu_history_load (self, error))
+		return FALSE;
+
+	/* add, or update the existing record */
+	locker = g_rw_lock_writer_locker_new (&self->db_mutex);
+	g_return_val_if_fail (locker != NULL, FALSE);
+	rc = sqlite3_prepare_v2 (self->db,
+				 "INSERT OR REPLACE INTO replug_latency "
+				 "(device_id, samples, latency_max) "
+				 "SELECT ?1, IFNULL(r.samples, 0) + 1, "
+				 "MAX(IFNULL(r.latency_max, 0), ?2) "
+				 "FROM (SELECT 1) LEFT JOIN replug_latency r "
+				 "ON r.device_id = ?1;", -1, &stmt, NULL);
+	if (rc != SQLITE_OK) {
+		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
+			     "Failed to prepare SQL to insert replug latency: %s",
+			     sqlite3_errmsg (self->db));
+		return FALSE;
+	}
+	sqlite3_bind_text (stmt, 1, device_id, -1, SQLITE_STATIC);
+	sqlite3_bind_int (stmt, 2, latency);
+	return fu_history_stmt_exec (self, stmt, NULL, error);
+}
+
+/**
+ * fu_history_get_replug_latency:
+ * @self: A #FuHistory
+ * @device_id: A device ID
+ * @samples: (out) (optional): The number of replugs recorded
+ * @latency_max: (out) (optional): The longest replug in ms
+ * @error: A #GError or NULL
+ *
+ * Gets the replug latency previously recorded for a device.
+ *
+ * Returns: #TRUE for success, #FALSE if there is no record
+ *
+ * Since: 1.5.8
+ **/
+gboolean
+fu_history_get_replug_latency (FuHistory *self,
+			       const gchar *device_id,
+			       guint *samples,
+			       guint *latency_max,
+			       GError **error)
+{
+	gint rc;
+	g_autoptr(GRWLockReaderLocker) locker = NULL;
+	g_autoptr(sqlite3_stmt) stmt = NULL;
+
+	g_return_val_if_fail (FU_IS_HISTORY (self), FALSE);
+	g_return_val_if_fail (device_id != NULL, FALSE);
+
+	/* lazy load */
+	if (self->db == NULL) {
+		if (!fu_history_load (self, error))
+			return FALSE;
+	}
+
+	/* get the record */
+	locker = g_rw_lock_reader_locker_new (&self->db_mutex);
+	g_return_val_if_fail (locker != NULL, FALSE);
+	rc = sqlite3_prepare_v2 (self->db,
+				 "SELECT samples, latency_max FROM replug_latency "
+				 "WHERE device_id = ?1 LIMIT 1;",
+				 -1, &stmt, NULL);
+	if (rc != SQLITE_OK) {
+		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
+			     "Failed to prepare SQL to get replug latency: %s",
+			     sqlite3_errmsg (self->db));
+		return FALSE;
+	}
+	sqlite3_bind_text (stmt, 1, device_id, -1, SQLITE_STATIC);
+	rc = sqlite3_step (stmt);
+	if (rc == SQLITE_DONE) {
+		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND,
+			     "no replug latency for %s", device_id);
+		return FALSE;
+	}
+	if (rc != SQLITE_ROW) {
+		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_READ,
+			     "failed to execute prepared statement: %s",
+			     sqlite3_errmsg (self->db));
+		return FALSE;
+	}
+	if (samples != NULL)
+		*samples = sqlite3_column_int (stmt, 0);
+	if (latency_max != NULL)
+		*latency_max = sqlite3_column_int (stmt, 1);
+	return TRUE;
+}
+
 static void
 fu_history_class_init (FuHistoryClass *klass)
 {
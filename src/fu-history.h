@@ -39,6 +39,20 @@ FuDevice	*fu_history_get_device_by_id		(FuHistory	*self,
 							 GError		**error);
 GPtrArray	*fu_history_get_devices			(FuHistory	*self,
 							 GError		**error);
+GPtrArray	*fu_history_get_devices_full		(FuHistory	*self,
+							 const gchar	*device_id,
+							 FwupdUpdateState update_state,
+							 guint64	 modified_min,
+							 guint64	 modified_max,
+							 guint		 offset,
+							 guint		 limit,
+							 GError		**error);
+gboolean	 fu_history_prune			(FuHistory	*self,
+							 guint64	 max_age,
+							 guint		 max_entries,
+							 GError		**error);
+gboolean	 fu_history_vacuum			(FuHistory	*self,
+							 GError		**error);
 
 gboolean	 fu_history_clear_approved_firmware	(FuHistory	*self,
 							 GError		**error);
@@ -54,3 +68,12 @@ gboolean	 fu_history_add_blocked_firmware	(FuHistory	*self,
 							 GError		**error);
 GPtrArray	*fu_history_get_blocked_firmware	(FuHistory	*self,
 							 GError		**error);
+gboolean	 fu_history_add_replug_latency		(FuHistory	*self,
+							 const gchar	*device_id,
+							 guint		 latency,
+							 GError		**error);
+gboolean	 fu_history_get_replug_latency		(FuHistory	*self,
+							 const gchar	*device_id,
+							 guint		*samples,
+							 guint		*latency_max,
+							 GError		**error);
@@ -33,6 +33,7 @@
 
 #include "fu-common.h"
 #include "fu-debug.h"
+#include "fu-device-changed-queue.h"
 #include "fu-device-private.h"
 #include "fu-engine.h"
 #include "fu-install-task.h"
@@ -48,6 +49,9 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC(PolkitSubject, g_object_unref)
 #endif /* HAVE_POLKIT_0_114 */
 #endif /* HAVE_POLKIT */
 
+#define FU_MAIN_QUERY_THREADS_MAX		4
+#define FU_MAIN_DEVICE_CHANGED_INTERVAL		100	/* ms */
+
 typedef enum {
 	FU_MAIN_MACHINE_KIND_PHYSICAL,
 	FU_MAIN_MACHINE_KIND_VIRTUAL,
@@ -61,6 +65,9 @@ typedef struct {
 	GMainLoop		*loop;
 	GFileMonitor		*argv0_monitor;
 	GHashTable		*sender_features;	/* sender:FwupdFeatureFlags */
+	GThreadPool		*query_pool;
+	guint			 query_filter_id;
+	FuDeviceChangedQueue	*devices_changed;
 #if GLIB_CHECK_VERSION(2,63,3)
 	GMemoryMonitor		*memory_monitor;
 #endif
@@ -111,6 +118,9 @@ fu_main_engine_device_added_cb (FuEngine *engine,
 	/* not yet connected */
 	if (priv->connection == NULL)
 		return;
+
+	/* send pending changes first so clients see the signals in order */
+	fu_device_changed_queue_flush (priv->devices_changed);
 	val = fwupd_device_to_variant (FWUPD_DEVICE (device));
 	g_dbus_connection_emit_signal (priv->connection,
 				       NULL,
@@ -120,6 +130,61 @@ fu_main_engine_device_added_cb (FuEngine *engine,
 				       g_variant_new_tuple (&val, 1), NULL);
 }
 
+/* emit one DeviceChanged per device with the latest state, and one
+ * DevicesChanged to each client that asked for the batched signal */
+static void
+fu_main_devices_changed_flush_cb (FuDeviceChangedQueue *queue,
+				  GPtrArray *devices,
+				  FuMainPrivate *priv)
+{
+	GHashTableIter iter;
+	gpointer key, value;
+	g_autoptr(GPtrArray) vals = NULL;
+
+	/* not yet connected */
+	if (priv->connection == NULL)
+		return;
+
+	/* broadcast to legacy clients */
+	vals = g_ptr_array_new_with_free_func ((GDestroyNotify) g_variant_unref);
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *device = g_ptr_array_index (devices, i);
+		GVariant *val = fwupd_device_to_variant (FWUPD_DEVICE (device));
+		g_ptr_array_add (vals, g_variant_ref_sink (val));
+		g_dbus_connection_emit_signal (priv->connection,
+					       NULL,
+					       FWUPD_DBUS_PATH,
+					       FWUPD_DBUS_INTERFACE,
+					       "DeviceChanged",
+					       g_variant_new_tuple (&val, 1), NULL);
+	}
+
+	/* unicast to each client that opted in */
+	g_hash_table_iter_init (&iter, priv->sender_features);
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		const gchar *sender = (const gchar *) key;
+		FwupdFeatureFlags *feature_flags = (FwupdFeatureFlags *) value;
+		GVariant *val;
+		g_autoptr(GError) error_local = NULL;
+
+		if ((*feature_flags & FWUPD_FEATURE_FLAG_DEVICES_CHANGED) == 0)
+			continue;
+		val = g_variant_new_array (G_VARIANT_TYPE ("a{sv}"),
+					   (GVariant * const *) vals->pdata,
+					   vals->len);
+		if (!g_dbus_connection_emit_signal (priv->connection,
+						    sender,
+						    FWUPD_DBUS_PATH,
+						    FWUPD_DBUS_INTERFACE,
+						    "DevicesChanged",
+						    g_variant_new_tuple (&val, 1),
+						    &error_local)) {
+			g_debug ("failed to send DevicesChanged to %s: %s",
+				 sender, error_local->message);
+		}
+	}
+}
+
 static void
 fu_main_engine_device_removed_cb (FuEngine *engine,
 				  FuDevice *device,
@@ -127,9 +192,15 @@ fu_main_engine_device_removed_cb (FuEngine *engine,
 {
 	GVariant *val;
 
+	/* a pending change is no longer interesting */
+	fu_device_changed_queue_remove (priv->devices_changed, device);
+
 	/* not yet connected */
 	if (priv->connection == NULL)
 		return;
+
+	/* send pending changes first so clients see the signals in order */
+	fu_device_changed_queue_flush (priv->devices_changed);
 	val = fwupd_device_to_variant (FWUPD_DEVICE (device));
 	g_dbus_connection_emit_signal (priv->connection,
 				       NULL,
@@ -144,18 +215,12 @@ fu_main_engine_device_changed_cb (FuEngine *engine,
 				  FuDevice *device,
 				  FuMainPrivate *priv)
 {
-	GVariant *val;
-
 	/* not yet connected */
 	if (priv->connection == NULL)
 		return;
-	val = fwupd_device_to_variant (FWUPD_DEVICE (device));
-	g_dbus_connection_emit_signal (priv->connection,
-				       NULL,
-				       FWUPD_DBUS_PATH,
-				       FWUPD_DBUS_INTERFACE,
-				       "DeviceChanged",
-				       g_variant_new_tuple (&val, 1), NULL);
+
+	/* only the final state of each device is sent */
+	fu_device_changed_queue_add (priv->devices_changed, device);
 }
 
 static void
@@ -172,6 +237,9 @@ fu_main_emit_property_changed (FuMainPrivate *priv,
 		return;
 	}
 
+	/* send pending changes first so clients see the signals in order */
+	fu_device_changed_queue_flush (priv->devices_changed);
+
 	/* build the dict */
 	g_variant_builder_init (&invalidated_builder, G_VARIANT_TYPE ("as"));
 	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
@@ -224,22 +292,23 @@ fu_main_engine_percentage_changed_cb (FuEngine *engine,
 				       g_variant_new_uint32 (percentage));
 }
 
-static FuEngineRequest *
-fu_main_create_request (FuMainPrivate *priv, const gchar *sender, GError **error)
+static void
+fu_main_engine_config_changed_cb (FuEngine *engine, FuMainPrivate *priv)
+{
+	fu_main_emit_property_changed (priv, "DownloadCacheSizeMax",
+				       g_variant_new_uint64 (fu_engine_get_download_cache_size_max (engine)));
+}
+
+/* this is safe to call from any thread */
+static gboolean
+fu_main_get_device_flags_for_sender (FuMainPrivate *priv,
+				     const gchar *sender,
+				     FwupdDeviceFlags *device_flags,
+				     GError **error)
 {
-	FwupdFeatureFlags *feature_flags;
-	FwupdDeviceFlags device_flags = FWUPD_DEVICE_FLAG_NONE;
 	uid_t calling_uid = 0;
-	g_autoptr(FuEngineRequest) request = fu_engine_request_new ();
 	g_autoptr(GVariant) value = NULL;
 
-	g_return_val_if_fail (sender != NULL, NULL);
-
-	/* did the client set the list of supported feature */
-	feature_flags = g_hash_table_lookup (priv->sender_features, sender);
-	if (feature_flags != NULL)
-		fu_engine_request_set_feature_flags (request, *feature_flags);
-
 	/* are we root and therefore trusted? */
 	value = g_dbus_proxy_call_sync (priv->proxy_uid,
 					"GetConnectionUnixUser",
@@ -250,11 +319,32 @@ fu_main_create_request (FuMainPrivate *priv, const gchar *sender, GError **error
 					error);
 	if (value == NULL) {
 		g_prefix_error (error, "failed to read user id of caller: ");
-		return NULL;
+		return FALSE;
 	}
 	g_variant_get (value, "(u)", &calling_uid);
+	*device_flags = FWUPD_DEVICE_FLAG_NONE;
 	if (calling_uid == 0)
-		device_flags |= FWUPD_DEVICE_FLAG_TRUSTED;
+		*device_flags |= FWUPD_DEVICE_FLAG_TRUSTED;
+	return TRUE;
+}
+
+static FuEngineRequest *
+fu_main_create_request (FuMainPrivate *priv, const gchar *sender, GError **error)
+{
+	FwupdFeatureFlags *feature_flags;
+	FwupdDeviceFlags device_flags = FWUPD_DEVICE_FLAG_NONE;
+	g_autoptr(FuEngineRequest) request = fu_engine_request_new ();
+
+	g_return_val_if_fail (sender != NULL, NULL);
+
+	/* did the client set the list of supported feature */
+	feature_flags = g_hash_table_lookup (priv->sender_features, sender);
+	if (feature_flags != NULL)
+		fu_engine_request_set_feature_flags (request, *feature_flags);
+
+	/* are we root and therefore trusted? */
+	if (!fu_main_get_device_flags_for_sender (priv, sender, &device_flags, error))
+		return NULL;
 	fu_engine_request_set_device_flags (request, device_flags);
 
 	/* success */
@@ -748,6 +838,7 @@ fu_main_authorize_install_queue (FuMainAuthHelper *helper_ref)
 				       helper->flags,
 				       &error);
 	priv->update_in_progress = FALSE;
+	fu_device_changed_queue_flush (priv->devices_changed);
 	if (priv->pending_sigterm)
 		g_main_loop_quit (priv->loop);
 	if (!ret) {
@@ -988,6 +1079,40 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 		g_dbus_method_invocation_return_value (invocation, val);
 		return;
 	}
+	if (g_strcmp0 (method_name, "GetDevicesSince") == 0) {
+		guint64 generation = 0;
+		guint64 generation_current;
+		GVariantBuilder builder_devices;
+		GVariantBuilder builder_removed;
+		g_autoptr(GPtrArray) devices = NULL;
+		g_autoptr(GPtrArray) removed = NULL;
+
+		g_variant_get (parameters, "(t)", &generation);
+		g_debug ("Called %s(%" G_GUINT64_FORMAT ")", method_name, generation);
+		devices = fu_engine_get_devices_since (priv->engine, generation, &removed, &error);
+		if (devices == NULL) {
+			g_dbus_method_invocation_return_gerror (invocation, error);
+			return;
+		}
+		generation_current = fu_engine_get_generation (priv->engine);
+		g_variant_builder_init (&builder_devices, G_VARIANT_TYPE ("aa{sv}"));
+		for (guint i = 0; i < devices->len; i++) {
+			FuDevice *device = g_ptr_array_index (devices, i);
+			FwupdDeviceFlags flags = fu_engine_request_get_device_flags (request);
+			g_variant_builder_add_value (&builder_devices,
+						     fwupd_device_to_variant_full (FWUPD_DEVICE (device),
+										   flags));
+		}
+		g_variant_builder_init (&builder_removed, G_VARIANT_TYPE ("as"));
+		for (guint i = 0; i < removed->len; i++) {
+			const gchar *device_id = g_ptr_array_index (removed, i);
+			g_variant_builder_add_value (&builder_removed, g_variant_new_string (device_id));
+		}
+		val = g_variant_new ("(taa{sv}as)", generation_current,
+				     &builder_devices, &builder_removed);
+		g_dbus_method_invocation_return_value (invocation, val);
+		return;
+	}
 	if (g_strcmp0 (method_name, "GetPlugins") == 0) {
 		g_debug ("Called %s()", method_name);
 		val = fu_main_plugin_array_to_variant (fu_engine_get_plugins (priv->engine));
@@ -1214,6 +1339,47 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 		g_dbus_method_invocation_return_value (invocation, val);
 		return;
 	}
+	if (g_strcmp0 (method_name, "GetAllUpgrades") == 0) {
+		GHashTableIter iter;
+		GVariantBuilder builder;
+		GVariantBuilder builder_errors;
+		gpointer key, value;
+		g_autoptr(GHashTable) errors = NULL;
+		g_autoptr(GHashTable) upgrades = NULL;
+		g_debug ("Called %s()", method_name);
+		upgrades = fu_engine_get_upgrades_all (priv->engine, request, &errors, &error);
+		if (upgrades == NULL) {
+			g_dbus_method_invocation_return_gerror (invocation, error);
+			return;
+		}
+		g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{saa{sv}}"));
+		g_hash_table_iter_init (&iter, upgrades);
+		while (g_hash_table_iter_next (&iter, &key, &value)) {
+			GPtrArray *releases = (GPtrArray *) value;
+			GVariantBuilder builder_rels;
+			g_variant_builder_init (&builder_rels, G_VARIANT_TYPE ("aa{sv}"));
+			for (guint i = 0; i < releases->len; i++) {
+				FwupdRelease *rel = g_ptr_array_index (releases, i);
+				g_variant_builder_add_value (&builder_rels,
+							     fwupd_release_to_variant (rel));
+			}
+			g_variant_builder_add (&builder, "{saa{sv}}",
+					       (const gchar *) key, &builder_rels);
+		}
+		g_variant_builder_init (&builder_errors, G_VARIANT_TYPE ("a{s(us)}"));
+		g_hash_table_iter_init (&iter, errors);
+		while (g_hash_table_iter_next (&iter, &key, &value)) {
+			GError *error_tmp = (GError *) value;
+			guint code = error_tmp->domain == FWUPD_ERROR ?
+					(guint) error_tmp->code : FWUPD_ERROR_INTERNAL;
+			g_variant_builder_add (&builder_errors, "{s(us)}",
+					       (const gchar *) key, code,
+					       error_tmp->message);
+		}
+		val = g_variant_new ("(a{saa{sv}}a{s(us)})", &builder, &builder_errors);
+		g_dbus_method_invocation_return_value (invocation, val);
+		return;
+	}
 	if (g_strcmp0 (method_name, "GetRemotes") == 0) {
 		g_autoptr(GPtrArray) remotes = NULL;
 		g_debug ("Called %s()", method_name);
@@ -1242,6 +1408,66 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 		g_dbus_method_invocation_return_value (invocation, val);
 		return;
 	}
+	if (g_strcmp0 (method_name, "GetHistoryFull") == 0) {
+		GVariant *prop_value;
+		const gchar *prop_key;
+		guint32 offset = 0;
+		guint32 limit = 0;
+		guint64 modified_min = 0;
+		guint64 modified_max = 0;
+		FwupdUpdateState update_state = FWUPD_UPDATE_STATE_UNKNOWN;
+		GVariantBuilder builder;
+		g_autofree gchar *device_id = NULL;
+		g_autoptr(GPtrArray) devices = NULL;
+		g_autoptr(GVariantIter) iter = NULL;
+
+		g_variant_get (parameters, "(uua{sv})", &offset, &limit, &iter);
+		g_debug ("Called %s(%u,%u)", method_name, offset, limit);
+		while (g_variant_iter_next (iter, "{&sv}", &prop_key, &prop_value)) {
+			g_debug ("got option %s", prop_key);
+			if (g_strcmp0 (prop_key, "device-id") == 0 &&
+			    g_variant_is_of_type (prop_value, G_VARIANT_TYPE_STRING)) {
+				g_free (device_id);
+				device_id = g_variant_dup_string (prop_value, NULL);
+			}
+			if (g_strcmp0 (prop_key, "update-state") == 0 &&
+			    g_variant_is_of_type (prop_value, G_VARIANT_TYPE_UINT32))
+				update_state = g_variant_get_uint32 (prop_value);
+			if (g_strcmp0 (prop_key, "modified-min") == 0 &&
+			    g_variant_is_of_type (prop_value, G_VARIANT_TYPE_UINT64))
+				modified_min = g_variant_get_uint64 (prop_value);
+			if (g_strcmp0 (prop_key, "modified-max") == 0 &&
+			    g_variant_is_of_type (prop_value, G_VARIANT_TYPE_UINT64))
+				modified_max = g_variant_get_uint64 (prop_value);
+			g_variant_unref (prop_value);
+		}
+		devices = fu_engine_get_history_full (priv->engine,
+						      device_id,
+						      update_state,
+						      modified_min,
+						      modified_max,
+						      offset,
+						      limit,
+						      &error);
+		if (devices == NULL) {
+			g_dbus_method_invocation_return_gerror (invocation, error);
+			return;
+		}
+
+		/* an empty page is valid */
+		g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
+		for (guint i = 0; i < devices->len; i++) {
+			FuDevice *device = g_ptr_array_index (devices, i);
+			FwupdDeviceFlags flags = fu_engine_request_get_device_flags (request);
+			g_variant_builder_add_value (&builder,
+						     fwupd_device_to_variant_full (FWUPD_DEVICE (device),
+										   flags));
+		}
+		val = g_variant_builder_end (&builder);
+		g_dbus_method_invocation_return_value (invocation,
+						       g_variant_new_tuple (&val, 1));
+		return;
+	}
 	if (g_strcmp0 (method_name, "GetHostSecurityAttrs") == 0) {
 		g_autoptr(FuSecurityAttrs) attrs = NULL;
 		g_debug ("Called %s()", method_name);
@@ -1520,13 +1746,16 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 	}
 	if (g_strcmp0 (method_name, "Verify") == 0) {
 		const gchar *device_id = NULL;
+		gboolean ret;
 		g_variant_get (parameters, "(&s)", &device_id);
 		g_debug ("Called %s(%s)", method_name, device_id);
 		if (!fu_main_device_id_valid (device_id, &error)) {
 			g_dbus_method_invocation_return_gerror (invocation, error);
 			return;
 		}
-		if (!fu_engine_verify (priv->engine, device_id, &error)) {
+		ret = fu_engine_verify (priv->engine, device_id, &error);
+		fu_device_changed_queue_flush (priv->devices_changed);
+		if (!ret) {
 			g_dbus_method_invocation_return_gerror (invocation, error);
 			return;
 		}
@@ -1717,6 +1946,9 @@ fu_main_daemon_get_property (GDBusConnection *connection_, const gchar *sender,
 	if (g_strcmp0 (property_name, "HostSecurityId") == 0)
 		return g_variant_new_string (fu_engine_get_host_security_id (priv->engine));
 
+	if (g_strcmp0 (property_name, "DownloadCacheSizeMax") == 0)
+		return g_variant_new_uint64 (fu_engine_get_download_cache_size_max (priv->engine));
+
 	if (g_strcmp0 (property_name, "Interactive") == 0)
 		return g_variant_new_boolean (isatty (fileno (stdout)) != 0);
 
@@ -1729,6 +1961,165 @@ fu_main_daemon_get_property (GDBusConnection *connection_, const gchar *sender,
 	return NULL;
 }
 
+typedef enum {
+	FU_MAIN_QUERY_KIND_DEVICES,
+	FU_MAIN_QUERY_KIND_REMOTES,
+	FU_MAIN_QUERY_KIND_HOST_SECURITY_ATTRS,
+} FuMainQueryKind;
+
+typedef struct {
+	FuMainPrivate		*priv;
+	FuMainQueryKind		 kind;
+	GDBusMessage		*message;
+	GPtrArray		*snapshot;		/* of GVariant */
+	GPtrArray		*snapshot_trusted;	/* (nullable) of GVariant */
+} FuMainQueryHelper;
+
+static void
+fu_main_query_helper_free (FuMainQueryHelper *helper)
+{
+	g_object_unref (helper->message);
+	if (helper->snapshot != NULL)
+		g_ptr_array_unref (helper->snapshot);
+	if (helper->snapshot_trusted != NULL)
+		g_ptr_array_unref (helper->snapshot_trusted);
+	g_free (helper);
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuMainQueryHelper, fu_main_query_helper_free)
+#pragma clang diagnostic pop
+
+static gboolean
+fu_main_query_idle_reset_cb (gpointer user_data)
+{
+	FuMainPrivate *priv = (FuMainPrivate *) user_data;
+	fu_engine_idle_reset (priv->engine);
+	return G_SOURCE_REMOVE;
+}
+
+/* runs in a worker thread, and only uses the immutable snapshots */
+static void
+fu_main_query_thread_cb (gpointer data, gpointer user_data)
+{
+	FuMainPrivate *priv = (FuMainPrivate *) user_data;
+	GPtrArray *snapshot;
+	GVariantBuilder builder;
+	const gchar *sender;
+	g_autoptr(FuMainQueryHelper) helper = (FuMainQueryHelper *) data;
+	g_autoptr(GDBusMessage) reply = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* activity */
+	g_idle_add (fu_main_query_idle_reset_cb, priv);
+
+	/* only devices are filtered for the caller */
+	snapshot = helper->snapshot;
+	sender = g_dbus_message_get_sender (helper->message);
+	g_debug ("Called %s() from worker thread",
+		 g_dbus_message_get_member (helper->message));
+	if (helper->kind == FU_MAIN_QUERY_KIND_DEVICES) {
+		FwupdDeviceFlags device_flags = FWUPD_DEVICE_FLAG_NONE;
+		if (!fu_main_get_device_flags_for_sender (priv, sender, &device_flags, &error)) {
+			g_autofree gchar *error_name = g_dbus_error_encode_gerror (error);
+			reply = g_dbus_message_new_method_error_literal (helper->message,
+									 error_name,
+									 error->message);
+		} else if (device_flags & FWUPD_DEVICE_FLAG_TRUSTED) {
+			snapshot = helper->snapshot_trusted;
+		}
+	}
+
+	/* build the same reply as fu_main_daemon_method_call() */
+	if (reply == NULL) {
+		g_variant_builder_init (&builder, G_VARIANT_TYPE_ARRAY);
+		for (guint i = 0; i < snapshot->len; i++)
+			g_variant_builder_add_value (&builder, g_ptr_array_index (snapshot, i));
+		reply = g_dbus_message_new_method_reply (helper->message);
+		g_dbus_message_set_body (reply, g_variant_new ("(aa{sv})", &builder));
+	}
+	if (!g_dbus_connection_send_message (priv->connection, reply,
+					     G_DBUS_SEND_MESSAGE_FLAGS_NONE,
+					     NULL, &error))
+		g_warning ("failed to send reply: %s", error->message);
+}
+
+/* read-only methods are answered from a worker thread when a snapshot is
+ * available, so that they do not wait for the main loop */
+static FuMainQueryHelper *
+fu_main_query_helper_new (FuMainPrivate *priv, GDBusMessage *message)
+{
+	const gchar *member = g_dbus_message_get_member (message);
+	GVariant *body = g_dbus_message_get_body (message);
+	g_autoptr(FuMainQueryHelper) helper = NULL;
+
+	/* not for us, or invalid */
+	if (g_dbus_message_get_message_type (message) != G_DBUS_MESSAGE_TYPE_METHOD_CALL)
+		return NULL;
+	if (g_strcmp0 (g_dbus_message_get_path (message), FWUPD_DBUS_PATH) != 0)
+		return NULL;
+	if (g_strcmp0 (g_dbus_message_get_interface (message), FWUPD_DBUS_INTERFACE) != 0)
+		return NULL;
+	if (body != NULL && g_strcmp0 (g_variant_get_type_string (body), "()") != 0)
+		return NULL;
+
+	helper = g_new0 (FuMainQueryHelper, 1);
+	helper->priv = priv;
+	helper->message = g_object_ref (message);
+	if (g_strcmp0 (member, "GetDevices") == 0) {
+		helper->kind = FU_MAIN_QUERY_KIND_DEVICES;
+		helper->snapshot = fu_engine_get_devices_snapshot (priv->engine,
+								   FWUPD_DEVICE_FLAG_NONE);
+		helper->snapshot_trusted = fu_engine_get_devices_snapshot (priv->engine,
+									   FWUPD_DEVICE_FLAG_TRUSTED);
+		if (helper->snapshot_trusted == NULL)
+			return NULL;
+	} else if (g_strcmp0 (member, "GetRemotes") == 0) {
+		helper->kind = FU_MAIN_QUERY_KIND_REMOTES;
+		helper->snapshot = fu_engine_get_remotes_snapshot (priv->engine);
+	} else if (g_strcmp0 (member, "GetHostSecurityAttrs") == 0) {
+		if (priv->machine_kind != FU_MAIN_MACHINE_KIND_PHYSICAL)
+			return NULL;
+		helper->kind = FU_MAIN_QUERY_KIND_HOST_SECURITY_ATTRS;
+		helper->snapshot = fu_engine_get_host_security_attrs_snapshot (priv->engine);
+	} else {
+		return NULL;
+	}
+
+	/* not built yet, or the main loop returns an error */
+	if (helper->snapshot == NULL || helper->snapshot->len == 0)
+		return NULL;
+	return g_steal_pointer (&helper);
+}
+
+/* runs in the GDBus worker thread, so must not block */
+static GDBusMessage *
+fu_main_query_filter_cb (GDBusConnection *connection,
+			 GDBusMessage *message,
+			 gboolean incoming,
+			 gpointer user_data)
+{
+	FuMainPrivate *priv = (FuMainPrivate *) user_data;
+	FuMainQueryHelper *helper;
+	g_autoptr(GError) error = NULL;
+
+	if (!incoming)
+		return message;
+	helper = fu_main_query_helper_new (priv, message);
+	if (helper == NULL)
+		return message;
+	if (!g_thread_pool_push (priv->query_pool, helper, &error)) {
+		g_warning ("failed to queue query: %s", error->message);
+		fu_main_query_helper_free (helper);
+		return message;
+	}
+
+	/* handled */
+	g_object_unref (message);
+	return NULL;
+}
+
 static void
 fu_main_on_bus_acquired_cb (GDBusConnection *connection,
 			    const gchar *name,
@@ -1768,6 +2159,18 @@ fu_main_on_bus_acquired_cb (GDBusConnection *connection,
 		g_warning ("cannot connect to DBus: %s", error->message);
 		return;
 	}
+
+	/* answer read-only queries without using the main loop */
+	priv->query_pool = g_thread_pool_new (fu_main_query_thread_cb, priv,
+					      FU_MAIN_QUERY_THREADS_MAX,
+					      FALSE, &error);
+	if (priv->query_pool == NULL) {
+		g_warning ("cannot create thread pool: %s", error->message);
+		return;
+	}
+	priv->query_filter_id = g_dbus_connection_add_filter (connection,
+							      fu_main_query_filter_cb,
+							      priv, NULL);
 }
 
 static void
@@ -1874,6 +2277,12 @@ fu_main_is_container (void)
 static void
 fu_main_private_free (FuMainPrivate *priv)
 {
+	if (priv->query_filter_id > 0)
+		g_dbus_connection_remove_filter (priv->connection, priv->query_filter_id);
+	if (priv->query_pool != NULL)
+		g_thread_pool_free (priv->query_pool, TRUE, TRUE);
+	if (priv->devices_changed != NULL)
+		g_object_unref (priv->devices_changed);
 	g_hash_table_unref (priv->sender_features);
 	if (priv->loop != NULL)
 		g_main_loop_unref (priv->loop);
@@ -1947,6 +2356,10 @@ main (int argc, char *argv[])
 	/* create new objects */
 	priv = g_new0 (FuMainPrivate, 1);
 	priv->sender_features = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	priv->devices_changed = fu_device_changed_queue_new (FU_MAIN_DEVICE_CHANGED_INTERVAL);
+	g_signal_connect (priv->devices_changed, "flush",
+			  G_CALLBACK (fu_main_devices_changed_flush_cb),
+			  priv);
 	priv->loop = g_main_loop_new (NULL, FALSE);
 
 	/* load engine */
@@ -1969,6 +2382,9 @@ main (int argc, char *argv[])
 	g_signal_connect (priv->engine, "percentage-changed",
 			  G_CALLBACK (fu_main_engine_percentage_changed_cb),
 			  priv);
+	g_signal_connect (priv->engine, "config-changed",
+			  G_CALLBACK (fu_main_engine_config_changed_cb),
+			  priv);
 	if (!fu_engine_load (priv->engine,
 			     FU_ENGINE_LOAD_FLAG_COLDPLUG |
 			     FU_ENGINE_LOAD_FLAG_HWINFO |
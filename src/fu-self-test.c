@@ -15,7 +15,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "fu-backend.h"
 #include "fu-config.h"
+#include "fu-device-changed-queue.h"
 #include "fu-device-list.h"
 #include "fu-device-private.h"
 #include "fu-engine.h"
@@ -115,20 +117,32 @@ fu_engine_generate_md_func (gconstpointer user_data)
 {
 	const gchar *tmp;
 	gboolean ret;
+	guint64 mtime;
+	guint32 mtime_usec;
+	g_autofree gchar *cabfn = NULL;
+	g_autofree gchar *cachedir = NULL;
 	g_autofree gchar *filename = NULL;
+	g_autofree gchar *metainfodir = NULL;
 	g_autoptr(FuDevice) device = fu_device_new ();
 	g_autoptr(FuEngine) engine = fu_engine_new (FU_APP_FLAGS_NONE);
+	g_autoptr(FuEngine) engine2 = fu_engine_new (FU_APP_FLAGS_NONE);
 	g_autoptr(GBytes) data = NULL;
 	g_autoptr(GError) error = NULL;
+	g_autoptr(GFile) file = NULL;
+	g_autoptr(GFileInfo) info = NULL;
+	g_autoptr(GFileInfo) info2 = NULL;
+	g_autoptr(GPtrArray) metainfos = NULL;
 	g_autoptr(XbNode) component = NULL;
+	g_autoptr(XbNode) component2 = NULL;
 
 	/* put cab file somewhere we can parse it */
 	filename = g_build_filename (TESTDATADIR_DST, "colorhug", "colorhug-als-3.0.2.cab", NULL);
 	data = fu_common_get_contents_bytes (filename, &error);
 	g_assert_no_error (error);
 	g_assert_nonnull (data);
-	ret = fu_common_set_contents_bytes ("/tmp/fwupd-self-test/var/cache/fwupd/foo.cab",
-					    data, &error);
+	cachedir = fu_common_get_path (FU_PATH_KIND_CACHEDIR_PKG);
+	cabfn = g_build_filename (cachedir, "foo.cab", NULL);
+	ret = fu_common_set_contents_bytes (cabfn, data, &error);
 	g_assert_no_error (error);
 	g_assert (ret);
 
@@ -151,6 +165,37 @@ fu_engine_generate_md_func (gconstpointer user_data)
 	g_assert_cmpstr (tmp, !=, NULL);
 	tmp = xb_node_query_text (component, "releases/release/checksum[@target='content']", NULL);
 	g_assert_cmpstr (tmp, ==, NULL);
+
+	/* the extracted metainfo was saved */
+	metainfodir = g_build_filename (cachedir, "metainfo", "directory", NULL);
+	metainfos = fu_common_get_files_recursive (metainfodir, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (metainfos);
+	g_assert_cmpint (metainfos->len, >=, 1);
+	file = g_file_new_for_path (g_ptr_array_index (metainfos, 0));
+	info = g_file_query_info (file,
+				  G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+				  G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+				  G_FILE_QUERY_INFO_NONE, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (info);
+	mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+	mtime_usec = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+
+	/* ...and is reused rather than extracted again the next time */
+	ret = fu_engine_load (engine2, FU_ENGINE_LOAD_FLAG_REMOTES, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+	component2 = fu_engine_get_component_by_guids (engine2, device);
+	g_assert_nonnull (component2);
+	info2 = g_file_query_info (file,
+				   G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+				   G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+				   G_FILE_QUERY_INFO_NONE, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (info2);
+	g_assert_cmpint (g_file_info_get_attribute_uint64 (info2, G_FILE_ATTRIBUTE_TIME_MODIFIED), ==, mtime);
+	g_assert_cmpint (g_file_info_get_attribute_uint32 (info2, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC), ==, mtime_usec);
 }
 
 static void
@@ -564,6 +609,14 @@ fu_engine_requirements_func (gconstpointer user_data)
 					    &error);
 	g_assert_no_error (error);
 	g_assert (ret);
+
+	/* the compiled requirements are reused with the new runtime version */
+	fu_engine_add_runtime_version (engine, "org.test.dummy", "1.2.2");
+	ret = fu_engine_check_requirements (engine, request, task,
+					    FWUPD_INSTALL_FLAG_NONE,
+					    &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert (!ret);
 }
 
 static void
@@ -943,6 +996,228 @@ fu_engine_requirements_parent_device_func (gconstpointer user_data)
 	g_assert (ret);
 }
 
+static void
+fu_engine_devices_since_func (gconstpointer user_data)
+{
+	guint64 generation;
+	g_autoptr(FuDevice) device1 = fu_device_new ();
+	g_autoptr(FuDevice) device2 = fu_device_new ();
+	g_autoptr(FuEngine) engine = fu_engine_new (FU_APP_FLAGS_NONE);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GPtrArray) removed = NULL;
+	g_autoptr(XbSilo) silo_empty = xb_silo_new ();
+
+	/* no metadata in daemon */
+	fu_engine_set_silo (engine, silo_empty);
+
+	/* add two devices */
+	fu_device_set_id (device1, "id1");
+	fu_device_set_plugin (device1, "test");
+	fu_device_add_vendor_id (device1, "USB:FFFF");
+	fu_device_set_protocol (device1, "com.acme");
+	fu_device_add_instance_id (device1, "GUID1");
+	fu_device_convert_instance_ids (device1);
+	fu_engine_add_device (engine, device1);
+	fu_device_set_id (device2, "id2");
+	fu_device_set_plugin (device2, "test");
+	fu_device_add_vendor_id (device2, "USB:FFFF");
+	fu_device_set_protocol (device2, "com.acme");
+	fu_device_add_instance_id (device2, "GUID2");
+	fu_device_convert_instance_ids (device2);
+	fu_engine_add_device (engine, device2);
+
+	/* everything is returned for the initial query */
+	devices = fu_engine_get_devices_since (engine, 0, &removed, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (devices);
+	g_assert_cmpint (devices->len, ==, 2);
+	g_assert_cmpint (removed->len, ==, 0);
+	g_clear_pointer (&devices, g_ptr_array_unref);
+	g_clear_pointer (&removed, g_ptr_array_unref);
+
+	/* nothing changed */
+	generation = fu_engine_get_generation (engine);
+	devices = fu_engine_get_devices_since (engine, generation, &removed, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (devices);
+	g_assert_cmpint (devices->len, ==, 0);
+	g_assert_cmpint (removed->len, ==, 0);
+	g_clear_pointer (&devices, g_ptr_array_unref);
+	g_clear_pointer (&removed, g_ptr_array_unref);
+
+	/* change one property */
+	fu_device_add_flag (device1, FWUPD_DEVICE_FLAG_REQUIRE_AC);
+	devices = fu_engine_get_devices_since (engine, generation, &removed, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (devices);
+	g_assert_cmpint (devices->len, ==, 1);
+	g_assert_true (g_ptr_array_index (devices, 0) == device1);
+	g_assert_cmpint (removed->len, ==, 0);
+	g_clear_pointer (&devices, g_ptr_array_unref);
+	g_clear_pointer (&removed, g_ptr_array_unref);
+
+	/* change a property that does not emit a notification */
+	generation = fu_engine_get_generation (engine);
+	fu_device_set_version_format (device2, FWUPD_VERSION_FORMAT_PLAIN);
+	fu_device_set_version (device2, "1.2.3");
+	devices = fu_engine_get_devices_since (engine, generation, &removed, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (devices);
+	g_assert_cmpint (devices->len, ==, 1);
+	g_assert_true (g_ptr_array_index (devices, 0) == device2);
+	g_assert_cmpint (removed->len, ==, 0);
+	g_clear_pointer (&devices, g_ptr_array_unref);
+	g_clear_pointer (&removed, g_ptr_array_unref);
+
+	/* progress and status are transient */
+	generation = fu_engine_get_generation (engine);
+	fu_device_set_status (device1, FWUPD_STATUS_DEVICE_WRITE);
+	fu_device_set_progress (device1, 50);
+	devices = fu_engine_get_devices_since (engine, generation, &removed, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (devices);
+	g_assert_cmpint (devices->len, ==, 0);
+	g_assert_cmpint (fu_engine_get_generation (engine), ==, generation);
+	g_clear_pointer (&devices, g_ptr_array_unref);
+	g_clear_pointer (&removed, g_ptr_array_unref);
+
+	/* removals from a previous daemon instance are not known */
+	devices = fu_engine_get_devices_since (engine, 1, &removed, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null (devices);
+}
+
+static void
+fu_engine_snapshot_func (gconstpointer user_data)
+{
+	g_autoptr(FuDevice) device1 = fu_device_new ();
+	g_autoptr(FuDevice) device2 = fu_device_new ();
+	g_autoptr(FuEngine) engine = fu_engine_new (FU_APP_FLAGS_NONE);
+	g_autoptr(GPtrArray) snapshot = NULL;
+	g_autoptr(XbSilo) silo_empty = xb_silo_new ();
+
+	/* no metadata in daemon */
+	fu_engine_set_silo (engine, silo_empty);
+
+	/* not published until idle */
+	fu_device_set_id (device1, "id1");
+	fu_device_set_plugin (device1, "test");
+	fu_device_add_vendor_id (device1, "USB:FFFF");
+	fu_device_set_protocol (device1, "com.acme");
+	fu_device_add_instance_id (device1, "GUID1");
+	fu_device_convert_instance_ids (device1);
+	fu_engine_add_device (engine, device1);
+	snapshot = fu_engine_get_devices_snapshot (engine, FWUPD_DEVICE_FLAG_NONE);
+	g_assert_null (snapshot);
+	while (g_main_context_iteration (NULL, FALSE));
+	snapshot = fu_engine_get_devices_snapshot (engine, FWUPD_DEVICE_FLAG_NONE);
+	g_assert_nonnull (snapshot);
+	g_assert_cmpint (snapshot->len, ==, 1);
+	g_clear_pointer (&snapshot, g_ptr_array_unref);
+	snapshot = fu_engine_get_devices_snapshot (engine, FWUPD_DEVICE_FLAG_TRUSTED);
+	g_assert_nonnull (snapshot);
+	g_assert_cmpint (snapshot->len, ==, 1);
+	g_clear_pointer (&snapshot, g_ptr_array_unref);
+
+	/* adding a device invalidates the old snapshot */
+	fu_device_set_id (device2, "id2");
+	fu_device_set_plugin (device2, "test");
+	fu_device_add_vendor_id (device2, "USB:FFFF");
+	fu_device_set_protocol (device2, "com.acme");
+	fu_device_add_instance_id (device2, "GUID2");
+	fu_device_convert_instance_ids (device2);
+	fu_engine_add_device (engine, device2);
+	snapshot = fu_engine_get_devices_snapshot (engine, FWUPD_DEVICE_FLAG_NONE);
+	g_assert_null (snapshot);
+	while (g_main_context_iteration (NULL, FALSE));
+	snapshot = fu_engine_get_devices_snapshot (engine, FWUPD_DEVICE_FLAG_NONE);
+	g_assert_nonnull (snapshot);
+	g_assert_cmpint (snapshot->len, ==, 2);
+	g_clear_pointer (&snapshot, g_ptr_array_unref);
+
+	/* so does a setter that does not emit a notification */
+	fu_device_set_summary (device2, "Changed");
+	snapshot = fu_engine_get_devices_snapshot (engine, FWUPD_DEVICE_FLAG_NONE);
+	g_assert_null (snapshot);
+	while (g_main_context_iteration (NULL, FALSE));
+	snapshot = fu_engine_get_devices_snapshot (engine, FWUPD_DEVICE_FLAG_NONE);
+	g_assert_nonnull (snapshot);
+	g_clear_pointer (&snapshot, g_ptr_array_unref);
+
+	/* the transient progress keeps the old snapshot */
+	fu_device_set_progress (device2, 50);
+	snapshot = fu_engine_get_devices_snapshot (engine, FWUPD_DEVICE_FLAG_NONE);
+	g_assert_nonnull (snapshot);
+}
+
+static void
+fu_engine_percentage_changed_cb (FuEngine *engine, guint percentage, gpointer user_data)
+{
+	GArray *percentages = (GArray *) user_data;
+	g_array_append_val (percentages, percentage);
+}
+
+static void
+fu_engine_percentage_rate_func (gconstpointer user_data)
+{
+	g_autoptr(FuDevice) device = fu_device_new ();
+	g_autoptr(FuEngine) engine = fu_engine_new (FU_APP_FLAGS_NONE);
+	g_autoptr(GArray) percentages = g_array_new (FALSE, FALSE, sizeof(guint));
+	g_autoptr(XbSilo) silo_empty = xb_silo_new ();
+
+	/* no metadata in daemon */
+	fu_engine_set_silo (engine, silo_empty);
+	g_signal_connect (engine, "percentage-changed",
+			  G_CALLBACK (fu_engine_percentage_changed_cb),
+			  percentages);
+
+	fu_device_set_id (device, "id1");
+	fu_device_set_plugin (device, "test");
+	fu_device_add_vendor_id (device, "USB:FFFF");
+	fu_device_set_protocol (device, "com.acme");
+	fu_device_add_instance_id (device, "GUID1");
+	fu_device_convert_instance_ids (device);
+	fu_engine_add_device (engine, device);
+	fu_device_set_status (device, FWUPD_STATUS_DEVICE_WRITE);
+
+	/* a fast write sends far fewer values, but always the first and last */
+	for (guint i = 1; i <= 100; i++)
+		fu_device_set_progress (device, i);
+	g_assert_cmpint (percentages->len, >=, 2);
+	g_assert_cmpint (percentages->len, <, 10);
+	g_assert_cmpint (g_array_index (percentages, guint, 0), ==, 1);
+	g_assert_cmpint (g_array_index (percentages, guint, percentages->len - 1), ==, 100);
+
+	/* a plugin blocking the main loop still sends each value that is due */
+	g_array_set_size (percentages, 0);
+	for (guint i = 1; i <= 3; i++) {
+		g_usleep (150 * 1000);
+		fu_device_set_progress (device, i * 10);
+	}
+	g_assert_cmpint (percentages->len, ==, 3);
+	g_assert_cmpint (g_array_index (percentages, guint, 2), ==, 30);
+
+	/* the pending value is sent before the status changes */
+	g_array_set_size (percentages, 0);
+	fu_device_set_progress (device, 50);
+	fu_device_set_progress (device, 51);
+	g_assert_cmpint (percentages->len, ==, 0);
+	fu_device_set_status (device, FWUPD_STATUS_DEVICE_VERIFY);
+	g_assert_cmpint (percentages->len, ==, 1);
+	g_assert_cmpint (g_array_index (percentages, guint, 0), ==, 51);
+
+	/* the latest pending value is sent when the interval has passed */
+	g_array_set_size (percentages, 0);
+	fu_device_set_progress (device, 60);
+	fu_device_set_progress (device, 61);
+	g_assert_cmpint (percentages->len, ==, 0);
+	while (percentages->len == 0)
+		g_main_context_iteration (NULL, TRUE);
+	g_assert_cmpint (percentages->len, ==, 1);
+	g_assert_cmpint (g_array_index (percentages, guint, 0), ==, 61);
+}
+
 static void
 fu_engine_device_priority_func (gconstpointer user_data)
 {
@@ -1286,6 +1561,10 @@ fu_engine_downgrade_func (gconstpointer user_data)
 	g_autoptr(GPtrArray) releases = NULL;
 	g_autoptr(GPtrArray) releases_up = NULL;
 	g_autoptr(GPtrArray) remotes = NULL;
+	g_autoptr(GPtrArray) releases_cached = NULL;
+	g_autoptr(GHashTable) upgrades_all = NULL;
+	g_autoptr(GHashTable) upgrades_errors = NULL;
+	GPtrArray *releases_all;
 	g_autoptr(XbSilo) silo_empty = xb_silo_new ();
 
 	/* ensure empty tree */
@@ -1438,6 +1717,43 @@ fu_engine_downgrade_func (gconstpointer user_data)
 	rel = FWUPD_RELEASE (g_ptr_array_index (releases_up, 1));
 	g_assert_cmpstr (fwupd_release_get_version (rel), ==, "1.2.4");
 
+	/* a second query with the same inputs is served from the cache */
+	releases_cached = fu_engine_get_upgrades (engine,
+						  request,
+						  fu_device_get_id (device),
+						  &error);
+	g_assert_no_error (error);
+	g_assert (releases_cached != NULL);
+	g_assert_cmpint (releases_cached->len, ==, 2);
+	rel = FWUPD_RELEASE (g_ptr_array_index (releases_cached, 0));
+	g_assert (rel != g_ptr_array_index (releases_up, 0));
+	g_assert_cmpstr (fwupd_release_get_version (rel), ==, "1.2.5");
+
+	/* modifying the returned release does not change the cache */
+	fwupd_release_set_update_message (rel, "Modified by the caller");
+	g_clear_pointer (&releases_cached, g_ptr_array_unref);
+	releases_cached = fu_engine_get_upgrades (engine,
+						  request,
+						  fu_device_get_id (device),
+						  &error);
+	g_assert_no_error (error);
+	g_assert (releases_cached != NULL);
+	rel = FWUPD_RELEASE (g_ptr_array_index (releases_cached, 0));
+	g_assert_cmpstr (fwupd_release_get_update_message (rel), ==, NULL);
+
+	/* upgrades for all devices in one call match the per-device results */
+	upgrades_all = fu_engine_get_upgrades_all (engine, request, &upgrades_errors, &error);
+	g_assert_no_error (error);
+	g_assert (upgrades_all != NULL);
+	g_assert (upgrades_errors != NULL);
+	g_assert_cmpint (g_hash_table_size (upgrades_all), ==, 1);
+	g_assert_cmpint (g_hash_table_size (upgrades_errors), ==, 0);
+	releases_all = g_hash_table_lookup (upgrades_all, fu_device_get_id (device));
+	g_assert (releases_all != NULL);
+	g_assert_cmpint (releases_all->len, ==, 2);
+	rel = FWUPD_RELEASE (g_ptr_array_index (releases_all, 0));
+	g_assert_cmpstr (fwupd_release_get_version (rel), ==, "1.2.5");
+
 	/* downgrades */
 	releases_dg = fu_engine_get_downgrades (engine,
 						request,
@@ -2010,6 +2326,71 @@ fu_device_list_delay_func (gconstpointer user_data)
 	g_assert_cmpint (changed_cnt, ==, 1);
 }
 
+static void
+_device_changed_queue_flush_cb (FuDeviceChangedQueue *queue,
+				GPtrArray *devices,
+				gpointer user_data)
+{
+	GString *str = (GString *) user_data;
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *device = g_ptr_array_index (devices, i);
+		g_string_append (str, fu_device_get_logical_id (device));
+	}
+	g_string_append (str, ";");
+	fu_test_loop_quit ();
+}
+
+static void
+fu_device_changed_queue_func (gconstpointer user_data)
+{
+	g_autoptr(FuDevice) device1 = fu_device_new ();
+	g_autoptr(FuDevice) device2 = fu_device_new ();
+	g_autoptr(FuDevice) device3 = fu_device_new ();
+	g_autoptr(FuDeviceChangedQueue) queue = fu_device_changed_queue_new (100);
+	g_autoptr(GString) str = g_string_new (NULL);
+
+	g_signal_connect (queue, "flush",
+			  G_CALLBACK (_device_changed_queue_flush_cb),
+			  str);
+	fu_device_set_id (device1, "device1");
+	fu_device_set_logical_id (device1, "1");
+	fu_device_set_id (device2, "device2");
+	fu_device_set_logical_id (device2, "2");
+	fu_device_set_id (device3, "device3");
+	fu_device_set_logical_id (device3, "3");
+
+	/* nothing sent recently, so sent straight away */
+	fu_device_changed_queue_add (queue, device1);
+	g_assert_cmpstr (str->str, ==, "1;");
+	g_string_truncate (str, 0);
+
+	/* only the last change of each device is kept, in order */
+	fu_device_changed_queue_add (queue, device1);
+	fu_device_changed_queue_add (queue, device2);
+	fu_device_changed_queue_add (queue, device3);
+	fu_device_changed_queue_add (queue, device1);
+	g_assert_cmpstr (str->str, ==, "");
+
+	/* removed devices are never sent */
+	fu_device_changed_queue_remove (queue, device3);
+
+	/* flushed before any other signal */
+	fu_device_changed_queue_flush (queue);
+	g_assert_cmpstr (str->str, ==, "21;");
+	g_string_truncate (str, 0);
+
+	/* nothing pending */
+	fu_device_changed_queue_flush (queue);
+	g_assert_cmpstr (str->str, ==, "");
+
+	/* sent from the main loop when the interval has passed */
+	fu_device_changed_queue_add (queue, device3);
+	g_assert_cmpstr (str->str, ==, "");
+	fu_test_loop_run_with_timeout (1000);
+	fu_test_loop_quit ();
+	g_assert_cmpstr (str->str, ==, "3;");
+}
+
 typedef struct {
 	FuDevice	*device_new;
 	FuDevice	*device_old;
@@ -2041,6 +2422,7 @@ fu_device_list_replug_auto_func (gconstpointer user_data)
 	g_autoptr(FuDevice) parent = fu_device_new ();
 	g_autoptr(FuDeviceList) device_list = fu_device_list_new ();
 	g_autoptr(GError) error = NULL;
+	guint latency = 0;
 	FuDeviceListReplugHelper helper;
 
 	/* parent */
@@ -2070,26 +2452,29 @@ fu_device_list_replug_auto_func (gconstpointer user_data)
 	g_assert_no_error (error);
 	g_assert (ret);
 
-	/* waiting */
+	/* waiting, and returns as soon as the device is added back */
 	helper.device_old = device1;
 	helper.device_new = device2;
 	helper.device_list = device_list;
 	g_timeout_add (100, fu_device_list_remove_cb, &helper);
 	g_timeout_add (200, fu_device_list_add_cb, &helper);
 	fu_device_add_flag (device1, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG);
-	ret = fu_device_list_wait_for_replug (device_list, device1, &error);
+	ret = fu_device_list_wait_for_replug_full (device_list, device1, 0, &latency, &error);
 	g_assert_no_error (error);
 	g_assert (ret);
 	g_assert_false (fu_device_has_flag (device1, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG));
+	g_assert_cmpint (latency, >=, 100);
+	g_assert_cmpint (latency, <, FU_DEVICE_REMOVE_DELAY_RE_ENUMERATE);
 
 	/* check device2 now has parent too */
 	g_assert (fu_device_get_parent (device2) == parent);
 
-	/* waiting, failed */
+	/* waiting, failed, with the time waited still returned */
 	fu_device_add_flag (device2, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG);
-	ret = fu_device_list_wait_for_replug (device_list, device2, &error);
+	ret = fu_device_list_wait_for_replug_full (device_list, device2, 0, &latency, &error);
 	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
 	g_assert (!ret);
+	g_assert_cmpint (latency, >=, fu_device_get_remove_delay (device2));
 	g_assert_true (fu_device_has_flag (device1, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG));
 }
 
@@ -2628,6 +3013,8 @@ fu_history_func (gconstpointer user_data)
 	FwupdRelease *release;
 	g_autoptr(FuDevice) device_found = NULL;
 	g_autoptr(FuHistory) history = NULL;
+	guint latency_max = 0;
+	guint samples = 0;
 	g_autoptr(GPtrArray) approved_firmware = NULL;
 	g_autofree gchar *dirname = NULL;
 	g_autofree gchar *filename = NULL;
@@ -2736,6 +3123,107 @@ fu_history_func (gconstpointer user_data)
 	g_assert_cmpint (approved_firmware->len, ==, 2);
 	g_assert_cmpstr (g_ptr_array_index (approved_firmware, 0), ==, "foo");
 	g_assert_cmpstr (g_ptr_array_index (approved_firmware, 1), ==, "bar");
+
+	/* replug latency */
+	ret = fu_history_get_replug_latency (history, "self-test", NULL, NULL, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_false (ret);
+	g_clear_error (&error);
+	ret = fu_history_add_replug_latency (history, "self-test", 300, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = fu_history_add_replug_latency (history, "self-test", 500, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = fu_history_add_replug_latency (history, "self-test", 400, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = fu_history_get_replug_latency (history, "self-test", &samples, &latency_max, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (samples, ==, 3);
+	g_assert_cmpint (latency_max, ==, 500);
+}
+
+static void
+fu_history_paged_func (gconstpointer user_data)
+{
+	gboolean ret;
+	g_autoptr(FuHistory) history = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+	g_autofree gchar *dirname = NULL;
+	g_autofree gchar *filename = NULL;
+
+	/* delete the database */
+	dirname = fu_common_get_path (FU_PATH_KIND_LOCALSTATEDIR_PKG);
+	if (!g_file_test (dirname, G_FILE_TEST_IS_DIR))
+		return;
+	filename = g_build_filename (dirname, "pending.db", NULL);
+	g_unlink (filename);
+
+	/* add some devices with increasing modification times */
+	history = fu_history_new ();
+	for (guint i = 0; i < 10; i++) {
+		g_autofree gchar *id = g_strdup_printf ("self-test-%u", i);
+		g_autoptr(FuDevice) device = fu_device_new ();
+		g_autoptr(FwupdRelease) release = fwupd_release_new ();
+		fu_device_set_id (device, id);
+		fu_device_set_name (device, "ColorHug");
+		fu_device_set_update_state (device, i % 2 == 0 ?
+						    FWUPD_UPDATE_STATE_SUCCESS :
+						    FWUPD_UPDATE_STATE_FAILED);
+		fu_device_set_created (device, 100);
+		fu_device_set_modified (device, 1000 + i);
+		fwupd_release_set_version (release, "1.2.3");
+		ret = fu_history_add_device (history, device, release, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+	}
+
+	/* get a page */
+	devices = fu_history_get_devices_full (history, NULL,
+					       FWUPD_UPDATE_STATE_UNKNOWN,
+					       0, 0, 2, 3, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (devices);
+	g_assert_cmpint (devices->len, ==, 3);
+	g_assert_cmpint (fu_device_get_modified (g_ptr_array_index (devices, 0)), ==, 1002);
+	g_assert_cmpint (fu_device_get_modified (g_ptr_array_index (devices, 2)), ==, 1004);
+	g_clear_pointer (&devices, g_ptr_array_unref);
+
+	/* filter by state and time range */
+	devices = fu_history_get_devices_full (history, NULL,
+					       FWUPD_UPDATE_STATE_FAILED,
+					       1003, 1007, 0, 0, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (devices);
+	g_assert_cmpint (devices->len, ==, 3);
+	g_clear_pointer (&devices, g_ptr_array_unref);
+
+	/* past the end is not an error */
+	devices = fu_history_get_devices_full (history, NULL,
+					       FWUPD_UPDATE_STATE_UNKNOWN,
+					       0, 0, 100, 10, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (devices);
+	g_assert_cmpint (devices->len, ==, 0);
+	g_clear_pointer (&devices, g_ptr_array_unref);
+
+	/* only keep the newest entries */
+	ret = fu_history_prune (history, 0, 4, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	devices = fu_history_get_devices (history, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (devices);
+	g_assert_cmpint (devices->len, ==, 4);
+	g_assert_cmpint (fu_device_get_modified (g_ptr_array_index (devices, 0)), ==, 1006);
+
+	/* reclaim the space from the removed entries */
+	ret = fu_history_vacuum (history, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
 }
 
 static GBytes *
@@ -2974,6 +3462,112 @@ fu_security_attr_func (gconstpointer user_data)
 	}
 }
 
+#define FU_TYPE_SELF_TEST_BACKEND (fu_self_test_backend_get_type ())
+G_DECLARE_FINAL_TYPE (FuSelfTestBackend, fu_self_test_backend, FU, SELF_TEST_BACKEND, FuBackend)
+
+struct _FuSelfTestBackend {
+	FuBackend		 parent_instance;
+	gint			 prefetched;	/* atomic */
+};
+
+G_DEFINE_TYPE (FuSelfTestBackend, fu_self_test_backend, FU_TYPE_BACKEND)
+
+static gboolean
+fu_self_test_backend_prefetch (FuBackend *backend, FuDevice *device, GError **error)
+{
+	FuSelfTestBackend *self = FU_SELF_TEST_BACKEND (backend);
+	g_atomic_int_inc (&self->prefetched);
+	return TRUE;
+}
+
+static void
+fu_self_test_backend_init (FuSelfTestBackend *self)
+{
+}
+
+static void
+fu_self_test_backend_class_init (FuSelfTestBackendClass *klass)
+{
+	FuBackendClass *klass_backend = FU_BACKEND_CLASS (klass);
+	klass_backend->prefetch = fu_self_test_backend_prefetch;
+}
+
+#define FU_TYPE_SELF_TEST_DEVICE (fu_self_test_device_get_type ())
+G_DECLARE_FINAL_TYPE (FuSelfTestDevice, fu_self_test_device, FU, SELF_TEST_DEVICE, FuDevice)
+
+struct _FuSelfTestDevice {
+	FuDevice		 parent_instance;
+	GThread			*thread;	/* no-ref, of the probe */
+};
+
+G_DEFINE_TYPE (FuSelfTestDevice, fu_self_test_device, FU_TYPE_DEVICE)
+
+static gboolean
+fu_self_test_device_probe (FuDevice *device, GError **error)
+{
+	FuSelfTestDevice *self = FU_SELF_TEST_DEVICE (device);
+	g_autofree gchar *instance_id = NULL;
+	self->thread = g_thread_self ();
+	instance_id = g_strdup_printf ("SELFTEST\\%s", fu_device_get_physical_id (device));
+	fu_device_add_instance_id (device, instance_id);
+	return TRUE;
+}
+
+static void
+fu_self_test_device_init (FuSelfTestDevice *self)
+{
+}
+
+static void
+fu_self_test_device_class_init (FuSelfTestDeviceClass *klass)
+{
+	FuDeviceClass *klass_device = FU_DEVICE_CLASS (klass);
+	klass_device->probe = fu_self_test_device_probe;
+}
+
+static void
+fu_backend_devices_added_cb (FuBackend *backend, FuDevice *device, gpointer user_data)
+{
+	GPtrArray *devices = (GPtrArray *) user_data;
+	g_autoptr(GError) error = NULL;
+
+	/* like the engine */
+	g_assert_true (fu_device_probe (device, &error));
+	g_assert_no_error (error);
+	g_ptr_array_add (devices, g_object_ref (device));
+}
+
+static void
+fu_backend_devices_added_func (gconstpointer user_data)
+{
+	g_autoptr(FuBackend) backend = g_object_new (FU_TYPE_SELF_TEST_BACKEND, "name", "test", NULL);
+	g_autoptr(GPtrArray) devices = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_autoptr(GPtrArray) devices_added = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+
+	g_signal_connect (backend, "device-added",
+			  G_CALLBACK (fu_backend_devices_added_cb),
+			  devices_added);
+	for (guint i = 0; i < 32; i++) {
+		g_autoptr(FuDevice) device = g_object_new (FU_TYPE_SELF_TEST_DEVICE, NULL);
+		g_autofree gchar *physical_id = g_strdup_printf ("dev%02u", i);
+		fu_device_set_physical_id (device, physical_id);
+		g_ptr_array_add (devices, g_steal_pointer (&device));
+	}
+
+	/* prefetched in parallel, but probed and added in the original order */
+	fu_backend_devices_added (backend, devices);
+	g_assert_cmpint (g_atomic_int_get (&FU_SELF_TEST_BACKEND (backend)->prefetched), ==, devices->len);
+	g_assert_cmpint (devices_added->len, ==, devices->len);
+	for (guint i = 0; i < devices->len; i++) {
+		FuSelfTestDevice *device = g_ptr_array_index (devices, i);
+		g_autofree gchar *instance_id = NULL;
+		g_assert (g_ptr_array_index (devices_added, i) == device);
+		g_assert (device->thread == g_thread_self ());
+		instance_id = g_strdup_printf ("SELFTEST\\dev%02u", i);
+		g_assert_true (fu_device_has_instance_id (FU_DEVICE (device), instance_id));
+	}
+}
+
 static void
 fu_memcpy_func (gconstpointer user_data)
 {
@@ -3156,10 +3750,14 @@ main (int argc, char **argv)
 			      fu_memcpy_func);
 	g_test_add_data_func ("/fwupd/security-attr", self,
 			      fu_security_attr_func);
+	g_test_add_data_func ("/fwupd/backend{devices-added}", self,
+			      fu_backend_devices_added_func);
 	g_test_add_data_func ("/fwupd/device-list", self,
 			      fu_device_list_func);
 	g_test_add_data_func ("/fwupd/device-list{delay}", self,
 			      fu_device_list_delay_func);
+	g_test_add_data_func ("/fwupd/device-changed-queue", self,
+			      fu_device_changed_queue_func);
 	g_test_add_data_func ("/fwupd/device-list{compatible}", self,
 			      fu_device_list_compatible_func);
 	g_test_add_data_func ("/fwupd/device-list{remove-chain}", self,
@@ -3218,6 +3816,12 @@ main (int argc, char **argv)
 			      fu_engine_requirements_version_format_func);
 	g_test_add_data_func ("/fwupd/engine{device-auto-parent}", self,
 			      fu_engine_device_parent_func);
+	g_test_add_data_func ("/fwupd/engine{devices-since}", self,
+			      fu_engine_devices_since_func);
+	g_test_add_data_func ("/fwupd/engine{snapshot}", self,
+			      fu_engine_snapshot_func);
+	g_test_add_data_func ("/fwupd/engine{percentage-rate}", self,
+			      fu_engine_percentage_rate_func);
 	g_test_add_data_func ("/fwupd/engine{device-priority}", self,
 			      fu_engine_device_priority_func);
 	g_test_add_data_func ("/fwupd/engine{install-duration}", self,
@@ -3230,6 +3834,8 @@ main (int argc, char **argv)
 			      fu_plugin_composite_func);
 	g_test_add_data_func ("/fwupd/history", self,
 			      fu_history_func);
+	g_test_add_data_func ("/fwupd/history{paged}", self,
+			      fu_history_paged_func);
 	g_test_add_data_func ("/fwupd/history{migrate}", self,
 			      fu_history_migrate_func);
 	g_test_add_data_func ("/fwupd/plugin-list", self,
@@ -2466,6 +2466,22 @@ fu_util_security (FuUtilPrivate *priv, gchar **values, GError **error)
 	items = fu_security_attrs_get_all (attrs);
 	str = fu_util_security_attrs_to_string (items, flags);
 	g_print ("%s\n", str);
+
+	/* show how long each plugin took to evaluate */
+	if (priv->show_all) {
+		GPtrArray *plugins = fu_engine_get_plugins (priv->engine);
+		for (guint i = 0; i < plugins->len; i++) {
+			FuPlugin *plugin = g_ptr_array_index (plugins, i);
+			guint64 duration;
+			duration = fu_engine_get_host_security_attrs_duration (priv->engine,
+									       fu_plugin_get_name (plugin));
+			if (duration == 0)
+				continue;
+			g_print ("%s: %.1fms\n",
+				 fu_plugin_get_name (plugin),
+				 (gdouble) duration / 1000.f);
+		}
+	}
 	return TRUE;
 }
 
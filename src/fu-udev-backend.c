@@ -10,7 +10,7 @@
 
 #include <gudev/gudev.h>
 
-#include "fu-udev-device.h"
+#include "fu-udev-device-private.h"
 #include "fu-udev-backend.h"
 
 struct _FuUdevBackend {
@@ -23,16 +23,23 @@ struct _FuUdevBackend {
 
 G_DEFINE_TYPE (FuUdevBackend, fu_udev_backend, FU_TYPE_BACKEND)
 
-static void
-fu_udev_backend_device_add (FuUdevBackend *self, GUdevDevice *udev_device)
+static FuDevice *
+fu_udev_backend_device_create (FuUdevBackend *self, GUdevDevice *udev_device)
 {
 	g_autoptr(FuUdevDevice) device = fu_udev_device_new (udev_device);
-
-	/* success */
 	g_hash_table_insert (self->devices,
 			     g_strdup (g_udev_device_get_sysfs_path (udev_device)),
 			     g_object_ref (device));
-	fu_backend_device_added (FU_BACKEND (self), FU_DEVICE (device));
+	return FU_DEVICE (g_steal_pointer (&device));
+}
+
+static void
+fu_udev_backend_device_add (FuUdevBackend *self, GUdevDevice *udev_device)
+{
+	g_autoptr(FuDevice) device = fu_udev_backend_device_create (self, udev_device);
+
+	/* success */
+	fu_backend_device_added (FU_BACKEND (self), device);
 }
 
 static void
@@ -133,10 +140,18 @@ fu_udev_backend_uevent_cb (GUdevClient *gudev_client,
 	}
 }
 
+/* libudev is not thread safe, so this only reads sysfs directly */
+static gboolean
+fu_udev_backend_prefetch (FuBackend *backend, FuDevice *device, GError **error)
+{
+	return fu_udev_device_prefetch (FU_UDEV_DEVICE (device), error);
+}
+
 static gboolean
 fu_udev_backend_coldplug (FuBackend *backend, GError **error)
 {
 	FuUdevBackend *self = FU_UDEV_BACKEND (backend);
+	g_autoptr(GPtrArray) devices_new = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
 
 	/* udev watches can only be set up in _init() so set up client now */
 	if (self->subsystems->len > 0) {
@@ -161,12 +176,23 @@ fu_udev_backend_coldplug (FuBackend *backend, GError **error)
 		}
 		for (GList *l = devices; l != NULL; l = l->next) {
 			GUdevDevice *udev_device = l->data;
-			fu_udev_backend_device_add (self, udev_device);
+			FuDevice *device = fu_udev_backend_device_create (self, udev_device);
+			fu_udev_device_prefetch_prepare (FU_UDEV_DEVICE (device));
+			g_ptr_array_add (devices_new, device);
 		}
 		g_list_foreach (devices, (GFunc) g_object_unref, NULL);
 		g_list_free (devices);
 	}
 
+	/* read sysfs in parallel, then add in the order enumerated */
+	fu_backend_devices_added (backend, devices_new);
+
+	/* any later rescan has to read the current values */
+	for (guint i = 0; i < devices_new->len; i++) {
+		FuDevice *device = g_ptr_array_index (devices_new, i);
+		fu_udev_device_prefetch_clear (FU_UDEV_DEVICE (device));
+	}
+
 	return TRUE;
 }
 
@@ -200,6 +226,7 @@ fu_udev_backend_class_init (FuUdevBackendClass *klass)
 	object_class->finalize = fu_udev_backend_finalize;
 	klass_backend->coldplug = fu_udev_backend_coldplug;
 	klass_backend->recoldplug = fu_udev_backend_coldplug;
+	klass_backend->prefetch = fu_udev_backend_prefetch;
 }
 
 FuBackend *
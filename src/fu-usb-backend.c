@@ -10,13 +10,14 @@
 
 #include <gusb.h>
 
-#include "fu-usb-device.h"
+#include "fu-usb-device-private.h"
 #include "fu-usb-backend.h"
 
 struct _FuUsbBackend {
 	FuBackend		 parent_instance;
 	GUsbContext		*usb_ctx;
 	GHashTable		*devices;	/* platform_id : FuDevice */
+	GPtrArray		*devices_coldplug; /* (nullable) of FuDevice */
 };
 
 G_DEFINE_TYPE (FuUsbBackend, fu_usb_backend, FU_TYPE_BACKEND)
@@ -33,6 +34,12 @@ fu_usb_backend_device_added_cb (GUsbContext *ctx,
 	g_hash_table_insert (self->devices,
 			     g_strdup (g_usb_device_get_platform_id (usb_device)),
 			     g_object_ref (device));
+
+	/* descriptors are read by enumerate, so added when it has finished */
+	if (self->devices_coldplug != NULL) {
+		g_ptr_array_add (self->devices_coldplug, g_object_ref (device));
+		return;
+	}
 	fu_backend_device_added (backend, FU_DEVICE (device));
 }
 
@@ -74,11 +81,23 @@ fu_usb_backend_setup (FuBackend *backend, GError **error)
 	return TRUE;
 }
 
+static gboolean
+fu_usb_backend_prefetch (FuBackend *backend, FuDevice *device, GError **error)
+{
+	return fu_usb_device_prefetch (FU_USB_DEVICE (device), error);
+}
+
 static gboolean
 fu_usb_backend_coldplug (FuBackend *backend, GError **error)
 {
 	FuUsbBackend *self = FU_USB_BACKEND (backend);
+	g_autoptr(GPtrArray) devices = NULL;
+
+	/* collect the devices added synchronously by enumerate */
+	self->devices_coldplug = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
 	g_usb_context_enumerate (self->usb_ctx);
+	devices = g_steal_pointer (&self->devices_coldplug);
+	fu_backend_devices_added (backend, devices);
 	return TRUE;
 }
 
@@ -107,6 +126,7 @@ fu_usb_backend_class_init (FuUsbBackendClass *klass)
 	object_class->finalize = fu_usb_backend_finalize;
 	klass_backend->setup = fu_usb_backend_setup;
 	klass_backend->coldplug = fu_usb_backend_coldplug;
+	klass_backend->prefetch = fu_usb_backend_prefetch;
 }
 
 FuBackend *
@@ -30,6 +30,7 @@
 #include "fu-security-attrs.h"
 #include "fu-util-common.h"
 #include "fwupd-common-private.h"
+#include "fwupd-device-private.h"
 
 #ifdef HAVE_SYSTEMD
 #include "fu-systemd.h"
@@ -71,6 +72,7 @@ struct FuUtilPrivate {
 	gboolean		 sign;
 	gboolean		 show_all;
 	gboolean		 disable_ssl_strict;
+	gboolean		 as_json;
 	/* only valid in update and downgrade */
 	FuUtilOperation		 current_operation;
 	FwupdDevice		*current_device;
@@ -869,6 +871,45 @@ fu_util_report_history (FuUtilPrivate *priv, gchar **values, GError **error)
 	return TRUE;
 }
 
+static gboolean
+fu_util_get_history_as_json (FuUtilPrivate *priv, GPtrArray *devices, GError **error)
+{
+	g_autofree gchar *data = NULL;
+	g_autoptr(JsonBuilder) builder = json_builder_new ();
+	g_autoptr(JsonGenerator) json_generator = NULL;
+	g_autoptr(JsonNode) json_root = NULL;
+
+	json_builder_begin_object (builder);
+	json_builder_set_member_name (builder, "Devices");
+	json_builder_begin_array (builder);
+	for (guint i = 0; i < devices->len; i++) {
+		FwupdDevice *dev = g_ptr_array_index (devices, i);
+		if (!fu_util_filter_device (priv, dev))
+			continue;
+		json_builder_begin_object (builder);
+		fwupd_device_to_json (dev, builder);
+		json_builder_end_object (builder);
+	}
+	json_builder_end_array (builder);
+	json_builder_end_object (builder);
+
+	/* export as a string */
+	json_root = json_builder_get_root (builder);
+	json_generator = json_generator_new ();
+	json_generator_set_pretty (json_generator, TRUE);
+	json_generator_set_root (json_generator, json_root);
+	data = json_generator_to_data (json_generator, NULL);
+	if (data == NULL) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INTERNAL,
+				     "Failed to convert to JSON string");
+		return FALSE;
+	}
+	g_print ("%s\n", data);
+	return TRUE;
+}
+
 static gboolean
 fu_util_get_history (FuUtilPrivate *priv, gchar **values, GError **error)
 {
@@ -876,11 +917,27 @@ fu_util_get_history (FuUtilPrivate *priv, gchar **values, GError **error)
 	g_autoptr(GNode) root = g_node_new (NULL);
 	g_autofree gchar *title = fu_util_get_tree_title (priv);
 
-	/* get all devices from the history database */
-	devices = fwupd_client_get_history (priv->client, NULL, error);
+	/* get all devices from the history database, or just the one */
+	if (g_strv_length (values) == 0) {
+		devices = fwupd_client_get_history (priv->client, NULL, error);
+	} else if (g_strv_length (values) == 1) {
+		devices = fwupd_client_get_history_full (priv->client, values[0],
+							 FWUPD_UPDATE_STATE_UNKNOWN,
+							 0, 0, 0, 0, NULL, error);
+	} else {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_ARGS,
+				     "Invalid arguments");
+		return FALSE;
+	}
 	if (devices == NULL)
 		return FALSE;
 
+	/* for scripts */
+	if (priv->as_json)
+		return fu_util_get_history_as_json (priv, devices, error);
+
 	/* show each device */
 	for (guint i = 0; i < devices->len; i++) {
 		g_autoptr(GPtrArray) rels = NULL;
@@ -1399,6 +1456,8 @@ static gboolean
 fu_util_get_updates (FuUtilPrivate *priv, gchar **values, GError **error)
 {
 	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GHashTable) upgrades = NULL;
+	g_autoptr(GHashTable) upgrades_errors = NULL;
 	gboolean supported = FALSE;
 	g_autoptr(GNode) root = g_node_new (NULL);
 	g_autofree gchar *title = fu_util_get_tree_title (priv);
@@ -1411,9 +1470,17 @@ fu_util_get_updates (FuUtilPrivate *priv, gchar **values, GError **error)
 
 	/* handle both forms */
 	if (g_strv_length (values) == 0) {
+		g_autoptr(GError) error_local = NULL;
 		devices = fwupd_client_get_devices (priv->client, NULL, error);
 		if (devices == NULL)
 			return FALSE;
+
+		/* get all the upgrades in one round-trip if the daemon supports it */
+		upgrades = fwupd_client_get_all_upgrades (priv->client,
+							  &upgrades_errors,
+							  NULL, &error_local);
+		if (upgrades == NULL)
+			g_debug ("falling back to per-device upgrades: %s", error_local->message);
 	} else if (g_strv_length (values) == 1) {
 		FwupdDevice *device = fu_util_get_device_by_id (priv, values[0], error);
 		if (device == NULL)
@@ -1451,9 +1518,19 @@ fu_util_get_updates (FuUtilPrivate *priv, gchar **values, GError **error)
 		supported = TRUE;
 
 		/* get the releases for this device and filter for validity */
-		rels = fwupd_client_get_upgrades (priv->client,
-						  fwupd_device_get_id (dev),
-						  NULL, &error_local);
+		if (upgrades != NULL &&
+		    g_hash_table_contains (upgrades, fwupd_device_get_id (dev))) {
+			GPtrArray *rels_tmp = g_hash_table_lookup (upgrades, fwupd_device_get_id (dev));
+			rels = g_ptr_array_ref (rels_tmp);
+		} else if (upgrades_errors != NULL &&
+			   g_hash_table_contains (upgrades_errors, fwupd_device_get_id (dev))) {
+			GError *error_tmp = g_hash_table_lookup (upgrades_errors, fwupd_device_get_id (dev));
+			error_local = g_error_copy (error_tmp);
+		} else {
+			rels = fwupd_client_get_upgrades (priv->client,
+							  fwupd_device_get_id (dev),
+							  NULL, &error_local);
+		}
 		if (rels == NULL) {
 			if (!latest_header) {
 				/* TRANSLATORS: message letting the user know no device upgrade available */
@@ -1575,6 +1652,8 @@ static gboolean
 fu_util_update_all (FuUtilPrivate *priv, GError **error)
 {
 	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GPtrArray) devices_todo = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_autoptr(GPtrArray) releases_todo = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
 	gboolean supported = FALSE;
 	gboolean no_updates_header = FALSE;
 	gboolean latest_header = FALSE;
@@ -1589,9 +1668,6 @@ fu_util_update_all (FuUtilPrivate *priv, GError **error)
 	g_ptr_array_sort (devices, fu_util_sort_devices_by_flags_cb);
 	for (guint i = 0; i < devices->len; i++) {
 		FwupdDevice *dev = g_ptr_array_index (devices, i);
-		FwupdRelease *rel;
-		const gchar *remote_id;
-		g_autofree gchar *upgrade_str = NULL;
 		g_autoptr(GPtrArray) rels = NULL;
 		g_autoptr(GError) error_local = NULL;
 
@@ -1626,7 +1702,29 @@ fu_util_update_all (FuUtilPrivate *priv, GError **error)
 			g_debug ("%s", error_local->message);
 			continue;
 		}
-		rel = g_ptr_array_index (rels, 0);
+		g_ptr_array_add (devices_todo, g_object_ref (dev));
+		g_ptr_array_add (releases_todo, g_object_ref (g_ptr_array_index (rels, 0)));
+	}
+
+	/* nobody is going to be asked, so fetch all the firmware in parallel */
+	if (releases_todo->len > 1 && (priv->no_safety_check || priv->assume_yes)) {
+		g_autoptr(GError) error_local = NULL;
+		g_autoptr(GPtrArray) filenames = NULL;
+		filenames = fwupd_client_download_releases (priv->client,
+							    releases_todo,
+							    priv->download_flags,
+							    priv->cancellable,
+							    &error_local);
+		if (filenames == NULL)
+			g_debug ("failed to prefetch: %s", error_local->message);
+	}
+
+	for (guint i = 0; i < devices_todo->len; i++) {
+		FwupdDevice *dev = g_ptr_array_index (devices_todo, i);
+		FwupdRelease *rel = g_ptr_array_index (releases_todo, i);
+		const gchar *remote_id;
+		g_autofree gchar *upgrade_str = NULL;
+
 		/* TRANSLATORS: message letting the user know an upgrade is available
 		 * %1 is the device name and %2 and %3 are version strings */
 		upgrade_str = g_strdup_printf (_("Upgrade available for %s from %s to %s"),
@@ -2797,6 +2895,9 @@ main (int argc, char *argv[])
 		{ "ignore-power", '\0', 0, G_OPTION_ARG_NONE, &ignore_power,
 			/* TRANSLATORS: command line option */
 			_("Ignore requirement of external power source"), NULL },
+		{ "json", '\0', 0, G_OPTION_ARG_NONE, &priv->as_json,
+			/* TRANSLATORS: command line option */
+			_("Output in JSON format"), NULL },
 		{ NULL}
 	};
 
@@ -2822,7 +2923,7 @@ main (int argc, char *argv[])
 		     fu_util_get_devices);
 	fu_util_cmd_array_add (cmd_array,
 		     "get-history",
-		     NULL,
+		     "[DEVICE-ID]",
 		     /* TRANSLATORS: command description */
 		     _("Show history of firmware updates"),
 		     fu_util_get_history);
@@ -3220,6 +3321,13 @@ main (int argc, char *argv[])
 		return EXIT_FAILURE;
 	}
 
+	/* only some commands can output JSON */
+	if (priv->as_json && g_strcmp0 (argv[1], "get-history") != 0) {
+		/* TRANSLATORS: error message, where --json is a command line option */
+		g_printerr ("%s\n", _("--json is only supported by get-history"));
+		return EXIT_FAILURE;
+	}
+
 	/* send our implemented feature set */
 	if (is_interactive) {
 		if (!fwupd_client_set_feature_flags (priv->client,